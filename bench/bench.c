@@ -0,0 +1,265 @@
+/** -------------------------------------------
+ * @file   bench.c
+ * @brief  Emfrp Benchmark Suite
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "misc.h"
+#include "emfrp.h"
+
+// ! A workload.
+typedef struct bench_workload_t
+{
+  // ! The name
+  const char * name;
+  // ! Count of iterations.
+  int iterations;
+  // ! Make the program.(It returns false if it fails.)
+  bool (*setup)(emfrp_t * e);
+  // ! Run before each iteration.(Nullable)
+  bool (*step)(emfrp_t * e, int i);
+} bench_workload_t;
+
+// ! The input of the workloads, which is the count of iterations.
+static int32_t bench_input = 0;
+
+static em_object_t *
+bench_input_callback(void)
+{
+  return emfrp_create_int_object(bench_input++);
+}
+
+static em_object_t * bench_last_output = nullptr;
+
+static void
+bench_output_callback(em_object_t * v)
+{
+  bench_last_output = v;
+}
+
+// ! Execute the line.
+/* !
+ * \param e The instance
+ * \param line The line
+ * \return Whether it succeeds.
+ */
+static bool
+bench_exec(emfrp_t * e, const char * line)
+{
+  em_object_t * v;
+  em_result     res = emfrp_repl(e, line, &v);
+  if(res != EM_RESULT_OK) fprintf(stderr, "bench: %s: %s\n", line, EM_RESULT_STR_TABLE[res]);
+  return res == EM_RESULT_OK;
+}
+
+// ! Execute the formatted line.
+static bool
+bench_execf(emfrp_t * e, const char * format, ...)
+{
+  char    buf[1024];
+  va_list ap;
+  va_start(ap, format);
+  vsnprintf(buf, sizeof(buf), format, ap);
+  va_end(ap);
+  return bench_exec(e, buf);
+}
+
+// Deep arithmetic chains: n0 <- n1 <- ... <- n63
+#define BENCH_CHAIN_DEPTH 64
+static bool
+bench_setup_chain(emfrp_t * e)
+{
+  if(!bench_exec(e, "node n0 = inp * 3 + 1")) return false;
+  for(int i = 1; i < BENCH_CHAIN_DEPTH; ++i)
+    if(!bench_execf(e, "node n%d = (n%d * 5 + %d) %% 65521 - (n%d >> 1)", i, i - 1, i, i - 1))
+      return false;
+  return bench_execf(e, "node out = n%d", BENCH_CHAIN_DEPTH - 1);
+}
+
+// Wide fan-out graphs: src -> w0, ..., w127 -> out
+#define BENCH_FANOUT_WIDTH 128
+static bool
+bench_setup_fanout(emfrp_t * e)
+{
+  char buf[1024];
+  int  len;
+  if(!bench_exec(e, "node src = inp + 1")) return false;
+  for(int i = 0; i < BENCH_FANOUT_WIDTH; ++i)
+    if(!bench_execf(e, "node w%d = src * %d + (src %% %d)", i, i + 1, i + 2)) return false;
+  // Sum the leaves by 8 to keep lines short.
+  for(int i = 0; i < BENCH_FANOUT_WIDTH / 8; ++i)
+    if(!bench_execf(
+         e, "node s%d = w%d + w%d + w%d + w%d + w%d + w%d + w%d + w%d", i, i * 8, i * 8 + 1,
+         i * 8 + 2, i * 8 + 3, i * 8 + 4, i * 8 + 5, i * 8 + 6, i * 8 + 7))
+      return false;
+  len = snprintf(buf, sizeof(buf), "node out = s0");
+  for(int i = 1; i < BENCH_FANOUT_WIDTH / 8; ++i)
+    len += snprintf(buf + len, sizeof(buf) - len, " + s%d", i);
+  return bench_exec(e, buf);
+}
+
+// Record-heavy programs: records are made and deconstructed in every node.
+static bool
+bench_setup_records(emfrp_t * e)
+{
+  return bench_exec(e, "record P(px, py)") && bench_exec(e, "record Q(qa, qb, qc)")
+         && bench_exec(e, "func swap(p) = P(py(p), px(p))")
+         && bench_exec(e, "func mk(a) = Q(P(a, a + 1), swap(P(a, 2)), a)")
+         && bench_exec(
+           e, "node init[P(0, 0)] p = swap(P((px(p@last) + inp) % 4096, py(p@last) % 4096 + 1))")
+         && bench_exec(e, "node q = mk(px(p))")
+         && bench_exec(e, "node r = q of: Q(P(a, b), P(c, d), x) -> P(a + c, b + d + x)")
+         && bench_exec(e, "node out = px(r) + py(r)");
+}
+
+// Closures: the captured variables of pick are only in the branch dropped by constant folding.
+static bool
+bench_setup_closures(emfrp_t * e)
+{
+  return bench_exec(e, "func adder(a) = func(b) -> a + b")
+         && bench_exec(
+           e, "func pick(a) = (func(b) -> if false then (b of: y -> (func() -> y)()) else (func() "
+              "-> a * b)())(3)")
+         && bench_exec(e, "node out = adder(pick(inp % 1024))(1)");
+}
+
+// Recursive functions
+static bool
+bench_setup_recursion(emfrp_t * e)
+{
+  return bench_exec(e, "func fib(n) = if n < 2 then n else fib(n - 1) + fib(n - 2)")
+         && bench_exec(e, "func sum(n, acc) = if n == 0 then acc else sum(n - 1, acc + n)")
+         && bench_exec(e, "node out = fib(inp % 4 + 12) + sum(inp % 64 + 128, 0)");
+}
+
+// Frequent redefinitions: a node in the middle is redefined before every iteration.
+static bool
+bench_setup_redefinition(emfrp_t * e)
+{
+  return bench_exec(e, "node a = inp + 1") && bench_exec(e, "node b = a * 2")
+         && bench_exec(e, "node c = b + a") && bench_exec(e, "node out = c + b");
+}
+
+static bool
+bench_step_redefinition(emfrp_t * e, int i)
+{
+  // The time includes parsing the definition.
+  return bench_execf(e, "node b = a * %d", i % 7 + 2);
+}
+
+// Big tuples: tuples of 16 elements are made and deconstructed.
+static bool
+bench_setup_tuples(emfrp_t * e)
+{
+  return bench_exec(
+           e, "node t = (inp, inp + 1, inp + 2, inp + 3, inp + 4, inp + 5, inp + 6, inp + 7, "
+              "inp + 8, inp + 9, inp + 10, inp + 11, inp + 12, inp + 13, inp + 14, inp + 15)")
+         && bench_exec(
+           e, "node u = t of: (a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, "
+              "a15) -> (a15, a14, a13, a12, a11, a10, a9, a8, a7, a6, a5, a4, a3, a2, a1, a0)")
+         && bench_exec(
+           e, "node out = u of: (a0, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, "
+              "a14, a15) -> a0 + a3 * a5 + a7 - a11 + a13 * a15")
+         && bench_exec(
+           e, "node init[(0, 0, 0, 0)] acc = acc@last of: (a, b, c, d) -> (b, c, d, out)");
+}
+
+static const bench_workload_t bench_workloads[] = {
+  {"chain", 20000, bench_setup_chain, nullptr},
+  {"closures", 20000, bench_setup_closures, nullptr},
+  {"fanout", 10000, bench_setup_fanout, nullptr},
+  {"records", 50000, bench_setup_records, nullptr},
+  {"recursion", 2000, bench_setup_recursion, nullptr},
+  {"redefinition", 5000, bench_setup_redefinition, bench_step_redefinition},
+  {"tuples", 50000, bench_setup_tuples, nullptr},
+};
+
+static double
+bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// ! Run the workload.
+/* !
+ * \param w The workload
+ * \param scale The count of iterations is multiplied by this.
+ * \return Whether it succeeds.
+ */
+static bool
+bench_run(const bench_workload_t * w, double scale)
+{
+  emfrp_t *            e;
+  emfrp_memory_stats_t before, after;
+  int                  iterations = (int)(w->iterations * scale);
+  double               elapsed    = 0;
+  if(iterations < 1) iterations = 1;
+  bench_input       = 0;
+  bench_last_output = nullptr;
+  if(emfrp_create(&e) != EM_RESULT_OK) return false;
+  if(emfrp_add_input_node(e, "inp", bench_input_callback) != EM_RESULT_OK) return false;
+  if(emfrp_add_output_node(e, "out", bench_output_callback) != EM_RESULT_OK) return false;
+  if(!w->setup(e)) return false;
+  // Warm up, so that the heap grows and the definitions are linked.
+  for(int i = 0; i < 16; ++i)
+    if(emfrp_update(e) != EM_RESULT_OK) return false;
+  emfrp_get_memory_stats(e, &before);
+  for(int i = 0; i < iterations; ++i) {
+    double start = 0;
+    if(w->step != nullptr) {
+      start = bench_now_ns();
+      if(!w->step(e, i)) return false;
+      elapsed += bench_now_ns() - start;
+    }
+    start         = bench_now_ns();
+    em_result res = emfrp_update(e);
+    elapsed += bench_now_ns() - start;
+    if(res != EM_RESULT_OK) {
+      fprintf(stderr, "bench: %s: emfrp_update: %s\n", w->name, EM_RESULT_STR_TABLE[res]);
+      return false;
+    }
+  }
+  emfrp_get_memory_stats(e, &after);
+  printf(
+    "%-14s %10d %14.1f %14.2f %10zu %10zu %11d\n", w->name, iterations, elapsed / iterations,
+    (double)(after.allocations - before.allocations) / iterations,
+    after.gc_cycles - before.gc_cycles, after.heap_objects,
+    bench_last_output == nullptr ? 0 : emfrp_get_integer(bench_last_output));
+  return true;
+}
+
+int
+main(int argc, char ** argv)
+{
+  double       scale  = 1.0;
+  const char * filter = nullptr;
+  int          failed = 0;
+  for(int i = 1; i < argc; ++i) {
+    if(strcmp(argv[i], "-s") == 0 && i + 1 < argc)
+      scale = atof(argv[++i]);
+    else if(argv[i][0] != '-')
+      filter = argv[i];
+    else {
+      fprintf(stderr, "usage: %s [-s scale] [workload]\n", argv[0]);
+      return 2;
+    }
+  }
+  printf(
+    "%-14s %10s %14s %14s %10s %10s %11s\n", "workload", "iterations", "ns/iteration",
+    "allocs/iter", "gc cycles", "heap", "last output");
+  for(size_t i = 0; i < sizeof(bench_workloads) / sizeof(bench_workloads[0]); ++i) {
+    if(filter != nullptr && strcmp(filter, bench_workloads[i].name) != 0) continue;
+    if(!bench_run(&bench_workloads[i], scale)) {
+      fprintf(stderr, "bench: %s failed.\n", bench_workloads[i].name);
+      failed++;
+    }
+  }
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/** -------------------------------------------
+ * @file   input_stress.c
+ * @brief  Stress Test of Posted Inputs
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "emfrp.h"
+#include "vm/input_queue_t.h"
+
+// Producers of input_queue_t
+#define STRESS_PRODUCERS 4
+
+// ! The producer of the queue.
+typedef struct stress_producer_t
+{
+  // ! The queue
+  input_queue_t * queue;
+  // ! The count of posts.
+  size_t count;
+  // ! The count of retries, because the queue is full.
+  size_t retries;
+} stress_producer_t;
+
+static void *
+stress_produce(void * arg)
+{
+  stress_producer_t * p = (stress_producer_t *)arg;
+  // The node is the producer, and the value is the sequence number.
+  for(size_t i = 1; i <= p->count; ++i)
+    while(!input_queue_post(p->queue, (node_t *)p, (struct object_t *)(uintptr_t)i)) {
+      p->retries++;
+      sched_yield();
+    }
+  return nullptr;
+}
+
+// ! Producers post through input_queue_t concurrently.
+/* !
+ * Posts of a producer are taken in the order, so that a lost or duplicated post breaks the sequence.
+ * \param count The count of posts per producer
+ * \return Whether it succeeds.
+ */
+static bool
+stress_threads(size_t count)
+{
+  static input_queue_t queue;
+  stress_producer_t    producers[STRESS_PRODUCERS];
+  pthread_t            threads[STRESS_PRODUCERS];
+  size_t               expected[STRESS_PRODUCERS];
+  size_t               taken   = 0;
+  size_t               retries = 0;
+  bool                 ok      = true;
+  input_queue_new(&queue);
+  for(int i = 0; i < STRESS_PRODUCERS; ++i) {
+    producers[i] = (stress_producer_t){.queue = &queue, .count = count, .retries = 0};
+    expected[i]  = 1;
+    if(pthread_create(&threads[i], nullptr, stress_produce, &producers[i]) != 0) {
+      fprintf(stderr, "input_stress: pthread_create failed.\n");
+      exit(1);
+    }
+  }
+  while(taken < count * STRESS_PRODUCERS) {
+    node_t *          node;
+    struct object_t * value;
+    if(!input_queue_take(&queue, &node, &value)) {
+      sched_yield();
+      continue;
+    }
+    int p = (int)((stress_producer_t *)node - producers);
+    if(p < 0 || p >= STRESS_PRODUCERS || (size_t)(uintptr_t)value != expected[p]) {
+      fprintf(
+        stderr, "input_stress: threads: got %zu from %d, expected %zu.\n",
+        (size_t)(uintptr_t)value, p, p < 0 || p >= STRESS_PRODUCERS ? 0 : expected[p]);
+      ok = false;
+      break;
+    }
+    expected[p]++;
+    taken++;
+  }
+  for(int i = 0; i < STRESS_PRODUCERS; ++i) {
+    pthread_join(threads[i], nullptr);
+    retries += producers[i].retries;
+  }
+  if(ok) {
+    node_t *          node;
+    struct object_t * value;
+    if(input_queue_take(&queue, &node, &value)) {
+      fprintf(stderr, "input_stress: threads: extra post.\n");
+      ok = false;
+    }
+  }
+  printf(
+    "%-8s %10zu posts %10zu retries %s\n", "threads", count * STRESS_PRODUCERS, retries,
+    ok ? "ok" : "FAILED");
+  return ok;
+}
+
+static emfrp_t *             stress_emfrp;
+static emfrp_node_handle     stress_input;
+static volatile sig_atomic_t stress_posted;  // The last value posted by the handler.
+static volatile sig_atomic_t stress_limit;
+static volatile sig_atomic_t stress_full;
+
+static void
+stress_alarm(int sig)
+{
+  (void)sig;
+  if(stress_posted >= stress_limit) return;
+  if(emfrp_post_input(stress_emfrp, stress_input, emfrp_create_int_object(stress_posted + 1))
+     == EM_RESULT_OK)
+    stress_posted++;
+  else
+    stress_full++;
+}
+
+// ! SIGALRM handler posts through emfrp_post_input while the main thread updates.
+/* !
+ * The handler posts 1, 2, ..., count to the node. Thus, the value never decreases if the last post
+ * wins, and it is count at the end if no post is lost.
+ * \param count The count of posts
+ * \return Whether it succeeds.
+ */
+static bool
+stress_signal(int count)
+{
+  struct itimerval timer   = {{0, 20}, {0, 20}};
+  struct itimerval stop    = {{0, 0}, {0, 0}};
+  size_t           updates = 0;
+  int32_t          last    = 0;
+  bool             ok      = true;
+  if(emfrp_create(&stress_emfrp) != EM_RESULT_OK
+     || emfrp_add_input_node(stress_emfrp, "x", nullptr) != EM_RESULT_OK) {
+    fprintf(stderr, "input_stress: signal: setup failed.\n");
+    return false;
+  }
+  stress_input  = emfrp_lookup_node(stress_emfrp, "x");
+  stress_posted = 0;
+  stress_full   = 0;
+  stress_limit  = count;
+  signal(SIGALRM, stress_alarm);
+  setitimer(ITIMER_REAL, &timer, nullptr);
+  while(ok) {
+    bool          done = stress_posted >= stress_limit;
+    em_result     res  = emfrp_drain_and_update(stress_emfrp);
+    em_object_t * v    = emfrp_get_value(stress_emfrp, stress_input);
+    int32_t       n    = v == nullptr ? 0 : emfrp_get_integer(v);
+    updates++;
+    if(res != EM_RESULT_OK) {
+      fprintf(stderr, "input_stress: signal: %s\n", EM_RESULT_STR_TABLE[res]);
+      ok = false;
+    } else if(n < last) {
+      fprintf(stderr, "input_stress: signal: %d is overridden by the older %d.\n", last, n);
+      ok = false;
+    } else if(done && n != count) {
+      fprintf(stderr, "input_stress: signal: got %d, expected the last post %d.\n", n, count);
+      ok = false;
+    } else if(done)
+      break;
+    last = n;
+  }
+  setitimer(ITIMER_REAL, &stop, nullptr);
+  signal(SIGALRM, SIG_DFL);
+  printf(
+    "%-8s %10d posts %10d retries %10zu updates %s\n", "signal", (int)stress_posted,
+    (int)stress_full, updates, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+int
+main(int argc, char ** argv)
+{
+  double scale  = 1.0;
+  int    failed = 0;
+  if(argc == 3 && strcmp(argv[1], "-s") == 0)
+    scale = atof(argv[2]);
+  else if(argc != 1) {
+    fprintf(stderr, "usage: %s [-s scale]\n", argv[0]);
+    return 2;
+  }
+  if(!stress_threads((size_t)(1000000 * scale) + 1)) failed++;
+  if(!stress_signal((int)(20000 * scale) + 1)) failed++;
+  return failed == 0 ? 0 : 1;
+}
@@ -8,6 +8,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "driver/gpio.h"
 #include "emfrp.h"
 
@@ -100,6 +101,10 @@ end:
 /// Console Functions
 
 emfrp_t * em = nullptr;
+// emfrp_t is not thread-safe. mainTask and updateTask take it.
+static SemaphoreHandle_t em_lock     = nullptr;
+static TaskHandle_t      update_task = nullptr;
+static emfrp_node_handle gpio16      = nullptr;
 
 em_object_t *
 gpio_input(void)
@@ -116,8 +121,22 @@ gpio_output(em_object_t * obj)
 void
 interruption(void * arg)
 {
-  emfrp_set_node_value(em, "gpio16", gpio_input());
-  em_result res = emfrp_update(em);
+  // The interpreter must not run in the interrupt context. It only posts the input.
+  BaseType_t woken = pdFALSE;
+  emfrp_post_input(em, gpio16, gpio_input());
+  vTaskNotifyGiveFromISR(update_task, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+void
+updateTask(void * arg)
+{
+  while(true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    xSemaphoreTake(em_lock, portMAX_DELAY);
+    emfrp_drain_and_update(em);
+    xSemaphoreGive(em_lock);
+  }
 }
 
 void
@@ -135,11 +154,19 @@ setup_gpio_test(void)
   g.mode         = GPIO_MODE_INPUT;
   gpio_config(&g);
   gpio_install_isr_service(0);
-  emfrp_add_input_node(em, "gpio16", gpio_input);
+  emfrp_add_input_node(em, "gpio16", nullptr);  // It is set by interruption.
   emfrp_add_output_node(em, "gpio17", gpio_output);
+  gpio16 = emfrp_lookup_node(em, "gpio16");
   gpio_isr_handler_add(16, interruption, nullptr);
 }
 
+// ! The sink of diagnostics.
+static void
+write_diagnostic(void * user, em_diag_level level, const char * text, size_t length)
+{
+  fwrite(text, 1, length, stdout);
+}
+
 void
 mainTask(void)
 {
@@ -152,6 +179,9 @@ mainTask(void)
     printf("Emfrp creation failure: %s\n", EM_RESULT_STR_TABLE[res]);
     goto fail;
   }
+  emfrp_set_diag_sink(EM_DIAG_LEVEL_INFO, write_diagnostic, nullptr);
+  em_lock = xSemaphoreCreateMutex();
+  xTaskCreate(updateTask, "update_task", 8192, nullptr, 9, &update_task);
   setup_gpio_test();
   puts("Emfrp REPL on ESP32.");
   printf("Heap free size: %ld\n", esp_get_free_heap_size());
@@ -164,13 +194,15 @@ mainTask(void)
       continue;
     }
     em_object_t * o = nullptr;
-    res             = emfrp_repl(em, line.buffer, &o);
+    xSemaphoreTake(em_lock, portMAX_DELAY);
+    res = emfrp_repl(em, line.buffer, &o);
     if(res == EM_RESULT_OK) {
       emfrp_print_object(o);
       puts("");
     } else {
       printf("machine_exec failure(%d): %s\n", res, EM_RESULT_STR_TABLE[res]);
     }
+    xSemaphoreGive(em_lock);
     printf("Heap free size: %ld\n", esp_get_free_heap_size());
   }
 fail:
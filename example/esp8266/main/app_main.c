@@ -98,6 +98,13 @@ end:
 
 emfrp_t * em = nullptr;
 
+// ! The sink of diagnostics.
+static void
+write_diagnostic(void * user, em_diag_level level, const char * text, size_t length)
+{
+  fwrite(text, 1, length, stdout);
+}
+
 void
 mainTask(void)
 {
@@ -110,6 +117,7 @@ mainTask(void)
     printf("Emfrp creation failure: %s\n", EM_RESULT_STR_TABLE[res]);
     goto fail;
   }
+  emfrp_set_diag_sink(EM_DIAG_LEVEL_INFO, write_diagnostic, nullptr);
   printf("Emfrp REPL on ESP8266.\n");
   while(true) {
     read_line(&line);
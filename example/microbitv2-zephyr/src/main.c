@@ -146,6 +146,13 @@ readLine()
   return NULL;
 }
 
+// ! The sink of diagnostics.
+static void
+write_diagnostic(void * user, em_diag_level level, const char * text, size_t length)
+{
+  fwrite(text, 1, length, stdout);
+}
+
 void
 main()
 {
@@ -159,6 +166,7 @@ main()
       k_usleep(100000000);
     }
   }
+  emfrp_set_diag_sink(EM_DIAG_LEVEL_INFO, write_diagnostic, nullptr);
   objectFalse = emfrp_get_false_object();
   setupLED();
   setupBtn();
@@ -14,6 +14,7 @@
 #include "ast.h"
 #include "vm/machine.h"
 #include "vm/exec.h"
+#include "emdiag.h"
 
 /// Console Functions
 #include "string_t.h"
@@ -75,6 +76,13 @@ end:
   string_new(out, buf, start);
   return EM_RESULT_OK;
 }
+
+// ! The sink of diagnostics.
+static void
+write_diagnostic(void * user, em_diag_level level, const char * text, size_t length)
+{
+  fwrite(text, 1, length, stdout);
+}
 /// Console Functions
 
 const uint LED_PIN    = 25;
@@ -95,8 +103,9 @@ main()
   string_null(&line);
   initialize_console();
   machine_new(&m);
+  em_diag_set_sink(EM_DIAG_LEVEL_INFO, write_diagnostic, nullptr);
   printf("Emfrp REPL on ESP32.\n");
-  machine_debug_print_definitions(&m);
+  EM_DIAG(EM_DIAG_LEVEL_DEBUG, machine_debug_print_definitions(&m));
   while(true) {
     string_null(&line);
     read_line(&line);
@@ -107,26 +116,25 @@ main()
     }
     parser_reader_new(&parser_reader, &line);
     parser_context_t * ctx = parser_create(&parser_reader);
-    if(!parser_parse(ctx, (void **)&parsed)) {
+    // parsed is nullptr if the line is empty or a comment.
+    if(!parser_parse(ctx, (void **)&parsed) && parsed != nullptr) {
       object_t * o = nullptr;
       // printf("Heap free size: %d\n", esp_get_free_heap_size());
-      parser_toplevel_print(parsed);
-      printf("\n");
+      EM_DIAG(EM_DIAG_LEVEL_DEBUG, parser_toplevel_print(parsed); em_diag_puts("\n"));
       em_result res = machine_exec(&m, parsed, &o);
-      // We have to think free_deep or free_shallow.
+      parser_toplevel_release(parsed);  // The machine retains it if it needs.
       if(res != EM_RESULT_OK) {
         printf("machine_exec failure(%d): %s\n", res, EM_RESULT_STR_TABLE[res]);
         printf("%s\n", EM_RESULT_STR_TABLE[res]);
-        parser_toplevel_free_deep(parsed);
       } else {
-        parser_toplevel_free_shallow(parsed);
         printf("OK, ");
-        object_print(o);
+        EM_DIAG(EM_DIAG_LEVEL_INFO, object_print(o));
         printf("\n");
       }
-      machine_debug_print_definitions(&m);
+      EM_DIAG(EM_DIAG_LEVEL_DEBUG, machine_debug_print_definitions(&m));
     }
     parser_destroy(ctx);
+    parser_reader_free(&parser_reader);
     // printf("Heap free size: %d\n", esp_get_free_heap_size());
   }
   while(1) {
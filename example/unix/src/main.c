@@ -11,6 +11,7 @@
 #include "vm/machine.h"
 #include "vm/exec.h"
 #include "vm/exec_sequence_t.h"
+#include "emdiag.h"
 
 int
 initialize_console(void)
@@ -28,6 +29,13 @@ read_line(string_t * out)
   return EM_RESULT_OK;
 }
 
+// ! The sink of diagnostics.
+static void
+write_diagnostic(void * user, em_diag_level level, const char * text, size_t length)
+{
+  fwrite(text, 1, length, stdout);
+}
+
 int
 main(void)
 {
@@ -38,6 +46,7 @@ main(void)
   string_null(&line);
   machine_new(&m);
   initialize_console();
+  em_diag_set_sink(EM_DIAG_LEVEL_DEBUG, write_diagnostic, nullptr);
   while(true) {
     string_free(&line);
     if(read_line(&line) != EM_RESULT_OK) {
@@ -51,26 +60,31 @@ main(void)
       continue;
     }
     if(line.length == 4 && strncmp(line.buffer, "exit", 4) == 0) return 0;
+#if EMFRP_ENABLE_PROFILING
+    if(line.length == 8 && strncmp(line.buffer, ":profile", 8) == 0) {
+      EM_DIAG(EM_DIAG_LEVEL_INFO, machine_debug_print_profile(&m));
+      continue;
+    }
+#endif
     parser_context_t * ctx = parser_create(&parser_reader);
-    if(!parser_parse(ctx, (void **)&parsed)) {
+    // parsed is nullptr if the line is empty or a comment.
+    if(!parser_parse(ctx, (void **)&parsed) && parsed != nullptr) {
       object_t * o = nullptr;
-      parser_toplevel_print(parsed);
-      puts("");
+      EM_DIAG(EM_DIAG_LEVEL_DEBUG, parser_toplevel_print(parsed); em_diag_puts("\n"));
       em_result res = machine_exec(&m, parsed, &o);
-      // We have to think free_deep or free_shallow.
+      parser_toplevel_release(parsed);  // The machine retains it if it needs.
       if(res != EM_RESULT_OK) {
         printf("machine_exec failure(%d): %s\n", res, EM_RESULT_STR_TABLE[res]);
         printf("%s\n", EM_RESULT_STR_TABLE[res]);
-        parser_toplevel_free_deep(parsed);
       } else {
-        parser_toplevel_free_shallow(parsed);
         fputs("OK, ", stdout);
-        object_print(o);
+        EM_DIAG(EM_DIAG_LEVEL_INFO, object_print(o));
         puts("");
       }
-      machine_debug_print_definitions(&m);
+      EM_DIAG(EM_DIAG_LEVEL_DEBUG, machine_debug_print_definitions(&m));
     }
     parser_destroy(ctx);
+    parser_reader_free(&parser_reader);
   }
   return 0;
 }
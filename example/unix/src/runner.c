@@ -0,0 +1,352 @@
+/** -------------------------------------------
+ * @file   runner.c
+ * @brief  Emfrp Headless Runner for UNIX-like systems.
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "emfrp.h"
+#include "vm/object_t.h"
+
+#define RUNNER_MAX_COLUMNS 256
+
+// ! The reader of lines, from the mapped file or the stream.
+typedef struct runner_reader_t
+{
+  // ! The mapped file.(Nullable)
+  char * map;
+  // ! The length of runner_reader_t::map.
+  size_t map_length;
+  // ! The position of the next line in runner_reader_t::map.
+  size_t position;
+  // ! The stream, if the file is not mapped.(Nullable)
+  FILE * file;
+  // ! The buffer of getline.
+  char * line;
+  // ! The capacity of runner_reader_t::line.
+  size_t line_capacity;
+} runner_reader_t;
+
+// ! Open the file.
+/* !
+ * Regular files are mapped if use_mmap is true, and the others(e.g. pipes) are read by stdio.
+ * \param out The result
+ * \param path The path, or "-" for stdin.
+ * \param use_mmap Whether the file may be mapped.
+ * \return Whether it succeeds.
+ */
+static bool
+runner_reader_open(runner_reader_t * out, const char * path, bool use_mmap)
+{
+  struct stat st;
+  memset(out, 0, sizeof(runner_reader_t));
+  int fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY);
+  if(fd < 0) return false;
+  if(use_mmap && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void * map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(map != MAP_FAILED) {
+      madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+      out->map        = (char *)map;
+      out->map_length = (size_t)st.st_size;
+      if(fd != STDIN_FILENO) close(fd);
+      return true;
+    }
+  }
+  out->file = fd == STDIN_FILENO ? stdin : fdopen(fd, "r");
+  return out->file != nullptr;
+}
+
+// ! Read the next line.
+/* !
+ * \param self The reader
+ * \param line The line without the line break. It is not terminated by '\0'.
+ * \param length The length of line.
+ * \return Whether a line is read(true) or it reaches the end(false).
+ */
+static bool
+runner_reader_next(runner_reader_t * self, const char ** line, size_t * length)
+{
+  if(self->map != nullptr) {
+    if(self->position >= self->map_length) return false;
+    const char * begin = self->map + self->position;
+    const char * end   = memchr(begin, '\n', self->map_length - self->position);
+    if(end == nullptr) end = self->map + self->map_length;
+    self->position = (size_t)(end - self->map) + 1;
+    *line          = begin;
+    *length        = (size_t)(end - begin);
+  } else {
+    ssize_t len = getline(&(self->line), &(self->line_capacity), self->file);
+    if(len < 0) return false;
+    if(len > 0 && self->line[len - 1] == '\n') len--;
+    *line   = self->line;
+    *length = (size_t)len;
+  }
+  if(*length > 0 && (*line)[*length - 1] == '\r') (*length)--;
+  return true;
+}
+
+static void
+runner_reader_close(runner_reader_t * self)
+{
+  if(self->map != nullptr) munmap(self->map, self->map_length);
+  if(self->file != nullptr && self->file != stdin) fclose(self->file);
+  free(self->line);
+}
+
+// ! Split the line by commas.
+/* !
+ * \param line The line
+ * \param length The length of line.
+ * \param columns The beginnings of columns.
+ * \param lengths The lengths of columns.
+ * \return The count of columns, or -1 if there are too many columns.
+ */
+static int
+runner_split(const char * line, size_t length, const char ** columns, size_t * lengths)
+{
+  int          count = 0;
+  const char * end   = line + length;
+  while(true) {
+    const char * comma = memchr(line, ',', (size_t)(end - line));
+    if(count == RUNNER_MAX_COLUMNS) return -1;
+    columns[count] = line;
+    lengths[count] = (size_t)((comma == nullptr ? end : comma) - line);
+    count++;
+    if(comma == nullptr) return count;
+    line = comma + 1;
+  }
+}
+
+// ! Parse an integer or a boolean value.
+/* !
+ * \param s The string, which is not terminated by '\0'.
+ * \param length The length of s.
+ * \param out The result
+ * \return Whether it succeeds.(Integers out of OBJECT_INT_MIN..OBJECT_INT_MAX are rejected.)
+ */
+static bool
+runner_parse_value(const char * s, size_t length, em_object_t ** out)
+{
+  int64_t v        = 0;
+  bool    negative = false;
+  size_t  i        = 0;
+  while(length > 0 && s[0] == ' ') s++, length--;
+  while(length > 0 && s[length - 1] == ' ') length--;
+  if(length == 4 && strncmp(s, "true", 4) == 0) {
+    *out = emfrp_get_true_object();
+    return true;
+  }
+  if(length == 5 && strncmp(s, "false", 5) == 0) {
+    *out = emfrp_get_false_object();
+    return true;
+  }
+  if(length > 0 && s[0] == '-') negative = true, i++;
+  if(i == length) return false;
+  for(; i < length; ++i) {
+    if(s[i] < '0' || s[i] > '9') return false;
+    v = v * 10 + (s[i] - '0');
+    // Integer objects are narrower than int32_t.
+    if(v > (negative ? -(int64_t)OBJECT_INT_MIN : OBJECT_INT_MAX)) return false;
+  }
+  *out = emfrp_create_int_object((int32_t)(negative ? -v : v));
+  return true;
+}
+
+// ! Print the value as a column.
+static void
+runner_print_value(em_object_t * v)
+{
+  if(v == nullptr)
+    return;  // Not evaluated, or failed.
+  else if(object_is_integer(v))
+    printf("%d", object_get_integer(v));
+  else if(v == &object_true)
+    fputs("true", stdout);
+  else if(v == &object_false)
+    fputs("false", stdout);
+  else {  // Tuples and records have commas.
+    putchar('"');
+    emfrp_print_object(v);
+    putchar('"');
+  }
+}
+
+// ! The sink of diagnostics. Values are written to stdout, and failures are to stderr.
+static void
+runner_write_diagnostic(void * user, em_diag_level level, const char * text, size_t length)
+{
+  fwrite(text, 1, length, level <= EM_DIAG_LEVEL_WARNING ? stderr : stdout);
+}
+
+// ! Load the program file.
+/* !
+ * \param emfrp The emfrp
+ * \param path The path
+ * \return Whether it succeeds.
+ */
+static bool
+runner_load_program(emfrp_t * emfrp, const char * path)
+{
+  FILE * file   = fopen(path, "rb");
+  char * source = nullptr;
+  size_t length = 0, failed = 0;
+  bool   result = false;
+  if(file == nullptr || fseek(file, 0, SEEK_END) != 0) goto err;
+  length = (size_t)ftell(file);
+  rewind(file);
+  source = malloc(length + 1);
+  if(source == nullptr || fread(source, 1, length, file) != length) goto err;
+  source[length] = '\0';
+  em_result res  = emfrp_load(emfrp, source, &failed);
+  if(res == EM_RESULT_CYCLIC_REFERENCE)
+    fprintf(stderr, "%s: %s\n", path, EM_RESULT_STR_TABLE[res]);
+  else if(res != EM_RESULT_OK)
+    fprintf(stderr, "%s: definition %zu: %s\n", path, failed + 1, EM_RESULT_STR_TABLE[res]);
+  result = res == EM_RESULT_OK;
+  free(source);
+  fclose(file);
+  return result;
+err:
+  perror(path);
+  free(source);
+  if(file != nullptr) fclose(file);
+  return false;
+}
+
+static void
+runner_usage(const char * name)
+{
+  fprintf(stderr, "usage: %s [-M] [-o node,...] program [input.csv]\n", name);
+  fputs("  Each row of input.csv(or stdin) runs one iteration.\n", stderr);
+  fputs("  The first row is the header: timestamp,input-node,...\n", stderr);
+  fputs("  Empty columns keep the previous values.\n", stderr);
+  fputs("  -o  Nodes printed after each iteration, as CSV.\n", stderr);
+  fputs("  -M  Do not mmap the input.\n", stderr);
+}
+
+int
+main(int argc, char ** argv)
+{
+  emfrp_t *         emfrp;
+  runner_reader_t   reader;
+  const char *      line;
+  size_t            length;
+  const char *      columns[RUNNER_MAX_COLUMNS];
+  size_t            lengths[RUNNER_MAX_COLUMNS];
+  emfrp_node_handle inputs[RUNNER_MAX_COLUMNS];
+  emfrp_node_handle outputs[RUNNER_MAX_COLUMNS];
+  char *            output_names[RUNNER_MAX_COLUMNS];
+  char *            output_option = nullptr;
+  int               count_inputs = 0, count_outputs = 0, opt;
+  bool              use_mmap = true;
+  size_t            row      = 1;
+  int               failures = 0;
+  while((opt = getopt(argc, argv, "Mo:")) != -1) {
+    switch(opt) {
+      case 'M':
+        use_mmap = false;
+        break;
+      case 'o':
+        output_option = optarg;
+        break;
+      default:
+        runner_usage(argv[0]);
+        return 2;
+    }
+  }
+  if(optind >= argc || argc - optind > 2) {
+    runner_usage(argv[0]);
+    return 2;
+  }
+  const char * input_path = optind + 1 < argc ? argv[optind + 1] : "-";
+  if(!runner_reader_open(&reader, input_path, use_mmap)) {
+    perror(input_path);
+    return 1;
+  }
+  static char output_buffer[1 << 16];
+  setvbuf(stdout, output_buffer, _IOFBF, sizeof(output_buffer));
+  if(emfrp_create(&emfrp) != EM_RESULT_OK) return 1;
+  emfrp_set_diag_sink(EM_DIAG_LEVEL_INFO, runner_write_diagnostic, nullptr);
+
+  // The header defines the input nodes, which the program may read.
+  if(!runner_reader_next(&reader, &line, &length)) {
+    fprintf(stderr, "%s: The header is missing.\n", input_path);
+    return 1;
+  }
+  count_inputs = runner_split(line, length, columns, lengths) - 1;
+  if(count_inputs < 0) {
+    fprintf(stderr, "%s: Too many columns.\n", input_path);
+    return 1;
+  }
+  for(int i = 0; i < count_inputs; ++i) {
+    char *    name = strndup(columns[i + 1], lengths[i + 1]);
+    em_result res  = emfrp_add_input_node(emfrp, name, nullptr);
+    inputs[i]      = emfrp_lookup_node(emfrp, name);
+    if(res != EM_RESULT_OK) {
+      fprintf(stderr, "%s: input %s: %s\n", input_path, name, EM_RESULT_STR_TABLE[res]);
+      free(name);
+      return 1;
+    }
+    free(name);
+  }
+  if(!runner_load_program(emfrp, argv[optind])) return 1;
+
+  // The output nodes.
+  char * name = output_option == nullptr ? nullptr : strtok(output_option, ",");
+  for(; name != nullptr; name = strtok(nullptr, ",")) {
+    if(count_outputs == RUNNER_MAX_COLUMNS) break;
+    outputs[count_outputs] = emfrp_lookup_node(emfrp, name);
+    if(outputs[count_outputs] == nullptr) {
+      fprintf(stderr, "output %s: %s\n", name, EM_RESULT_STR_TABLE[EM_RESULT_MISSING_IDENTIFIER]);
+      return 1;
+    }
+    output_names[count_outputs++] = name;
+  }
+  printf("%.*s", (int)lengths[0], columns[0]);
+  for(int i = 0; i < count_outputs; ++i)
+    printf(",%s", output_names[i]);
+  putchar('\n');
+
+  while(runner_reader_next(&reader, &line, &length)) {
+    row++;
+    if(length == 0) continue;
+    int count = runner_split(line, length, columns, lengths);
+    if(count != count_inputs + 1) {
+      fprintf(stderr, "%s:%zu: %d columns are expected.\n", input_path, row, count_inputs + 1);
+      failures++;
+      continue;
+    }
+    for(int i = 0; i < count_inputs; ++i) {
+      em_object_t * v;
+      if(lengths[i + 1] == 0) continue;  // Keep the previous value.
+      if(!runner_parse_value(columns[i + 1], lengths[i + 1], &v)) {
+        fprintf(
+          stderr, "%s:%zu: %.*s is not a value.\n", input_path, row, (int)lengths[i + 1],
+          columns[i + 1]);
+        failures++;
+        continue;
+      }
+      emfrp_set_value(emfrp, inputs[i], v);
+    }
+    em_result res = emfrp_update(emfrp);
+    if(res != EM_RESULT_OK) {
+      fprintf(stderr, "%s:%zu: %s\n", input_path, row, EM_RESULT_STR_TABLE[res]);
+      failures++;
+    }
+    fwrite(columns[0], 1, lengths[0], stdout);
+    for(int i = 0; i < count_outputs; ++i) {
+      putchar(',');
+      runner_print_value(emfrp_get_value(emfrp, outputs[i]));
+    }
+    putchar('\n');
+  }
+  runner_reader_close(&reader);
+  fflush(stdout);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+/** -------------------------------------------
+ * @file   arena_t.h
+ * @brief  Arena Allocator
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include <stddef.h>
+#include "emmem.h"
+#include "em_result.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+// ! The size of a chunk of arena_t.
+#ifndef EMFRP_ARENA_CHUNK_SIZE
+#if defined(__ESP_IDF__) || defined(RPI_PICO) || defined(__PLATFORM_IO__) || defined(__ZEPHYR__)
+#define EMFRP_ARENA_CHUNK_SIZE 256
+#else
+#define EMFRP_ARENA_CHUNK_SIZE 2048
+#endif
+#endif
+
+// ! Round up the size, so that pointers placed after it are aligned.
+#define ARENA_ALIGN(size) (((size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+  // ! A chunk of arena_t. The buffer follows it.
+  typedef struct arena_chunk_t
+  {
+    // ! The previous chunk.(Nullable)
+    struct arena_chunk_t * next;
+    // ! The size of the buffer.
+    size_t capacity;
+  } arena_chunk_t;
+
+  // ! Bump allocator.
+  /* !
+ * Items cannot be freed one by one. They are freed together by arena_reset or arena_free.
+ */
+  typedef struct arena_t
+  {
+    // ! The current chunk.(Nullable)
+    arena_chunk_t * chunks;
+    // ! Used bytes of the current chunk.
+    size_t used;
+  } arena_t;
+
+  // ! Constructor of arena_t. It does not allocate until arena_alloc.
+  /* !
+ * \param out The result
+ */
+  static inline void
+  arena_new(arena_t * out)
+  {
+    out->chunks = nullptr;
+    out->used   = 0;
+  }
+
+  // ! Allocate from the arena.
+  /* !
+ * \param self The arena
+ * \param out The result, aligned for pointers.
+ * \param size The size
+ * \return The status code
+ */
+  em_result arena_alloc(arena_t * self, void ** out, size_t size);
+
+  // ! Free all of items, keeping the current chunk for the next use.
+  /* !
+ * \param self The arena
+ */
+  void arena_reset(arena_t * self);
+
+  // ! Free all of items and chunks.
+  /* !
+ * \param self The arena
+ */
+  void arena_free(arena_t * self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
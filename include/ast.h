@@ -7,6 +7,7 @@
 
 #pragma once
 #include "emmem.h"
+#include "arena_t.h"
 #include "string_t.h"
 #include <stdint.h>
 #include "collections/list_t.h"
@@ -20,6 +21,7 @@ extern "C"
 #endif /* __cplusplus */
 
   struct parser_expression_t;
+  struct parser_toplevel_t;
 
   typedef struct parser_expression_tuple_list_t
   {
@@ -156,6 +158,8 @@ typedef enum parser_expression_kind_t
         string_t * tag;
         // ! Tuple
         list_t /*<deconstructor_t>*/ * data;
+        // ! ID of the tag(record_tag_t), or 0 if not resolved yet.(See record_table_resolve.)
+        int32_t record;
       } tuple;
       // ! Integer
       int integer;
@@ -214,8 +218,12 @@ typedef enum parser_expression_kind_t
       // ! When kind is EXPR_KIND_FUNCTION
       struct
       {
-        // ! Reference Count
-        size_t reference_count;
+        // ! The definition which holds the function.
+        /* !
+         * Bytecodes compiled from the function retain it, because they refer to the AST.
+         * It is set by parser_toplevel_compact.
+         */
+        struct parser_toplevel_t * owner;
         // ! Argument List
         list_t /*<string_or_tuple_t>*/ * arguments;
         // ! Body
@@ -255,10 +263,8 @@ typedef enum parser_expression_kind_t
   {
     // ! The name.
     string_t * name;
-    // ! The arguments.
-    list_t /*<deconstructor_t>*/ * arguments;
-    // ! The body.
-    parser_expression_t * expression;
+    // ! The function.(EXPR_KIND_FUNCTION)
+    parser_expression_t * function;
   } parser_func_t;
 
   typedef struct parser_data_t
@@ -293,8 +299,15 @@ typedef enum parser_expression_kind_t
   } parser_toplevel_kind;
 
   // ! Toplevel Expression.
+  /* !
+ * The parser places the whole definition in one malloc-ed block, which starts with
+ * parser_toplevel_t.(See parser_toplevel_compact.) The block is freed when the reference count
+ * reaches 0.
+ */
   typedef struct parser_toplevel_t
   {
+    // ! Reference Count
+    size_t reference_count;
     // ! Kind of value.
     parser_toplevel_kind kind;
     // ! The value.
@@ -308,270 +321,298 @@ typedef enum parser_expression_kind_t
     } value;
   } parser_toplevel_t;
 
+  // ! Constructor of parser_toplevel_t.
+  /* !
+ * \param a The arena
+ * \param kind The kind
+ * \return Constructed parser_toplevel_t in the arena, whose value is not set.
+ */
+  static inline parser_toplevel_t *
+  parser_toplevel_new(arena_t * a, parser_toplevel_kind kind)
+  {
+    parser_toplevel_t * ret = nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_toplevel_t))) return nullptr;
+    ret->reference_count = 1;
+    ret->kind            = kind;
+    return ret;
+  }
+
   // ! Constructor of parser_toplevel_t(node)
   /* !
+ * \param a The arena
  * \param n The node.
- * \return Malloc-ed and constructed parser_toplevel_t
+ * \return Constructed parser_toplevel_t in the arena
  */
   static inline parser_toplevel_t *
-  parser_toplevel_new_node(parser_node_t * n)
+  parser_toplevel_new_node(arena_t * a, parser_node_t * n)
   {
-    parser_toplevel_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_toplevel_t))) return nullptr;
-    ret->kind       = PARSER_TOPLEVEL_KIND_NODE;
-    ret->value.node = n;
+    parser_toplevel_t * ret = parser_toplevel_new(a, PARSER_TOPLEVEL_KIND_NODE);
+    if(ret != nullptr) ret->value.node = n;
     return ret;
   }
 
   // ! Constructor of parser_toplevel_t(func)
   /* !
+ * \param a The arena
  * \param f The function.
- * \return Malloc-ed and constructed parser_toplevel_t
+ * \return Constructed parser_toplevel_t in the arena
  */
   static inline parser_toplevel_t *
-  parser_toplevel_new_func(parser_func_t * f)
+  parser_toplevel_new_func(arena_t * a, parser_func_t * f)
   {
-    parser_toplevel_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_toplevel_t))) return nullptr;
-    ret->kind       = PARSER_TOPLEVEL_KIND_FUNC;
-    ret->value.func = f;
+    parser_toplevel_t * ret = parser_toplevel_new(a, PARSER_TOPLEVEL_KIND_FUNC);
+    if(ret != nullptr) ret->value.func = f;
     return ret;
   }
 
   // ! Constructor of parser_toplevel_t(data)
   /* !
+ * \param a The arena
  * \param d The data definition.
- * \return Malloc-ed and constructed parser_toplevel_t
+ * \return Constructed parser_toplevel_t in the arena
  */
   static inline parser_toplevel_t *
-  parser_toplevel_new_data(parser_data_t * d)
+  parser_toplevel_new_data(arena_t * a, parser_data_t * d)
   {
-    parser_toplevel_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_toplevel_t))) return nullptr;
-    ret->kind       = PARSER_TOPLEVEL_KIND_DATA;
-    ret->value.data = d;
+    parser_toplevel_t * ret = parser_toplevel_new(a, PARSER_TOPLEVEL_KIND_DATA);
+    if(ret != nullptr) ret->value.data = d;
     return ret;
   }
 
   // ! Constructor of parser_toplevel_t(expr)
   /* !
+ * \param a The arena
  * \param e The expression.
- * \return Malloc-ed and constructed parser_toplevel_t
+ * \return Constructed parser_toplevel_t in the arena
  */
   static inline parser_toplevel_t *
-  parser_toplevel_new_expr(parser_expression_t * e)
+  parser_toplevel_new_expr(arena_t * a, parser_expression_t * e)
   {
-    parser_toplevel_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_toplevel_t))) return nullptr;
-    ret->kind             = PARSER_TOPLEVEL_KIND_EXPR;
-    ret->value.expression = e;
+    parser_toplevel_t * ret = parser_toplevel_new(a, PARSER_TOPLEVEL_KIND_EXPR);
+    if(ret != nullptr) ret->value.expression = e;
     return ret;
   }
 
   // ! Constructor of parser_toplevel_t(record)
   /* !
+ * \param a The arena
  * \param r The record.
- * \return Malloc-ed and constructed parser_toplevel_t
+ * \return Constructed parser_toplevel_t in the arena
  */
   static inline parser_toplevel_t *
-  parser_toplevel_new_record(parser_record_t * r)
+  parser_toplevel_new_record(arena_t * a, parser_record_t * r)
   {
-    parser_toplevel_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_toplevel_t))) return nullptr;
-    ret->kind         = PARSER_TOPLEVEL_KIND_RECORD;
-    ret->value.record = r;
+    parser_toplevel_t * ret = parser_toplevel_new(a, PARSER_TOPLEVEL_KIND_RECORD);
+    if(ret != nullptr) ret->value.record = r;
     return ret;
   }
 
-  // ! Shallow free for parser_node_t.
+  // ! Copy the definition in the arena to one block.
   /* !
- * This does not free strings, and expressions.
- * This is used when execution is succeeded.
- * \param pn To be freed.
+ * The arena can be reset after this.
+ * \param pt The definition in the arena.(Nullable)
+ * \return The malloc-ed block which starts with the copied parser_toplevel_t.(Nullable)
  */
-  void parser_toplevel_free_shallow(parser_toplevel_t * pt);
+  parser_toplevel_t * parser_toplevel_compact(parser_toplevel_t * pt);
 
-  // ! Deep free for parser_node_t.
+  // ! Retain the definition.
   /* !
- * This does free strings, and expressions.
- * This is used when execution is failed.
- * \param pn To be freed.
+ * \param pt The definition.
  */
-  void parser_toplevel_free_deep(parser_toplevel_t * pt);
+  static inline void
+  parser_toplevel_retain(parser_toplevel_t * pt)
+  {
+    pt->reference_count++;
+  }
 
-  // ! Constructor of parser_func_t
+  // ! Release the definition.
   /* !
- * \param name The name.
- * \param dec The arguments.
- * \param e The body.
- * \return Malloc-ed and constructed parser_func_t
+ * The block is freed if no one refers it.
+ * \param pt The definition.(Nullable)
  */
-  static inline parser_func_t *
-  parser_func_new(string_t * name, list_t /*<deconstructor_t>*/ * dec, parser_expression_t * e)
+  void parser_toplevel_release(parser_toplevel_t * pt);
+
+  // ! Constructor of string_t.
+  /* !
+ * \param a The arena
+ * \param buffer The buffer. Copied.
+ * \return Constructed string_t in the arena
+ */
+  static inline string_t *
+  parser_string_new(arena_t * a, const char_t * buffer)
   {
-    parser_func_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_func_t))) return nullptr;
-    ret->name       = name;
-    ret->arguments  = dec;
-    ret->expression = e;
+    string_t * ret    = nullptr;
+    size_t     length = em_strlen(buffer);
+    if(arena_alloc(a, (void **)&ret, sizeof(string_t))) return nullptr;
+    if(arena_alloc(a, (void **)&(ret->buffer), (length + 1) * sizeof(char_t))) return nullptr;
+    memcpy(ret->buffer, buffer, (length + 1) * sizeof(char_t));
+    ret->length = length;
     return ret;
   }
 
-  // ! Shallow free for parser_func_t.
+  // ! Constructor of function expression.
   /* !
- * This does not arguments and parser_func_t::expression.
- * This is used when adding a func succeeded.
- * \param pn To be freed.
+ * \param a The arena
+ * \param deconstructors The arguments deconstructor.
+ * \param body The body of the function.
+ * \return The result
  */
-  void parser_func_free_shallow(parser_func_t * pf);
+  static inline parser_expression_t *
+  parser_expression_new_function(
+    arena_t * a, list_t /*<deconstructor_t>*/ * deconstructors, parser_expression_t * body)
+  {
+    parser_expression_t * ret = nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    ret->kind                     = EXPR_KIND_FUNCTION;
+    ret->value.function.owner     = nullptr;
+    ret->value.function.arguments = deconstructors;
+    ret->value.function.body      = body;
+    return ret;
+  }
 
-  // ! Deep free for parser_func_t.
+  // ! Constructor of parser_func_t
   /* !
- * This does free arguments and parser_func_t::expression.
- * This is used when adding a func failed.
- * \param pn To be freed.
+ * \param a The arena
+ * \param name The name.
+ * \param dec The arguments.
+ * \param e The body.
+ * \return Constructed parser_func_t in the arena
  */
-  void parser_func_free_deep(parser_func_t * pf);
+  static inline parser_func_t *
+  parser_func_new(
+    arena_t * a, string_t * name, list_t /*<deconstructor_t>*/ * dec, parser_expression_t * e)
+  {
+    parser_func_t * ret = nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_func_t))) return nullptr;
+    ret->name     = name;
+    ret->function = parser_expression_new_function(a, dec, e);
+    return ret->function == nullptr ? nullptr : ret;
+  }
 
   // ! Constructor of parser_data_t
   /* !
+ * \param a The arena
  * \param dec The names.
  * \param e The body.
- * \return Malloc-ed and constructed parser_data_t
+ * \return Constructed parser_data_t in the arena
  */
   static inline parser_data_t *
-  parser_data_new(deconstructor_t * dec, parser_expression_t * e)
+  parser_data_new(arena_t * a, deconstructor_t * dec, parser_expression_t * e)
   {
     parser_data_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_data_t))) return nullptr;
-    ret->name = *dec;
-    em_free(dec);
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_data_t))) return nullptr;
+    ret->name       = *dec;
     ret->expression = e;
     return ret;
   }
 
-  // ! Deep free for parser_data_t.
-  /* !
- * This does free parser_data_t::expression.
- * This is used when adding a data failed.
- * \param pn To be freed.
- */
-  void parser_data_free_deep(parser_data_t * pd);
-
   // ! Constructor of parser_record_t.
   /* !
+ * \param a The arena
  * \param name The name.
  * \param accessors The accessors list.
- * \return Malloc-ed and constructed parser_record_t
+ * \return Constructed parser_record_t in the arena
  */
   static inline parser_record_t *
-  parser_record_new(string_t * name, list_t /*<string_t> */ * accessors)
+  parser_record_new(arena_t * a, string_t * name, list_t /*<string_t> */ * accessors)
   {
     parser_record_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_record_t))) return nullptr;
-    ret->name = *name;
-    em_free(name);
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_record_t))) return nullptr;
+    ret->name      = *name;
     ret->accessors = accessors;
     return ret;
   }
 
-  // ! Deep free for parser_record_t.
-  /* !
- * This is used when adding a record failed.
- * \param pr To be freed.
- */
-  void parser_record_free_deep(parser_record_t * pr);
-
   // ! Constructor of parser_node_t.
   /* !
+ * \param a The arena
  * \param node_name Name of node. Not copied.
  * \param expression Expression of node. Not copied.
  * \param init_expression `init` expression. Not copied.
- * \return Malloc-ed and constructed parser_node_t
+ * \return Constructed parser_node_t in the arena
  */
   static inline parser_node_t *
   parser_node_new(
-    deconstructor_t * node_name, parser_expression_t * expression,
+    arena_t * a, deconstructor_t * node_name, parser_expression_t * expression,
     parser_expression_t * init_expression, string_t * node_as)
   {
     parser_node_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_node_t))) return nullptr;
-    ret->name = *node_name;
-    em_free(node_name);
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_node_t))) return nullptr;
+    ret->name            = *node_name;
     ret->expression      = expression;
     ret->init_expression = init_expression;
     ret->as              = node_as;
     return ret;
   }
 
-  // ! Shallow free for parser_node_t.
-  /* !
- * This does not free strings, and parser_node_t::expression.
- * This is used when adding a node succeeded.
- * \param pn To be freed.
- */
-  void parser_node_free_shallow(parser_node_t * pn);
-
-  // ! Deep free for parser_node_t.
-  /* !
- * This does free strings, and parser_node_t::expression.
- * This is used when adding a node failed.
- * \param pn To be freed.
- */
-  void parser_node_free_deep(parser_node_t * pn);
-
   static inline deconstructor_t *
-  parser_deconstructor_new_identifier(string_t * str)
+  parser_deconstructor_new_identifier(arena_t * a, string_t * str)
   {
     deconstructor_t * v;
-    if(em_malloc((void **)&v, sizeof(deconstructor_t))) return nullptr;
+    if(arena_alloc(a, (void **)&v, sizeof(deconstructor_t))) return nullptr;
     v->kind             = DECONSTRUCTOR_IDENTIFIER;
     v->value.identifier = str;
     return v;
   }
 
   static inline deconstructor_t *
-  parser_deconstructor_new_tuple(string_t * tag, list_t /*<deconstructor_t>*/ * li)
+  parser_deconstructor_new_tuple(arena_t * a, string_t * tag, list_t /*<deconstructor_t>*/ * li)
   {
     deconstructor_t * v;
-    if(em_malloc((void **)&v, sizeof(deconstructor_t))) return nullptr;
-    v->kind             = DECONSTRUCTOR_TUPLE;
-    v->value.tuple.tag  = tag;
-    v->value.tuple.data = li;
+    if(arena_alloc(a, (void **)&v, sizeof(deconstructor_t))) return nullptr;
+    v->kind               = DECONSTRUCTOR_TUPLE;
+    v->value.tuple.tag    = tag;
+    v->value.tuple.data   = li;
+    v->value.tuple.record = 0;
     return v;
   }
 
   static inline deconstructor_t *
-  parser_deconstructor_new_integer(int i)
+  parser_deconstructor_new_integer(arena_t * a, int i)
   {
     deconstructor_t * v;
-    if(em_malloc((void **)&v, sizeof(deconstructor_t))) return nullptr;
+    if(arena_alloc(a, (void **)&v, sizeof(deconstructor_t))) return nullptr;
     v->kind          = DECONSTRUCTOR_INTEGER;
     v->value.integer = i;
     return v;
   }
 
+  // ! Prepend to the list in the arena.
+  /* !
+ * \param a The arena
+ * \param tail The list.(Nullable)
+ * \param value_size sizeof(value)
+ * \param value The value to be copied.
+ * \return The list
+ */
+  static inline list_t *
+  parser_list_prepend(arena_t * a, list_t * tail, size_t value_size, void * value)
+  {
+    list_t * ret = nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(list_t *) + value_size)) return nullptr;
+    ret->next = tail;
+    memcpy(&(ret->value), value, value_size);
+    return ret;
+  }
+
   static inline list_t /*<deconstructor_t>*/ *
-  parser_deconstructors_prepend(deconstructor_t * head, list_t /*<deconstructor_t>*/ * tail)
+  parser_deconstructors_prepend(
+    arena_t * a, deconstructor_t * head, list_t /*<deconstructor_t>*/ * tail)
   {
-    if(list_add2(&tail, deconstructor_t, head)) return nullptr;
-    em_free(head);
-    return tail;
+    return parser_list_prepend(a, tail, sizeof(deconstructor_t), head);
   }
 
   static inline list_t /*<string_t> */ *
-  parser_identifiers_prepend(string_t * str, list_t /*<string_t>*/ * tail)
+  parser_identifiers_prepend(arena_t * a, string_t * str, list_t /*<string_t>*/ * tail)
   {
-    if(list_add2(&tail, string_t, str)) return nullptr;
-    em_free(str);
-    return tail;
+    return parser_list_prepend(a, tail, sizeof(string_t), str);
   }
 
   static inline parser_branch_list_t *
-  parser_expression_branch_new(deconstructor_t * decon, parser_expression_t * body)
+  parser_expression_branch_new(arena_t * a, deconstructor_t * decon, parser_expression_t * body)
   {
     parser_branch_list_t * v;
-    if(em_malloc((void **)&v, sizeof(parser_branch_list_t))) return nullptr;
+    if(arena_alloc(a, (void **)&v, sizeof(parser_branch_list_t))) return nullptr;
     v->deconstruct = decon;
     v->body        = body;
     v->next        = nullptr;
@@ -587,64 +628,71 @@ typedef enum parser_expression_kind_t
 
   // ! Constructor of binary expression.
   /* !
+ * \param a The arena
  * \param lhs Left hand side. Not copied.
  * \param rhs Right hand side. Not copied.
  * \param kind The binary expression kind, validated only in Debug mode.
- * \return Malloc-ed and constructed parser_expression_t
+ * \return Constructed parser_expression_t in the arena
  */
   static inline parser_expression_t *
   parser_expression_new_binary(
-    parser_expression_t * lhs, parser_expression_t * rhs, parser_expression_kind_t kind)
+    arena_t * a, parser_expression_t * lhs, parser_expression_t * rhs,
+    parser_expression_kind_t kind)
   {
 #if DEBUG
     if(kind & 1 == 0) DEBUGBREAK;
 #endif
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t)) != EM_RESULT_OK) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t)) != EM_RESULT_OK) return nullptr;
     ret->kind             = kind;
     ret->value.binary.lhs = lhs;
     ret->value.binary.rhs = rhs;
     return ret;
   }
 
-#define parser_expression_new_addition(lhs, rhs)                                                   \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_ADDITION)
-#define parser_expression_new_subtraction(lhs, rhs)                                                \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_SUBTRACTION)
-#define parser_expression_new_multiplication(lhs, rhs)                                             \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_MULTIPLICATION)
-#define parser_expression_new_division(lhs, rhs)                                                   \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_DIVISION)
-#define parser_expression_new_modulo(lhs, rhs)                                                     \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_MODULO)
-#define parser_expression_new_left_shift(lhs, rhs)                                                 \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_LEFT_SHIFT)
-#define parser_expression_new_right_shift(lhs, rhs)                                                \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_RIGHT_SHIFT)
-#define parser_expression_new_less_or_equal(lhs, rhs)                                              \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_LESS_OR_EQUAL)
-#define parser_expression_new_less_than(lhs, rhs)                                                  \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_LESS_THAN)
-#define parser_expression_new_greater_or_equal(lhs, rhs)                                           \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_GREATER_OR_EQUAL)
-#define parser_expression_new_greater_than(lhs, rhs)                                               \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_GREATER_THAN)
-#define parser_expression_new_equal(lhs, rhs)                                                      \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_EQUAL)
-#define parser_expression_new_not_equal(lhs, rhs)                                                  \
-  parser_expression_new_binary(lhs, rhs, EXPR_KIND_NOT_EQUAL)
-#define parser_expression_new_and(lhs, rhs)  parser_expression_new_binary(lhs, rhs, EXPR_KIND_AND)
-#define parser_expression_new_or(lhs, rhs)   parser_expression_new_binary(lhs, rhs, EXPR_KIND_OR)
-#define parser_expression_new_xor(lhs, rhs)  parser_expression_new_binary(lhs, rhs, EXPR_KIND_XOR)
-#define parser_expression_new_dand(lhs, rhs) parser_expression_new_binary(lhs, rhs, EXPR_KIND_DAND)
-#define parser_expression_new_dor(lhs, rhs)  parser_expression_new_binary(lhs, rhs, EXPR_KIND_DOR)
+#define parser_expression_new_addition(a, lhs, rhs)                                                \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_ADDITION)
+#define parser_expression_new_subtraction(a, lhs, rhs)                                             \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_SUBTRACTION)
+#define parser_expression_new_multiplication(a, lhs, rhs)                                          \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_MULTIPLICATION)
+#define parser_expression_new_division(a, lhs, rhs)                                                \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_DIVISION)
+#define parser_expression_new_modulo(a, lhs, rhs)                                                  \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_MODULO)
+#define parser_expression_new_left_shift(a, lhs, rhs)                                              \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_LEFT_SHIFT)
+#define parser_expression_new_right_shift(a, lhs, rhs)                                             \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_RIGHT_SHIFT)
+#define parser_expression_new_less_or_equal(a, lhs, rhs)                                           \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_LESS_OR_EQUAL)
+#define parser_expression_new_less_than(a, lhs, rhs)                                               \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_LESS_THAN)
+#define parser_expression_new_greater_or_equal(a, lhs, rhs)                                        \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_GREATER_OR_EQUAL)
+#define parser_expression_new_greater_than(a, lhs, rhs)                                            \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_GREATER_THAN)
+#define parser_expression_new_equal(a, lhs, rhs)                                                   \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_EQUAL)
+#define parser_expression_new_not_equal(a, lhs, rhs)                                               \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_NOT_EQUAL)
+#define parser_expression_new_and(a, lhs, rhs)                                                     \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_AND)
+#define parser_expression_new_or(a, lhs, rhs) parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_OR)
+#define parser_expression_new_xor(a, lhs, rhs)                                                     \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_XOR)
+#define parser_expression_new_dand(a, lhs, rhs)                                                    \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_DAND)
+#define parser_expression_new_dor(a, lhs, rhs)                                                     \
+  parser_expression_new_binary(a, lhs, rhs, EXPR_KIND_DOR)
 
   static inline parser_expression_t *
   parser_expression_new_if(
-    parser_expression_t * cond, parser_expression_t * then, parser_expression_t * otherwise)
+    arena_t * a, parser_expression_t * cond, parser_expression_t * then,
+    parser_expression_t * otherwise)
   {
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
     ret->kind                       = EXPR_KIND_IF;
     ret->value.ifthenelse.cond      = cond;
     ret->value.ifthenelse.then      = then;
@@ -655,7 +703,7 @@ typedef enum parser_expression_kind_t
   // ! Constructor of integer literal expression.
   /* !
  * \param num Value
- * \return Malloc-ed and constructed parser_expression_t
+ * \return The immediate parser_expression_t
  */
   static inline parser_expression_t *
   parser_expression_new_integer(int num)
@@ -673,45 +721,46 @@ typedef enum parser_expression_kind_t
 
   // ! Constructor of indentifier expression.
   /* !
+ * \param a The arena
  * \param ident Identifier
- * \return Malloc-ed and constructed parser_expression_t
+ * \return Constructed parser_expression_t in the arena
  */
   static inline parser_expression_t *
-  parser_expression_new_identifier(string_t * ident)
+  parser_expression_new_identifier(arena_t * a, string_t * ident)
   {
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
     ret->kind             = EXPR_KIND_IDENTIFIER;
     ret->value.identifier = *ident;
-    em_free(ident);
     return ret;
   }
 
   // ! Constructor of identifier expression(@last).
   /* !
+ * \param a The arena
  * \param ident Identifier
- * \return Malloc-ed and constructed parser_expression_t
+ * \return Constructed parser_expression_t in the arena
  */
   static inline parser_expression_t *
-  parser_expression_new_last_identifier(string_t * ident)
+  parser_expression_new_last_identifier(arena_t * a, string_t * ident)
   {
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
     ret->kind             = EXPR_KIND_LAST_IDENTIFIER;
     ret->value.identifier = *ident;
-    em_free(ident);
     return ret;
   }
 
   // ! Constructor of tuple expression.
   /* !
+ * \param a The arena
  * \param e Inner expression.
  */
   static inline parser_expression_t *
-  parser_expression_new_tuple(parser_expression_t * inner)
+  parser_expression_new_tuple(arena_t * a, parser_expression_t * inner)
   {
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
     ret->kind              = EXPR_KIND_TUPLE;
     ret->value.tuple.next  = nullptr;
     ret->value.tuple.value = inner;
@@ -720,53 +769,38 @@ typedef enum parser_expression_kind_t
 
   // ! Prepend to the tuple expression.
   /* !
+ * \param a The arena
  * \param self The tuple expression add to.
  * \param inner The expression to be added.
  */
   static inline parser_expression_t *
-  parser_expression_tuple_prepend(parser_expression_t * self, parser_expression_t * inner)
+  parser_expression_tuple_prepend(
+    arena_t * a, parser_expression_t * self, parser_expression_t * inner)
   {
 #if DEBUG
     if(self->kind != EXPR_KIND_TUPLE) DEBUGBREAK;
 #endif
     parser_expression_tuple_list_t * new_tl = nullptr;
-    if(em_malloc((void **)&new_tl, sizeof(parser_expression_tuple_list_t))) return nullptr;
+    if(arena_alloc(a, (void **)&new_tl, sizeof(parser_expression_tuple_list_t))) return nullptr;
     *new_tl                 = self->value.tuple;
     self->value.tuple.next  = new_tl;
     self->value.tuple.value = inner;
     return self;
   }
 
-  // ! Constructor of function expression.
-  /* !
- * \param deconstructors The arguments deconstructor.
- * \param body The body of the function.
- * \return The result
- */
-  static inline parser_expression_t *
-  parser_expression_new_function(
-    list_t /*<deconstructor_t>*/ * deconstructors, parser_expression_t * body)
-  {
-    parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
-    ret->kind                           = EXPR_KIND_FUNCTION;
-    ret->value.function.reference_count = 1;
-    ret->value.function.arguments       = deconstructors;
-    ret->value.function.body            = body;
-    return ret;
-  }
-
   // ! Constructor of function call.
   /* !
+ * \param a The arena
  * \param callee The callee
  * \param arguments The arguments.
  * \return The result
  */
   static inline parser_expression_t *
-  parser_expression_new_function_call(parser_expression_t * callee, parser_expression_t * arguments)
+  parser_expression_new_function_call(
+    arena_t * a, parser_expression_t * callee, parser_expression_t * arguments)
   {
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
 #if DEBUG
     if(arguments != nullptr && arguments->kind != EXPR_KIND_TUPLE) {
       DEBUGBREAK;  // NOT TUPLE
@@ -777,17 +811,18 @@ typedef enum parser_expression_kind_t
     ret->value.funccall.callee = callee;
     if(arguments == nullptr) {
       ret->value.funccall.arguments.value = nullptr;
+      ret->value.funccall.arguments.next  = nullptr;
     } else
       ret->value.funccall.arguments = arguments->value.tuple;
-    em_free(arguments);
     return ret;
   }
 
   static inline parser_expression_t *
-  parser_expression_new_case(parser_expression_t * v, parser_branch_list_t * branches)
+  parser_expression_new_case(
+    arena_t * a, parser_expression_t * v, parser_branch_list_t * branches)
   {
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
     ret->kind                  = EXPR_KIND_CASE;
     ret->value.caseof.of       = v;
     ret->value.caseof.branches = branches;
@@ -795,55 +830,49 @@ typedef enum parser_expression_kind_t
   }
 
   static inline parser_expression_t *
-  parser_expression_new_begin(parser_branch_list_t * branches)
+  parser_expression_new_begin(arena_t * a, parser_branch_list_t * branches)
   {
     parser_expression_t * ret = nullptr;
-    if(em_malloc((void **)&ret, sizeof(parser_expression_t))) return nullptr;
+    if(arena_alloc(a, (void **)&ret, sizeof(parser_expression_t))) return nullptr;
     ret->kind                 = EXPR_KIND_BEGIN;
     ret->value.begin.branches = branches;
     return ret;
   }
 
-  // ! Freeing parser_expression_t.
-  /* !
- * \param expr The expression to be freed.
- */
-  void parser_expression_free(parser_expression_t * expr);
-
   // ! Used for parser_expression_print.
   extern const char * const binary_op_table[];
 
-  // ! Print parser_toplevel_t to stdout.
+  // ! Print parser_toplevel_t to the current diagnostic message.
   /* !
  * \ param t The toplevel expression to be printed.
  */
   void parser_toplevel_print(parser_toplevel_t * t);
 
-  // ! Print parser_node_t to stdout.
+  // ! Print parser_node_t to the current diagnostic message.
   /* !
  * \param n The node definition to be printed.
  */
   void parser_node_print(parser_node_t * n);
 
-  // ! Print parser_data_t to stdout.
+  // ! Print parser_data_t to the current diagnostic message.
   /* !
  * \param d The data definition to be printed.
  */
   void parser_data_print(parser_data_t * d);
 
-  // ! Print parser_record_t to stdout.
+  // ! Print parser_record_t to the current diagnostic message.
   /* !
  * \param r The record definition to be printed.
  */
   void parser_record_print(parser_record_t * r);
 
-  // ! Print parser_func_t to stdout.
+  // ! Print parser_func_t to the current diagnostic message.
   /* !
  * \param f The function definition to be printed.
  */
   void parser_function_print(parser_func_t * f);
 
-  // ! Print parser_expression_t to stdout.
+  // ! Print parser_expression_t to the current diagnostic message.
   /* !
  * \param n The expression to be printed.
  */
@@ -12,12 +12,49 @@
 extern "C"
 {
 #endif /* __cplusplus */
-#define DICTIONARY_TABLE_SIZE 16
 
-  // ! Dictionary
+// ! Small-footprint mode for microcontrollers.
+/* !
+ * Entries do not cache hash values, and the table is filled more densely.
+ */
+#ifndef EMFRP_SMALL_DICTIONARY
+#if defined(__ESP_IDF__) || defined(__ESP_8266__) || defined(RPI_PICO) || defined(__ZEPHYR__)
+#define EMFRP_SMALL_DICTIONARY 1
+#else
+#define EMFRP_SMALL_DICTIONARY 0
+#endif
+#endif
+
+#if EMFRP_SMALL_DICTIONARY
+#define DICTIONARY_INITIAL_CAPACITY 4
+// ! The table grows if the count of entries exceeds 7/8 of the capacity.
+#define DICTIONARY_IS_OVERLOADED(length, capacity) ((length) * 8 > (capacity) * 7)
+#else
+#define DICTIONARY_INITIAL_CAPACITY 16
+// ! The table grows if the count of entries exceeds 3/4 of the capacity.
+#define DICTIONARY_IS_OVERLOADED(length, capacity) ((length) * 4 > (capacity) * 3)
+#endif
+
+  // ! An entry of dictionary_t.
+  typedef struct dictionary_entry_t
+  {
+#if !EMFRP_SMALL_DICTIONARY
+    // ! The hash value of dictionary_entry_t::value.
+    size_t hash;
+#endif
+    // ! The value, or nullptr if it is empty.(Its address is never moved.)
+    void * value;
+  } dictionary_entry_t;
+
+  // ! Dictionary(Open addressing with linear probing)
   typedef struct dictionary_t
   {
-    list_t * values[DICTIONARY_TABLE_SIZE];
+    // ! The entries.(Nullable)
+    dictionary_entry_t * entries;
+    // ! Length of dictionary_t::entries, which is zero or a power of 2.
+    size_t capacity;
+    // ! Count of values.
+    size_t length;
   } dictionary_t;
 
   // ! Construct dictionary_t.
@@ -84,9 +121,9 @@ extern "C"
     dictionary_t * self, size_t(hasher(void *)), bool(comparer(void *, void *)),
     void *         search_value);
 
-#define FOREACH_DICTIONARY(li, dic)                                                                \
-  li = (dic)->values[0];                                                                           \
-  for(int i = 0; i < DICTIONARY_TABLE_SIZE; ++i, li = (dic)->values[i])
+#define FOREACH_DICTIONARY(v, dic)                                                                 \
+  for(size_t _dictionary_index = 0; _dictionary_index < (dic)->capacity; ++_dictionary_index)      \
+    if(((v) = (dic)->entries[_dictionary_index].value) != nullptr)
 
 #ifdef __cplusplus
 }
@@ -45,6 +45,8 @@ extern "C"
     EM_RESULT_GC_WORKLIST_OVERFLOW = 5,
     // ! Stack is overflowed.
     EM_RESULT_STACK_OVERFLOW = 6,
+    // ! The queue is full.
+    EM_RESULT_QUEUE_FULL = 7,
     // Below, users are responsible.
     // ! Type Mismatch
     EM_RESULT_TYPE_MISMATCH = 16,
@@ -0,0 +1,133 @@
+/** -------------------------------------------
+ * @file   emdiag.h
+ * @brief  Diagnostics
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "misc.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+// ! Levels of diagnostics. Lower is more important.
+#define EM_DIAG_LEVEL_NONE    0
+#define EM_DIAG_LEVEL_ERROR   1
+#define EM_DIAG_LEVEL_WARNING 2
+#define EM_DIAG_LEVEL_INFO    3
+#define EM_DIAG_LEVEL_DEBUG   4
+
+// ! Diagnostics above the level are removed at compile time.
+#ifndef EMFRP_DIAG_LEVEL
+#if defined(__ESP_IDF__) || defined(RPI_PICO) || defined(__PLATFORM_IO__) || defined(__ZEPHYR__)
+#define EMFRP_DIAG_LEVEL EM_DIAG_LEVEL_INFO
+#else
+#define EMFRP_DIAG_LEVEL EM_DIAG_LEVEL_DEBUG
+#endif
+#endif
+
+// ! The size of the buffer of a message.
+#ifndef EMFRP_DIAG_BUFFER_SIZE
+#if defined(__ESP_IDF__) || defined(RPI_PICO) || defined(__PLATFORM_IO__) || defined(__ZEPHYR__)
+#define EMFRP_DIAG_BUFFER_SIZE 128
+#else
+#define EMFRP_DIAG_BUFFER_SIZE 1024
+#endif
+#endif
+
+  typedef int em_diag_level;
+
+  // ! The sink of diagnostics.
+  /* !
+   * A message is passed by one call, or by a few calls if it is longer than the buffer.
+   * \param user The user data of em_diag_set_sink.
+   * \param level The level of the message.
+   * \param text The text, which is not terminated by '\0'.
+   * \param length The length of text.
+   */
+  typedef void (*em_diag_sink)(void * user, em_diag_level level, const char * text, size_t length);
+
+  // ! The channel of diagnostics. Use functions below instead of touching it.
+  typedef struct em_diag_channel_t
+  {
+    // ! The sink.(Nullable)
+    em_diag_sink sink;
+    // ! The user data of the sink.
+    void * user;
+    // ! Messages above the level are dropped.
+    em_diag_level level;
+    // ! The level of the current message, or EM_DIAG_LEVEL_NONE if no message is written.
+    em_diag_level current;
+    // ! Used bytes of buffer.
+    size_t used;
+    // ! The buffer of the current message.
+    char buffer[EMFRP_DIAG_BUFFER_SIZE];
+  } em_diag_channel_t;
+
+  extern em_diag_channel_t em_diag;
+
+  // ! Set the sink of diagnostics. The core does not write to the console without it.
+  /* !
+   * The sink is shared by all machines.
+   * \param level Messages above the level are dropped.
+   * \param sink The sink(Nullable, nullptr drops all messages.)
+   * \param user The user data passed to the sink.
+   */
+  void em_diag_set_sink(em_diag_level level, em_diag_sink sink, void * user);
+
+  // ! Whether messages of the level are delivered.
+  static inline bool
+  em_diag_is_enabled(em_diag_level level)
+  {
+    return level <= EMFRP_DIAG_LEVEL && level <= em_diag.level && em_diag.sink != nullptr;
+  }
+
+  // ! Begin a message. Writes are buffered until em_diag_end.
+  /* !
+   * \param level The level, which should be enabled(See em_diag_is_enabled.)
+   */
+  void em_diag_begin(em_diag_level level);
+
+  // ! End the message, and pass it to the sink.
+  void em_diag_end(void);
+
+  // ! Write to the current message.
+  /* !
+   * Writes outside a message are passed to the sink immediately as EM_DIAG_LEVEL_INFO.
+   * \param text The text
+   * \param length The length of text.
+   */
+  void em_diag_write(const char * text, size_t length);
+
+  // ! Write the string to the current message.
+  void em_diag_puts(const char * str);
+
+  // ! Write the integer to the current message.
+  void em_diag_print_int(int32_t v);
+
+  // ! Write the formatted string to the current message.(It is truncated by the buffer size.)
+  void em_diag_printf(const char * format, ...);
+
+// ! Run the statements as a message of the level, only if the level is enabled.
+#define EM_DIAG(level, ...)             \
+  do {                                  \
+    if(em_diag_is_enabled(level)) {     \
+      em_diag_begin(level);             \
+      __VA_ARGS__;                      \
+      em_diag_end();                    \
+    }                                   \
+  } while(0)
+
+#define EM_DIAG_ERROR(...)   EM_DIAG(EM_DIAG_LEVEL_ERROR, em_diag_printf(__VA_ARGS__))
+#define EM_DIAG_WARNING(...) EM_DIAG(EM_DIAG_LEVEL_WARNING, em_diag_printf(__VA_ARGS__))
+#define EM_DIAG_INFO(...)    EM_DIAG(EM_DIAG_LEVEL_INFO, em_diag_printf(__VA_ARGS__))
+#define EM_DIAG_DEBUG(...)   EM_DIAG(EM_DIAG_LEVEL_DEBUG, em_diag_printf(__VA_ARGS__))
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -5,9 +5,11 @@
  * @date   2023/8/28
  ------------------------------------------- */
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "em_result.h"
+#include "emdiag.h"
 
 #if __cplusplus
 extern "C"
@@ -30,22 +32,117 @@ extern "C"
   typedef em_object_t * (*em_input_callback)(void);
   typedef void (*em_output_callback)(em_object_t *);
   typedef struct emfrp_t emfrp_t;
+  // ! The handle of the node, which is valid while emfrp_t lives.(Even if the node is redefined.)
+  typedef struct node_t * emfrp_node_handle;
+
+  // ! Statistics of the memory manager.
+  typedef struct emfrp_memory_stats_t
+  {
+    // ! Count of allocated objects so far.
+    size_t allocations;
+    // ! Count of completed gc cycles so far.
+    size_t gc_cycles;
+    // ! Count of objects which the heap can hold now.
+    size_t heap_objects;
+  } emfrp_memory_stats_t;
+
+  // ! Counters of the node, which are collected if EMFRP_ENABLE_PROFILING is set.
+  /* !
+   * Nodes defined together(e.g. `node (a, b) = ...`) share the counters.
+   */
+  typedef struct emfrp_node_stats_t
+  {
+    // ! Count of evaluations.
+    size_t evaluations;
+    // ! Cumulative wall time of evaluations in nanoseconds.
+    uint64_t total_ns;
+    // ! The longest wall time of an evaluation in nanoseconds.
+    uint64_t max_ns;
+    // ! Count of allocated objects.
+    size_t allocations;
+    // ! Count of failed evaluations.
+    size_t failures;
+  } emfrp_node_stats_t;
 
   EM_EXPORTDECL em_result emfrp_create(emfrp_t ** result);
   EM_EXPORTDECL em_result emfrp_repl(emfrp_t * self, const char * str, em_object_t ** value);
+  // ! Load the program, which has many definitions.
+  /* !
+   * The nodes may refer to the ones below, and the definitions are accepted all or nothing.
+   * Empty lines and lines beginning with '#' are skipped.
+   * failed(Nullable) is the index of the failed definition, if it fails.
+   */
+  EM_EXPORTDECL em_result emfrp_load(emfrp_t * self, const char * source, size_t * failed);
   EM_EXPORTDECL em_result
   emfrp_add_input_node(emfrp_t * self, char * node_name, em_input_callback callback);
   EM_EXPORTDECL em_result
   emfrp_add_output_node(emfrp_t * self, char * node_name, em_output_callback callback);
   EM_EXPORTDECL em_result
   emfrp_set_node_value(emfrp_t * self, char * node_name, em_object_t * value);
+  EM_EXPORTDECL em_result
+  emfrp_set_node_cut_off(emfrp_t * self, char * node_name, bool cut_off);
+  EM_EXPORTDECL void          emfrp_set_heap_limit(emfrp_t * self, size_t max_objects);
   EM_EXPORTDECL em_result     emfrp_update(emfrp_t * self);
+  EM_EXPORTDECL void          emfrp_get_memory_stats(emfrp_t * self, emfrp_memory_stats_t * out);
+  EM_EXPORTDECL em_result
+  emfrp_get_node_stats(emfrp_t * self, char * node_name, emfrp_node_stats_t * out);
   EM_EXPORTDECL em_object_t * emfrp_create_int_object(int32_t num);
   EM_EXPORTDECL em_object_t * emfrp_get_true_object(void);
   EM_EXPORTDECL em_object_t * emfrp_get_false_object(void);
   EM_EXPORTDECL int32_t       emfrp_get_integer(em_object_t * v);
 
+  // ! Find the node.(It returns nullptr if not found.)
+  /* !
+   * The functions below take the handle instead of the name, so that they do not look up the
+   * dictionary. Nodes made by emfrp_add_input_node and emfrp_add_output_node are always found.
+   * They return EM_RESULT_INVALID_ARGUMENT(or nullptr) if the handle is nullptr, so that a failed
+   * lookup is not dereferenced.
+   */
+  EM_EXPORTDECL emfrp_node_handle emfrp_lookup_node(emfrp_t * self, char * node_name);
+  EM_EXPORTDECL em_result
+  emfrp_set_input_callback(emfrp_t * self, emfrp_node_handle node, em_input_callback callback);
+  EM_EXPORTDECL em_result
+  emfrp_set_output_callback(emfrp_t * self, emfrp_node_handle node, em_output_callback callback);
+  EM_EXPORTDECL em_result
+  emfrp_set_value(emfrp_t * self, emfrp_node_handle node, em_object_t * value);
+  // ! Get the current value of the node.(It returns nullptr if the node is not evaluated.)
+  EM_EXPORTDECL em_object_t * emfrp_get_value(emfrp_t * self, emfrp_node_handle node);
+  // ! Post the value of the node, which is set by emfrp_drain_and_update.
+  /* !
+   * It is safe to call from interrupt handlers, signal handlers and other threads, because it
+   * neither blocks nor allocates. Thus, the value must be an integer or a boolean value.
+   * It returns EM_RESULT_QUEUE_FULL if EMFRP_INPUT_QUEUE_SIZE values are waiting.
+   */
+  EM_EXPORTDECL em_result
+  emfrp_post_input(emfrp_t * self, emfrp_node_handle node, em_object_t * value);
+  // ! Set the posted values, and update once.(Only one thread may call it.)
+  EM_EXPORTDECL em_result emfrp_drain_and_update(emfrp_t * self);
+  // ! Run n_steps iterations with the given inputs, and collect the outputs.
+  /* !
+   * Row `s` of the matrices is the step `s`, and column `i` is the node of handles[i]. That is,
+   * input_matrix[s * n_inputs + i] is set to input_handles[i] before the step `s`, and
+   * output_matrix[s * n_outputs + i] is the value of output_handles[i] after the step.
+   * Input nodes should be added without the callback, otherwise the callback overwrites the value.
+   * Inputs must be in the range of integer objects, -2^29 to 2^29 - 1.
+   * Boolean outputs are 1 or 0, and the other non-integer outputs(e.g. failed nodes) are 0.
+   * It stops at the first failed step, and returns its status code. No step runs if a handle is
+   * nullptr or an input is out of the range.(EM_RESULT_INVALID_ARGUMENT)
+   */
+  EM_EXPORTDECL em_result emfrp_run_batch(
+    emfrp_t * self, size_t n_steps, size_t n_inputs, emfrp_node_handle * input_handles,
+    const int32_t * input_matrix, size_t n_outputs, emfrp_node_handle * output_handles,
+    int32_t * output_matrix);
+
+  // ! Print the object to the sink of diagnostics as EM_DIAG_LEVEL_INFO.
   EM_EXPORTDECL void emfrp_print_object(em_object_t * v);
+  // ! Set the sink of diagnostics, which is shared by all emfrp_t.
+  /* !
+   * Without the sink, emfrp does not write to the console. Failures of nodes are
+   * EM_DIAG_LEVEL_ERROR, and echoes of emfrp_repl are EM_DIAG_LEVEL_DEBUG.
+   * Levels above EMFRP_DIAG_LEVEL are removed at compile time.
+   */
+  EM_EXPORTDECL void
+  emfrp_set_diag_sink(em_diag_level level, em_diag_sink sink, void * user);
 #if __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,57 @@
+/** -------------------------------------------
+ * @file   emtime.h
+ * @brief  Clock Implementation
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+
+#pragma once
+
+#include <stdint.h>
+#if defined(__ESP_IDF__) || defined(__ESP_8266__)
+#include "esp_timer.h"
+#elif defined(RPI_PICO)
+#include "pico/time.h"
+#elif defined(__ZEPHYR__)
+#include <zephyr/kernel.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  // ! Get the monotonic time.
+  /* !
+ * The resolution depends on the platform.(e.g. 1us on ESP32 and Raspberry Pi Pico.)
+ * \return The time in nanoseconds.
+ */
+  static inline uint64_t
+  em_time_ns(void)
+  {
+#if defined(__ESP_IDF__) || defined(__ESP_8266__)
+    return (uint64_t)esp_timer_get_time() * 1000;
+#elif defined(RPI_PICO)
+    return time_us_64() * 1000;
+#elif defined(__ZEPHYR__)
+    return k_ticks_to_ns_floor64(k_uptime_ticks());
+#elif defined(_WIN32)
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)(count.QuadPart / frequency.QuadPart) * 1000000000
+         + (uint64_t)(count.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+#endif
+  }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -0,0 +1,57 @@
+/** -------------------------------------------
+ * @file   atom_t.h
+ * @brief  Interned Identifiers
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include <stdint.h>
+#include "em_result.h"
+#include "string_t.h"
+#include "collections/dictionary_t.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  // ! An interned identifier.
+  /* !
+   * Every distinct identifier exists once in the atom table(machine_t::atoms),
+   * so that atoms are compared by the pointer. Atoms are never freed nor moved.
+   */
+  typedef string_t * atom_t;
+
+  // ! Intern the identifier.
+  /* !
+ * \param table The atom table
+ * \param name The identifier, which is copied if it is not interned yet.
+ * \param out The result
+ * \return The status code
+ */
+  em_result atom_intern(dictionary_t /*<string_t>*/ * table, string_t * name, atom_t * out);
+
+  // ! Lookup the atom of the identifier.
+  /* !
+ * \param table The atom table
+ * \param name The identifier
+ * \param out The result
+ * \return Whether the identifier is interned or not
+ */
+  bool atom_lookup(dictionary_t /*<string_t>*/ * table, string_t * name, atom_t * out);
+
+  // ! Hash value of the atom.
+  /* !
+ * Atoms are hashed by the pointer.(Fibonacci hashing)
+ * \param atom The atom
+ * \return The hash value
+ */
+  static inline size_t
+  atom_hash(atom_t atom)
+  {
+    return ((uint32_t)((uintptr_t)atom >> 3) * 2654435769u) >> 12;
+  }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -0,0 +1,360 @@
+/** -------------------------------------------
+ * @file   bytecode_t.h
+ * @brief  Emfrp Bytecode Representation
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include <stdint.h>
+#include "em_result.h"
+#include "emmem.h"
+#include "string_t.h"
+#include "vm/atom_t.h"
+#include "ast.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  struct object_t;
+  struct bytecode_t;
+  struct variable_t;
+  struct node_t;
+
+  // ! An instruction.
+  /* !
+   The lower 8 bits are the opcode, and the upper 24 bits are the (signed) operand.
+ */
+  typedef uint32_t instruction_t;
+
+#define INSTRUCTION_OPCODE_BITS 8
+#define INSTRUCTION_OPERAND_MAX ((1 << (31 - INSTRUCTION_OPCODE_BITS)) - 1)
+#define INSTRUCTION_OPERAND_MIN (-(1 << (31 - INSTRUCTION_OPCODE_BITS)))
+#define INSTRUCTION_OPCODE(i)   ((opcode_t)((i) & ((1 << INSTRUCTION_OPCODE_BITS) - 1)))
+#define INSTRUCTION_OPERAND(i)  (((int32_t)(i)) >> INSTRUCTION_OPCODE_BITS)
+#define INSTRUCTION_NEW(op, operand)                                                               \
+  ((instruction_t)(((uint32_t)(operand) << INSTRUCTION_OPCODE_BITS) | (uint32_t)(op)))
+// The operand may be a pair of 12 bits unsigned integers.(e.g. depth and slot)
+#define INSTRUCTION_OPERAND_HALF_BITS 12
+#define INSTRUCTION_OPERAND_HALF_MAX  ((1 << INSTRUCTION_OPERAND_HALF_BITS) - 1)
+#define INSTRUCTION_OPERAND_HIGH(i)                                                                \
+  ((int)(((uint32_t)(i)) >> (INSTRUCTION_OPCODE_BITS + INSTRUCTION_OPERAND_HALF_BITS)))
+#define INSTRUCTION_OPERAND_LOW(i)                                                                 \
+  ((int)((((uint32_t)(i)) >> INSTRUCTION_OPCODE_BITS) & INSTRUCTION_OPERAND_HALF_MAX))
+#define INSTRUCTION_NEW2(op, high, low)                                                            \
+  INSTRUCTION_NEW(op, ((uint32_t)(high) << INSTRUCTION_OPERAND_HALF_BITS) | (uint32_t)(low))
+
+  // ! Opcode of the instruction.
+  /* !
+   `[a, b -- c]` means that the instruction pops b and a, and pushes c.
+ */
+  typedef enum opcode_t
+  {
+    // ! [ -- n] Push the immediate integer(operand).
+    OPCODE_PUSH_INT = 0,
+    // ! [ -- v] Push the constant(operand: index of bytecode_t::constants).
+    OPCODE_PUSH_CONSTANT,
+    // ! [ -- true]
+    OPCODE_PUSH_TRUE,
+    // ! [ -- false]
+    OPCODE_PUSH_FALSE,
+    // ! [ -- nil]
+    OPCODE_PUSH_NIL,
+    // ! [v -- ]
+    OPCODE_POP,
+    // ! [v -- v, v]
+    OPCODE_DUP,
+    // ! [v_0, ..., v_n, r -- r] Drop n(operand) values under the top.
+    OPCODE_SLIDE,
+    // ! [ -- v] Lookup the variable(operand: index of the string constant).
+    /* !
+     * It is emitted only if the name is not defined at compile time.
+     * When the name is found, this is rewritten to OPCODE_LOAD_GLOBAL or OPCODE_LOAD_NODE.
+     */
+    OPCODE_LOAD_NAME,
+    // ! [ -- v] Load @last of the node(operand: index of the string constant).
+    /* !
+     * It is emitted only if the node is not defined at compile time.
+     * When the node is found, this is rewritten to OPCODE_LOAD_NODE_LAST.
+     */
+    OPCODE_LOAD_LAST,
+    // ! [ -- v] Load the local variable in the frame(operand: slot).
+    OPCODE_LOAD_LOCAL,
+    // ! [ -- v] Load the captured variable(operand: depth and slot, see variable_table_t).
+    OPCODE_LOAD_ENV,
+    // ! [ -- v] Load the global variable(operand: index of the variable constant).
+    OPCODE_LOAD_GLOBAL,
+    // ! [ -- v] Load the value of the node(operand: index of the node constant).
+    OPCODE_LOAD_NODE,
+    // ! [ -- v] Load @last of the node(operand: index of the node constant).
+    OPCODE_LOAD_NODE_LAST,
+    // Binary operators. The order is the same as parser_expression_kind_t.
+    // ! [a, b -- a + b]
+    OPCODE_ADD,
+    // ! [a, b -- a - b]
+    OPCODE_SUB,
+    // ! [a, b -- a / b]
+    OPCODE_DIV,
+    // ! [a, b -- a * b]
+    OPCODE_MUL,
+    // ! [a, b -- a % b]
+    OPCODE_MOD,
+    // ! [a, b -- a << b]
+    OPCODE_LEFT_SHIFT,
+    // ! [a, b -- a >> b]
+    OPCODE_RIGHT_SHIFT,
+    // ! [a, b -- a <= b]
+    OPCODE_LESS_OR_EQUAL,
+    // ! [a, b -- a < b]
+    OPCODE_LESS_THAN,
+    // ! [a, b -- a >= b]
+    OPCODE_GREATER_OR_EQUAL,
+    // ! [a, b -- a > b]
+    OPCODE_GREATER_THAN,
+    // ! [a, b -- a = b]
+    OPCODE_EQUAL,
+    // ! [a, b -- a != b]
+    OPCODE_NOT_EQUAL,
+    // ! [a, b -- a & b]
+    OPCODE_AND,
+    // ! [a, b -- a | b]
+    OPCODE_OR,
+    // ! [a, b -- a ^ b]
+    OPCODE_XOR,
+    // ! [v -- bool] Convert to the boolean. (v != false)
+    OPCODE_TO_BOOLEAN,
+    // ! [ -- ] Jump to operand.
+    OPCODE_JUMP,
+    // ! [cond -- ] Jump to operand if cond is false. nil is a type mismatch.
+    OPCODE_JUMP_IF_FALSE,
+    // ! [v -- v] or [v -- ] Jump to operand if v is false, otherwise pop v.(for &&)
+    OPCODE_JUMP_IF_FALSE_OR_POP,
+    // ! [v -- v] or [v -- ] Jump to operand if v is not false, otherwise pop v.(for ||)
+    OPCODE_JUMP_IF_TRUE_OR_POP,
+    // ! [v_0, ..., v_(n-1) -- t] Construct a tuple of length n(operand).
+    OPCODE_TUPLE,
+    // ! [a_0, ..., a_(n-1), f -- r] Call f with n(operand) arguments.
+    OPCODE_CALL,
+    // ! [a_0, ..., a_(n-1), f -- ] Call f with n(operand) arguments, replacing the current frame.
+    OPCODE_TAIL_CALL,
+    // ! [r -- ] Return r to the caller.
+    OPCODE_RETURN,
+    // ! [ -- f] Construct a closure(operand: index of the bytecode constant).
+    OPCODE_CLOSURE,
+    // ! [v -- ] Store v to the local variable in the frame(operand: slot).
+    OPCODE_STORE_LOCAL,
+    // ! [ -- ] Jump by the integer in the frame(operand: index of the jump table, see below.)
+    /* !
+     * The case is [the integer, the target]. Cases are sorted by the integer.
+     */
+    OPCODE_SWITCH_INT,
+    // ! [ -- ] Jump by the tag and the arity of the tuple in the frame(operand: same as above.)
+    /* !
+     * The case is [the arity, the tag(or RECORD_TAG_NONE), the target, the first slot].
+     * When a case is matched, the elements are copied to the slots from the first slot,
+     * unless the first slot is negative.
+     * A tag object is a tuple whose arity is 0.
+     */
+    OPCODE_SWITCH_TUPLE,
+    // ! [v -- ] Bind v to the deconstructor(operand: the first slot and index of the constant).
+    OPCODE_MATCH_LOCAL,
+    // ! [v -- ] Same as OPCODE_MATCH_LOCAL, but the slots are in the variable table.
+    OPCODE_MATCH_ENV,
+    // Superinstructions of binary operators, which take the right operand without the stack.
+    // The order of each group is the same as OPCODE_ADD...OPCODE_NOT_EQUAL.
+    // ! [a -- a + n] The right operand is the immediate integer(operand).
+    OPCODE_ADD_INT,
+    OPCODE_SUB_INT,
+    OPCODE_DIV_INT,
+    OPCODE_MUL_INT,
+    OPCODE_MOD_INT,
+    OPCODE_LEFT_SHIFT_INT,
+    OPCODE_RIGHT_SHIFT_INT,
+    OPCODE_LESS_OR_EQUAL_INT,
+    OPCODE_LESS_THAN_INT,
+    OPCODE_GREATER_OR_EQUAL_INT,
+    OPCODE_GREATER_THAN_INT,
+    OPCODE_EQUAL_INT,
+    OPCODE_NOT_EQUAL_INT,
+    // ! [a -- a + v] The right operand is the local variable in the frame(operand: slot).
+    OPCODE_ADD_LOCAL,
+    OPCODE_SUB_LOCAL,
+    OPCODE_DIV_LOCAL,
+    OPCODE_MUL_LOCAL,
+    OPCODE_MOD_LOCAL,
+    OPCODE_LEFT_SHIFT_LOCAL,
+    OPCODE_RIGHT_SHIFT_LOCAL,
+    OPCODE_LESS_OR_EQUAL_LOCAL,
+    OPCODE_LESS_THAN_LOCAL,
+    OPCODE_GREATER_OR_EQUAL_LOCAL,
+    OPCODE_GREATER_THAN_LOCAL,
+    OPCODE_EQUAL_LOCAL,
+    OPCODE_NOT_EQUAL_LOCAL,
+    // ! [a -- a + v] The right operand is the node(operand: index of the node constant).
+    OPCODE_ADD_NODE,
+    OPCODE_SUB_NODE,
+    OPCODE_DIV_NODE,
+    OPCODE_MUL_NODE,
+    OPCODE_MOD_NODE,
+    OPCODE_LEFT_SHIFT_NODE,
+    OPCODE_RIGHT_SHIFT_NODE,
+    OPCODE_LESS_OR_EQUAL_NODE,
+    OPCODE_LESS_THAN_NODE,
+    OPCODE_GREATER_OR_EQUAL_NODE,
+    OPCODE_GREATER_THAN_NODE,
+    OPCODE_EQUAL_NODE,
+    OPCODE_NOT_EQUAL_NODE,
+    // Binary operators whose operands are proven to be integers.(See typing_proves_int.)
+    // The order of each group is the same as OPCODE_ADD...OPCODE_GREATER_THAN.
+    // ! [a, b -- a + b] Same as OPCODE_ADD, but the operands are not checked.
+    OPCODE_ADD_UNCHECKED,
+    OPCODE_SUB_UNCHECKED,
+    OPCODE_DIV_UNCHECKED,
+    OPCODE_MUL_UNCHECKED,
+    OPCODE_MOD_UNCHECKED,
+    OPCODE_LEFT_SHIFT_UNCHECKED,
+    OPCODE_RIGHT_SHIFT_UNCHECKED,
+    OPCODE_LESS_OR_EQUAL_UNCHECKED,
+    OPCODE_LESS_THAN_UNCHECKED,
+    OPCODE_GREATER_OR_EQUAL_UNCHECKED,
+    OPCODE_GREATER_THAN_UNCHECKED,
+    // ! [a -- a + n] Same as OPCODE_ADD_INT, but the left operand is not checked.
+    OPCODE_ADD_INT_UNCHECKED,
+    OPCODE_SUB_INT_UNCHECKED,
+    OPCODE_DIV_INT_UNCHECKED,
+    OPCODE_MUL_INT_UNCHECKED,
+    OPCODE_MOD_INT_UNCHECKED,
+    OPCODE_LEFT_SHIFT_INT_UNCHECKED,
+    OPCODE_RIGHT_SHIFT_INT_UNCHECKED,
+    OPCODE_LESS_OR_EQUAL_INT_UNCHECKED,
+    OPCODE_LESS_THAN_INT_UNCHECKED,
+    OPCODE_GREATER_OR_EQUAL_INT_UNCHECKED,
+    OPCODE_GREATER_THAN_INT_UNCHECKED,
+    // ! [a -- a + v] Same as OPCODE_ADD_LOCAL, but the operands are not checked.
+    OPCODE_ADD_LOCAL_UNCHECKED,
+    OPCODE_SUB_LOCAL_UNCHECKED,
+    OPCODE_DIV_LOCAL_UNCHECKED,
+    OPCODE_MUL_LOCAL_UNCHECKED,
+    OPCODE_MOD_LOCAL_UNCHECKED,
+    OPCODE_LEFT_SHIFT_LOCAL_UNCHECKED,
+    OPCODE_RIGHT_SHIFT_LOCAL_UNCHECKED,
+    OPCODE_LESS_OR_EQUAL_LOCAL_UNCHECKED,
+    OPCODE_LESS_THAN_LOCAL_UNCHECKED,
+    OPCODE_GREATER_OR_EQUAL_LOCAL_UNCHECKED,
+    OPCODE_GREATER_THAN_LOCAL_UNCHECKED,
+    // ! [a_0, ..., a_(n-1), f -- r] Same as OPCODE_CALL, but f is proven to take n arguments.
+    OPCODE_CALL_UNCHECKED,
+    // ! [a_0, ..., a_(n-1), f -- ] Same as OPCODE_TAIL_CALL, but f is proven to take n arguments.
+    OPCODE_TAIL_CALL_UNCHECKED,
+    // ! [ -- ] Check that the argument in the frame is an integer(operand: slot).
+    OPCODE_GUARD_INT,
+    // ! [t -- v] Get the element of the tuple which is proven to have it(operand: index).
+    OPCODE_TUPLE_ITH,
+  } opcode_t;
+
+// ! Count of binary operators which have superinstructions.(OPCODE_ADD...OPCODE_NOT_EQUAL)
+#define OPCODE_FUSED_BINARY_COUNT (OPCODE_NOT_EQUAL - OPCODE_ADD + 1)
+// ! Count of binary operators which have unchecked ones.(OPCODE_ADD...OPCODE_GREATER_THAN)
+#define OPCODE_UNCHECKED_BINARY_COUNT (OPCODE_GREATER_THAN - OPCODE_ADD + 1)
+// ! Does the instruction read the value of the node?(operand: index of the node constant)
+#define OPCODE_LOADS_NODE(op)                                                                      \
+  ((op) == OPCODE_LOAD_NODE || ((op) >= OPCODE_ADD_NODE && (op) <= OPCODE_NOT_EQUAL_NODE))
+
+// Layout of the jump table of OPCODE_SWITCH_INT and OPCODE_SWITCH_TUPLE in the constant pool.
+// Items are bytecode_constant_t::integer.(Tags are record_tag_t.)
+// ! The slot of the frame to be tested.
+#define BYTECODE_SWITCH_SLOT 0
+// ! Count of cases.
+#define BYTECODE_SWITCH_LENGTH 1
+// ! The target if no case matches.
+#define BYTECODE_SWITCH_OTHERWISE 2
+// ! The first case.
+#define BYTECODE_SWITCH_CASES 3
+// ! Size of a case of OPCODE_SWITCH_INT.
+#define BYTECODE_SWITCH_INT_CASE_SIZE 2
+// ! Size of a case of OPCODE_SWITCH_TUPLE.
+#define BYTECODE_SWITCH_TUPLE_CASE_SIZE 4
+
+  // ! An item of the constant pool.
+  typedef union bytecode_constant_t
+  {
+    // ! An object which is not garbage collected.(i.e. an immediate value)
+    struct object_t * object;
+    // ! An integer.(e.g. items of the jump table.)
+    int32_t integer;
+    // ! A name.
+    atom_t name;
+    // ! A deconstructor.(It is owned by the source AST.)
+    deconstructor_t * deconstructor;
+    // ! A nested function.(Its reference is owned by the constant pool.)
+    struct bytecode_t * bytecode;
+    // ! A global variable.(It is owned by machine_t::globals.)
+    struct variable_t * global;
+    // ! A node.(It is owned by machine_t::nodes.)
+    struct node_t * node;
+  } bytecode_constant_t;
+
+  // ! The compiled program.
+  typedef struct bytecode_t
+  {
+    // ! Reference Count
+    size_t reference_count;
+    // ! Instructions
+    instruction_t * code;
+    // ! Length of bytecode_t::code
+    size_t length;
+    // ! Constant Pool
+    bytecode_constant_t * constants;
+    // ! Length of bytecode_t::constants
+    size_t constants_length;
+    // ! The function expression compiled from.(Nullable)
+    /* !
+     * If it is not nullptr, this is a body of the function,
+     * and the arguments are source->value.function.arguments.
+     * The reference of the definition which holds it(source->value.function.owner) is owned.
+     */
+    parser_expression_t * source;
+    // ! Count of the arguments, if this is a body of the function.
+    int arity;
+    // ! Count of slots of the frame on the stack.
+    /* !
+     * Local variables are placed in the frame, unless they are captured by closures.
+     * If this is a body of the function, the frame starts with the arguments, the callee and
+     * the caller's variable table.
+     */
+    int frame_size;
+    // ! Count of slots of the variable table, which holds captured variables.
+    /* !
+     * The variable table is made only if it is not zero.
+     */
+    int env_size;
+  } bytecode_t;
+
+  // ! Increment the reference count.
+  /* !
+ * \param self The bytecode.
+ * \return self
+ */
+  static inline bytecode_t *
+  bytecode_retain(bytecode_t * self)
+  {
+    self->reference_count++;
+    return self;
+  }
+
+  // ! Decrement the reference count, and free it if it reaches zero.
+  /* !
+ * \param self The bytecode.(Nullable)
+ */
+  void bytecode_release(bytecode_t * self);
+
+  // ! [DEBUG] Print the bytecode to the current diagnostic message.
+  /* !
+ * \param self The bytecode.
+ */
+  void bytecode_debug_print(bytecode_t * self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
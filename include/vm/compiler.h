@@ -0,0 +1,49 @@
+/** -------------------------------------------
+ * @file   compiler.h
+ * @brief  Emfrp Bytecode Compiler
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include "em_result.h"
+#include "ast.h"
+#include "vm/bytecode_t.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  struct machine_t;
+  struct variable_dependent_t;
+
+  // ! Compile the expression(e.g. a body of the node).
+  /* !
+ * The result refers strings and deconstructors of v, so v must outlive the result.
+ * Constant subexpressions are evaluated at compile time.
+ * \param m The machine
+ * \param v The expression
+ * \param owner The definition to be compiled, which is recorded as the dependent of the data
+ * inlined or typed.(See variable_t::dependents.) If it is nullptr, immediate values of data are not
+ * inlined. It should be nullptr for the code executed only once, because nothing compiles it again.
+ * \param out The result, whose reference count is 1.
+ * \return The status code
+ */
+  em_result compile_expression(
+    struct machine_t * m, parser_expression_t * v, const struct variable_dependent_t * owner,
+    bytecode_t ** out);
+
+  // ! Compile the function.
+  /* !
+ * The result holds a reference of f. Immediate values of data are inlined, and the function is
+ * recorded as their dependent by the name.(See variable_t::dependents.)
+ * \param m The machine
+ * \param f The function expression(kind == EXPR_KIND_FUNCTION)
+ * \param out The result, whose reference count is 1.
+ * \return The status code
+ */
+  em_result compile_function(struct machine_t * m, parser_expression_t * f, bytecode_t ** out);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
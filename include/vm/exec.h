@@ -9,6 +9,7 @@
 
 #include "vm/object_t.h"
 #include "vm/machine.h"
+#include "vm/bytecode_t.h"
 #include "ast.h"
 #include "collections/list_t.h"
 
@@ -19,6 +20,7 @@ extern "C"
 
   // ! Execute AST.
   /* !
+ * The expression is compiled, executed once, and the compiled code is discarded.
  * \param m The machine.
  * \param v The expression to be executed.
  * \param out The result.
@@ -26,6 +28,23 @@ extern "C"
  */
   em_result exec_ast(machine_t * m, parser_expression_t * v, object_t ** out);
 
+  // ! Execute the compiled bytecode.
+  /* !
+ * \param m The machine.
+ * \param code The bytecode to be executed.(compiled by compile_expression)
+ * \param out The result.
+ * \return The status code.
+ */
+  em_result exec_bytecode(machine_t * m, bytecode_t * code, object_t ** out);
+
+  // ! Test equality of two objects.
+  /* !
+ * \param l The left hand side.
+ * \param r The right hand side.
+ * \return Whether l and r are structurally equal.
+ */
+  bool exec_equal(object_t * l, object_t * r);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
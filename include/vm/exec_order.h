@@ -0,0 +1,86 @@
+/** -------------------------------------------
+ * @file   exec_order.h
+ * @brief  Incremental Topological Order of Execution Sequences
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include "em_result.h"
+#include "vm/exec_sequence_t.h"
+#include "vm/journal_t.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  struct machine_t;
+
+  // ! Collect exec_sequence_t::reads from the compiled code.
+  /* !
+ * \param self The machine
+ * \param es The exec_sequence_t with the AST program.
+ * \return The status code(may return EM_RESULT_MISSING_IDENTIFIER.)
+ */
+  em_result exec_order_collect_reads(struct machine_t * self, exec_sequence_t * es);
+
+  // ! Test es can be added to the dependency graph.
+  /* !
+ * It does not modify the graph. es is not added to the graph yet.
+ * \param self The machine
+ * \param es The new exec_sequence_t whose exec_sequence_t::reads are collected.
+ * \param journal The nodes which es redefines.
+ * \return The status code(EM_RESULT_MISSING_IDENTIFIER or EM_RESULT_CYCLIC_REFERENCE.)
+ */
+  em_result exec_order_check(struct machine_t * self, exec_sequence_t * es, journal_t * journal);
+
+  // ! Add es to the dependency graph, and repair machine_t::order.
+  /* !
+ * Readers of the redefined nodes are moved to es. If es replaces a previous definition entirely,
+ * es takes its place in the order. Then, only the region between the edges which violate the
+ * order is reordered.(Pearce-Kelly algorithm)
+ * \param self The machine
+ * \param es The exec_sequence_t which is checked by exec_order_check.(It is never moved.)
+ * \param journal The nodes which es redefines.
+ * \return The status code
+ */
+  em_result exec_order_add(struct machine_t * self, exec_sequence_t * es, journal_t * journal);
+
+  // ! Replace exec_sequence_t::reads of es, and repair machine_t::order.
+  /* !
+ * It is used when the functions which es calls are changed.
+ * \param self The machine
+ * \param es The ordered exec_sequence_t.
+ * \param reads The new exec_sequence_t::reads.(It is moved if it succeeds. It is freed if they are
+ * the same as before.)
+ * \param length The length of reads
+ * \return The status code(EM_RESULT_MISSING_IDENTIFIER or EM_RESULT_CYCLIC_REFERENCE, then the
+ * graph is not modified.)
+ */
+  em_result exec_order_update_reads(
+    struct machine_t * self, exec_sequence_t * es, node_t ** reads, int length);
+
+  // ! Add many exec_sequence_t at once, and sort machine_t::order again.
+  /* !
+ * It is used to load a program. The graph is sorted once in linear time(Kahn's algorithm), so
+ * that the definitions may refer to the ones below. The graph is not modified if it fails.
+ * \param self The machine
+ * \param added The new exec_sequence_t whose exec_sequence_t::reads are collected. All of the
+ * nodes which they read have node_t::definition, and the nodes which they update are linked to
+ * them already.(They are never moved.)
+ * \param length The length of added.
+ * \return The status code(EM_RESULT_CYCLIC_REFERENCE.)
+ */
+  em_result exec_order_add_all(struct machine_t * self, exec_sequence_t ** added, size_t length);
+
+  // ! Remove es from the dependency graph and machine_t::order.
+  /* !
+ * es must not update any nodes.
+ * \param self The machine
+ * \param es The exec_sequence_t to be removed.
+ */
+  void exec_order_remove(struct machine_t * self, exec_sequence_t * es);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
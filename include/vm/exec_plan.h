@@ -0,0 +1,71 @@
+/** -------------------------------------------
+ * @file   exec_plan.h
+ * @brief  Execution Plan, the Flat Execution Order
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include "em_result.h"
+#include "vm/exec_sequence_t.h"
+#include "vm/node_t.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  struct machine_t;
+
+  // ! The program is always executed.(Callbacks are polled.)
+#define EXEC_PLAN_ENTRY_ALWAYS 1
+  // ! The program is never executed.(EMFRP_PROGRAM_KIND_NOTHING)
+#define EXEC_PLAN_ENTRY_NEVER 2
+  // ! exec_plan_entry_t::dependencies are not collected yet.
+#define EXEC_PLAN_ENTRY_UNRESOLVED 4
+
+  // ! An entry of the execution plan.
+  /* !
+ * It has what the iteration reads, so that machine_indicate does not follow exec_sequence_t.
+ */
+  typedef struct exec_plan_entry_t
+  {
+    // ! The program and the nodes to be updated.
+    exec_sequence_t * sequence;
+    // ! The node whose node_t::last is updated at the beginning of the iteration.(Nullable)
+    node_t * last;
+    // ! exec_sequence_t::dependencies.(Nullable)
+    node_dependency_t * dependencies;
+    // ! Length of exec_plan_entry_t::dependencies
+    int dependencies_length;
+    // ! EXEC_PLAN_ENTRY_*
+    int flags;
+  } exec_plan_entry_t;
+
+  // ! Build machine_t::plan from machine_t::order.
+  /* !
+ * It is called only if machine_t::plan_outdated is true.
+ * \param self The machine
+ * \return The status code
+ */
+  em_result exec_plan_build(struct machine_t * self);
+
+  // ! Assign node_t::last := node_t::value of all nodes in the plan.
+  /* !
+ * \param self The machine
+ * \return The status code
+ */
+  em_result exec_plan_update_last(struct machine_t * self);
+
+  // ! Execute the programs in the plan.
+  /* !
+ * A failed program does not stop the iteration. It is marked(exec_sequence_mark_lastfailed) and
+ * reported to the diagnostics by exec_sequence_update_value.
+ * \param self The machine
+ * \param all Whether all of the programs are executed, or only the ones whose dependencies are
+ * updated in this iteration.
+ */
+  void exec_plan_update_values(struct machine_t * self, bool all);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -10,6 +10,7 @@
 #include "collections/arraylist_t.h"
 #include "vm/node_t.h"
 #include "vm/program.h"
+#include "vm/bytecode_t.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -49,6 +50,32 @@ extern "C"
 
   typedef emfrp_program_kind exec_sequence_program_kind;
 
+  // ! A node which the program reads.
+  typedef struct node_dependency_t
+  {
+    // ! The node.
+    node_t * node;
+    // ! Whether the program reads node_t::last(true) or node_t::value(false).
+    bool last;
+  } node_dependency_t;
+
+#if EMFRP_ENABLE_PROFILING
+  // ! Counters of exec_sequence_update_value.
+  typedef struct exec_sequence_profile_t
+  {
+    // ! Count of evaluations.
+    size_t evaluations;
+    // ! Cumulative wall time of evaluations in nanoseconds.
+    uint64_t total_ns;
+    // ! The longest wall time of an evaluation in nanoseconds.
+    uint64_t max_ns;
+    // ! Count of cells allocated through memory_manager_alloc.
+    size_t allocations;
+    // ! Count of failed evaluations.
+    size_t failures;
+  } exec_sequence_profile_t;
+#endif
+
   typedef struct exec_sequence_t
   {
     // ! Kind of exec_sequence_t::program.
@@ -58,8 +85,17 @@ extern "C"
     {
       // ! Nothing
       nullptr_t nothing;
-      // ! AST
-      parser_expression_t * ast;
+      // ! AST and its compiled code.
+      struct
+      {
+        // ! The definition compiled from.(Its reference is owned.)
+        /* !
+         * The compiled code refers to the AST in it.
+         */
+        parser_toplevel_t * source;
+        // ! The compiled code.
+        bytecode_t * code;
+      } ast;
       // ! CallBack
       exec_callback_t callback;
     } program;
@@ -67,8 +103,49 @@ extern "C"
     node_t * node_definition;
     // Multiple node definitions. Nullable.
     node_or_tuple_t * /*<node_t *>*/ node_definitions;
+    // ! Nodes which the program reads.(Nullable)
+    /* !
+     * They are collected from the compiled code lazily.
+     */
+    node_dependency_t * dependencies;
+    // ! Length of exec_sequence_t::dependencies, or -1 if they must be collected again.
+    /* !
+     * It stays -1 while the compiled code has names which are not resolved yet.
+     */
+    int dependencies_length;
+    // ! Nodes whose values the program reads.(Nullable)
+    /* !
+     * They are the edges of the dependency graph. The program is executed after
+     * node_t::definition of them.
+     */
+    node_t ** reads;
+    // ! Length of exec_sequence_t::reads
+    int reads_length;
+    // ! Whether the program reads nodes through global variables.(e.g. bodies of the functions)
+    /* !
+     * If it is true, exec_sequence_t::reads are collected again when global variables are
+     * assigned.(See machine_t::globals_changed.)
+     */
+    bool reads_globals;
+    // ! exec_sequence_t which read the nodes updated by this.(The reverse edges)
+    arraylist_t /*<exec_sequence_t *>*/ successors;
+    // ! The index in machine_t::order, or -1 if it is not ordered.
+    int order;
+    // ! Used while searching the dependency graph.
+    bool visited;
+#if EMFRP_ENABLE_PROFILING
+    // ! The counters.
+    exec_sequence_profile_t profile;
+#endif
   } exec_sequence_t;
 
+#if EMFRP_ENABLE_PROFILING
+#define exec_sequence_profile_reset(v)                                                             \
+  ((v)->profile = (exec_sequence_profile_t){0, 0, 0, 0, 0})
+#else
+#define exec_sequence_profile_reset(v)
+#endif
+
   // ! Constructor of exec_sequence_t.
   /* !
  * \param out The result
@@ -77,26 +154,47 @@ extern "C"
   static inline em_result
   exec_sequence_new_mono_nothing(exec_sequence_t * out, node_t * value)
   {
-    out->program_kind     = EMFRP_PROGRAM_KIND_NOTHING;
-    out->program.nothing  = nullptr;
-    out->node_definition  = value;
-    out->node_definitions = nullptr;
+    out->program_kind        = EMFRP_PROGRAM_KIND_NOTHING;
+    out->program.nothing     = nullptr;
+    out->node_definition     = value;
+    out->node_definitions    = nullptr;
+    out->dependencies        = nullptr;
+    out->dependencies_length = -1;
+    out->reads               = nullptr;
+    out->reads_length        = 0;
+    out->reads_globals       = false;
+    out->order               = -1;
+    out->visited             = false;
+    arraylist_default(&(out->successors));
+    exec_sequence_profile_reset(out);
     return EM_RESULT_OK;
   }
 
   // ! Constructor of exec_sequence_t.
   /* !
  * \param out The result
- * \param ast The program(AST)
+ * \param ast The node definition. The reference is moved.
+ * \param code The compiled program. The reference is moved.
  * \param value The node to update.
  */
   static inline em_result
-  exec_sequence_new_mono_ast(exec_sequence_t * out, parser_expression_t * ast, node_t * value)
+  exec_sequence_new_mono_ast(
+    exec_sequence_t * out, parser_toplevel_t * ast, bytecode_t * code, node_t * value)
   {
-    out->program_kind     = EMFRP_PROGRAM_KIND_AST;
-    out->program.ast      = ast;
-    out->node_definition  = value;
-    out->node_definitions = nullptr;
+    out->program_kind        = EMFRP_PROGRAM_KIND_AST;
+    out->program.ast.source  = ast;
+    out->program.ast.code    = code;
+    out->node_definition     = value;
+    out->node_definitions    = nullptr;
+    out->dependencies        = nullptr;
+    out->dependencies_length = -1;
+    out->reads               = nullptr;
+    out->reads_length        = 0;
+    out->reads_globals       = false;
+    out->order               = -1;
+    out->visited             = false;
+    arraylist_default(&(out->successors));
+    exec_sequence_profile_reset(out);
     return EM_RESULT_OK;
   }
 
@@ -110,10 +208,19 @@ extern "C"
   static inline em_result
   exec_sequence_new_mono_callback(exec_sequence_t * out, exec_callback_t callback, node_t * value)
   {
-    out->program_kind     = EMFRP_PROGRAM_KIND_CALLBACK;
-    out->program.callback = callback;
-    out->node_definition  = value;
-    out->node_definitions = nullptr;
+    out->program_kind        = EMFRP_PROGRAM_KIND_CALLBACK;
+    out->program.callback    = callback;
+    out->node_definition     = value;
+    out->node_definitions    = nullptr;
+    out->dependencies        = nullptr;
+    out->dependencies_length = -1;
+    out->reads               = nullptr;
+    out->reads_length        = 0;
+    out->reads_globals       = false;
+    out->order               = -1;
+    out->visited             = false;
+    arraylist_default(&(out->successors));
+    exec_sequence_profile_reset(out);
     return EM_RESULT_OK;
   }
 
@@ -129,10 +236,19 @@ extern "C"
   exec_sequence_new_multi_callback(
     exec_sequence_t * out, exec_callback_t callback, node_t * as_value, node_or_tuple_t * value)
   {
-    out->program_kind     = EMFRP_PROGRAM_KIND_CALLBACK;
-    out->program.callback = callback;
-    out->node_definition  = as_value;
-    out->node_definitions = value;
+    out->program_kind        = EMFRP_PROGRAM_KIND_CALLBACK;
+    out->program.callback    = callback;
+    out->node_definition     = as_value;
+    out->node_definitions    = value;
+    out->dependencies        = nullptr;
+    out->dependencies_length = -1;
+    out->reads               = nullptr;
+    out->reads_length        = 0;
+    out->reads_globals       = false;
+    out->order               = -1;
+    out->visited             = false;
+    arraylist_default(&(out->successors));
+    exec_sequence_profile_reset(out);
     return EM_RESULT_OK;
   }
 
@@ -146,6 +262,15 @@ extern "C"
   em_result exec_sequence_update_value_given_object(
     struct machine_t * machine, exec_sequence_t * self, object_t * obj);
 
+  // ! Mark the sequence as last failed, and report the failure.
+  /* !
+ * It is reported once until the sequence is executed successfully.
+ * \param self The exec_sequence_t
+ * \param action The failed action, e.g. "execution".
+ * \param res The status code of the failure.
+ */
+  void exec_sequence_report_failure(exec_sequence_t * self, const char * action, em_result res);
+
   // ! Update the value of nodes.
   /* !
  * \param machine The machine to execute the program.
@@ -154,6 +279,73 @@ extern "C"
  */
   em_result exec_sequence_update_value(struct machine_t * machine, exec_sequence_t * self);
 
+  // ! Whether any of the dependencies are updated in the iteration.
+  /* !
+ * \param deps The dependencies
+ * \param length The length of deps
+ * \param iteration The iteration(machine_t::iteration)
+ * \return Whether updated or not
+ */
+  static inline bool
+  node_dependencies_updated(node_dependency_t * deps, int length, size_t iteration)
+  {
+    for(int i = 0; i < length; ++i)
+      if((deps[i].last ? deps[i].node->last_updated_at : deps[i].node->updated_at) == iteration)
+        return true;
+    return false;
+  }
+
+  // ! Called with each node which the compiled code reads.
+  /* !
+ * \param user The user data given to exec_sequence_walk_reads.
+ * \param node The node.
+ * \param last Whether node_t::last(true) or node_t::value(false) is read.
+ * \return The status code
+ */
+  typedef em_result (*exec_sequence_read_callback_t)(void * user, node_t * node, bool last);
+
+  // ! Visit the nodes which the compiled code reads.
+  /* !
+ * Nested closures and the functions(and data) which the code refers to are followed, because
+ * bodies of the functions read the nodes directly. Each code is visited once.
+ * \param machine The machine
+ * \param code The compiled code of the node.
+ * \param callback Called with each node.(The same node may be given twice or more.)
+ * \param user The user data of callback.
+ * \param unresolved Set to true, if the code has names which are not linked yet.
+ * \param globals Set to true, if global variables are followed.
+ * \return The status code(EM_RESULT_MISSING_IDENTIFIER if the code of the node has unknown names.)
+ */
+  em_result exec_sequence_walk_reads(
+    struct machine_t * machine, bytecode_t * code, exec_sequence_read_callback_t callback,
+    void * user, bool * unresolved, bool * globals);
+
+  // ! Collect exec_sequence_t::dependencies if they are not collected yet.
+  /* !
+ * \param machine The machine
+ * \param self The exec_sequence_t whose program is AST.
+ * \return Whether exec_sequence_t::dependencies are available(true) or not(false).
+ */
+  bool exec_sequence_resolve_dependencies(struct machine_t * machine, exec_sequence_t * self);
+
+  // ! Test the nodes must be updated in this iteration.
+  /* !
+ * Callbacks are always executed, because they are polled. Programs are executed only if the
+ * nodes they read are updated in this iteration(machine_t::iteration).
+ * \param machine The machine.
+ * \param self The exec_sequence_t to be tested.
+ * \return Whether the nodes must be updated or not
+ */
+  bool exec_sequence_needs_update(struct machine_t * machine, exec_sequence_t * self);
+
+  // ! Assign node_t::last := node_t::value.
+  /* !
+ * \param machine The machine. It is used for GC.
+ * \param n The node to be updated.(Nullable)
+ * \return The result
+ */
+  em_result update_node_last(struct machine_t * machine, node_t * n);
+
   // ! Assign node_t::last := node_t::value.
   /* !
  * \param machine The machine. It is used for GC.
@@ -172,29 +364,7 @@ extern "C"
   // ! Freeing the exec_sequence. In this method, it does not call em_free(es);
   void exec_sequence_free(exec_sequence_t * es);
 
-  // ! Get dependencies of give AST.
-  /* !
- * \param v The expression
- * \param out The result
- * \return The status code
- */
-  em_result get_dependencies_ast(
-    struct machine_t * machine, parser_expression_t * v, list_t /*<string_t>*/ ** out);
-
-  // ! Check the given identifier is referenced from v.
-
-  /* !
- * \param v The expression
- * \param str The string which refers
- * \return Whether v references str.
- */
-  bool check_depends_on_ast(parser_expression_t * v, string_t * str);
-
-  em_result topological_sort(
-    struct machine_t * machine, list_t /*<exec_sequence_t>*/ ** es,
-    list_t /*<exec_sequence_t>*/ *** last_es);
-
-  // ! Print out the given node_or_tuple_t.
+  // ! Print out the given node_or_tuple_t to the current diagnostic message.
   void node_or_tuple_debug_print(node_or_tuple_t * nt);
 
 #ifdef __cplusplus
@@ -8,15 +8,41 @@
 #pragma once
 #include "em_result.h"
 #include "vm/object_t.h"
+#include "collections/arraylist_t.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif /* __cplusplus */
-// ! Size of objects.
-#define MEMORY_MANAGER_HEAP_SIZE 512
-// ! When memory_manager_t::remaining is below this, the gc starts.
-#define MEMORY_MANAGER_GC_START_SIZE (MEMORY_MANAGER_HEAP_SIZE / 2)
+// ! Count of objects in a page.
+#ifndef MEMORY_MANAGER_PAGE_SIZE
+#if defined(__ESP_IDF__) || defined(__ESP_8266__) || defined(RPI_PICO) || defined(__ZEPHYR__)
+#define MEMORY_MANAGER_PAGE_SIZE 128
+#else
+#define MEMORY_MANAGER_PAGE_SIZE 512
+#endif
+#endif
+// ! Maximum count of pages, which is the default of memory_manager_t::max_pages.
+#ifndef MEMORY_MANAGER_MAX_PAGES
+#if defined(__ESP_IDF__) || defined(__ESP_8266__) || defined(RPI_PICO) || defined(__ZEPHYR__)
+#define MEMORY_MANAGER_MAX_PAGES 4
+#else
+#define MEMORY_MANAGER_MAX_PAGES 2048
+#endif
+#endif
+// ! Count of pages allocated first. Pages are never returned below this.
+#define MEMORY_MANAGER_MIN_PAGES 1
+// ! Whether the gc starts.(The half of the heap is used.)
+#define MEMORY_MANAGER_SHOULD_START_GC(remaining, pages_length)                                    \
+  ((remaining) * 2 <= (pages_length) * MEMORY_MANAGER_PAGE_SIZE)
+// ! Count of objects in the nursery.
+#ifndef MEMORY_MANAGER_NURSERY_SIZE
+#if defined(__ESP_IDF__) || defined(__ESP_8266__) || defined(RPI_PICO) || defined(__ZEPHYR__)
+#define MEMORY_MANAGER_NURSERY_SIZE 64
+#else
+#define MEMORY_MANAGER_NURSERY_SIZE 1024
+#endif
+#endif
 // ! Size of work list.
 #define MEMORY_MANAGER_WORK_LIST_SIZE 256  // = 1KiB
 
@@ -33,23 +59,65 @@ extern "C"
     MEMORY_MANAGER_STATE_SWEEP
   } memory_manager_t_state;
 
+  // ! A page of the heap.
+  typedef struct memory_page_t
+  {
+    // ! List of free cells in this page.
+    object_t * freelist;
+    // ! size(freelist)
+    int remaining;
+    // ! The cells
+    object_t space[MEMORY_MANAGER_PAGE_SIZE];
+  } memory_page_t;
+
   // ! The memory manager(snapshot GC)
+  /* !
+   * The heap is a list of pages, which grows on demand up to memory_manager_t::max_pages.
+   * Pages which become empty after sweeping are returned to the system.
+   */
   typedef struct memory_manager_t
   {
     // ! The state
     memory_manager_t_state state;
-    // ! The heap space
-    object_t space[MEMORY_MANAGER_HEAP_SIZE];
-    // ! List of free cells.
-    object_t * freelist;
-    // ! size(freelist)
+    // ! The pages
+    memory_page_t ** pages;
+    // ! Count of pages
+    int pages_length;
+    // ! Capacity of memory_manager_t::pages
+    int pages_capacity;
+    // ! The heap never grows beyond this count of pages.
+    int max_pages;
+    // ! The page which cells are allocated from.
+    int allocator;
+    // ! Sum of memory_page_t::remaining
     int remaining;
     // ! Gray-colored list.
     object_t * worklist[MEMORY_MANAGER_WORK_LIST_SIZE];
     // ! worklist.iter
     int worklist_top;
-    // ! sweeper for snapshot GC.
+    // ! Some objects are marked, but they are not pushed to the work list.
+    bool worklist_overflowed;
+    // ! The page to be swept.
+    int sweeper_page;
+    // ! sweeper for snapshot GC.(The index in the page.)
     int sweeper;
+    // ! The nursery, where temporaries in an iteration are bump-allocated.
+    object_t * nursery;
+    // ! Count of used cells in memory_manager_t::nursery
+    int nursery_top;
+    // ! Whether memory_manager_alloc allocates from the nursery.
+    bool nursery_enabled;
+    // ! Objects in pages, which are allocated while the nursery is used.
+    /* !
+     * They may refer objects in the nursery, so they are scanned when promoting.
+     */
+    arraylist_t /*<object_t *>*/ remembered;
+    // ! Objects promoted, whose children are not promoted yet.
+    arraylist_t /*<object_t *>*/ promoted;
+    // ! Count of allocations so far.(for benchmarking)
+    size_t allocations;
+    // ! Count of completed gc cycles so far.(for benchmarking)
+    size_t gc_cycles;
   } memory_manager_t;
 
   // ! Push to work list without checking the state. (Coloring with gray.)
@@ -82,6 +150,39 @@ extern "C"
  */
   em_result memory_manager_new(memory_manager_t ** out);
 
+  // ! Set the maximum size of the heap.
+  /* !
+ * Pages which are already allocated are not returned immediately.
+ * /param self The memory manager
+ * /param max_objects The maximum count of objects.(It is rounded up to pages.)
+ */
+  static inline void
+  memory_manager_set_limit(memory_manager_t * self, size_t max_objects)
+  {
+    self->max_pages =
+      (int)((max_objects + MEMORY_MANAGER_PAGE_SIZE - 1) / MEMORY_MANAGER_PAGE_SIZE);
+  }
+
+  // ! Start an iteration.
+  /* !
+ * Cells are allocated from the nursery until memory_manager_end_iteration.
+ * /param self The memory manager
+ */
+  static inline void
+  memory_manager_begin_iteration(memory_manager_t * self)
+  {
+    self->nursery_enabled = true;
+  }
+
+  // ! End an iteration.
+  /* !
+ * Objects in the nursery, which are reachable from nodes, globals and the stack, are promoted
+ * to pages, and the nursery is reset. If pages cannot hold them, the nursery is kept as it is.
+ * /param self The machine
+ * /return The result
+ */
+  em_result memory_manager_end_iteration(struct machine_t * self);
+
   // ! Allocate a cell.
   /* !
  * /param self The machine(may start the garbage collection.)
@@ -0,0 +1,173 @@
+/** -------------------------------------------
+ * @file   input_queue_t.h
+ * @brief  Lock-free Queue of Posted Inputs
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include "vm/node_t.h"
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  struct object_t;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  // Visual Studio 2019 does not have <stdatomic.h>.
+  // volatile accesses are acquire/release on x86 and x64 by default(/volatile:ms).
+  typedef volatile size_t input_queue_atomic_t;
+#define input_queue_atomic_init(p, v)   (*(p) = (v))
+#define input_queue_load_relaxed(p)     (*(p))
+#define input_queue_load_acquire(p)     (*(p))
+#define input_queue_store_release(p, v) (*(p) = (v))
+  static inline bool
+  input_queue_compare_exchange(input_queue_atomic_t * p, size_t * expected, size_t desired)
+  {
+#if defined(_WIN64)
+    size_t old = (size_t)_InterlockedCompareExchange64(
+      (volatile __int64 *)p, (__int64)desired, (__int64)*expected);
+#else
+    size_t old =
+      (size_t)_InterlockedCompareExchange((volatile long *)p, (long)desired, (long)*expected);
+#endif
+    if(old == *expected) return true;
+    *expected = old;
+    return false;
+  }
+#else
+// C11 atomics of size_t must not take a lock, or posting from interrupt handlers may deadlock.
+#if SIZE_MAX == UINT_MAX
+#define INPUT_QUEUE_LOCK_FREE ATOMIC_INT_LOCK_FREE
+#elif SIZE_MAX == ULONG_MAX
+#define INPUT_QUEUE_LOCK_FREE ATOMIC_LONG_LOCK_FREE
+#else
+#define INPUT_QUEUE_LOCK_FREE ATOMIC_LLONG_LOCK_FREE
+#endif
+#if INPUT_QUEUE_LOCK_FREE != 2
+// e.g. Cortex-M0+(RP2040) does not have compare-and-swap instructions, and libatomic uses locks.
+// Aligned loads and stores of size_t are atomic, so that only compare-and-swap needs the critical
+// section, which masks the interrupts(and the other core).
+#if !defined(EMFRP_INPUT_QUEUE_CRITICAL_BEGIN) && defined(RPI_PICO)
+#include "hardware/sync.h"
+#define EMFRP_INPUT_QUEUE_CRITICAL_BEGIN()                                                         \
+  uint32_t input_queue_saved_irq = spin_lock_blocking(spin_lock_instance(PICO_SPINLOCK_ID_OS1))
+#define EMFRP_INPUT_QUEUE_CRITICAL_END()                                                           \
+  spin_unlock(spin_lock_instance(PICO_SPINLOCK_ID_OS1), input_queue_saved_irq)
+#endif
+#ifndef EMFRP_INPUT_QUEUE_CRITICAL_BEGIN
+#error atomic_size_t is not lock-free. Define EMFRP_INPUT_QUEUE_CRITICAL_BEGIN/END().
+#endif
+  typedef volatile size_t input_queue_atomic_t;
+#define input_queue_atomic_init(p, v) (*(p) = (v))
+#define input_queue_load_relaxed(p)   (*(p))
+  static inline size_t
+  input_queue_load_acquire(input_queue_atomic_t * p)
+  {
+    size_t v = *p;
+    atomic_thread_fence(memory_order_acquire);
+    return v;
+  }
+  static inline void
+  input_queue_store_release(input_queue_atomic_t * p, size_t v)
+  {
+    atomic_thread_fence(memory_order_release);
+    *p = v;
+  }
+  static inline bool
+  input_queue_compare_exchange(input_queue_atomic_t * p, size_t * expected, size_t desired)
+  {
+    bool ret;
+    EMFRP_INPUT_QUEUE_CRITICAL_BEGIN();
+    ret = *p == *expected;
+    if(ret)
+      *p = desired;
+    else
+      *expected = *p;
+    EMFRP_INPUT_QUEUE_CRITICAL_END();
+    return ret;
+  }
+#else
+  typedef atomic_size_t input_queue_atomic_t;
+#define input_queue_atomic_init(p, v)   atomic_init((p), (v))
+#define input_queue_load_relaxed(p)     atomic_load_explicit((p), memory_order_relaxed)
+#define input_queue_load_acquire(p)     atomic_load_explicit((p), memory_order_acquire)
+#define input_queue_store_release(p, v) atomic_store_explicit((p), (v), memory_order_release)
+#define input_queue_compare_exchange(p, expected, desired)                                         \
+  atomic_compare_exchange_weak_explicit(                                                           \
+    (p), (expected), (desired), memory_order_relaxed, memory_order_relaxed)
+#endif
+#endif
+
+// ! The capacity of input_queue_t. It must be a power of 2.
+#ifndef EMFRP_INPUT_QUEUE_SIZE
+#define EMFRP_INPUT_QUEUE_SIZE 32
+#endif
+
+  // ! A slot of input_queue_t.
+  typedef struct input_queue_item_t
+  {
+    // ! The position which can use this slot.
+    /* !
+     * The producer of the position `p` can write it if sequence == p, and the consumer can read it
+     * if sequence == p + 1.
+     */
+    input_queue_atomic_t sequence;
+    // ! The node to be set.
+    node_t * node;
+    // ! The value.
+    struct object_t * value;
+  } input_queue_item_t;
+
+  // ! Bounded multi-producer single-consumer queue.
+  /* !
+ * input_queue_post never blocks nor allocates, so that it can be called from interrupt handlers and
+ * signal handlers. Only one thread may take items. See bench/input_stress.c for the stress test.
+ */
+  typedef struct input_queue_t
+  {
+    // ! The ring buffer.
+    input_queue_item_t items[EMFRP_INPUT_QUEUE_SIZE];
+    // ! The next position to be posted.
+    input_queue_atomic_t enqueue_position;
+    // ! The next position to be taken.(Only the consumer touches it.)
+    size_t dequeue_position;
+  } input_queue_t;
+
+  // ! Constructor of input_queue_t.
+  /* !
+ * \param out The result
+ */
+  void input_queue_new(input_queue_t * out);
+
+  // ! Post an input.(Interrupt-safe)
+  /* !
+ * \param self The queue
+ * \param node The node to be set.
+ * \param value The value, which must not be in the heap.
+ * \return Whether it is posted(true) or the queue is full(false).
+ */
+  bool input_queue_post(input_queue_t * self, node_t * node, struct object_t * value);
+
+  // ! Take the oldest input.
+  /* !
+ * \param self The queue
+ * \param node The node to be set.
+ * \param value The value.
+ * \return Whether it is taken(true) or the queue is empty(false).
+ */
+  bool input_queue_take(input_queue_t * self, node_t ** node, struct object_t ** value);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -35,6 +35,14 @@ extern "C"
   em_result remove_defined_node(
     list_t /*<exec_sequence_t>*/ * exec_sequences, journal_t ** out, node_t * node);
 
+  // ! Remove the pointer to the node(node) from node_t::definition.
+  /* !
+ * It does not search the execution list, unlike remove_defined_node.
+ * \param out The journal
+ * \param node The node which remove from.
+ */
+  em_result remove_defined_node2(journal_t ** out, node_t * node);
+
   // ! Revert by journal_t.
   /* !
  * \param j The journal which records the modifications.
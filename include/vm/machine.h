@@ -13,6 +13,8 @@
 #include "vm/gc.h"
 #include "vm/exec_sequence_t.h"
 #include "vm/variable_t.h"
+#include "vm/atom_t.h"
+#include "vm/input_queue_t.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -20,7 +22,6 @@ extern "C"
 #endif /* __cplusplus */
 
   struct object_t;
-  struct parser_node_t;
   struct parser_toplevel_t;
 
 #define MACHINE_STACK_SIZE 16
@@ -34,17 +35,67 @@ extern "C"
    * They references machine_t::nodes;
    */
     queue_t /*<exec_sequence_t*>*/ execution_list;
+    // ! exec_sequence_t in machine_t::execution_list in the topological order.
+    /* !
+   * It is maintained incrementally by exec_order_add and exec_order_remove.
+   */
+    arraylist_t /*<exec_sequence_t *>*/ order;
+    // ! machine_t::order flattened for machine_indicate.
+    /* !
+   * It is built from machine_t::order again only if machine_t::plan_outdated is true.
+   */
+    arraylist_t /*<exec_plan_entry_t>*/ plan;
+    // ! Whether machine_t::plan must be built again.(The dependency graph is changed.)
+    bool plan_outdated;
     // ! The details of nodes.
     /* !
    * Items are the node(not pointer).
    */
     dictionary_t /*<node_t>*/ nodes;
+    // ! The global variables.(functions, data and records)
+    /* !
+   * Items are the variable(not pointer), which are referred from the compiled code.
+   */
+    dictionary_t /*<variable_t>*/ globals;
+    // ! The interned identifiers.(atom_t)
+    /* !
+   * Names of the nodes and the global variables are the atoms.
+   */
+    dictionary_t /*<string_t>*/ atoms;
     // ! The memory manager.
     memory_manager_t * memory_manager;
     // ! The stack space.
     object_t * stack;
-    // ! The variable table.
+    // ! The variable table of local variables.
     variable_table_t * variable_table;
+    // ! Count of iterations.(machine_indicate)
+    size_t iteration;
+    // ! Whether the definitions are changed after the last iteration.
+    /* !
+   * If it is true, all of nodes are updated in the next iteration.
+   */
+    bool definitions_changed;
+    // ! The definitions which depend on changed values of global variables.
+    /* !
+   * They are compiled again by machine_exec.(See variable_t::dependents.)
+   */
+    arraylist_t /*<variable_dependent_t>*/ outdated;
+    // ! Whether global variables are assigned after exec_sequence_t::reads are collected.
+    /* !
+   * If it is true, exec_sequence_t::reads of the nodes which call the functions are collected
+   * again.(See exec_sequence_t::reads_globals.)
+   */
+    bool globals_changed;
+    // ! Whether the functions and the nodes are being compiled again.
+    /* !
+   * They were accepted before, so that they are not rejected even if they are ill-typed.
+   */
+    bool recompiling;
+    // ! The inputs posted by interrupts or other threads.
+    /* !
+   * They are applied by machine_drain_inputs.
+   */
+    input_queue_t inputs;
   } machine_t;
 
   // ! Constructor of machine_t.
@@ -56,6 +107,7 @@ extern "C"
 
   // ! Execute the given toplevel expression.
   /* !
+ * The machine retains prog if it needs, so that the caller releases it whether it succeeds or not.
  * \param self The machine
  * \param prog The toplevel expression
  * \param out The result if it is an expression.
@@ -63,33 +115,98 @@ extern "C"
  */
   em_result machine_exec(machine_t * self, struct parser_toplevel_t * prog, struct object_t ** out);
 
+  // ! Execute the given toplevels at once.(Load a program.)
+  /* !
+ * Records, functions and data are defined first in this order. Then, all of the nodes are added by
+ * machine_add_node_ast_all, so that the order of definitions does not matter. The definitions are
+ * accepted all or nothing: if one fails, the global variables are restored and no node is added.
+ * (The names of records stay in record_table, but they are not reachable without the
+ * constructors.) Expressions are evaluated last, after the definitions are accepted.
+ * \param self The machine
+ * \param programs The toplevels. They are released, whether it succeeds or not.
+ * \param length The length of programs.
+ * \param failed The index of the failed toplevel, or length if the nodes make a cycle.(Nullable)
+ * \return The status code
+ */
+  em_result machine_load(
+    machine_t * self, struct parser_toplevel_t ** programs, size_t length, size_t * failed);
+
+  // ! Add nodes(with AST programs) at once.
+  /* !
+ * The nodes may refer to each other regardless of the order, and the dependency graph is sorted
+ * once. They are added all or nothing.
+ * \param self The machine
+ * \param nodes The node definitions.(Released by the caller like machine_add_node_ast.)
+ * \param length The length of nodes.
+ * \param failed The index of the failed node, or length if they make a cycle.(Nullable)
+ * \return The status code
+ */
+  em_result machine_add_node_ast_all(
+    machine_t * self, struct parser_toplevel_t ** nodes, size_t length, size_t * failed);
+
   // ! Add a node(with an AST program).
   /* !
  * \param self The machine
- * \param n The AST of the node.
+ * \param out The added exec_sequence_t.(Nullable)
+ * \param prog The node definition. It is retained by the new exec_sequence_t, and the caller
+ * releases its own reference.
  * \return The status code
  */
   em_result
-  machine_add_node_ast(machine_t * self, exec_sequence_t ** out, struct parser_node_t * n);
+  machine_add_node_ast(machine_t * self, exec_sequence_t ** out, struct parser_toplevel_t * prog);
 
   // ! Add a node(a input node).
   /* !
  * \param self The machine
- * \param str Name of the node
+ * \param name Name of the node.(It is not moved.)
  * \param callback The callback of node. (Nullable)
  * \return The status code
  */
-  em_result machine_add_node_callback(machine_t * self, string_t str, exec_callback_t callback);
+  em_result
+  machine_add_node_callback(machine_t * self, string_t * name, exec_callback_t callback);
 
-  // ! Search value of the node.
+  // ! Add a node(a input node).
   /* !
+ * The previous definition of the node is replaced.
  * \param self The machine
+ * \param node_ptr The node.
+ * \param callback The callback of node. (Nullable)
+ * \return The status code
+ */
+  em_result
+  machine_add_node_callback2(machine_t * self, node_t * node_ptr, exec_callback_t callback);
+
+  // ! Intern the identifier.
+  /* !
+ * \param self The machine
+ * \param name The identifier
  * \param out The result
+ * \return The status code
+ */
+  static inline em_result
+  machine_intern(machine_t * self, string_t * name, atom_t * out)
+  {
+    return atom_intern(&(self->atoms), name, out);
+  }
+
+  // ! Search value of the node.
+  /* !
+ * \param self The machine
+ * \param out The result(It is never moved.)
  * \param name Name of the node
  * \return Whether found or not
  */
   bool machine_lookup_node(machine_t * self, node_t ** out, string_t * name);
 
+  // ! Search value of the node.
+  /* !
+ * \param self The machine
+ * \param out The result(It is never moved.)
+ * \param name Name of the node
+ * \return Whether found or not
+ */
+  bool machine_lookup_node_atom(machine_t * self, node_t ** out, atom_t name);
+
   // ! Push a object into the stack.
   /* !
  * \param self The machine
@@ -160,15 +277,15 @@ err:
   // ! Push a new variable table.
   /* !
  * \param self The machine
+ * \param length Count of slots
  * \return The result
  */
   static inline em_result
-  machine_new_variable_table(machine_t * self)
+  machine_new_variable_table(machine_t * self, size_t length)
   {
     em_result          errres = EM_RESULT_OK;
     variable_table_t * v      = nullptr;
-    CHKERR(em_malloc((void **)&v, sizeof(variable_table_t)));
-    CHKERR(variable_table_new(self, v, self->variable_table));
+    CHKERR(variable_table_new(self, &v, self->variable_table, length));
     self->variable_table = v;
 err:
     return errres;
@@ -188,7 +305,7 @@ err:
     return EM_RESULT_OK;
   }
 
-  // ! Assign a value to the variable.
+  // ! Assign a value to the global variable.
   /* !
  * \param self The machine
  * \param name The name of the variable.
@@ -198,28 +315,38 @@ err:
   static inline em_result
   machine_assign_variable(machine_t * self, string_t * name, struct object_t * value)
   {
-    return variable_table_assign(self, self->variable_table, name, value);
+    atom_t    atom;
+    em_result errres = machine_intern(self, name, &atom);
+    if(errres != EM_RESULT_OK) return errres;
+    self->definitions_changed = true;
+    return variable_dictionary_assign(self, &(self->globals), atom, value);
   }
 
   // ! Match values to the deconstructors.
   /* !
+ * Identifiers in the deconstructors are bound to slots from left to right.
  * \param self The machine
  * \param nt The deconstructor
  * \param length The length of vs
  * \param vs The pointer to the array of objects
+ * \param slots The slots to be bound.(If it is nullptr, they are bound to the global variables.)
  * \return The result
  */
   em_result machine_match(
-    machine_t * self, list_t /*<deconstructor_t>*/ * nt, struct object_t ** vs, int length);
+    machine_t * self, list_t /*<deconstructor_t>*/ * nt, struct object_t ** vs, int length,
+    struct object_t ** slots);
 
   // ! Match value to the deconstructor.
   /* !
+ * Identifiers in the deconstructor are bound to slots from left to right.
  * \param self The machine
  * \param nt The deconstructor
  * \param v The object
+ * \param slots The slots to be bound.(If it is nullptr, they are bound to the global variables.)
  * \return The result
  */
-  em_result machine_matches(machine_t * self, deconstructor_t * deconst, struct object_t * v);
+  em_result machine_matches(
+    machine_t * self, deconstructor_t * deconst, struct object_t * v, struct object_t ** slots);
 
   // ! Test matching values to the deconstructors.
   /* !
@@ -241,7 +368,34 @@ err:
  */
   bool machine_test_matches(machine_t * self, deconstructor_t * deconst, struct object_t * v);
 
-  // ! Lookup a value of the variable.
+  // ! Lookup the global variable.
+  /* !
+ * \param self The machine
+ * \param out The result.(It is never moved.)
+ * \param name The name of the variable.
+ * \return Whether found or not
+ */
+  static inline bool
+  machine_lookup_global_atom(machine_t * self, variable_t ** out, atom_t name)
+  {
+    return variable_dictionary_lookup(&(self->globals), out, name);
+  }
+
+  // ! Lookup the global variable.
+  /* !
+ * \param self The machine
+ * \param out The result.(It is never moved.)
+ * \param name The name of the variable.
+ * \return Whether found or not
+ */
+  static inline bool
+  machine_lookup_global(machine_t * self, variable_t ** out, string_t * name)
+  {
+    atom_t atom;
+    return atom_lookup(&(self->atoms), name, &atom) && machine_lookup_global_atom(self, out, atom);
+  }
+
+  // ! Lookup a value of the global variable or the node.
   /* !
  * \param self The machine
  * \param out The result.
@@ -251,7 +405,11 @@ err:
   static inline bool
   machine_lookup_variable(machine_t * self, struct object_t ** out, string_t * name)
   {
-    if(variable_table_lookup(self->variable_table, out, name)) return true;
+    variable_t * var;
+    if(machine_lookup_global(self, &var, name)) {
+      *out = var->value;
+      return true;
+    }
     node_t * no;
     if(machine_lookup_node(self, &no, name)) {
       *out = no->value;
@@ -270,9 +428,12 @@ err:
 
   // ! Indicate value of the node is changed
   /* !
+ * Only the nodes which depend on the changed nodes are updated.
+ * The nodes set by machine_set_value_of_node and the input nodes(callbacks) are changed nodes.
  * \param self The machine
- * \param name List of names of the changed node.(Nullable)
- * \return The status code
+ * \param names List of names of the changed node.(Nullable)
+ * \param count_names The length of names.
+ * \return The status code(Failed nodes are not reported here. See exec_plan_update_values.)
  */
   em_result machine_indicate(machine_t * self, string_t * names, int count_names);
 
@@ -284,6 +445,40 @@ err:
  */
   em_result machine_set_value_of_node(machine_t * self, string_t * name, struct object_t * val);
 
+  // ! Set value of the node.
+  /* !
+ * \param self The machine
+ * \param node The node to be changed its value.
+ * \param val the object to be set.
+ */
+  em_result machine_set_value_of_node2(machine_t * self, node_t * node, struct object_t * val);
+
+  // ! Set values of the nodes posted to machine_t::inputs.
+  /* !
+ * If a node is posted twice or more, the last one is the value.
+ * \param self The machine
+ * \return The status code
+ */
+  em_result machine_drain_inputs(machine_t * self);
+
+  // ! Set whether the node ignores the value equal to the current one.
+  /* !
+ * \param self The machine
+ * \param name Name of the node.
+ * \param cut_off If it is true, the equal value does not propagate and does not invoke the action.
+ * \return The status code
+ */
+  em_result machine_set_node_cut_off(machine_t * self, string_t * name, bool cut_off);
+
+  // ! Search the exec_sequence_t which updates the node.
+  /* !
+ * \param self The machine
+ * \param out The result
+ * \param name Name of the node
+ * \return Whether found or not
+ */
+  bool machine_lookup_exec_sequence(machine_t * self, exec_sequence_t ** out, string_t * name);
+
   // ! Register the output node
   /* !
  * \param self The machine
@@ -292,11 +487,16 @@ err:
  * \return The status code
  */
   em_result
-  machine_add_output_node(machine_t * self, string_t name, node_event_delegate_t callback);
+  machine_add_output_node(machine_t * self, string_t * name, node_event_delegate_t callback);
 
-  // ! [DEBUG] Print node definitions.
+  // ! [DEBUG] Print node definitions to the current diagnostic message.
   void machine_debug_print_definitions(machine_t * self);
 
+#if EMFRP_ENABLE_PROFILING
+  // ! [DEBUG] Print the counters of exec_sequence_update_value to the current diagnostic message.
+  void machine_debug_print_profile(machine_t * self);
+#endif
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -8,25 +8,39 @@
 #include "ast.h"
 #include "em_result.h"
 #include "vm/object_t.h"
+#include "vm/atom_t.h"
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif /* __cplusplus */
 
+  struct exec_sequence_t;
   typedef void (*node_event_delegate_t)(object_t *);
 
   // ! Node definition struct.
   typedef struct node_t
   {
     // ! Name of node.
-    string_t name;
+    atom_t name;
     // ! Value of node.
     object_t * value;
     // ! Value of node@lst.
     object_t * last;
     // ! The action when the value is changed.
     node_event_delegate_t action;
+    // ! The iteration(machine_t::iteration) when node_t::value is updated.
+    size_t updated_at;
+    // ! The iteration(machine_t::iteration) when node_t::last is updated.
+    size_t last_updated_at;
+    // ! Whether the value equal to the current one is ignored.
+    /* !
+     * If it is true, the equal value does not update the dependent nodes
+     * and does not invoke node_t::action.
+     */
+    bool cut_off;
+    // ! The exec_sequence_t which updates the node.(Nullable)
+    struct exec_sequence_t * definition;
   } node_t;
 
   // ! Construct node_t without any programs.
@@ -36,12 +50,16 @@ extern "C"
  * \return The status code
  */
   static inline em_result
-  node_new(node_t * out, string_t name)
+  node_new(node_t * out, atom_t name)
   {
-    out->name   = name;
-    out->value  = nullptr;
-    out->last   = nullptr;
-    out->action = nullptr;
+    out->name            = name;
+    out->value           = nullptr;
+    out->last            = nullptr;
+    out->action          = nullptr;
+    out->updated_at      = 0;
+    out->last_updated_at = 0;
+    out->cut_off         = false;
+    out->definition      = nullptr;
     return EM_RESULT_OK;
   }
 
@@ -10,7 +10,10 @@
 #include <stdbool.h>
 #include "string_t.h"
 #include "emmem.h"
+#include "emdiag.h"
 #include "vm/program.h"
+#include "vm/bytecode_t.h"
+#include "vm/record_table.h"
 #include "ast.h"
 
 #ifdef __cplusplus
@@ -27,7 +30,8 @@ extern "C"
      xxxxxx...xxx00 -> a pointer (distinguished by object_kind_t.)
      xxxxxx...xxx01 -> integer (immediate)
      xxxxxx...xxx10 -> reserved
-     xxxxxx...xxx11 -> reserved
+     xxxxxx...xxx11 -> tag (immediate, a record without elements)
+   Tuples hold their tags in the upper bits of object_t::kind.(See object_tuple_tag.)
  */
 #if __STD_VERSION__ <= 201710L
   typedef enum object_kind_t
@@ -85,21 +89,18 @@ typedef enum object_kind_t
       struct
       {
         struct object_t * i0;
-        struct object_t * tag;
       } tuple1;
       // ! used on tuple 2.
       struct
       {
         struct object_t * i0;
         struct object_t * i1;
-        struct object_t * tag;
       } tuple2;
       // ! used on tuple N.
       struct
       {
         struct object_t ** data;
         size_t             length;
-        struct object_t *  tag;
       } tupleN;
       // ! used on Function.
       struct
@@ -110,13 +111,14 @@ typedef enum object_kind_t
         {
           // ! Nothing
           nullptr_t nothing;
-          // ! AST
+          // ! Bytecode
           struct
           {
             // ! Closure(kind == EMFRP_OBJECT_VARIABLE_TABLE)
-            struct object_t *            closure;
-            struct parser_expression_t * program;
-          } ast;
+            struct object_t * closure;
+            // ! The compiled body.(Its reference is owned.)
+            bytecode_t * program;
+          } bytecode;
           // ! CallBack
           foreign_func_t callback;
           // ! Record Constructor
@@ -124,16 +126,16 @@ typedef enum object_kind_t
           {
             // ! Arity(length of tuple.)
             size_t arity;
-            // ! The symbol of tag.
-            struct object_t * tag;
+            // ! The tag.
+            record_tag_t tag;
           } construct;
           // ! Record Accessor
           struct
           {
             // ! Index(nth element).
             size_t index;
-            // ! The symbol of tag.
-            struct object_t * tag;
+            // ! The tag.
+            record_tag_t tag;
           } access;
         } function;
       } function;
@@ -158,7 +160,33 @@ typedef enum object_kind_t
   extern object_t object_false;
 #define object_is_pointer(v) (((size_t)v & 3) == 0)
 
-#define object_kind(v) ((v)->kind & (-1 ^ 1))
+// ! Bits of object_t::kind below the tag.
+#define OBJECT_TAG_SHIFT 8
+
+#define object_kind(v) ((v)->kind & ((1 << OBJECT_TAG_SHIFT) - 2))
+
+  // ! Get the tag of the tuple.
+  /* !
+ * \param v The tuple.
+ * \return The tag, or RECORD_TAG_NONE.
+ */
+  static inline record_tag_t
+  object_tuple_tag(object_t * v)
+  {
+    return (record_tag_t)((uint32_t)v->kind >> OBJECT_TAG_SHIFT);
+  }
+
+  // ! Set the tag of the tuple.
+  /* !
+ * \param v The tuple.
+ * \param tag The tag.
+ */
+  static inline void
+  object_set_tuple_tag(object_t * v, record_tag_t tag)
+  {
+    v->kind =
+      (object_kind_t)((v->kind & ((1 << OBJECT_TAG_SHIFT) - 1)) | (tag << OBJECT_TAG_SHIFT));
+  }
 
   // ! Mark the object.
   /* !
@@ -222,6 +250,16 @@ typedef enum object_kind_t
   {
     return ((size_t)v & 3) == 2;
   }
+  // ! Test whether the object is a tag.
+  /* !
+ * \param v The object to be tested.
+ * \return Whether v is a tag.
+ */
+  static inline bool
+  object_is_tag(object_t * v)
+  {
+    return ((size_t)v & 3) == 3;
+  }
   // ! Test whether the object is a boolean value.
   /* !
  * \param v The object to be tested.
@@ -243,7 +281,7 @@ typedef enum object_kind_t
   {
 #if DEBUG
     if(!object_is_integer(v)) {
-      fprintf(stderr, "Error: Invalid objcet type.\n");
+      EM_DIAG_ERROR("Error: Invalid objcet type.\n");
       return -1;
     }
 #endif
@@ -268,6 +306,17 @@ typedef enum object_kind_t
     return EM_RESULT_OK;
   }
 
+  // ! Get the tag from the given object.
+  /* !
+ * \param v The tag object. Must be tested by object_is_tag.
+ * \return The tag.
+ */
+  static inline record_tag_t
+  object_get_tag(object_t * v)
+  {
+    return (record_tag_t)((size_t)v >> 2);
+  }
+
   // ! Freeing the given object.
   /* !
  * \param v The object to be freed.
@@ -278,6 +327,10 @@ typedef enum object_kind_t
     // if(((size_t)v & 3) == 0 && v != nullptr) em_free(v);
   }
 
+  // ! The range of integer objects.(Integers are 30-bit, because of the tag bits.)
+#define OBJECT_INT_MAX ((1 << 29) - 1)
+#define OBJECT_INT_MIN (-(1 << 29))
+
   // DESIGN CONSIDERATION IS REQUIRED!
   // ! Construct the new integer object.
   /* !
@@ -293,6 +346,20 @@ typedef enum object_kind_t
     return EM_RESULT_OK;
   }
 
+  // ! Construct the new tag object.
+  /* !
+ * \param out Output object.
+ * \param tag The tag, which is not RECORD_TAG_NONE.
+ * \return The result.
+ */
+  static inline em_result
+  object_new_tag(object_t ** out, record_tag_t tag)
+  {
+    size_t * ret = (size_t *)out;
+    *ret         = ((size_t)tag << 2) | 3;
+    return EM_RESULT_OK;
+  }
+
   // ! Construct the new tuple1 object.
   /* !
  * \param out The output object **Must be allocated before calling this function.**
@@ -302,9 +369,8 @@ typedef enum object_kind_t
   static inline em_result
   object_new_tuple1(object_t * out, object_t * v)
   {
-    out->kind             = EMFRP_OBJECT_TUPLE1 | (out->kind & 1);
-    out->value.tuple1.i0  = v;
-    out->value.tuple1.tag = nullptr;
+    out->kind            = EMFRP_OBJECT_TUPLE1 | (out->kind & 1);
+    out->value.tuple1.i0 = v;
     return EM_RESULT_OK;
   }
 
@@ -318,10 +384,9 @@ typedef enum object_kind_t
   static inline em_result
   object_new_tuple2(object_t * out, object_t * v0, object_t * v1)
   {
-    out->kind             = EMFRP_OBJECT_TUPLE2 | (out->kind & 1);
-    out->value.tuple2.i0  = v0;
-    out->value.tuple2.i1  = v1;
-    out->value.tuple2.tag = nullptr;
+    out->kind            = EMFRP_OBJECT_TUPLE2 | (out->kind & 1);
+    out->value.tuple2.i0 = v0;
+    out->value.tuple2.i1 = v1;
     return EM_RESULT_OK;
   }
 
@@ -340,7 +405,6 @@ typedef enum object_kind_t
     em_result errres         = EM_RESULT_OK;
     out->kind                = EMFRP_OBJECT_TUPLEN | (out->kind & 1);
     out->value.tupleN.length = size;
-    out->value.tupleN.tag    = nullptr;
     CHKERR(em_allocarray((void **)(&(out->value.tupleN.data)), size, sizeof(object_t *)));
     for(int i = 0; i < size; ++i)
       object_tuple_ith(out, i) = nullptr;
@@ -362,35 +426,30 @@ err:
     return EM_RESULT_OK;
   }
 
-  // ! Construct the new function object(ast).
+  // ! Construct the new function object(bytecode).
   /* !
  * \param out The output object **Must be allocated before calling this function.**
  * \param closure The environment.
- * \param ast The program.
+ * \param program The compiled function. Its reference count is incremented.
  * \return The result.
  */
   static inline em_result
-  object_new_function_ast(object_t * out, object_t * closure, parser_expression_t * ast)
+  object_new_function_bytecode(object_t * out, object_t * closure, bytecode_t * program)
   {
-    if(ast->kind != EXPR_KIND_FUNCTION) {
+    if(program->source == nullptr) {
       DEBUGBREAK;
       return EM_RESULT_INVALID_ARGUMENT;
     }
-    out->kind                                = EMFRP_OBJECT_FUNCTION | (out->kind & 1);
-    out->value.function.function.ast.closure = closure;
-    out->value.function.kind                 = EMFRP_PROGRAM_KIND_AST;
-    out->value.function.function.ast.program = ast;
-    ast->value.function.reference_count++;
+    out->kind                                     = EMFRP_OBJECT_FUNCTION | (out->kind & 1);
+    out->value.function.function.bytecode.closure = closure;
+    out->value.function.kind                      = EMFRP_PROGRAM_KIND_BYTECODE;
+    out->value.function.function.bytecode.program = bytecode_retain(program);
     return EM_RESULT_OK;
   }
 
   static inline em_result
-  object_new_function_constructor(object_t * out, object_t * tag, size_t arity)
+  object_new_function_constructor(object_t * out, record_tag_t tag, size_t arity)
   {
-    if(object_kind(tag) != EMFRP_OBJECT_SYMBOL) {
-      DEBUGBREAK;
-      return EM_RESULT_INVALID_ARGUMENT;
-    }
     out->kind                                    = EMFRP_OBJECT_FUNCTION | (out->kind & 1);
     out->value.function.kind                     = EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT;
     out->value.function.function.construct.arity = arity;
@@ -399,12 +458,8 @@ err:
   }
 
   static inline em_result
-  object_new_function_accessor(object_t * out, object_t * tag, size_t index)
+  object_new_function_accessor(object_t * out, record_tag_t tag, size_t index)
   {
-    if(object_kind(tag) != EMFRP_OBJECT_SYMBOL) {
-      DEBUGBREAK;
-      return EM_RESULT_INVALID_ARGUMENT;
-    }
     out->kind                                 = EMFRP_OBJECT_FUNCTION | (out->kind & 1);
     out->value.function.kind                  = EMFRP_PROGRAM_KIND_RECORD_ACCESS;
     out->value.function.function.access.index = index;
@@ -447,7 +502,7 @@ err:
     return errres;
   }
 
-  // ! Printing the object.
+  // ! Printing the object to the current diagnostic message.(See em_diag_begin.)
   /* !
  * \param v The object to be printed.
  */
@@ -35,7 +35,9 @@ extern "C"
     // ! containing record constructor.
     EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT = 4 << EXEC_SEQUENCE_PROGRAM_KIND_SHIFT,
     // ! containing record accessor.
-    EMFRP_PROGRAM_KIND_RECORD_ACCESS = 5 << EXEC_SEQUENCE_PROGRAM_KIND_SHIFT
+    EMFRP_PROGRAM_KIND_RECORD_ACCESS = 5 << EXEC_SEQUENCE_PROGRAM_KIND_SHIFT,
+    // ! containing compiled bytecode.
+    EMFRP_PROGRAM_KIND_BYTECODE = 6 << EXEC_SEQUENCE_PROGRAM_KIND_SHIFT
   } emfrp_program_kind;
 
 #ifdef __cplusplus
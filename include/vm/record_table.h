@@ -0,0 +1,65 @@
+/** -------------------------------------------
+ * @file   record_table.h
+ * @brief  Table of Record Types
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_result.h"
+#include "string_t.h"
+#include "ast.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  // ! ID of the record type, which is the tag of tuples.
+  /* !
+   * Every distinct name of records has its own ID, so that tags are compared as integers.
+   * The table is shared by all machines, and IDs are never freed.
+   */
+  typedef int32_t record_tag_t;
+
+// ! The tag of tuples which are not records.
+#define RECORD_TAG_NONE 0
+// ! The maximum ID.(It is packed in object_t::kind, see object_tuple_tag.)
+#define RECORD_TAG_MAX ((1 << 23) - 1)
+
+  // ! Get the ID of the record type, registering it if not registered yet.
+  /* !
+   * \param name The name of the record, which is copied if it is not registered yet.
+   * \param out The result
+   * \return The status code
+   */
+  em_result record_table_intern(string_t * name, record_tag_t * out);
+
+  // ! Get the name of the record type.
+  /* !
+   * \param tag The ID, which is not RECORD_TAG_NONE.
+   * \return The name
+   */
+  string_t * record_table_name(record_tag_t tag);
+
+  // ! Get the ID of the tag of the tuple pattern.
+  /* !
+   * The result is cached in the deconstructor.
+   * \param d The tuple pattern
+   * \param out The result, RECORD_TAG_NONE if the pattern has no tag.
+   * \return The status code
+   */
+  static inline em_result
+  record_table_resolve(deconstructor_t * d, record_tag_t * out)
+  {
+    em_result errres = EM_RESULT_OK;
+    if(d->value.tuple.tag != nullptr && d->value.tuple.record == RECORD_TAG_NONE)
+      errres = record_table_intern(d->value.tuple.tag, &(d->value.tuple.record));
+    *out = d->value.tuple.record;
+    return errres;
+  }
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
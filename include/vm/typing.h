@@ -0,0 +1,145 @@
+/** -------------------------------------------
+ * @file   typing.h
+ * @brief  Type Inference
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#pragma once
+#include <stdbool.h>
+#include "em_result.h"
+#include "arena_t.h"
+#include "ast.h"
+#include "collections/arraylist_t.h"
+#include "vm/record_table.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+  struct machine_t;
+  struct type_t;
+  struct variable_dependent_t;
+
+  // ! The state of the type inference.
+  /* !
+   * Types are inferred by unification(Hindley-Milner), when definitions are compiled.
+   * Types of other definitions are inferred again from their ASTs or their values, so that no types
+   * are kept in the machine. Toplevel functions are polymorphic, and others are monomorphic.
+   *
+   * Types never reject what the runtime accepts, except that:
+   * - Branches of `if` and case/of, and operands of `==` and `!=` have the same type.
+   * - The left operand of `||` is Bool, because it is the result if it is not false.
+   * Tuples(and records) of different tags or arities are unified into Any instead of the error,
+   * because they are often mixed. Any is also given to what is not known statically.(e.g. inputs)
+   *
+   * The compiler omits runtime type checks of values whose types are proven.
+   * A value is proven if it is made in the compiled code(e.g. literals and results of operators),
+   * or it is the argument of the function which checks it once at the entry(OPCODE_GUARD_INT).
+   * Values of global variables are also proven, and the code is compiled again when they are
+   * changed.(See variable_t::dependents.) Values of nodes and results of functions(except record
+   * constructors) are never proven, because they may be nil, or functions may be compiled again
+   * without the caller.
+   */
+  typedef struct typing_t
+  {
+    // ! The machine.
+    struct machine_t * machine;
+    // ! Types and bindings.
+    arena_t arena;
+    // ! Types of expressions and arguments of the compiled definition.(typing_entry_t)
+    /* !
+     * It is sorted by the key after typing_infer.
+     */
+    arraylist_t entries;
+    // ! Visible local variables.(typing_binding_t *)
+    arraylist_t scope;
+    // ! The first index of typing_t::scope visible from the current definition.
+    size_t scope_base;
+    // ! Types of other definitions.(typing_memo_t)
+    arraylist_t memos;
+    // ! The expression of the compiled definition.
+    parser_expression_t * root;
+    // ! Are types of the current definition recorded to typing_t::entries?
+    bool recording;
+    // ! The definition which is recorded as the dependent of proven global variables.(Nullable)
+    /* !
+     * It is nullptr if the code is executed only once.(See variable_t::dependents.)
+     */
+    const struct variable_dependent_t * owner;
+    // ! The expression which is ill-typed.(Nullable)
+    parser_expression_t * error_at;
+    // ! The expected type, when it is ill-typed.
+    struct type_t * error_expected;
+    // ! The actual type, when it is ill-typed.
+    struct type_t * error_actual;
+  } typing_t;
+
+  // ! Construct the state of the type inference.
+  /* !
+ * \param out The result
+ * \param m The machine
+ * \param owner The definition to be compiled.(Nullable, if the code is executed only once.)
+ */
+  void
+  typing_new(typing_t * out, struct machine_t * m, const struct variable_dependent_t * owner);
+
+  // ! Infer types of the definition.
+  /* !
+ * \param self The state
+ * \param v The expression, or the function of func.
+ * \return EM_RESULT_TYPE_MISMATCH if it is ill-typed, or the status code.
+ */
+  em_result typing_infer(typing_t * self, parser_expression_t * v);
+
+  // ! Is the value of the expression proven to be an integer?
+  /* !
+ * \param self The state after typing_infer.(Nullable, then nothing is proven.)
+ * \param v The expression
+ * \return The result
+ */
+  bool typing_proves_int(typing_t * self, parser_expression_t * v);
+
+  // ! Is the value of the expression proven to be a function of the arity?
+  /* !
+ * \param self The state after typing_infer.(Nullable, then nothing is proven.)
+ * \param v The expression
+ * \param arity The arity
+ * \return The result
+ */
+  bool typing_proves_function(typing_t * self, parser_expression_t * v, int arity);
+
+  // ! Is the value of the expression proven to be a record which has the field?
+  /* !
+ * \param self The state after typing_infer.(Nullable, then nothing is proven.)
+ * \param v The expression
+ * \param tag The tag of the record
+ * \param index The index of the field
+ * \return The result
+ */
+  bool typing_proves_record(
+    typing_t * self, parser_expression_t * v, record_tag_t tag, size_t index);
+
+  // ! Is the argument of the function checked to be an integer at the entry?(OPCODE_GUARD_INT)
+  /* !
+ * \param self The state after typing_infer.(Nullable, then nothing is checked.)
+ * \param d The argument
+ * \return The result
+ */
+  bool typing_guards_int(typing_t * self, deconstructor_t * d);
+
+  // ! Print the type error to the current diagnostic message.
+  /* !
+ * \param self The state which typing_infer is failed with EM_RESULT_TYPE_MISMATCH.
+ */
+  void typing_print_error(typing_t * self);
+
+  // ! Free the state.
+  /* !
+ * \param self The state
+ */
+  void typing_free(typing_t * self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -6,7 +6,9 @@
  ------------------------------------------- */
 #pragma once
 #include "string_t.h"
+#include "collections/arraylist_t.h"
 #include "collections/dictionary_t.h"
+#include "vm/atom_t.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -17,24 +19,56 @@ extern "C"
   struct dictionary_t;
   struct machine_t;
 
+  // ! A definition whose compiled code depends on values of global variables.
+  /* !
+   * It is identified by the name, so that it is found even if it is redefined.
+   */
+  typedef struct variable_dependent_t
+  {
+    // ! The name of the function, or the first name of the nodes.
+    atom_t name;
+    // ! Is it the node?(Otherwise, it is the function defined by func.)
+    bool node;
+  } variable_dependent_t;
+
   // ! Variable Definition.
   typedef struct variable_t
   {
     // ! Name of the variable.
-    string_t name;
+    atom_t name;
     // ! Value of the variable.
     struct object_t * value;
+    // ! Is it bound by data?(The compiler may inline its value if it is immediate.)
+    bool constant;
+    // ! Is it defined?
+    /* !
+     * It is false if the definition is reverted by machine_load. The variable is kept in the
+     * dictionary, because the compiled code may refer to it.
+     */
+    bool defined;
+    // ! Definitions whose compiled code depends on its value.
+    /* !
+     * e.g. the value is inlined, or its type is proven. If the value is changed, they are moved to
+     * machine_t::outdated, and compiled again.
+     */
+    arraylist_t /*<variable_dependent_t>*/ dependents;
   } variable_t;
 
   // ! The Variable Table.
+  /* !
+   * Local variables are resolved to (depth, slot) by the compiler.
+   * depth is the count of variable_table_t::parent to follow, and slot is the index of slots.
+   */
   typedef struct variable_table_t
   {
     // ! Parent of the variable.
     struct variable_table_t * parent;
     // ! Object Reference to this. (for closure)
     struct object_t * this_object_ref;
-    // ! Table.
-    dictionary_t /*<variable_t>*/ table;
+    // ! Count of slots.
+    size_t length;
+    // ! Slots of local variables.(It is allocated with this.)
+    struct object_t ** slots;
   } variable_table_t;
 
   // ! Construct variable_t.
@@ -44,10 +78,13 @@ extern "C"
  * \return The status code
  */
   static inline em_result
-  variable_new(variable_t * out, string_t name)
+  variable_new(variable_t * out, atom_t name)
   {
-    out->name  = name;
-    out->value = nullptr;
+    out->name     = name;
+    out->value    = nullptr;
+    out->constant = false;
+    out->defined  = true;
+    arraylist_default(&(out->dependents));
     return EM_RESULT_OK;
   }
   // ! Construct variable_table_t.
@@ -55,30 +92,64 @@ extern "C"
  * \param m The machine
  * \param out The result
  * \param parent The parent
+ * \param length Count of slots
  * \return The status code
  */
-  em_result
-  variable_table_new(struct machine_t * m, variable_table_t * out, variable_table_t * parent);
+  em_result variable_table_new(
+    struct machine_t * m, variable_table_t ** out, variable_table_t * parent, size_t length);
 
-  // ! Assign given value to the variable.
+  // ! Assign given value to the global variable.
   /* !
  * \param m The machine
- * \param self The table to search or added.
+ * \param self The dictionary to search or added.
  * \param name The name of the variable to be assigned to.
  * \param value The value to be assigned.
  * \return The status code
  */
-  em_result variable_table_assign(
-    struct machine_t * m, variable_table_t * self, string_t * name, struct object_t * value);
+  em_result variable_dictionary_assign(
+    struct machine_t * m, dictionary_t /*<variable_t>*/ * self, atom_t name,
+    struct object_t * value);
+
+  // ! Copy the global variable, so that it is restored by variable_dictionary_restore.
+  /* !
+ * \param self The dictionary to search.
+ * \param out The result. variable_t::defined is false if it is not defined.
+ * \param name The name of the variable.
+ * \return The status code
+ */
+  em_result
+  variable_dictionary_backup(dictionary_t /*<variable_t>*/ * self, variable_t * out, atom_t name);
+
+  // ! Restore the global variable from variable_dictionary_backup.
+  /* !
+ * The dependents are moved from backup. The caller frees backup by variable_deep_free.
+ * \param m The machine
+ * \param self The dictionary.
+ * \param backup The backup.
+ * \return The status code
+ */
+  em_result variable_dictionary_restore(
+    struct machine_t * m, dictionary_t /*<variable_t>*/ * self, variable_t * backup);
+
+  // ! Add the dependent unless it is in the list.
+  /* !
+ * \param self The list of variable_dependent_t
+ * \param dependent The dependent
+ * \return The status code
+ */
+  em_result variable_dependents_add(
+    arraylist_t /*<variable_dependent_t>*/ * self, const variable_dependent_t * dependent);
 
-  // ! Lookup from the variable table.
+  // ! Lookup the global variable.
   /* !
- * \param self The table to search.
+ * The result is never moved, so that it is referred from the compiled code.
+ * \param self The dictionary to search.
  * \param out The result.
  * \param name The name of the variable to be searched.
  * \return Wether it is found.
  */
-  bool variable_table_lookup(variable_table_t * self, struct object_t ** out, string_t * name);
+  bool variable_dictionary_lookup(
+    dictionary_t /*<variable_t>*/ * self, variable_t ** out, atom_t name);
 
   // ! Freeing Deeply variable_t
   /* !
@@ -0,0 +1,51 @@
+/** -------------------------------------------
+ * @file   arena_t.c
+ * @brief  Arena Allocator
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include "arena_t.h"
+
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof(arena_chunk_t))
+
+em_result
+arena_alloc(arena_t * self, void ** out, size_t size)
+{
+  em_result       errres = EM_RESULT_OK;
+  arena_chunk_t * chunk  = self->chunks;
+  size                   = ARENA_ALIGN(size);
+  if(chunk == nullptr || chunk->capacity - self->used < size) {
+    // The rest of the current chunk is wasted.
+    size_t capacity = size > EMFRP_ARENA_CHUNK_SIZE ? size : EMFRP_ARENA_CHUNK_SIZE;
+    CHKERR(em_malloc((void **)&chunk, ARENA_HEADER_SIZE + capacity));
+    chunk->next     = self->chunks;
+    chunk->capacity = capacity;
+    self->chunks    = chunk;
+    self->used      = 0;
+  }
+  *out = (char *)chunk + ARENA_HEADER_SIZE + self->used;
+  self->used += size;
+err:
+  return errres;
+}
+
+void
+arena_reset(arena_t * self)
+{
+  if(self->chunks == nullptr) return;
+  for(arena_chunk_t * c = self->chunks->next; c != nullptr;) {
+    arena_chunk_t * ne = c->next;
+    em_free(c);
+    c = ne;
+  }
+  self->chunks->next = nullptr;
+  self->used         = 0;
+}
+
+void
+arena_free(arena_t * self)
+{
+  arena_reset(self);
+  em_free(self->chunks);
+  arena_new(self);
+}
@@ -7,169 +7,282 @@
 
 #include "ast.h"
 #include "string_t.h"
-#include <stdio.h>
+#include "emdiag.h"
 
 const char * const binary_op_table[] = {"+",  "-", "/",  "*",  "%", "<<", ">>", "<=", "<",
                                         ">=", ">", "==", "!=", "&", "|",  "^",  "&&", "||"};
 
-void
-deconstructor_free_shallow(deconstructor_t * st)
+// ! The state of parser_toplevel_compact.
+typedef struct compactor_t
 {
-  switch(st->kind) {
-    case DECONSTRUCTOR_IDENTIFIER:
-      break;
-    case DECONSTRUCTOR_TUPLE:
-      if(st->value.tuple.tag != nullptr) {  // ILLEGAL STATE
-        DEBUGBREAK;
-        string_free(st->value.tuple.tag);
-        em_free(st->value.tuple.tag);
-      }
-      for(list_t * li = st->value.tuple.data; li != nullptr;) {
-        deconstructor_free_shallow((deconstructor_t *)(&(li->value)));
-        list_t * ne = LIST_NEXT(li);
-        free(li);
-        li = ne;
-      }
-      break;
-    default:
-      break;
+  // ! The next position in the block, or nullptr while the size is measured.
+  char * position;
+  // ! The size of the block.
+  size_t size;
+  // ! The copied definition.(parser_expression_t::value::function::owner)
+  parser_toplevel_t * owner;
+  // ! Items are written here while the size is measured.
+  union
+  {
+    parser_toplevel_t              toplevel;
+    parser_node_t                  node;
+    parser_func_t                  func;
+    parser_data_t                  data;
+    parser_record_t                record;
+    parser_expression_t            expression;
+    parser_expression_tuple_list_t tuple;
+    parser_branch_list_t           branch;
+    deconstructor_t                deconstructor;
+    string_t                       string;
+    struct
+    {
+      list_t *        next;
+      deconstructor_t value;
+    } deconstructor_list;
+    struct
+    {
+      list_t * next;
+      string_t value;
+    } string_list;
+  } scratch;
+} compactor_t;
+
+// ! Allocate from the block. Copying functions must not read the allocated item.
+static void *
+compact_alloc(compactor_t * c, size_t size)
+{
+  void * ret = &(c->scratch);
+  size       = ARENA_ALIGN(size);
+  c->size += size;
+  if(c->position != nullptr) {
+    ret = c->position;
+    c->position += size;
   }
+  return ret;
 }
 
-void
-deconstructor_free_deep(deconstructor_t * st)
+static void
+compact_chars(compactor_t * c, string_t * dst, const string_t * src)
 {
-  switch(st->kind) {
-    case DECONSTRUCTOR_IDENTIFIER:
-      string_free(st->value.identifier);
-      em_free(st->value.identifier);
-      break;
-    case DECONSTRUCTOR_TUPLE:
-      if(st->value.tuple.tag != nullptr) {
-        string_free(st->value.tuple.tag);
-        em_free(st->value.tuple.tag);
-      }
-      for(list_t * li = st->value.tuple.data; li != nullptr;) {
-        deconstructor_free_deep((deconstructor_t *)(&(li->value)));
-        list_t * ne = LIST_NEXT(li);
-        free(li);
-        li = ne;
-      }
-      break;
-    default:
-      break;
+  size_t size = (src->length + 1) * sizeof(char_t);
+  dst->length = src->length;
+  if(c->position == nullptr) {  // The buffer may be larger than the scratch.
+    c->size += ARENA_ALIGN(size);
+    return;
   }
+  dst->buffer = compact_alloc(c, size);
+  memcpy(dst->buffer, src->buffer, size);
 }
 
-void
-parser_toplevel_free_shallow(parser_toplevel_t * pt)
+static string_t *
+compact_string(compactor_t * c, const string_t * src)
 {
-  switch(pt->kind) {
-    case PARSER_TOPLEVEL_KIND_NODE:
-      parser_node_free_shallow(pt->value.node);
-      break;
-    case PARSER_TOPLEVEL_KIND_DATA:
-      parser_data_free_deep(pt->value.data);
-      break;
-    case PARSER_TOPLEVEL_KIND_FUNC:
-      parser_func_free_shallow(pt->value.func);
-      break;
-    case PARSER_TOPLEVEL_KIND_EXPR:
-      parser_expression_free(pt->value.expression);
-      break;
-    case PARSER_TOPLEVEL_KIND_RECORD:
-      parser_record_free_deep(pt->value.record);
-      break;
+  string_t * ret;
+  if(src == nullptr) return nullptr;
+  ret = compact_alloc(c, sizeof(string_t));
+  compact_chars(c, ret, src);
+  return ret;
+}
+
+static void compact_deconstructor(compactor_t * c, deconstructor_t * dst, deconstructor_t * src);
+
+static list_t /*<deconstructor_t>*/ *
+compact_deconstructor_list(compactor_t * c, list_t /*<deconstructor_t>*/ * src)
+{
+  list_t *  ret  = nullptr;
+  list_t ** last = &ret;
+  for(; src != nullptr; src = LIST_NEXT(src)) {
+    list_t * li = compact_alloc(c, sizeof(list_t *) + sizeof(deconstructor_t));
+    *last       = li;
+    li->next    = nullptr;
+    last        = &(li->next);
+    compact_deconstructor(c, (deconstructor_t *)&(li->value), (deconstructor_t *)&(src->value));
   }
-  em_free(pt);
+  return ret;
 }
 
-void
-parser_toplevel_free_deep(parser_toplevel_t * pt)
+static void
+compact_deconstructor(compactor_t * c, deconstructor_t * dst, deconstructor_t * src)
 {
-  switch(pt->kind) {
-    case PARSER_TOPLEVEL_KIND_NODE:
-      parser_node_free_deep(pt->value.node);
-      break;
-    case PARSER_TOPLEVEL_KIND_DATA:
-      parser_data_free_deep(pt->value.data);
-      break;
-    case PARSER_TOPLEVEL_KIND_FUNC:
-      parser_func_free_deep(pt->value.func);
+  *dst = *src;
+  switch(src->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      dst->value.identifier = compact_string(c, src->value.identifier);
       break;
-    case PARSER_TOPLEVEL_KIND_EXPR:
-      parser_expression_free(pt->value.expression);
+    case DECONSTRUCTOR_TUPLE:
+      dst->value.tuple.tag  = compact_string(c, src->value.tuple.tag);
+      dst->value.tuple.data = compact_deconstructor_list(c, src->value.tuple.data);
       break;
-    case PARSER_TOPLEVEL_KIND_RECORD:
-      parser_record_free_deep(pt->value.record);
+    default:
       break;
   }
-  em_free(pt);
 }
 
-void
-parser_func_free_shallow(parser_func_t * pf)
+static deconstructor_t *
+compact_deconstructor_new(compactor_t * c, deconstructor_t * src)
 {
-  string_free(pf->name);
-  em_free(pf);
+  deconstructor_t * ret;
+  if(src == nullptr) return nullptr;
+  ret = compact_alloc(c, sizeof(deconstructor_t));
+  compact_deconstructor(c, ret, src);
+  return ret;
 }
 
-void
-parser_func_free_deep(parser_func_t * pf)
+static parser_expression_t * compact_expression(compactor_t * c, parser_expression_t * src);
+
+static void
+compact_tuple_list(
+  compactor_t * c, parser_expression_tuple_list_t * dst, parser_expression_tuple_list_t * src)
 {
-  string_free(pf->name);
-  em_free(pf->name);
-  if(pf->arguments != nullptr) {
-    deconstructor_t dt = {
-      DECONSTRUCTOR_TUPLE, .value.tuple.tag = nullptr, .value.tuple.data = pf->arguments};
-    deconstructor_free_deep(&dt);
+  dst->value = compact_expression(c, src->value);
+  dst->next  = nullptr;
+  for(parser_expression_tuple_list_t ** last = &(dst->next); src->next != nullptr;) {
+    parser_expression_tuple_list_t * tl = compact_alloc(c, sizeof(parser_expression_tuple_list_t));
+    src                                 = src->next;
+    *last                               = tl;
+    tl->value                           = compact_expression(c, src->value);
+    tl->next                            = nullptr;
+    last                                = &(tl->next);
   }
-  parser_expression_free(pf->expression);
-  em_free(pf);
 }
 
-void
-parser_data_free_deep(parser_data_t * pd)
+static parser_branch_list_t *
+compact_branch_list(compactor_t * c, parser_branch_list_t * src)
 {
-  deconstructor_free_deep(&(pd->name));
-  parser_expression_free(pd->expression);
-  em_free(pd);
+  parser_branch_list_t *  ret  = nullptr;
+  parser_branch_list_t ** last = &ret;
+  for(; src != nullptr; src = src->next) {
+    parser_branch_list_t * bl = compact_alloc(c, sizeof(parser_branch_list_t));
+    *last                     = bl;
+    bl->deconstruct           = compact_deconstructor_new(c, src->deconstruct);
+    bl->body                  = compact_expression(c, src->body);
+    bl->next                  = nullptr;
+    last                      = &(bl->next);
+  }
+  return ret;
 }
 
-void
-parser_record_free_deep(parser_record_t * pr)
+static parser_expression_t *
+compact_expression(compactor_t * c, parser_expression_t * src)
+{
+  parser_expression_t * ret;
+  if(!EXPR_IS_POINTER(src) || src == nullptr) return src;  // Immediate values.
+  ret  = compact_alloc(c, sizeof(parser_expression_t));
+  *ret = *src;
+  switch(src->kind) {
+    case EXPR_KIND_IDENTIFIER:
+    case EXPR_KIND_LAST_IDENTIFIER:
+      compact_chars(c, &(ret->value.identifier), &(src->value.identifier));
+      break;
+    case EXPR_KIND_IF:
+      ret->value.ifthenelse.cond      = compact_expression(c, src->value.ifthenelse.cond);
+      ret->value.ifthenelse.then      = compact_expression(c, src->value.ifthenelse.then);
+      ret->value.ifthenelse.otherwise = compact_expression(c, src->value.ifthenelse.otherwise);
+      break;
+    case EXPR_KIND_CASE:
+      ret->value.caseof.of       = compact_expression(c, src->value.caseof.of);
+      ret->value.caseof.branches = compact_branch_list(c, src->value.caseof.branches);
+      break;
+    case EXPR_KIND_BEGIN:
+      ret->value.begin.branches = compact_branch_list(c, src->value.begin.branches);
+      break;
+    case EXPR_KIND_TUPLE:
+      compact_tuple_list(c, &(ret->value.tuple), &(src->value.tuple));
+      break;
+    case EXPR_KIND_FUNCCALL:
+      ret->value.funccall.callee = compact_expression(c, src->value.funccall.callee);
+      compact_tuple_list(c, &(ret->value.funccall.arguments), &(src->value.funccall.arguments));
+      break;
+    case EXPR_KIND_FUNCTION:
+      ret->value.function.owner     = c->owner;
+      ret->value.function.arguments = compact_deconstructor_list(c, src->value.function.arguments);
+      ret->value.function.body      = compact_expression(c, src->value.function.body);
+      break;
+    default:
+      if(EXPR_KIND_IS_BIN_OP(src)) {
+        ret->value.binary.lhs = compact_expression(c, src->value.binary.lhs);
+        ret->value.binary.rhs = compact_expression(c, src->value.binary.rhs);
+      }
+      break;
+  }
+  return ret;
+}
+
+static parser_toplevel_t *
+compact_toplevel(compactor_t * c, parser_toplevel_t * src)
 {
-  string_free(&(pr->name));
-  list_t /*<string_t>*/ * li = pr->accessors;
-  while(li != nullptr) {
-    list_t *   ne = LIST_NEXT(li);
-    string_t * v  = (string_t *)(&(li->value));
-    string_free(v);
-    em_free(li);
-    li = ne;
+  parser_toplevel_t * ret = compact_alloc(c, sizeof(parser_toplevel_t));
+  ret->reference_count    = 1;
+  ret->kind               = src->kind;
+  switch(src->kind) {
+    case PARSER_TOPLEVEL_KIND_NODE: {
+      parser_node_t * s = src->value.node;
+      parser_node_t * n = compact_alloc(c, sizeof(parser_node_t));
+      ret->value.node   = n;
+      compact_deconstructor(c, &(n->name), &(s->name));
+      n->expression      = compact_expression(c, s->expression);
+      n->init_expression = compact_expression(c, s->init_expression);
+      n->as              = compact_string(c, s->as);
+      break;
+    }
+    case PARSER_TOPLEVEL_KIND_FUNC: {
+      parser_func_t * s = src->value.func;
+      parser_func_t * f = compact_alloc(c, sizeof(parser_func_t));
+      ret->value.func   = f;
+      f->name           = compact_string(c, s->name);
+      f->function       = compact_expression(c, s->function);
+      break;
+    }
+    case PARSER_TOPLEVEL_KIND_DATA: {
+      parser_data_t * s = src->value.data;
+      parser_data_t * d = compact_alloc(c, sizeof(parser_data_t));
+      ret->value.data   = d;
+      compact_deconstructor(c, &(d->name), &(s->name));
+      d->expression = compact_expression(c, s->expression);
+      break;
+    }
+    case PARSER_TOPLEVEL_KIND_EXPR:
+      ret->value.expression = compact_expression(c, src->value.expression);
+      break;
+    case PARSER_TOPLEVEL_KIND_RECORD: {
+      parser_record_t * s    = src->value.record;
+      parser_record_t * r    = compact_alloc(c, sizeof(parser_record_t));
+      list_t **         last = &(r->accessors);
+      ret->value.record      = r;
+      compact_chars(c, &(r->name), &(s->name));
+      for(list_t * li = s->accessors; li != nullptr; li = LIST_NEXT(li)) {
+        list_t * nl = compact_alloc(c, sizeof(list_t *) + sizeof(string_t));
+        *last       = nl;
+        last        = &(nl->next);
+        compact_chars(c, (string_t *)&(nl->value), (string_t *)&(li->value));
+      }
+      *last = nullptr;
+      break;
+    }
   }
-  em_free(pr);
+  return ret;
 }
 
-void
-parser_node_free_shallow(parser_node_t * pn)
+parser_toplevel_t *
+parser_toplevel_compact(parser_toplevel_t * pt)
 {
-  deconstructor_free_shallow(&(pn->name));
-  parser_expression_free(pn->init_expression);
-  em_free(pn);
+  compactor_t c = {.position = nullptr, .size = 0, .owner = nullptr};
+  char *      block;
+  if(pt == nullptr) return nullptr;
+  compact_toplevel(&c, pt);  // Measure the size.
+  if(em_malloc((void **)&block, c.size)) return nullptr;
+  c.position = block;
+  c.owner    = (parser_toplevel_t *)block;
+  return compact_toplevel(&c, pt);
 }
 
 void
-parser_node_free_deep(parser_node_t * pn)
+parser_toplevel_release(parser_toplevel_t * pt)
 {
-  deconstructor_free_deep(&(pn->name));
-  if(pn->as != nullptr) {
-    string_free(pn->as);
-    em_free(pn->as);
-  }
-  parser_expression_free(pn->expression);
-  if(pn->init_expression != nullptr) parser_expression_free(pn->init_expression);
-  em_free(pn);
+  if(pt == nullptr) return;
+  pt->reference_count--;
+  if(pt->reference_count > 0) return;
+  em_free(pt);
 }
 
 void go_deconstructor_list_print(list_t /*<deconstructor_t>*/ * li);
@@ -179,24 +292,24 @@ go_deconstructor_print(deconstructor_t * dt)
 {
   switch(dt->kind) {
     case DECONSTRUCTOR_ANY:
-      fputs("_", stdout);
+      em_diag_puts("_");
       break;
     case DECONSTRUCTOR_IDENTIFIER:
-      fputs(dt->value.identifier->buffer, stdout);
+      em_diag_puts(dt->value.identifier->buffer);
       break;
     case DECONSTRUCTOR_TUPLE:
       if(dt->value.tuple.tag != nullptr) {
-        fputs(dt->value.tuple.tag->buffer, stdout);
-        fputs(" ", stdout);
+        em_diag_puts(dt->value.tuple.tag->buffer);
+        em_diag_puts(" ");
       }
       go_deconstructor_list_print(dt->value.tuple.data);
       break;
     case DECONSTRUCTOR_INTEGER:
-      printf("%d", dt->value.integer);
+      em_diag_print_int(dt->value.integer);
       break;
 #if EMFRP_ENABLE_FLOATING
     case DECONSTRUCTOR_FLOATING:
-      printf("%lf", dt->value.floating);
+      em_diag_printf("%lf", dt->value.floating);
       break;
 #endif
     default:
@@ -209,13 +322,13 @@ void
 go_deconstructor_list_print(list_t /*<deconstructor_t>*/ * li)
 {
   if(li == nullptr) return;
-  fputs("(", stdout);
+  em_diag_puts("(");
   go_deconstructor_print((deconstructor_t *)(&(li->value)));
   for(li = LIST_NEXT(li); li != nullptr; li = LIST_NEXT(li)) {
-    fputs(", ", stdout);
+    em_diag_puts(", ");
     go_deconstructor_print((deconstructor_t *)(&(li->value)));
   }
-  fputs(")", stdout);
+  em_diag_puts(")");
 }
 
 void
@@ -246,249 +359,170 @@ parser_toplevel_print(parser_toplevel_t * t)
 void
 parser_node_print(parser_node_t * n)
 {
-  fputs("node ", stdout);
+  em_diag_puts("node ");
   go_deconstructor_print(&(n->name));
   if(n->init_expression != nullptr) {
-    fputs(" init[", stdout);
+    em_diag_puts(" init[");
     parser_expression_print(n->init_expression);
-    fputs("]", stdout);
+    em_diag_puts("]");
   }
   if(n->as != nullptr) {
-    fputs(" as ", stdout);
-    fputs(n->as->buffer, stdout);
+    em_diag_puts(" as ");
+    em_diag_puts(n->as->buffer);
   }
-  fputs(" = ", stdout);
+  em_diag_puts(" = ");
   parser_expression_print(n->expression);
-  fputs("\n", stdout);
+  em_diag_puts("\n");
 }
 
 void
 parser_data_print(parser_data_t * d)
 {
-  fputs("data ", stdout);
+  em_diag_puts("data ");
   go_deconstructor_print(&(d->name));
-  fputs(" = ", stdout);
+  em_diag_puts(" = ");
   parser_expression_print(d->expression);
 }
 
 void
 parser_function_print(parser_func_t * f)
 {
-  fputs("func ", stdout);
-  fputs(f->name->buffer, stdout);
-  go_deconstructor_list_print(f->arguments);
-  fputs(" = ", stdout);
-  parser_expression_print(f->expression);
+  em_diag_puts("func ");
+  em_diag_puts(f->name->buffer);
+  go_deconstructor_list_print(f->function->value.function.arguments);
+  em_diag_puts(" = ");
+  parser_expression_print(f->function->value.function.body);
 }
 
 void
 parser_record_print(parser_record_t * r)
 {
-  fputs("record ", stdout);
-  fputs(r->name.buffer, stdout);
-  fputs("(", stdout);
+  em_diag_puts("record ");
+  em_diag_puts(r->name.buffer);
+  em_diag_puts("(");
   for(list_t /*<string_t>*/ * li = r->accessors; li != nullptr; li = LIST_NEXT(li)) {
     string_t * v = (string_t *)(&(li->value));
-    fputs(v->buffer, stdout);
-    if(LIST_NEXT(li) != nullptr) fputs(", ", stdout);
+    em_diag_puts(v->buffer);
+    if(LIST_NEXT(li) != nullptr) em_diag_puts(", ");
   }
-  fputs(")", stdout);
+  em_diag_puts(")");
 }
 
 void
 parser_expression_print(parser_expression_t * e)
 {
-  if(EXPR_KIND_IS_INTEGER(e)) printf("%d", ((int)(size_t)e) >> 2);
+  if(EXPR_KIND_IS_INTEGER(e)) em_diag_print_int(((int)(size_t)e) >> 2);
 #if EMFRP_ENABLE_FLOATING
   else if(EXPR_KIND_IS_FLOAT(e))
-    printf("%f", uninline_float(e));
+    em_diag_printf("%f", uninline_float(e));
 #endif
   else if(EXPR_KIND_IS_BOOLEAN(e))
-    fputs(EXPR_IS_TRUE(e) ? "True" : "False", stdout);
+    em_diag_puts(EXPR_IS_TRUE(e) ? "True" : "False");
   else if(e == nullptr)
-    fputs("NIL", stdout);
+    em_diag_puts("NIL");
   else {
     switch(e->kind) {
       case EXPR_KIND_FLOATING:
-        printf("%f", e->value.floating);
+        em_diag_printf("%f", e->value.floating);
         break;
       case EXPR_KIND_IDENTIFIER:
-        printf("%s", e->value.identifier.buffer);
+        em_diag_puts(e->value.identifier.buffer);
         break;
       case EXPR_KIND_LAST_IDENTIFIER:
-        printf("%s@last", e->value.identifier.buffer);
+        em_diag_puts(e->value.identifier.buffer);
+        em_diag_puts("@last");
         break;
       case EXPR_KIND_IF:
-        fputs("if ", stdout);
+        em_diag_puts("if ");
         parser_expression_print(e->value.ifthenelse.cond);
-        fputs(" then ", stdout);
+        em_diag_puts(" then ");
         parser_expression_print(e->value.ifthenelse.then);
-        fputs(" else ", stdout);
+        em_diag_puts(" else ");
         parser_expression_print(e->value.ifthenelse.otherwise);
         break;
       case EXPR_KIND_CASE:
         parser_expression_print(e->value.caseof.of);
-        fputs(": ", stdout);
+        em_diag_puts(": ");
         {
           parser_branch_list_t * bl = e->value.caseof.branches;
           if(bl == nullptr) break;
           go_deconstructor_print(bl->deconstruct);
-          fputs(" -> ", stdout);
+          em_diag_puts(" -> ");
           parser_expression_print(bl->body);
           bl = bl->next;
           for(; bl != nullptr; bl = bl->next) {
-            fputs(", ", stdout);
+            em_diag_puts(", ");
             go_deconstructor_print(bl->deconstruct);
-            fputs(" -> ", stdout);
+            em_diag_puts(" -> ");
             parser_expression_print(bl->body);
           }
           break;
         }
       case EXPR_KIND_BEGIN:
-        printf(" { ");
+        em_diag_puts(" { ");
         {
           parser_branch_list_t * bl = e->value.begin.branches;
           if(bl == nullptr) break;
           if(bl->deconstruct != nullptr) {
             go_deconstructor_print(bl->deconstruct);
-            printf(" <- ");
+            em_diag_puts(" <- ");
           }
           parser_expression_print(bl->body);
           bl = bl->next;
           for(; bl != nullptr; bl = bl->next) {
-            fputs("; ", stdout);
+            em_diag_puts("; ");
             if(bl->deconstruct != nullptr) {
               go_deconstructor_print(bl->deconstruct);
-              fputs(" <- ", stdout);
+              em_diag_puts(" <- ");
             }
             parser_expression_print(bl->body);
           }
-          fputs(" } ", stdout);
+          em_diag_puts(" } ");
           break;
         }
       case EXPR_KIND_TUPLE:
-        fputs("(", stdout);
+        em_diag_puts("(");
         for(parser_expression_tuple_list_t * tl = &(e->value.tuple); tl != nullptr; tl = tl->next) {
           parser_expression_print(tl->value);
-          if(tl->next != nullptr) fputs(", ", stdout);
+          if(tl->next != nullptr) em_diag_puts(", ");
         }
-        fputs(")", stdout);
+        em_diag_puts(")");
         break;
       case EXPR_KIND_FUNCCALL:
-        fputs("(", stdout);
+        em_diag_puts("(");
         parser_expression_print(e->value.funccall.callee);
-        fputs(")", stdout);
+        em_diag_puts(")");
         {
-          fputs("(", stdout);
+          em_diag_puts("(");
           parser_expression_tuple_list_t * tl = &(e->value.funccall.arguments);
           if(tl->value != nullptr)
             for(; tl != nullptr; tl = tl->next) {
               parser_expression_print(tl->value);
-              if(tl->next != nullptr) fputs(", ", stdout);
+              if(tl->next != nullptr) em_diag_puts(", ");
             }
-          fputs(")", stdout);
+          em_diag_puts(")");
         }
         break;
       case EXPR_KIND_FUNCTION: {
-        fputs("(fun", stdout);
+        em_diag_puts("(fun");
         go_deconstructor_list_print(e->value.function.arguments);
-        fputs(" -> (", stdout);
+        em_diag_puts(" -> (");
         parser_expression_print(e->value.function.body);
-        fputs("))", stdout);
+        em_diag_puts("))");
         break;
       }
       default:
         if(EXPR_KIND_IS_BIN_OP(e)) {
-          fputs("(", stdout);
+          em_diag_puts("(");
           parser_expression_print(e->value.binary.lhs);
-          fputs(" ", stdout);
-          fputs(binary_op_table[e->kind >> PARSER_EXPRESSION_KIND_SHIFT], stdout);
-          fputs(" ", stdout);
+          em_diag_puts(" ");
+          em_diag_puts(binary_op_table[e->kind >> PARSER_EXPRESSION_KIND_SHIFT]);
+          em_diag_puts(" ");
           parser_expression_print(e->value.binary.rhs);
-          fputs(")", stdout);
+          em_diag_puts(")");
           break;
         } else
           DEBUGBREAK;
     }
   }
 }
-
-void
-parser_expression_free(parser_expression_t * expr)
-{
-  if(!EXPR_IS_POINTER(expr)) return;  // It is not pointer.
-  if(expr == nullptr) return;
-  switch(expr->kind) {
-    case EXPR_KIND_IDENTIFIER:
-    case EXPR_KIND_LAST_IDENTIFIER:
-      string_free(&(expr->value.identifier));
-      break;
-    case EXPR_KIND_IF:
-      parser_expression_free(expr->value.ifthenelse.cond);
-      parser_expression_free(expr->value.ifthenelse.then);
-      parser_expression_free(expr->value.ifthenelse.otherwise);
-      break;
-    case EXPR_KIND_CASE:
-      parser_expression_free(expr->value.caseof.of);
-      for(parser_branch_list_t * bl = expr->value.caseof.branches; bl != nullptr;) {
-        deconstructor_free_deep(bl->deconstruct);
-        parser_expression_free(bl->body);
-        parser_branch_list_t * prev = bl;
-        bl                          = bl->next;
-        em_free(prev);
-      }
-      break;
-    case EXPR_KIND_BEGIN:
-      for(parser_branch_list_t * bl = expr->value.begin.branches; bl != nullptr;) {
-        if(bl->deconstruct != nullptr) deconstructor_free_deep(bl->deconstruct);
-        parser_expression_free(bl->body);
-        parser_branch_list_t * prev = bl;
-        bl                          = bl->next;
-        em_free(prev);
-      }
-      break;
-    case EXPR_KIND_TUPLE: {
-      parser_expression_tuple_list_t * tl = &expr->value.tuple;
-      parser_expression_free(tl->value);
-      tl = tl->next;
-      while(tl != nullptr) {
-        parser_expression_tuple_list_t * v = tl->next;
-        parser_expression_free(tl->value);
-        free(tl);
-        tl = v;
-      }
-      break;
-    }
-    case EXPR_KIND_FUNCCALL: {
-      parser_expression_tuple_list_t * tl = &expr->value.funccall.arguments;
-      tl                                  = tl->next;
-      while(tl != nullptr) {
-        parser_expression_tuple_list_t * v = tl->next;
-        parser_expression_free(tl->value);
-        free(tl);
-        tl = v;
-      }
-      parser_expression_free(expr->value.funccall.callee);
-      break;
-    }
-    case EXPR_KIND_FUNCTION: {
-      deconstructor_t dt = {
-        DECONSTRUCTOR_TUPLE, .value.tuple.tag = nullptr,
-        .value.tuple.data = expr->value.function.arguments};
-      expr->value.function.reference_count--;
-      if(expr->value.function.reference_count > 0) return;
-      parser_expression_free(expr->value.function.body);
-
-      deconstructor_free_deep(&dt);
-      em_free(expr->value.function.arguments);
-      break;
-    }
-    default:
-      if(EXPR_KIND_IS_BIN_OP(expr)) {
-        parser_expression_free(expr->value.binary.lhs);
-        parser_expression_free(expr->value.binary.rhs);
-      } else
-        DEBUGBREAK;
-  }
-  free(expr);
-}
@@ -5,6 +5,7 @@
  * @date   2023/1/10
  ------------------------------------------- */
 #include "collections/arraylist_t.h"
+#include "emdiag.h"
 
 void
 arraylist_default(arraylist_t * out)
@@ -103,7 +104,7 @@ arraylist_get(arraylist_t * self, void * out, size_t index, size_t item_size)
 {
 #if DEBUG
   if(self->length <= index || index < 0) {
-    fprintf(stderr, "Out of Index(arraylist).");
+    EM_DIAG_ERROR("Out of Index(arraylist).\n");
     DEBUGBREAK;
   }
 #endif
@@ -115,7 +116,7 @@ arraylist_set(arraylist_t * self, size_t index, size_t item_size, void * value)
 {
 #if DEBUG
   if(self->length <= index || index < 0) {
-    fprintf(stderr, "Out of Index(arraylist).");
+    EM_DIAG_ERROR("Out of Index(arraylist).\n");
     DEBUGBREAK;
   }
 #endif
@@ -6,12 +6,61 @@
  ------------------------------------------- */
 #include "collections/dictionary_t.h"
 
+#if EMFRP_SMALL_DICTIONARY
+#define DICTIONARY_ENTRY_HASH(e, hasher) hasher((e)->value)
+#define DICTIONARY_ENTRY_MAY_EQUAL(e, h) true
+#define DICTIONARY_ENTRY_SET_HASH(e, h)
+#else
+#define DICTIONARY_ENTRY_HASH(e, hasher) ((e)->hash)
+#define DICTIONARY_ENTRY_MAY_EQUAL(e, h) ((e)->hash == (h))
+#define DICTIONARY_ENTRY_SET_HASH(e, h)  ((e)->hash = (h))
+#endif
+
 em_result
 dictionary_new(dictionary_t * out)
 {
-  em_result errres;
-  for(int i = 0; i < DICTIONARY_TABLE_SIZE; ++i)
-    CHKERR(list_default(&(out->values[i])));
+  out->entries  = nullptr;
+  out->capacity = 0;
+  out->length   = 0;
+  return EM_RESULT_OK;
+}
+
+// ! Find the entry of search_value, or the empty entry where it should be placed.
+dictionary_entry_t *
+dictionary_find(
+  dictionary_t * self, size_t hash, bool(comparer(void *, void *)), void * search_value)
+{
+  if(self->capacity == 0) return nullptr;
+  size_t mask = self->capacity - 1;
+  // The table always has an empty entry, so it terminates.
+  for(size_t i = hash & mask;; i = (i + 1) & mask) {
+    dictionary_entry_t * e = &(self->entries[i]);
+    if(e->value == nullptr) return e;
+    if(DICTIONARY_ENTRY_MAY_EQUAL(e, hash) && comparer(e->value, search_value)) return e;
+  }
+}
+
+em_result
+dictionary_grow(dictionary_t * self, size_t(hasher(void *)))
+{
+  em_result            errres;
+  size_t               new_capacity = DICTIONARY_INITIAL_CAPACITY;
+  dictionary_entry_t * new_entries  = nullptr;
+  if(self->capacity != 0) new_capacity = self->capacity * 2;
+  CHKERR(em_allocarray((void **)&new_entries, new_capacity, sizeof(dictionary_entry_t)));
+  for(size_t i = 0; i < new_capacity; ++i)
+    new_entries[i].value = nullptr;
+  for(size_t i = 0; i < self->capacity; ++i) {
+    dictionary_entry_t * e = &(self->entries[i]);
+    if(e->value == nullptr) continue;
+    size_t j = DICTIONARY_ENTRY_HASH(e, hasher) & (new_capacity - 1);
+    while(new_entries[j].value != nullptr)
+      j = (j + 1) & (new_capacity - 1);
+    new_entries[j] = *e;
+  }
+  em_free(self->entries);
+  self->entries  = new_entries;
+  self->capacity = new_capacity;
   return EM_RESULT_OK;
 err:
   return errres;
@@ -22,19 +71,8 @@ dictionary_add(
   dictionary_t * out, void * value, size_t value_size, size_t(hasher(void *)),
   bool(comparer(void *, void *)), void(replacer(void *, void *)), void * replacer_arg)
 {
-  em_result errres;
-  size_t    hashed = hasher(value) % DICTIONARY_TABLE_SIZE;
-  void *    overwrite;
-  if(list_search(out->values[hashed], &overwrite, comparer, value)) {
-    if(replacer != nullptr)
-      replacer(overwrite, replacer_arg);
-    else
-      memcpy(overwrite, value, value_size);
-  } else
-    CHKERR(list_add(&(out->values[hashed]), value_size, value));
-  return EM_RESULT_OK;
-err:
-  return errres;
+  void * _;
+  return dictionary_add2(out, value, value_size, hasher, comparer, replacer, replacer_arg, &_);
 }
 
 em_result
@@ -43,17 +81,28 @@ dictionary_add2(
   bool(comparer(void *, void *)), void(replacer(void *, void *)), void * replacer_arg,
   void ** entry_ptr)
 {
-  em_result errres;
-  size_t    hashed = hasher(value) % DICTIONARY_TABLE_SIZE;
-  void *    overwrite;
-  if(list_search(out->values[hashed], &overwrite, comparer, value)) {
+  em_result            errres;
+  size_t               hashed = hasher(value);
+  dictionary_entry_t * e      = dictionary_find(out, hashed, comparer, value);
+  void *               copied = nullptr;
+  if(e != nullptr && e->value != nullptr) {
     if(replacer != nullptr)
-      replacer(overwrite, replacer_arg);
+      replacer(e->value, replacer_arg);
     else
-      memcpy(overwrite, value, value_size);
-    *entry_ptr = overwrite;
-  } else
-    CHKERR(list_add3(&(out->values[hashed]), value_size, value, entry_ptr));
+      memcpy(e->value, value, value_size);
+    *entry_ptr = e->value;
+    return EM_RESULT_OK;
+  }
+  if(DICTIONARY_IS_OVERLOADED(out->length + 1, out->capacity)) {
+    CHKERR(dictionary_grow(out, hasher));
+    e = dictionary_find(out, hashed, comparer, value);
+  }
+  CHKERR(em_malloc(&copied, value_size));
+  memcpy(copied, value, value_size);
+  e->value = copied;
+  DICTIONARY_ENTRY_SET_HASH(e, hashed);
+  out->length++;
+  *entry_ptr = copied;
   return EM_RESULT_OK;
 err:
   return errres;
@@ -64,14 +113,16 @@ dictionary_get(
   dictionary_t * self, void ** out, size_t(hasher(void *)), bool(comparer(void *, void *)),
   void * search_value)
 {
-  size_t hashed = hasher(search_value) % DICTIONARY_TABLE_SIZE;
-  return list_search(self->values[hashed], out, comparer, search_value);
+  dictionary_entry_t * e = dictionary_find(self, hasher(search_value), comparer, search_value);
+  if(e == nullptr || e->value == nullptr) return false;
+  *out = e->value;
+  return true;
 }
 
 bool
 dictionary_contains(
   dictionary_t * self, size_t(hasher(void *)), bool(comparer(void *, void *)), void * search_value)
 {
-  size_t hashed = hasher(search_value) % DICTIONARY_TABLE_SIZE;
-  return list_contains(self->values[hashed], comparer, search_value);
+  dictionary_entry_t * e = dictionary_find(self, hasher(search_value), comparer, search_value);
+  return e != nullptr && e->value != nullptr;
 }
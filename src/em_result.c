@@ -13,7 +13,7 @@ const char * const EM_RESULT_STR_TABLE[] = {
   "Invalid Argument",
   "Worklist Overflow",
   "Stack Overflow",
-  "",
+  "Queue Full",
   "",
   "",
   "",
@@ -0,0 +1,101 @@
+/** -------------------------------------------
+ * @file   emdiag.c
+ * @brief  Diagnostics
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "emdiag.h"
+
+em_diag_channel_t em_diag;
+
+// ! Pass the buffer to the sink.
+static void
+em_diag_flush(void)
+{
+  if(em_diag.used == 0) return;
+  em_diag.sink(em_diag.user, em_diag.current, em_diag.buffer, em_diag.used);
+  em_diag.used = 0;
+}
+
+void
+em_diag_set_sink(em_diag_level level, em_diag_sink sink, void * user)
+{
+  if(em_diag.sink != nullptr) em_diag_flush();
+  em_diag.sink    = sink;
+  em_diag.user    = user;
+  em_diag.level   = level;
+  em_diag.current = EM_DIAG_LEVEL_NONE;
+  em_diag.used    = 0;
+}
+
+void
+em_diag_begin(em_diag_level level)
+{
+  if(em_diag.current != EM_DIAG_LEVEL_NONE) em_diag_flush();  // Nested.
+  em_diag.current = level;
+}
+
+void
+em_diag_end(void)
+{
+  if(em_diag.current == EM_DIAG_LEVEL_NONE) return;
+  em_diag_flush();
+  em_diag.current = EM_DIAG_LEVEL_NONE;
+}
+
+void
+em_diag_write(const char * text, size_t length)
+{
+  if(em_diag.current == EM_DIAG_LEVEL_NONE) {
+    if(em_diag_is_enabled(EM_DIAG_LEVEL_INFO))
+      em_diag.sink(em_diag.user, EM_DIAG_LEVEL_INFO, text, length);
+    return;
+  }
+  while(length > 0) {
+    size_t n = EMFRP_DIAG_BUFFER_SIZE - em_diag.used;
+    if(n == 0) {
+      em_diag_flush();
+      continue;
+    }
+    if(n > length) n = length;
+    memcpy(em_diag.buffer + em_diag.used, text, n);
+    em_diag.used += n;
+    text += n;
+    length -= n;
+  }
+}
+
+void
+em_diag_puts(const char * str)
+{
+  em_diag_write(str, strlen(str));
+}
+
+void
+em_diag_print_int(int32_t v)
+{
+  char     buf[12];
+  char *   p = buf + sizeof(buf);
+  uint32_t u = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+  do {
+    *(--p) = (char)('0' + u % 10);
+    u /= 10;
+  } while(u != 0);
+  if(v < 0) *(--p) = '-';
+  em_diag_write(p, (size_t)(buf + sizeof(buf) - p));
+}
+
+void
+em_diag_printf(const char * format, ...)
+{
+  char    buf[EMFRP_DIAG_BUFFER_SIZE];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if(len < 0) return;
+  em_diag_write(buf, (size_t)len < sizeof(buf) ? (size_t)len : sizeof(buf) - 1);
+}
@@ -9,7 +9,6 @@
 #include "emmem.h"
 #include "emfrp_parser.h"
 #include "emfrp.h"
-#include <stdio.h>
 typedef struct emfrp_t
 {
   machine_t * machine;
@@ -43,50 +42,103 @@ emfrp_repl(emfrp_t * self, const char * str, object_t ** out)
   parser_reader_new(&parser_reader, &line);
   parser_context_t * ctx = parser_create(&parser_reader);
   if(strlen(str) > 0 && !parser_parse(ctx, (void **)&parsed)) {
-    parser_toplevel_print(parsed);
-    printf("\n");
+    if(parsed == nullptr) {  // An empty line or a comment.
+      *out = nullptr;
+      parser_destroy(ctx);
+      parser_reader_free(&parser_reader);
+      return EM_RESULT_OK;
+    }
+    EM_DIAG(EM_DIAG_LEVEL_DEBUG, parser_toplevel_print(parsed); em_diag_puts("\n"));
     errres = machine_exec(self->machine, parsed, out);
-    if(errres != EM_RESULT_OK)
-      parser_toplevel_free_deep(parsed);
-    else
-      parser_toplevel_free_shallow(parsed);
+    parser_toplevel_release(parsed);
   } else
     errres = EM_RESULT_PARSE_ERROR;
   parser_destroy(ctx);
-  if(errres == EM_RESULT_OK) machine_debug_print_definitions(self->machine);
+  parser_reader_free(&parser_reader);
+  if(errres == EM_RESULT_OK)
+    EM_DIAG(EM_DIAG_LEVEL_DEBUG, machine_debug_print_definitions(self->machine));
   return errres;
 }
 
 EM_EXPORTDECL em_result
-emfrp_add_input_node(emfrp_t * self, char * node_name, em_input_callback callback)
+emfrp_load(emfrp_t * self, const char * source, size_t * failed)
 {
-  em_result errres = EM_RESULT_OK;
-  string_t  s, s_dup;
-  string_new1(&s, node_name);
-  CHKERR(string_copy(&s_dup, &s));
-  return machine_add_node_callback(self->machine, s_dup, callback);
+  em_result           errres = EM_RESULT_OK;
+  parser_reader_t     parser_reader;
+  parser_toplevel_t * parsed;
+  string_t            text;
+  arraylist_t         programs;  // parser_toplevel_t *
+  bool                more = true;
+  arraylist_default(&programs);
+  string_new1(&text, (char *)source);
+  parser_reader_new(&parser_reader, &text);
+  parser_context_t * ctx = parser_create(&parser_reader);
+  // parser_parse returns one toplevel, or nullptr at the end.
+  while(more) {
+    parsed = nullptr;
+    more   = parser_parse(ctx, (void **)&parsed) != 0;
+    if(parsed == nullptr) {
+      TEST_AND_ERROR(more, EM_RESULT_PARSE_ERROR);
+      continue;
+    }
+    errres = arraylist_append(&programs, sizeof(parser_toplevel_t *), &parsed);
+    if(errres != EM_RESULT_OK) {
+      parser_toplevel_release(parsed);
+      goto err;
+    }
+  }
+  parser_destroy(ctx);
+  parser_reader_free(&parser_reader);
+  errres = machine_load(
+    self->machine, (parser_toplevel_t **)programs.buffer, programs.length, failed);
+  arraylist_free(&programs);
+  return errres;
 err:
+  if(failed != nullptr) *failed = programs.length;
+  for(size_t i = 0; i < programs.length; ++i)
+    parser_toplevel_release(((parser_toplevel_t **)programs.buffer)[i]);
+  arraylist_free(&programs);
+  parser_destroy(ctx);
+  parser_reader_free(&parser_reader);
   return errres;
 }
 
+EM_EXPORTDECL em_result
+emfrp_add_input_node(emfrp_t * self, char * node_name, em_input_callback callback)
+{
+  string_t s;
+  string_new1(&s, node_name);
+  return machine_add_node_callback(self->machine, &s, callback);
+}
+
 EM_EXPORTDECL em_result
 emfrp_add_output_node(emfrp_t * self, char * node_name, em_output_callback callback)
 {
-  em_result errres = EM_RESULT_OK;
-  string_t  s, s_dup;
+  string_t s;
   string_new1(&s, node_name);
-  CHKERR(string_copy(&s_dup, &s));
-  return machine_add_output_node(self->machine, s_dup, callback);
-err:
-  return errres;
+  return machine_add_output_node(self->machine, &s, callback);
 }
 
 EM_EXPORTDECL em_result
 emfrp_set_node_value(emfrp_t * self, char * node_name, em_object_t * v)
+{
+  emfrp_node_handle node = emfrp_lookup_node(self, node_name);
+  if(node == nullptr) return EM_RESULT_MISSING_IDENTIFIER;
+  return machine_set_value_of_node2(self->machine, node, v);
+}
+
+EM_EXPORTDECL em_result
+emfrp_set_node_cut_off(emfrp_t * self, char * node_name, bool cut_off)
 {
   string_t s;
   string_new1(&s, node_name);
-  return machine_set_value_of_node(self->machine, &s, v);
+  return machine_set_node_cut_off(self->machine, &s, cut_off);
+}
+
+EM_EXPORTDECL void
+emfrp_set_heap_limit(emfrp_t * self, size_t max_objects)
+{
+  memory_manager_set_limit(self->machine->memory_manager, max_objects);
 }
 
 EM_EXPORTDECL em_result
@@ -95,6 +147,126 @@ emfrp_update(emfrp_t * self)
   return machine_indicate(self->machine, nullptr, 0);
 }
 
+EM_EXPORTDECL emfrp_node_handle
+emfrp_lookup_node(emfrp_t * self, char * node_name)
+{
+  string_t s;
+  node_t * node;
+  string_new1(&s, node_name);
+  return machine_lookup_node(self->machine, &node, &s) ? node : nullptr;
+}
+
+EM_EXPORTDECL em_result
+emfrp_set_input_callback(emfrp_t * self, emfrp_node_handle node, em_input_callback callback)
+{
+  if(node == nullptr) return EM_RESULT_INVALID_ARGUMENT;
+  return machine_add_node_callback2(self->machine, node, callback);
+}
+
+EM_EXPORTDECL em_result
+emfrp_set_output_callback(emfrp_t * self, emfrp_node_handle node, em_output_callback callback)
+{
+  if(node == nullptr) return EM_RESULT_INVALID_ARGUMENT;
+  node->action = callback;
+  return EM_RESULT_OK;
+}
+
+EM_EXPORTDECL em_result
+emfrp_set_value(emfrp_t * self, emfrp_node_handle node, em_object_t * v)
+{
+  if(node == nullptr) return EM_RESULT_INVALID_ARGUMENT;
+  return machine_set_value_of_node2(self->machine, node, v);
+}
+
+EM_EXPORTDECL em_object_t *
+emfrp_get_value(emfrp_t * self, emfrp_node_handle node)
+{
+  return node == nullptr ? nullptr : node->value;
+}
+
+EM_EXPORTDECL em_result
+emfrp_post_input(emfrp_t * self, emfrp_node_handle node, em_object_t * v)
+{
+  // Objects in the heap may be collected while they are in the queue.
+  if(node == nullptr || !(object_is_integer(v) || object_is_boolean(v)))
+    return EM_RESULT_INVALID_ARGUMENT;
+  if(!input_queue_post(&(self->machine->inputs), node, v)) return EM_RESULT_QUEUE_FULL;
+  return EM_RESULT_OK;
+}
+
+EM_EXPORTDECL em_result
+emfrp_drain_and_update(emfrp_t * self)
+{
+  em_result errres = EM_RESULT_OK;
+  CHKERR(machine_drain_inputs(self->machine));
+  return machine_indicate(self->machine, nullptr, 0);
+err:
+  return errres;
+}
+
+EM_EXPORTDECL em_result
+emfrp_run_batch(
+  emfrp_t * self, size_t n_steps, size_t n_inputs, emfrp_node_handle * input_handles,
+  const int32_t * input_matrix, size_t n_outputs, emfrp_node_handle * output_handles,
+  int32_t * output_matrix)
+{
+  em_result errres = EM_RESULT_OK;
+  for(size_t i = 0; i < n_inputs; ++i)
+    if(input_handles[i] == nullptr) return EM_RESULT_INVALID_ARGUMENT;
+  for(size_t i = 0; i < n_outputs; ++i)
+    if(output_handles[i] == nullptr) return EM_RESULT_INVALID_ARGUMENT;
+  for(size_t i = 0; i < n_steps * n_inputs; ++i)
+    if(input_matrix[i] < OBJECT_INT_MIN || input_matrix[i] > OBJECT_INT_MAX)
+      return EM_RESULT_INVALID_ARGUMENT;
+  for(size_t step = 0; step < n_steps; ++step) {
+    const int32_t * in  = &(input_matrix[step * n_inputs]);
+    int32_t *       out = &(output_matrix[step * n_outputs]);
+    for(size_t i = 0; i < n_inputs; ++i) {
+      object_t * v;
+      CHKERR(object_new_int(&v, in[i]));
+      CHKERR(machine_set_value_of_node2(self->machine, input_handles[i], v));
+    }
+    CHKERR(machine_indicate(self->machine, nullptr, 0));
+    for(size_t i = 0; i < n_outputs; ++i) {
+      object_t * v = output_handles[i]->value;
+      if(object_is_integer(v))
+        out[i] = object_get_integer(v);
+      else
+        out[i] = v == &object_true ? 1 : 0;
+    }
+  }
+err:
+  return errres;
+}
+
+EM_EXPORTDECL void
+emfrp_get_memory_stats(emfrp_t * self, emfrp_memory_stats_t * out)
+{
+  memory_manager_t * mm = self->machine->memory_manager;
+  out->allocations      = mm->allocations;
+  out->gc_cycles        = mm->gc_cycles;
+  out->heap_objects     = (size_t)mm->pages_length * MEMORY_MANAGER_PAGE_SIZE;
+}
+
+EM_EXPORTDECL em_result
+emfrp_get_node_stats(emfrp_t * self, char * node_name, emfrp_node_stats_t * out)
+{
+#if EMFRP_ENABLE_PROFILING
+  string_t          s;
+  exec_sequence_t * es;
+  string_new1(&s, node_name);
+  if(!machine_lookup_exec_sequence(self->machine, &es, &s)) return EM_RESULT_MISSING_IDENTIFIER;
+  out->evaluations = es->profile.evaluations;
+  out->total_ns    = es->profile.total_ns;
+  out->max_ns      = es->profile.max_ns;
+  out->allocations = es->profile.allocations;
+  out->failures    = es->profile.failures;
+  return EM_RESULT_OK;
+#else
+  return EM_RESULT_INVALID_ARGUMENT;  // Profiling is disabled.
+#endif
+}
+
 EM_EXPORTDECL em_object_t *
 emfrp_create_int_object(int32_t num)
 {
@@ -123,5 +295,11 @@ emfrp_get_integer(em_object_t * v)
 EM_EXPORTDECL void
 emfrp_print_object(em_object_t * v)
 {
-  object_print(v);
+  EM_DIAG(EM_DIAG_LEVEL_INFO, object_print(v));
+}
+
+EM_EXPORTDECL void
+emfrp_set_diag_sink(em_diag_level level, em_diag_sink sink, void * user)
+{
+  em_diag_set_sink(level, sink, user);
 }
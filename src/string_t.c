@@ -6,6 +6,7 @@
  ------------------------------------------- */
 
 #include "string_t.h"
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -35,10 +36,11 @@ err:
 size_t
 string_hash(const string_t * self)
 {
-  return self->buffer[0];
-  // Light implementation above.
-  size_t ret = 0;
-  for(int i = 0; i < self->length; ++i)
-    ret ^= self->buffer[i];
+  // FNV-1a(32 bits), which is cheap on microcontrollers.
+  uint32_t ret = 2166136261u;
+  for(size_t i = 0; i < self->length; ++i) {
+    ret ^= (unsigned char)self->buffer[i];
+    ret *= 16777619u;
+  }
   return ret;
 }
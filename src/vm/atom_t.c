@@ -0,0 +1,38 @@
+/** -------------------------------------------
+ * @file   atom_t.c
+ * @brief  Interned Identifiers
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include "vm/atom_t.h"
+
+bool
+atom_compare(void * l, void * r)
+{
+  return string_compare((string_t *)l, (string_t *)r);
+}
+
+em_result
+atom_intern(dictionary_t * table, string_t * name, atom_t * out)
+{
+  em_result errres = EM_RESULT_OK;
+  string_t  copied;
+  if(dictionary_get(table, (void **)out, (size_t(*)(void *))string_hash, atom_compare, name))
+    return EM_RESULT_OK;
+  CHKERR(string_copy(&copied, name));
+  CHKERR2(
+    err2, dictionary_add2(
+            table, &copied, sizeof(string_t), (size_t(*)(void *))string_hash, atom_compare,
+            nullptr, nullptr, (void **)out));
+  return EM_RESULT_OK;
+err2:
+  string_free(&copied);
+err:
+  return errres;
+}
+
+bool
+atom_lookup(dictionary_t * table, string_t * name, atom_t * out)
+{
+  return dictionary_get(table, (void **)out, (size_t(*)(void *))string_hash, atom_compare, name);
+}
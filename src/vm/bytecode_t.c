@@ -0,0 +1,129 @@
+/** -------------------------------------------
+ * @file   bytecode_t.c
+ * @brief  Emfrp Bytecode Representation
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include "vm/bytecode_t.h"
+#include "vm/variable_t.h"
+#include "vm/node_t.h"
+#include "vm/record_table.h"
+#include "emdiag.h"
+
+void
+bytecode_release(bytecode_t * self)
+{
+  if(self == nullptr) return;
+  self->reference_count--;
+  if(self->reference_count > 0) return;
+  for(size_t i = 0; i < self->length; ++i)
+    if(INSTRUCTION_OPCODE(self->code[i]) == OPCODE_CLOSURE)
+      bytecode_release(self->constants[INSTRUCTION_OPERAND(self->code[i])].bytecode);
+  if(self->source != nullptr) parser_toplevel_release(self->source->value.function.owner);
+  em_free(self->code);
+  em_free(self->constants);
+  em_free(self);
+}
+
+static const char * const opcode_name_table[] = {
+  "PUSH_INT", "PUSH_CONSTANT", "PUSH_TRUE", "PUSH_FALSE", "PUSH_NIL", "POP", "DUP", "SLIDE",
+  "LOAD_NAME", "LOAD_LAST", "LOAD_LOCAL", "LOAD_ENV", "LOAD_GLOBAL", "LOAD_NODE", "LOAD_NODE_LAST",
+  "ADD", "SUB", "DIV", "MUL", "MOD", "LSHIFT", "RSHIFT", "LE", "LT", "GE", "GT", "EQ", "NE", "AND",
+  "OR", "XOR", "TO_BOOLEAN", "JUMP", "JUMP_IF_FALSE", "JUMP_IF_FALSE_OR_POP",
+  "JUMP_IF_TRUE_OR_POP", "TUPLE", "CALL", "TAIL_CALL", "RETURN", "CLOSURE", "STORE_LOCAL",
+  "SWITCH_INT", "SWITCH_TUPLE", "MATCH_LOCAL", "MATCH_ENV", "ADD_INT", "SUB_INT", "DIV_INT",
+  "MUL_INT", "MOD_INT", "LSHIFT_INT", "RSHIFT_INT", "LE_INT", "LT_INT", "GE_INT", "GT_INT",
+  "EQ_INT", "NE_INT", "ADD_LOCAL", "SUB_LOCAL", "DIV_LOCAL", "MUL_LOCAL", "MOD_LOCAL",
+  "LSHIFT_LOCAL", "RSHIFT_LOCAL", "LE_LOCAL", "LT_LOCAL", "GE_LOCAL", "GT_LOCAL", "EQ_LOCAL",
+  "NE_LOCAL", "ADD_NODE", "SUB_NODE", "DIV_NODE", "MUL_NODE", "MOD_NODE", "LSHIFT_NODE",
+  "RSHIFT_NODE", "LE_NODE", "LT_NODE", "GE_NODE", "GT_NODE", "EQ_NODE", "NE_NODE",
+  "ADD_UNCHECKED", "SUB_UNCHECKED", "DIV_UNCHECKED", "MUL_UNCHECKED", "MOD_UNCHECKED",
+  "LSHIFT_UNCHECKED", "RSHIFT_UNCHECKED", "LE_UNCHECKED", "LT_UNCHECKED", "GE_UNCHECKED",
+  "GT_UNCHECKED", "ADD_INT_UNCHECKED", "SUB_INT_UNCHECKED", "DIV_INT_UNCHECKED",
+  "MUL_INT_UNCHECKED", "MOD_INT_UNCHECKED", "LSHIFT_INT_UNCHECKED", "RSHIFT_INT_UNCHECKED",
+  "LE_INT_UNCHECKED", "LT_INT_UNCHECKED", "GE_INT_UNCHECKED", "GT_INT_UNCHECKED",
+  "ADD_LOCAL_UNCHECKED", "SUB_LOCAL_UNCHECKED", "DIV_LOCAL_UNCHECKED", "MUL_LOCAL_UNCHECKED",
+  "MOD_LOCAL_UNCHECKED", "LSHIFT_LOCAL_UNCHECKED", "RSHIFT_LOCAL_UNCHECKED", "LE_LOCAL_UNCHECKED",
+  "LT_LOCAL_UNCHECKED", "GE_LOCAL_UNCHECKED", "GT_LOCAL_UNCHECKED", "CALL_UNCHECKED",
+  "TAIL_CALL_UNCHECKED", "GUARD_INT", "TUPLE_ITH"};
+
+// ! [DEBUG] Print the jump table.(See OPCODE_SWITCH_INT and OPCODE_SWITCH_TUPLE.)
+static void
+bytecode_debug_print_switch(bytecode_constant_t * table, bool tuple)
+{
+  bytecode_constant_t * cs = table + BYTECODE_SWITCH_CASES;
+  em_diag_printf(" %d {", table[BYTECODE_SWITCH_SLOT].integer);
+  for(int i = 0; i < table[BYTECODE_SWITCH_LENGTH].integer; ++i) {
+    if(tuple) {
+      const char * tag =
+        cs[1].integer == RECORD_TAG_NONE ? "" : record_table_name(cs[1].integer)->buffer;
+      em_diag_printf(" %s/%d: %d", tag, cs[0].integer, cs[2].integer);
+      cs += BYTECODE_SWITCH_TUPLE_CASE_SIZE;
+    } else {
+      em_diag_printf(" %d: %d", cs[0].integer, cs[1].integer);
+      cs += BYTECODE_SWITCH_INT_CASE_SIZE;
+    }
+  }
+  em_diag_printf(" } %d\n", table[BYTECODE_SWITCH_OTHERWISE].integer);
+}
+
+void
+bytecode_debug_print(bytecode_t * self)
+{
+  for(size_t i = 0; i < self->length; ++i) {
+    opcode_t op = INSTRUCTION_OPCODE(self->code[i]);
+    int      v  = INSTRUCTION_OPERAND(self->code[i]);
+    em_diag_printf("%4d: %s", (int)i, opcode_name_table[op]);
+    if(OPCODE_LOADS_NODE(op)) op = OPCODE_LOAD_NODE;
+    if(
+      (op >= OPCODE_ADD_INT && op <= OPCODE_NOT_EQUAL_LOCAL)
+      || (op >= OPCODE_ADD_INT_UNCHECKED && op <= OPCODE_GREATER_THAN_LOCAL_UNCHECKED))
+      op = OPCODE_PUSH_INT;
+    switch(op) {
+      case OPCODE_LOAD_NAME:
+      case OPCODE_LOAD_LAST:
+        em_diag_printf(" %s\n", self->constants[v].name->buffer);
+        break;
+      case OPCODE_LOAD_GLOBAL:
+        em_diag_printf(" %s\n", self->constants[v].global->name->buffer);
+        break;
+      case OPCODE_LOAD_NODE:
+      case OPCODE_LOAD_NODE_LAST:
+        em_diag_printf(" %s\n", self->constants[v].node->name->buffer);
+        break;
+      case OPCODE_SWITCH_INT:
+      case OPCODE_SWITCH_TUPLE:
+        bytecode_debug_print_switch(&(self->constants[v]), op == OPCODE_SWITCH_TUPLE);
+        break;
+      case OPCODE_LOAD_ENV:
+      case OPCODE_MATCH_LOCAL:
+      case OPCODE_MATCH_ENV:
+        em_diag_printf(
+          " %d %d\n", INSTRUCTION_OPERAND_HIGH(self->code[i]),
+          INSTRUCTION_OPERAND_LOW(self->code[i]));
+        break;
+      case OPCODE_PUSH_INT:
+      case OPCODE_PUSH_CONSTANT:
+      case OPCODE_LOAD_LOCAL:
+      case OPCODE_STORE_LOCAL:
+      case OPCODE_SLIDE:
+      case OPCODE_JUMP:
+      case OPCODE_JUMP_IF_FALSE:
+      case OPCODE_JUMP_IF_FALSE_OR_POP:
+      case OPCODE_JUMP_IF_TRUE_OR_POP:
+      case OPCODE_TUPLE:
+      case OPCODE_CALL:
+      case OPCODE_TAIL_CALL:
+      case OPCODE_CALL_UNCHECKED:
+      case OPCODE_TAIL_CALL_UNCHECKED:
+      case OPCODE_GUARD_INT:
+      case OPCODE_TUPLE_ITH:
+      case OPCODE_CLOSURE:
+        em_diag_printf(" %d\n", v);
+        break;
+      default:
+        em_diag_puts("\n");
+        break;
+    }
+  }
+}
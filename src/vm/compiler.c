@@ -0,0 +1,1481 @@
+/** -------------------------------------------
+ * @file   compiler.c
+ * @brief  Emfrp Bytecode Compiler Implementation
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include "vm/compiler.h"
+#include "vm/machine.h"
+#include "vm/exec.h"
+#include "vm/typing.h"
+#include "collections/arraylist_t.h"
+
+// ! A local variable which is visible at compile time.
+typedef struct compiler_local_t
+{
+  // ! Name of the variable.(It is owned by the AST.)
+  string_t * name;
+  // ! Slot of the frame, or the variable table if captured.
+  int slot;
+  // ! Is it captured by closures?(i.e. placed in the variable table.)
+  bool captured;
+} compiler_local_t;
+
+// ! A binding which is visible in the capture analysis.
+typedef struct compiler_binding_t
+{
+  // ! Name of the variable.(The identity of the binding.)
+  string_t * name;
+  // ! Nesting level of functions. 0 is the function being compiled.
+  int level;
+} compiler_binding_t;
+
+// ! The state of the compiler.
+typedef struct compiler_t
+{
+  // ! The machine.
+  machine_t * machine;
+  // ! The compiler of the enclosing function.(Nullable)
+  struct compiler_t * parent;
+  // ! Emitted instructions.
+  arraylist_t /*<instruction_t>*/ code;
+  // ! The constant pool.
+  arraylist_t /*<bytecode_constant_t>*/ constants;
+  // ! Visible local variables. The later one shadows the former one.
+  arraylist_t /*<compiler_local_t>*/ locals;
+  // ! Bindings which are captured by closures.(Items are deconstructor_t::value.identifier.)
+  arraylist_t /*<string_t *>*/ captured;
+  // ! Count of allocated slots of the frame.
+  int frame_size;
+  // ! Count of allocated slots of the variable table.
+  /* !
+   * Slots are never reused, because closures may capture them.
+   */
+  int env_size;
+  // ! Compiling a body of the function?(Tail calls are emitted only in functions.)
+  bool in_function;
+  // ! The definition which is recorded as the dependent of inlined data.
+  /* !
+   * Immediate values of data are not inlined if it is nullptr.(See compile_expression.)
+   */
+  const variable_dependent_t * owner;
+  // ! Types of the definition.(Nullable, then runtime type checks are not omitted.)
+  typing_t * typing;
+} compiler_t;
+
+em_result compile_mono(compiler_t * c, parser_expression_t * v, bool tail);
+em_result compile_function2(
+  machine_t * m, compiler_t * parent, typing_t * typing, const variable_dependent_t * owner,
+  parser_expression_t * f, bytecode_t ** out);
+
+static inline size_t
+compiler_position(compiler_t * c)
+{
+  return c->code.length;
+}
+
+em_result
+compiler_emit(compiler_t * c, opcode_t op, int32_t operand)
+{
+  instruction_t i = INSTRUCTION_NEW(op, operand);
+  if(operand > INSTRUCTION_OPERAND_MAX || operand < INSTRUCTION_OPERAND_MIN)
+    return EM_RESULT_OUT_OF_INDEX;
+  return arraylist_append(&(c->code), sizeof(instruction_t), &i);
+}
+
+em_result
+compiler_emit2(compiler_t * c, opcode_t op, int high, int low)
+{
+  instruction_t i = INSTRUCTION_NEW2(op, high, low);
+  if(
+    high > INSTRUCTION_OPERAND_HALF_MAX || high < 0 || low > INSTRUCTION_OPERAND_HALF_MAX
+    || low < 0)
+    return EM_RESULT_OUT_OF_INDEX;
+  return arraylist_append(&(c->code), sizeof(instruction_t), &i);
+}
+
+// ! Rewrite the operand of the jump instruction at `at` to the current position.
+void
+compiler_patch_jump(compiler_t * c, size_t at)
+{
+  instruction_t * buf = (instruction_t *)c->code.buffer;
+  buf[at]             = INSTRUCTION_NEW(INSTRUCTION_OPCODE(buf[at]), compiler_position(c));
+}
+
+em_result
+compiler_add_constant(compiler_t * c, bytecode_constant_t v, int32_t * out)
+{
+  em_result errres = EM_RESULT_OK;
+  TEST_AND_ERROR(c->constants.length > INSTRUCTION_OPERAND_MAX, EM_RESULT_OUT_OF_INDEX);
+  *out = c->constants.length;
+  CHKERR(arraylist_append(&(c->constants), sizeof(bytecode_constant_t), &v));
+err:
+  return errres;
+}
+
+em_result
+compiler_emit_constant(compiler_t * c, opcode_t op, bytecode_constant_t v)
+{
+  em_result errres = EM_RESULT_OK;
+  int32_t   index  = 0;
+  CHKERR(compiler_add_constant(c, v, &index));
+  CHKERR(compiler_emit(c, op, index));
+err:
+  return errres;
+}
+
+// ! The deconstructor matches anything?
+static inline bool
+deconstructor_is_irrefutable(deconstructor_t * d)
+{
+  return d->kind == DECONSTRUCTOR_IDENTIFIER || d->kind == DECONSTRUCTOR_ANY;
+}
+
+// ! Make bindings of the deconstructor visible in the capture analysis.
+em_result
+compiler_analyze_bind(arraylist_t /*<compiler_binding_t>*/ * scope, deconstructor_t * d, int level)
+{
+  em_result          errres = EM_RESULT_OK;
+  compiler_binding_t b;
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      b.name  = d->value.identifier;
+      b.level = level;
+      CHKERR(arraylist_append(scope, sizeof(compiler_binding_t), &b));
+      break;
+    case DECONSTRUCTOR_TUPLE:
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+        CHKERR(compiler_analyze_bind(scope, (deconstructor_t *)(&(li->value)), level));
+      break;
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+// ! Add the binding to compiler_t::captured.
+em_result
+compiler_capture(compiler_t * c, string_t * name)
+{
+  for(size_t i = 0; i < c->captured.length; ++i)
+    if(((string_t **)c->captured.buffer)[i] == name) return EM_RESULT_OK;  // Already captured.
+  return arraylist_append(&(c->captured), sizeof(string_t *), &name);
+}
+
+// ! The capture analysis.
+/* !
+ * Collect bindings of level 0 which are referred from nested functions into compiler_t::captured.
+ * \param c The compiler
+ * \param scope Visible bindings
+ * \param v The expression
+ * \param level Nesting level of functions
+ * \return The status code
+ */
+em_result
+compiler_analyze(
+  compiler_t * c, arraylist_t /*<compiler_binding_t>*/ * scope, parser_expression_t * v, int level)
+{
+  em_result errres  = EM_RESULT_OK;
+  size_t    visible = scope->length;
+  if(EXPR_KIND_IS_INTEGER(v) || EXPR_KIND_IS_BOOLEAN(v)) return EM_RESULT_OK;
+  if(EXPR_KIND_IS_BIN_OP(v)) {
+    CHKERR(compiler_analyze(c, scope, v->value.binary.lhs, level));
+    CHKERR(compiler_analyze(c, scope, v->value.binary.rhs, level));
+    return EM_RESULT_OK;
+  }
+  switch(v->kind) {
+    case EXPR_KIND_IDENTIFIER: {
+      compiler_binding_t * bindings = (compiler_binding_t *)scope->buffer;
+      for(size_t i = scope->length; i > 0; --i) {
+        if(!string_compare(bindings[i - 1].name, &(v->value.identifier))) continue;
+        // Referred from the nested function.
+        if(bindings[i - 1].level == 0 && level > 0)
+          CHKERR(compiler_capture(c, bindings[i - 1].name));
+        break;
+      }
+      break;
+    }
+    case EXPR_KIND_IF:
+      CHKERR(compiler_analyze(c, scope, v->value.ifthenelse.cond, level));
+      CHKERR(compiler_analyze(c, scope, v->value.ifthenelse.then, level));
+      CHKERR(compiler_analyze(c, scope, v->value.ifthenelse.otherwise, level));
+      break;
+    case EXPR_KIND_TUPLE:
+      for(parser_expression_tuple_list_t * li = &(v->value.tuple); li != nullptr; li = li->next)
+        CHKERR(compiler_analyze(c, scope, li->value, level));
+      break;
+    case EXPR_KIND_FUNCCALL:
+      CHKERR(compiler_analyze(c, scope, v->value.funccall.callee, level));
+      if(v->value.funccall.arguments.value != nullptr)
+        for(parser_expression_tuple_list_t * li = &(v->value.funccall.arguments); li != nullptr;
+            li                                  = li->next)
+          CHKERR(compiler_analyze(c, scope, li->value, level));
+      break;
+    case EXPR_KIND_FUNCTION:
+      for(list_t * li = v->value.function.arguments; li != nullptr; li = LIST_NEXT(li))
+        CHKERR(compiler_analyze_bind(scope, (deconstructor_t *)(&(li->value)), level + 1));
+      CHKERR(compiler_analyze(c, scope, v->value.function.body, level + 1));
+      break;
+    case EXPR_KIND_CASE:
+      CHKERR(compiler_analyze(c, scope, v->value.caseof.of, level));
+      for(parser_branch_list_t * bl = v->value.caseof.branches; bl != nullptr; bl = bl->next) {
+        CHKERR(compiler_analyze_bind(scope, bl->deconstruct, level));
+        CHKERR(compiler_analyze(c, scope, bl->body, level));
+        scope->length = visible;
+        if(deconstructor_is_irrefutable(bl->deconstruct)) break;  // Same as compile_case.
+      }
+      break;
+    case EXPR_KIND_BEGIN:
+      for(parser_branch_list_t * bl = v->value.begin.branches; bl != nullptr; bl = bl->next) {
+        CHKERR(compiler_analyze(c, scope, bl->body, level));
+        if(bl->deconstruct != nullptr) CHKERR(compiler_analyze_bind(scope, bl->deconstruct, level));
+      }
+      break;
+    default:
+      break;
+  }
+err:
+  scope->length = visible;
+  return errres;
+}
+
+// ! Is any binding in the deconstructor captured?
+bool
+compiler_is_captured(compiler_t * c, deconstructor_t * d)
+{
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      for(size_t i = 0; i < c->captured.length; ++i)
+        if(((string_t **)c->captured.buffer)[i] == d->value.identifier) return true;
+      return false;
+    case DECONSTRUCTOR_TUPLE:
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+        if(compiler_is_captured(c, (deconstructor_t *)(&(li->value)))) return true;
+      return false;
+    default:
+      return false;
+  }
+}
+
+// ! Allocate slots for identifiers in the deconstructor, and make them visible.
+/* !
+ * \param c The compiler
+ * \param d The deconstructor
+ * \param captured Allocate slots of the variable table, instead of the frame.
+ * \return The status code
+ */
+em_result
+compiler_declare(compiler_t * c, deconstructor_t * d, bool captured)
+{
+  em_result        errres = EM_RESULT_OK;
+  compiler_local_t l;
+  int *            slots = captured ? &(c->env_size) : &(c->frame_size);
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      TEST_AND_ERROR(*slots >= INSTRUCTION_OPERAND_HALF_MAX, EM_RESULT_OUT_OF_INDEX);
+      l.name     = d->value.identifier;
+      l.slot     = (*slots)++;
+      l.captured = captured;
+      CHKERR(arraylist_append(&(c->locals), sizeof(compiler_local_t), &l));
+      break;
+    case DECONSTRUCTOR_TUPLE:
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+        CHKERR(compiler_declare(c, (deconstructor_t *)(&(li->value)), captured));
+      break;
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+// ! Resolve the local variable.
+/* !
+ * \param c The compiler
+ * \param name The name
+ * \param out The result
+ * \param depth The result, count of variable tables to go out.
+ * \return Whether found or not
+ */
+bool
+compiler_resolve(compiler_t * c, string_t * name, compiler_local_t * out, int * depth)
+{
+  for(int d = 0; c != nullptr; c = c->parent) {
+    compiler_local_t * locals = (compiler_local_t *)c->locals.buffer;
+    for(size_t i = c->locals.length; i > 0; --i)
+      if(string_compare(locals[i - 1].name, name)) {
+        *out   = locals[i - 1];
+        *depth = d;
+        return true;
+      }
+    // The variable table is made only if there are captured variables.
+    if(c->captured.length > 0) d++;
+  }
+  return false;
+}
+
+em_result
+compile_identifier(compiler_t * c, parser_expression_t * v)
+{
+  em_result           errres = EM_RESULT_OK;
+  int                 depth;
+  compiler_local_t    l;
+  bytecode_constant_t k;
+  if(compiler_resolve(c, &(v->value.identifier), &l, &depth))
+    return l.captured ? compiler_emit2(c, OPCODE_LOAD_ENV, depth, l.slot)
+                      : compiler_emit(c, OPCODE_LOAD_LOCAL, l.slot);
+  if(machine_lookup_global(c->machine, &(k.global), &(v->value.identifier)))
+    return compiler_emit_constant(c, OPCODE_LOAD_GLOBAL, k);
+  if(machine_lookup_node(c->machine, &(k.node), &(v->value.identifier)))
+    return compiler_emit_constant(c, OPCODE_LOAD_NODE, k);
+  // Not defined yet, it is resolved at runtime.
+  CHKERR(machine_intern(c->machine, &(v->value.identifier), &(k.name)));
+  return compiler_emit_constant(c, OPCODE_LOAD_NAME, k);
+err:
+  return errres;
+}
+
+em_result
+compile_last_identifier(compiler_t * c, parser_expression_t * v)
+{
+  em_result           errres = EM_RESULT_OK;
+  bytecode_constant_t k;
+  if(machine_lookup_node(c->machine, &(k.node), &(v->value.identifier)))
+    return compiler_emit_constant(c, OPCODE_LOAD_NODE_LAST, k);
+  CHKERR(machine_intern(c->machine, &(v->value.identifier), &(k.name)));
+  return compiler_emit_constant(c, OPCODE_LOAD_LAST, k);
+err:
+  return errres;
+}
+
+// ! Bind the top of the stack to the deconstructor.
+em_result
+compile_match(compiler_t * c, deconstructor_t * d)
+{
+  em_result           errres   = EM_RESULT_OK;
+  bool                captured = compiler_is_captured(c, d);
+  int                 first    = captured ? c->env_size : c->frame_size;
+  int32_t             index    = 0;
+  bytecode_constant_t k        = {.deconstructor = d};
+  CHKERR(compiler_declare(c, d, captured));
+  CHKERR(compiler_add_constant(c, k, &index));
+  CHKERR(compiler_emit2(c, captured ? OPCODE_MATCH_ENV : OPCODE_MATCH_LOCAL, first, index));
+err:
+  return errres;
+}
+
+em_result
+compile_integer(compiler_t * c, int v)
+{
+  if(v <= INSTRUCTION_OPERAND_MAX && v >= INSTRUCTION_OPERAND_MIN)
+    return compiler_emit(c, OPCODE_PUSH_INT, v);
+  bytecode_constant_t k;
+  object_new_int(&(k.object), v);
+  return compiler_emit_constant(c, OPCODE_PUSH_CONSTANT, k);
+}
+
+// ! Push the immediate value.(See compiler_fold.)
+em_result
+compile_immediate(compiler_t * c, object_t * v)
+{
+  bytecode_constant_t k = {.object = v};
+  if(object_is_integer(v)) return compile_integer(c, object_get_integer(v));
+  if(v == &object_true) return compiler_emit(c, OPCODE_PUSH_TRUE, 0);
+  if(v == &object_false) return compiler_emit(c, OPCODE_PUSH_FALSE, 0);
+  if(v == nullptr) return compiler_emit(c, OPCODE_PUSH_NIL, 0);
+  return compiler_emit_constant(c, OPCODE_PUSH_CONSTANT, k);  // A tag.
+}
+
+// ! Is the value never garbage collected, so that it can be placed in the code?
+static inline bool
+compiler_is_immediate(object_t * v)
+{
+  return !object_is_pointer(v) || v == nullptr || v == &object_true || v == &object_false;
+}
+
+bool compiler_fold(compiler_t * c, parser_expression_t * v, object_t ** out);
+
+// ! Get the value of the data at compile time, if it is an immediate value.
+static bool
+compiler_fold_identifier(compiler_t * c, parser_expression_t * v, object_t ** out)
+{
+  int              depth;
+  compiler_local_t l;
+  variable_t *     var;
+  if(c->owner == nullptr || compiler_resolve(c, &(v->value.identifier), &l, &depth)) return false;
+  if(!machine_lookup_global(c->machine, &var, &(v->value.identifier))) return false;
+  if(!var->constant || !compiler_is_immediate(var->value)) return false;
+  // The code is compiled again, if the value is changed.
+  if(variable_dependents_add(&(var->dependents), c->owner) != EM_RESULT_OK) return false;
+  *out = var->value;
+  return true;
+}
+
+// ! Evaluate the binary operator at compile time, if the operands are constants.
+/* !
+ * It follows exec_bytecode. The operator which fails or is undefined at runtime(e.g. division by
+ * zero, or operands which are not integers) is left to runtime.
+ */
+static bool
+compiler_fold_binary(compiler_t * c, parser_expression_t * v, object_t ** out)
+{
+  object_t * l;
+  object_t * r;
+  int        ll, rr, n;
+  if(!compiler_fold(c, v->value.binary.lhs, &l)) return false;
+  // The right operand is not evaluated.
+  if((v->kind == EXPR_KIND_DAND && l == &object_false)
+     || (v->kind == EXPR_KIND_DOR && l != &object_false)) {
+    *out = l;
+    return true;
+  }
+  if(!compiler_fold(c, v->value.binary.rhs, &r)) return false;
+  switch(v->kind) {
+    case EXPR_KIND_DAND:
+    case EXPR_KIND_DOR:
+      *out = r != &object_false ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_EQUAL:
+      *out = exec_equal(l, r) ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_NOT_EQUAL:
+      *out = !exec_equal(l, r) ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_AND:
+      *out = (l != &object_false) && (r != &object_false) ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_OR:
+      *out = (l != &object_false) || (r != &object_false) ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_XOR:
+      *out = (l != &object_false) ^ (r != &object_false) ? &object_true : &object_false;
+      return true;
+    default:
+      break;
+  }
+  if(!object_is_integer(l) || !object_is_integer(r)) return false;
+  ll = object_get_integer(l);
+  rr = object_get_integer(r);
+  switch(v->kind) {
+    case EXPR_KIND_ADDITION:
+      n = ll + rr;
+      break;
+    case EXPR_KIND_SUBTRACTION:
+      n = ll - rr;
+      break;
+    case EXPR_KIND_MULTIPLICATION:
+      n = (int)((unsigned)ll * (unsigned)rr);
+      break;
+    case EXPR_KIND_DIVISION:
+      if(rr == 0) return false;
+      n = ll / rr;
+      break;
+    case EXPR_KIND_MODULO:
+      if(rr == 0) return false;
+      n = ll % rr;
+      break;
+    case EXPR_KIND_LEFT_SHIFT:
+      if(rr < 0 || rr >= 32) return false;
+      n = (int)((unsigned)ll << rr);
+      break;
+    case EXPR_KIND_RIGHT_SHIFT:
+      if(rr < 0 || rr >= 32) return false;
+      n = ll >> rr;
+      break;
+    case EXPR_KIND_LESS_OR_EQUAL:
+      *out = ll <= rr ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_LESS_THAN:
+      *out = ll < rr ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_GREATER_OR_EQUAL:
+      *out = ll >= rr ? &object_true : &object_false;
+      return true;
+    case EXPR_KIND_GREATER_THAN:
+      *out = ll > rr ? &object_true : &object_false;
+      return true;
+    default:
+      return false;
+  }
+  object_new_int(out, n);
+  return true;
+}
+
+// ! Evaluate the expression at compile time, if it is a constant.
+/* !
+ * Constants are literals, data bound to immediate values, and operators and `if` on them.
+ * \param c The compiler
+ * \param v The expression
+ * \param out The result, an immediate value.
+ * \return Whether v is a constant.
+ */
+bool
+compiler_fold(compiler_t * c, parser_expression_t * v, object_t ** out)
+{
+  object_t * cond;
+  if(EXPR_KIND_IS_INTEGER(v)) {
+    object_new_int(out, ((int)(size_t)v) >> 2);
+    return true;
+  }
+  if(EXPR_KIND_IS_BOOLEAN(v)) {
+    *out = EXPR_IS_TRUE(v) ? &object_true : &object_false;
+    return true;
+  }
+  if(!EXPR_IS_POINTER(v)) return false;
+  if(EXPR_KIND_IS_BIN_OP(v)) return compiler_fold_binary(c, v, out);
+  switch(v->kind) {
+    case EXPR_KIND_IDENTIFIER:
+      return compiler_fold_identifier(c, v, out);
+    case EXPR_KIND_IF:  // nil is left to runtime, because it fails.
+      if(!compiler_fold(c, v->value.ifthenelse.cond, &cond) || cond == nullptr) return false;
+      return compiler_fold(
+        c, cond != &object_false ? v->value.ifthenelse.then : v->value.ifthenelse.otherwise, out);
+    default:
+      return false;
+  }
+}
+
+em_result
+compile_tuple_list_t(compiler_t * c, parser_expression_tuple_list_t * li, int * length)
+{
+  em_result errres = EM_RESULT_OK;
+  int       len    = 0;
+  for(; li != nullptr; li = LIST_NEXT(li), len++)
+    CHKERR(compile_mono(c, li->value, false));
+  *length = len;
+err:
+  return errres;
+}
+
+// ! The operator whose operands are swapped, or -1.(Indices are relative to OPCODE_ADD.)
+static const int8_t compiler_swapped_operator[OPCODE_FUSED_BINARY_COUNT] = {
+  OPCODE_ADD - OPCODE_ADD,
+  -1,
+  -1,
+  OPCODE_MUL - OPCODE_ADD,
+  -1,
+  -1,
+  -1,
+  OPCODE_GREATER_OR_EQUAL - OPCODE_ADD,
+  OPCODE_GREATER_THAN - OPCODE_ADD,
+  OPCODE_LESS_OR_EQUAL - OPCODE_ADD,
+  OPCODE_LESS_THAN - OPCODE_ADD,
+  OPCODE_EQUAL - OPCODE_ADD,
+  OPCODE_NOT_EQUAL - OPCODE_ADD,
+};
+
+// ! Get the superinstruction which takes v as the right operand.
+/* !
+ * v can be taken if it is an integer literal, a local variable in the frame or a node.
+ * They have no side effects, so that they can be evaluated after the left operand.
+ * \param c The compiler
+ * \param op The operator(relative to OPCODE_ADD)
+ * \param v The right operand
+ * \param instruction The result, the opcode and the operand.
+ * \param k The result, the node constant if the opcode needs.
+ * \return Whether v can be taken.
+ */
+bool
+compiler_fuse_operand(
+  compiler_t * c, int op, parser_expression_t * v, instruction_t * instruction,
+  bytecode_constant_t * k)
+{
+  int              depth;
+  compiler_local_t l;
+  object_t *       o;
+  if(compiler_fold(c, v, &o)) {
+    if(!object_is_integer(o)) return false;
+    int n = object_get_integer(o);
+    // Division by zero is left to the generic instruction.
+    if(n == 0 && (op == OPCODE_DIV - OPCODE_ADD || op == OPCODE_MOD - OPCODE_ADD)) return false;
+    if(n > INSTRUCTION_OPERAND_MAX || n < INSTRUCTION_OPERAND_MIN) return false;
+    *instruction = INSTRUCTION_NEW(OPCODE_ADD_INT + op, n);
+    return true;
+  }
+  if(!EXPR_IS_POINTER(v) || v->kind != EXPR_KIND_IDENTIFIER) return false;
+  if(compiler_resolve(c, &(v->value.identifier), &l, &depth)) {
+    if(l.captured) return false;
+    *instruction = INSTRUCTION_NEW(OPCODE_ADD_LOCAL + op, l.slot);
+    return true;
+  }
+  if(machine_lookup_global(c->machine, &(k->global), &(v->value.identifier))) return false;
+  if(!machine_lookup_node(c->machine, &(k->node), &(v->value.identifier))) return false;
+  *instruction = INSTRUCTION_NEW(OPCODE_ADD_NODE + op, 0);
+  return true;
+}
+
+// ! Compile the binary operator into the superinstruction, if either operand can be taken.
+/* !
+ * \param c The compiler
+ * \param v The binary expression
+ * \param fused The result, whether the superinstruction is emitted.
+ * \return The status code
+ */
+em_result
+compile_binary_fused(compiler_t * c, parser_expression_t * v, bool * fused)
+{
+  em_result             errres = EM_RESULT_OK;
+  int                   op     = v->kind >> PARSER_EXPRESSION_KIND_SHIFT;
+  parser_expression_t * lhs    = v->value.binary.lhs;
+  parser_expression_t * rhs    = v->value.binary.rhs;
+  parser_expression_t * taken  = rhs;
+  instruction_t         i;
+  bytecode_constant_t   k;
+  *fused = false;
+  if(op >= OPCODE_FUSED_BINARY_COUNT) return EM_RESULT_OK;
+  if(!compiler_fuse_operand(c, op, rhs, &i, &k)) {
+    // e.g. `1 + f(x)` is compiled as `f(x) + 1`.
+    op = compiler_swapped_operator[op];
+    if(op < 0 || !compiler_fuse_operand(c, op, lhs, &i, &k)) return EM_RESULT_OK;
+    taken = lhs;
+    lhs   = rhs;
+  }
+  if(
+    op < OPCODE_UNCHECKED_BINARY_COUNT && INSTRUCTION_OPCODE(i) < OPCODE_ADD_NODE
+    && typing_proves_int(c->typing, lhs)
+    && (INSTRUCTION_OPCODE(i) < OPCODE_ADD_LOCAL || typing_proves_int(c->typing, taken)))
+    i = INSTRUCTION_NEW(
+      (INSTRUCTION_OPCODE(i) < OPCODE_ADD_LOCAL ? OPCODE_ADD_INT_UNCHECKED
+                                                 : OPCODE_ADD_LOCAL_UNCHECKED)
+        + op,
+      INSTRUCTION_OPERAND(i));
+  *fused = true;
+  CHKERR(compile_mono(c, lhs, false));
+  if(OPCODE_LOADS_NODE(INSTRUCTION_OPCODE(i))) {
+    CHKERR(compiler_emit_constant(c, INSTRUCTION_OPCODE(i), k));
+  } else {
+    CHKERR(arraylist_append(&(c->code), sizeof(instruction_t), &i));
+  }
+err:
+  return errres;
+}
+
+em_result
+compile_binary(compiler_t * c, parser_expression_t * v)
+{
+  em_result  errres = EM_RESULT_OK;
+  size_t     jump_at;
+  bool       fused;
+  int        op;
+  object_t * l;
+  if(
+    (v->kind == EXPR_KIND_DAND || v->kind == EXPR_KIND_DOR)
+    && compiler_fold(c, v->value.binary.lhs, &l)) {
+    // The left operand does not short circuit.(Otherwise, compile_mono folds v.)
+    CHKERR(compile_mono(c, v->value.binary.rhs, false));
+    return compiler_emit(c, OPCODE_TO_BOOLEAN, 0);
+  }
+  CHKERR(compile_binary_fused(c, v, &fused));
+  if(fused) return EM_RESULT_OK;
+  CHKERR(compile_mono(c, v->value.binary.lhs, false));
+  switch(v->kind) {
+    case EXPR_KIND_DAND:
+    case EXPR_KIND_DOR:
+      jump_at = compiler_position(c);
+      CHKERR(compiler_emit(
+        c, v->kind == EXPR_KIND_DAND ? OPCODE_JUMP_IF_FALSE_OR_POP : OPCODE_JUMP_IF_TRUE_OR_POP,
+        0));
+      CHKERR(compile_mono(c, v->value.binary.rhs, false));
+      CHKERR(compiler_emit(c, OPCODE_TO_BOOLEAN, 0));
+      compiler_patch_jump(c, jump_at);
+      break;
+    default:
+      CHKERR(compile_mono(c, v->value.binary.rhs, false));
+      op = v->kind >> PARSER_EXPRESSION_KIND_SHIFT;
+      if(
+        op < OPCODE_UNCHECKED_BINARY_COUNT && typing_proves_int(c->typing, v->value.binary.lhs)
+        && typing_proves_int(c->typing, v->value.binary.rhs))
+        op += OPCODE_ADD_UNCHECKED - OPCODE_ADD;
+      CHKERR(compiler_emit(c, OPCODE_ADD + op, 0));
+      break;
+  }
+err:
+  return errres;
+}
+
+em_result
+compile_if(compiler_t * c, parser_expression_t * v, bool tail)
+{
+  em_result  errres = EM_RESULT_OK;
+  size_t     else_at, end_at;
+  object_t * cond;
+  if(compiler_fold(c, v->value.ifthenelse.cond, &cond) && cond != nullptr)  // Prune the branch.
+    return compile_mono(
+      c, cond != &object_false ? v->value.ifthenelse.then : v->value.ifthenelse.otherwise, tail);
+  CHKERR(compile_mono(c, v->value.ifthenelse.cond, false));
+  else_at = compiler_position(c);
+  CHKERR(compiler_emit(c, OPCODE_JUMP_IF_FALSE, 0));
+  CHKERR(compile_mono(c, v->value.ifthenelse.then, tail));
+  end_at = compiler_position(c);
+  CHKERR(compiler_emit(c, OPCODE_JUMP, 0));
+  compiler_patch_jump(c, else_at);
+  CHKERR(compile_mono(c, v->value.ifthenelse.otherwise, tail));
+  compiler_patch_jump(c, end_at);
+err:
+  return errres;
+}
+
+// ! Is the call the accessor of the record whose argument is proven to be the record?
+/* !
+ * \param c The compiler
+ * \param v The function call
+ * \param index The result, the index of the field.
+ * \return The result
+ */
+static bool
+compiler_proves_access(compiler_t * c, parser_expression_t * v, int * index)
+{
+  parser_expression_t * callee = v->value.funccall.callee;
+  compiler_local_t      l;
+  variable_t *          var;
+  object_t *            f;
+  int                   depth;
+  if(v->value.funccall.arguments.value == nullptr || v->value.funccall.arguments.next != nullptr)
+    return false;
+  if(!EXPR_IS_POINTER(callee) || callee->kind != EXPR_KIND_IDENTIFIER) return false;
+  if(compiler_resolve(c, &(callee->value.identifier), &l, &depth)) return false;
+  if(!machine_lookup_global(c->machine, &var, &(callee->value.identifier))) return false;
+  f = var->value;
+  if(
+    !object_is_pointer(f) || f == nullptr || object_kind(f) != EMFRP_OBJECT_FUNCTION
+    || f->value.function.kind != EMFRP_PROGRAM_KIND_RECORD_ACCESS)
+    return false;
+  // The callee is proven, so that the code is compiled again if the accessor is changed.
+  if(
+    !typing_proves_function(c->typing, callee, 1)
+    || !typing_proves_record(
+      c->typing, v->value.funccall.arguments.value, f->value.function.function.access.tag,
+      f->value.function.function.access.index))
+    return false;
+  *index = (int)f->value.function.function.access.index;
+  return true;
+}
+
+em_result
+compile_funccall(compiler_t * c, parser_expression_t * v, bool tail)
+{
+  em_result errres = EM_RESULT_OK;
+  int       arglen = 0;
+  int       index  = 0;
+  opcode_t  op     = tail && c->in_function ? OPCODE_TAIL_CALL : OPCODE_CALL;
+  if(v->value.funccall.arguments.value != nullptr)
+    CHKERR(compile_tuple_list_t(c, &(v->value.funccall.arguments), &arglen));
+  if(compiler_proves_access(c, v, &index)) return compiler_emit(c, OPCODE_TUPLE_ITH, index);
+  if(typing_proves_function(c->typing, v->value.funccall.callee, arglen))
+    op = op == OPCODE_CALL ? OPCODE_CALL_UNCHECKED : OPCODE_TAIL_CALL_UNCHECKED;
+  CHKERR(compile_mono(c, v->value.funccall.callee, false));
+  CHKERR(compiler_emit(c, op, arglen));
+err:
+  return errres;
+}
+
+em_result
+compile_func(compiler_t * c, parser_expression_t * v)
+{
+  em_result           errres = EM_RESULT_OK;
+  bytecode_constant_t k      = {.bytecode = nullptr};
+  CHKERR(compile_function2(c->machine, c, c->typing, c->owner, v, &(k.bytecode)));
+  CHKERR2(err2, compiler_emit_constant(c, OPCODE_CLOSURE, k));
+  return EM_RESULT_OK;
+err2:
+  bytecode_release(k.bytecode);
+err:
+  return errres;
+}
+
+// ! A position in the value matched by case/of. It is held in the slot of the frame.
+typedef struct compiler_occurrence_t
+{
+  // ! The occurrence of the tuple which has this, or -1 if this is the value itself.
+  int parent;
+  // ! The index in the tuple.
+  int index;
+  // ! The slot of the frame.
+  int slot;
+  // ! The first slot of elements, or -1 if this is never matched as a tuple.
+  int fields;
+  // ! The maximum arity of tuple patterns at this occurrence.
+  int width;
+} compiler_occurrence_t;
+
+// ! A variable which is bound by the branch of case/of.
+typedef struct compiler_case_binding_t
+{
+  // ! Index of the branch.
+  int branch;
+  // ! The occurrence to be bound.
+  int occurrence;
+  // ! The identifier.(It is owned by the AST.)
+  deconstructor_t * identifier;
+  // ! The slot of the variable table if captured, or -1.(The slot of the occurrence is used.)
+  int env_slot;
+  // ! Index of the constant of the identifier, or -1 if not added yet.
+  int32_t constant;
+} compiler_case_binding_t;
+
+// ! A matrix of patterns, which is compiled into the decision tree.
+typedef struct compiler_matrix_t
+{
+  // ! Occurrences of columns.
+  arraylist_t /*<int>*/ columns;
+  // ! Branches of rows. They are in the order of branches.
+  arraylist_t /*<int>*/ rows;
+  // ! Patterns of rows.(nullptr matches anything.)
+  arraylist_t /*<deconstructor_t *>*/ cells;
+} compiler_matrix_t;
+
+// ! The state of compile_case.
+typedef struct compiler_case_t
+{
+  // ! Branches.
+  arraylist_t /*<parser_branch_list_t *>*/ branches;
+  // ! Positions of compiled bodies of branches, or -1 if not compiled yet.
+  arraylist_t /*<int32_t>*/ bodies;
+  // ! Occurrences. The first one is the value itself.
+  arraylist_t /*<compiler_occurrence_t>*/ occurrences;
+  // ! Variables bound by branches.
+  arraylist_t /*<compiler_case_binding_t>*/ bindings;
+  // ! Jumps to the end of case/of.
+  arraylist_t /*<size_t>*/ ends;
+  // ! Bodies are in the tail position?
+  bool tail;
+} compiler_case_t;
+
+// ! Count of elements of the tuple pattern.
+static inline int
+deconstructor_arity(deconstructor_t * d)
+{
+  int ret = 0;
+  for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+    ret++;
+  return ret;
+}
+
+// ! Do both patterns test the same integer, or the same tag and arity?
+static bool
+deconstructor_same_head(deconstructor_t * a, deconstructor_t * b)
+{
+  if(a->kind != b->kind) return false;
+  if(a->kind == DECONSTRUCTOR_INTEGER) return a->value.integer == b->value.integer;
+  if(deconstructor_arity(a) != deconstructor_arity(b)) return false;
+  if(a->value.tuple.tag == nullptr || b->value.tuple.tag == nullptr)
+    return a->value.tuple.tag == b->value.tuple.tag;
+  return string_compare(a->value.tuple.tag, b->value.tuple.tag);
+}
+
+// ! Find the occurrence of the element of the tuple, or add it.
+em_result
+compiler_case_occurrence(compiler_case_t * cs, int parent, int index, int * out)
+{
+  compiler_occurrence_t * os = (compiler_occurrence_t *)cs->occurrences.buffer;
+  compiler_occurrence_t   o  = {.parent = parent, .index = index, .slot = -1, .fields = -1};
+  for(size_t i = 0; i < cs->occurrences.length; ++i)
+    if(os[i].parent == parent && os[i].index == index) {
+      *out = (int)i;
+      return EM_RESULT_OK;
+    }
+  o.width = 0;
+  *out    = (int)cs->occurrences.length;
+  return arraylist_append(&(cs->occurrences), sizeof(compiler_occurrence_t), &o);
+}
+
+// ! Collect occurrences and variables of the pattern of the branch.
+em_result
+compiler_case_scan(
+  compiler_t * c, compiler_case_t * cs, deconstructor_t * d, int occurrence, int branch)
+{
+  em_result               errres = EM_RESULT_OK;
+  int                     arity = 0, child = 0;
+  compiler_case_binding_t b;
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      b.branch     = branch;
+      b.occurrence = occurrence;
+      b.identifier = d;
+      b.env_slot   = -1;
+      b.constant   = -1;
+      if(compiler_is_captured(c, d)) {
+        TEST_AND_ERROR(c->env_size >= INSTRUCTION_OPERAND_HALF_MAX, EM_RESULT_OUT_OF_INDEX);
+        b.env_slot = c->env_size++;
+      }
+      CHKERR(arraylist_append(&(cs->bindings), sizeof(compiler_case_binding_t), &b));
+      break;
+    case DECONSTRUCTOR_TUPLE: {
+      compiler_occurrence_t * o;
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li), arity++) {
+        CHKERR(compiler_case_occurrence(cs, occurrence, arity, &child));
+        CHKERR(compiler_case_scan(c, cs, (deconstructor_t *)(&(li->value)), child, branch));
+      }
+      o = &(((compiler_occurrence_t *)cs->occurrences.buffer)[occurrence]);
+      if(o->width < arity) o->width = arity;
+      break;
+    }
+    case DECONSTRUCTOR_ANY:
+    case DECONSTRUCTOR_INTEGER:
+      break;
+    default:  // Floating is not supported, yet.
+      return EM_RESULT_INVALID_ARGUMENT;
+  }
+err:
+  return errres;
+}
+
+// ! Allocate slots of the frame for occurrences.
+/* !
+ * Elements of a tuple are placed in consecutive slots, so that OPCODE_SWITCH_TUPLE copies them.
+ */
+em_result
+compiler_case_allocate(compiler_t * c, compiler_case_t * cs)
+{
+  compiler_occurrence_t * os = (compiler_occurrence_t *)cs->occurrences.buffer;
+  // Parents are always before their elements.
+  for(size_t i = 0; i < cs->occurrences.length; ++i) {
+    os[i].slot = os[i].parent < 0 ? c->frame_size++ : os[os[i].parent].fields + os[i].index;
+    if(os[i].width > 0) {
+      os[i].fields = c->frame_size;
+      c->frame_size += os[i].width;
+    }
+  }
+  return c->frame_size > INSTRUCTION_OPERAND_HALF_MAX ? EM_RESULT_OUT_OF_INDEX : EM_RESULT_OK;
+}
+
+// ! Jump to the body of the branch. The body is compiled at the first time.
+em_result
+compiler_case_leaf(compiler_t * c, compiler_case_t * cs, int branch)
+{
+  em_result                 errres  = EM_RESULT_OK;
+  size_t                    visible = c->locals.length;
+  size_t                    end_at  = 0;
+  compiler_occurrence_t *   os      = (compiler_occurrence_t *)cs->occurrences.buffer;
+  compiler_case_binding_t * bs      = (compiler_case_binding_t *)cs->bindings.buffer;
+  int32_t *                 bodies  = (int32_t *)cs->bodies.buffer;
+  parser_branch_list_t *    bl      = ((parser_branch_list_t **)cs->branches.buffer)[branch];
+  compiler_local_t          l;
+  // Captured variables are copied to the variable table.
+  for(size_t i = 0; i < cs->bindings.length; ++i) {
+    bytecode_constant_t k = {.deconstructor = bs[i].identifier};
+    if(bs[i].branch != branch || bs[i].env_slot < 0) continue;
+    if(bs[i].constant < 0) CHKERR(compiler_add_constant(c, k, &(bs[i].constant)));
+    CHKERR(compiler_emit(c, OPCODE_LOAD_LOCAL, os[bs[i].occurrence].slot));
+    CHKERR(compiler_emit2(c, OPCODE_MATCH_ENV, bs[i].env_slot, bs[i].constant));
+  }
+  if(bodies[branch] >= 0) return compiler_emit(c, OPCODE_JUMP, bodies[branch]);
+  bodies[branch] = compiler_position(c);
+  for(size_t i = 0; i < cs->bindings.length; ++i) {
+    if(bs[i].branch != branch) continue;
+    l.name     = bs[i].identifier->value.identifier;
+    l.captured = bs[i].env_slot >= 0;
+    l.slot     = l.captured ? bs[i].env_slot : os[bs[i].occurrence].slot;
+    CHKERR(arraylist_append(&(c->locals), sizeof(compiler_local_t), &l));
+  }
+  CHKERR(compile_mono(c, bl->body, cs->tail));
+  end_at = compiler_position(c);
+  CHKERR(compiler_emit(c, OPCODE_JUMP, 0));
+  CHKERR(arraylist_append(&(cs->ends), sizeof(size_t), &end_at));
+err:
+  c->locals.length = visible;
+  return errres;
+}
+
+// ! Construct an empty matrix.
+static inline void
+compiler_matrix_new(compiler_matrix_t * out)
+{
+  arraylist_default(&(out->columns));
+  arraylist_default(&(out->rows));
+  arraylist_default(&(out->cells));
+}
+
+// ! Free the matrix.
+static inline void
+compiler_matrix_free(compiler_matrix_t * mx)
+{
+  arraylist_free(&(mx->columns));
+  arraylist_free(&(mx->rows));
+  arraylist_free(&(mx->cells));
+}
+
+// ! Append the pattern to the row of the matrix. Irrefutable patterns are nullptr.
+static inline em_result
+compiler_matrix_append(compiler_matrix_t * mx, deconstructor_t * d)
+{
+  if(d != nullptr && deconstructor_is_irrefutable(d)) d = nullptr;
+  return arraylist_append(&(mx->cells), sizeof(deconstructor_t *), &d);
+}
+
+// ! Specialize the matrix by the pattern of the column.
+/* !
+ * \param cs The state
+ * \param mx The matrix
+ * \param column The column
+ * \param head The pattern, or nullptr to make the matrix of rows which do not test the column.
+ * \param out The result
+ * \param fields The result, whether any row refers elements of the tuple.(Nullable)
+ * \return The status code
+ */
+em_result
+compiler_matrix_specialize(
+  compiler_case_t * cs, compiler_matrix_t * mx, int column, deconstructor_t * head,
+  compiler_matrix_t * out, bool * fields)
+{
+  em_result          errres = EM_RESULT_OK;
+  int                width  = (int)mx->columns.length;
+  int *              cols   = (int *)mx->columns.buffer;
+  deconstructor_t ** cells  = (deconstructor_t **)mx->cells.buffer;
+  int                arity  = 0;
+  if(head != nullptr && head->kind == DECONSTRUCTOR_TUPLE) arity = deconstructor_arity(head);
+  compiler_matrix_new(out);
+  for(int j = 0; j < width; ++j) {
+    if(j != column) {
+      CHKERR(arraylist_append(&(out->columns), sizeof(int), &(cols[j])));
+      continue;
+    }
+    for(int i = 0, child = 0; i < arity; ++i) {
+      CHKERR(compiler_case_occurrence(cs, cols[column], i, &child));
+      CHKERR(arraylist_append(&(out->columns), sizeof(int), &child));
+    }
+  }
+  for(size_t r = 0; r < mx->rows.length; ++r) {
+    deconstructor_t ** row = cells + r * width;
+    deconstructor_t *  p   = row[column];
+    if(p != nullptr && (head == nullptr || !deconstructor_same_head(p, head))) continue;
+    CHKERR(arraylist_append(&(out->rows), sizeof(int), &(((int *)mx->rows.buffer)[r])));
+    for(int j = 0; j < width; ++j) {
+      if(j != column) {
+        CHKERR(compiler_matrix_append(out, row[j]));
+      } else if(p == nullptr) {
+        for(int i = 0; i < arity; ++i)
+          CHKERR(compiler_matrix_append(out, nullptr));
+      } else if(arity > 0) {
+        for(list_t * li = p->value.tuple.data; li != nullptr; li = LIST_NEXT(li)) {
+          deconstructor_t * d = (deconstructor_t *)(&(li->value));
+          if(d->kind != DECONSTRUCTOR_ANY && fields != nullptr) *fields = true;
+          CHKERR(compiler_matrix_append(out, d));
+        }
+      }
+    }
+  }
+err:
+  return errres;
+}
+
+// ! Add the jump table of OPCODE_SWITCH_INT or OPCODE_SWITCH_TUPLE. Targets are filled later.
+em_result
+compiler_add_switch(
+  compiler_t * c, int slot, deconstructor_t ** heads, int length, bool tuple, int32_t * out)
+{
+  em_result           errres = EM_RESULT_OK;
+  int32_t             index  = 0;
+  bytecode_constant_t k      = {.integer = slot};
+  CHKERR(compiler_add_constant(c, k, out));
+  k.integer = length;
+  CHKERR(compiler_add_constant(c, k, &index));
+  k.integer = 0;  // Otherwise
+  CHKERR(compiler_add_constant(c, k, &index));
+  for(int i = 0; i < length; ++i) {
+    k.integer = tuple ? deconstructor_arity(heads[i]) : heads[i]->value.integer;
+    CHKERR(compiler_add_constant(c, k, &index));
+    if(tuple) {
+      CHKERR(record_table_resolve(heads[i], &(k.integer)));
+      CHKERR(compiler_add_constant(c, k, &index));
+    }
+    k.integer = 0;  // Target
+    CHKERR(compiler_add_constant(c, k, &index));
+    if(tuple) {
+      k.integer = -1;  // The first slot
+      CHKERR(compiler_add_constant(c, k, &index));
+    }
+  }
+err:
+  return errres;
+}
+
+// ! Set the item of the jump table.
+static inline void
+compiler_set_switch(compiler_t * c, int32_t table, int item, int32_t v)
+{
+  ((bytecode_constant_t *)c->constants.buffer)[table + item].integer = v;
+}
+
+// ! Compile the matrix into the decision tree.
+/* !
+ * The first row which tests something decides the column to be switched. Each case of the switch
+ * continues with rows which match the case, and the otherwise continues with rows which do not
+ * test the column. The order of rows is kept, so that the former branch has priority.
+ * \param c The compiler
+ * \param cs The state
+ * \param mx The matrix
+ * \return The status code
+ */
+em_result
+compile_decision(compiler_t * c, compiler_case_t * cs, compiler_matrix_t * mx)
+{
+  em_result          errres = EM_RESULT_OK;
+  int                width = (int)mx->columns.length, column = 0;
+  int                ints = 0, length = 0, slot = 0, first = 0;
+  int32_t            int_table = -1, tuple_table = -1;
+  size_t             end_at = 0;
+  deconstructor_t ** cells  = (deconstructor_t **)mx->cells.buffer;
+  compiler_matrix_t  sub;
+  arraylist_t /*<deconstructor_t *>*/ heads;
+  arraylist_default(&heads);
+  compiler_matrix_new(&sub);
+  if(mx->rows.length == 0) {  // Nothing matches.
+    CHKERR(compiler_emit(c, OPCODE_PUSH_NIL, 0));
+    end_at = compiler_position(c);
+    CHKERR(compiler_emit(c, OPCODE_JUMP, 0));
+    CHKERR(arraylist_append(&(cs->ends), sizeof(size_t), &end_at));
+    goto err;
+  }
+  while(column < width && cells[column] == nullptr)
+    column++;
+  if(column == width) {  // The first row matches.
+    CHKERR(compiler_case_leaf(c, cs, ((int *)mx->rows.buffer)[0]));
+    goto err;
+  }
+  {
+    compiler_occurrence_t * os = (compiler_occurrence_t *)cs->occurrences.buffer;
+    slot                       = os[((int *)mx->columns.buffer)[column]].slot;
+    first                      = os[((int *)mx->columns.buffer)[column]].fields;
+  }
+  // Collect patterns of the column. Integers are sorted, and followed by tuples.
+  for(size_t r = 0; r < mx->rows.length; ++r) {
+    deconstructor_t *  p  = cells[r * width + column];
+    deconstructor_t ** hs = (deconstructor_t **)heads.buffer;
+    int                i  = 0;
+    if(p == nullptr) continue;
+    for(i = 0; i < length && !deconstructor_same_head(hs[i], p); ++i)
+      ;
+    if(i < length) continue;  // Already collected.
+    if(p->kind == DECONSTRUCTOR_INTEGER) {
+      for(i = ints; i > 0 && hs[i - 1]->value.integer > p->value.integer; --i)
+        ;
+      CHKERR(arraylist_insert(&heads, i, sizeof(deconstructor_t *), &p));
+      ints++;
+    } else {
+      CHKERR(arraylist_append(&heads, sizeof(deconstructor_t *), &p));
+    }
+    length++;
+  }
+  if(ints > 0) {
+    CHKERR(compiler_add_switch(c, slot, (deconstructor_t **)heads.buffer, ints, false, &int_table));
+    CHKERR(compiler_emit(c, OPCODE_SWITCH_INT, int_table));
+  }
+  if(length > ints) {
+    if(int_table >= 0)
+      compiler_set_switch(c, int_table, BYTECODE_SWITCH_OTHERWISE, compiler_position(c));
+    CHKERR(compiler_add_switch(
+      c, slot, (deconstructor_t **)heads.buffer + ints, length - ints, true, &tuple_table));
+    CHKERR(compiler_emit(c, OPCODE_SWITCH_TUPLE, tuple_table));
+  }
+  for(int i = 0; i < length; ++i) {
+    deconstructor_t * h      = ((deconstructor_t **)heads.buffer)[i];
+    bool              fields = false;
+    int32_t           item   = 0;
+    CHKERR(compiler_matrix_specialize(cs, mx, column, h, &sub, &fields));
+    if(i < ints) {
+      item = BYTECODE_SWITCH_CASES + i * BYTECODE_SWITCH_INT_CASE_SIZE;
+      compiler_set_switch(c, int_table, item + 1, compiler_position(c));
+    } else {
+      item = BYTECODE_SWITCH_CASES + (i - ints) * BYTECODE_SWITCH_TUPLE_CASE_SIZE;
+      compiler_set_switch(c, tuple_table, item + 2, compiler_position(c));
+      // Elements are copied only if they are referred.
+      if(fields) compiler_set_switch(c, tuple_table, item + 3, first);
+    }
+    CHKERR(compile_decision(c, cs, &sub));
+    compiler_matrix_free(&sub);
+  }
+  compiler_set_switch(
+    c, tuple_table >= 0 ? tuple_table : int_table, BYTECODE_SWITCH_OTHERWISE, compiler_position(c));
+  CHKERR(compiler_matrix_specialize(cs, mx, column, nullptr, &sub, nullptr));
+  CHKERR(compile_decision(c, cs, &sub));
+err:
+  compiler_matrix_free(&sub);
+  arraylist_free(&heads);
+  return errres;
+}
+
+em_result
+compile_case(compiler_t * c, parser_expression_t * v, bool tail)
+{
+  em_result         errres = EM_RESULT_OK;
+  int32_t           none   = -1;
+  int               branch = 0, root = 0;
+  compiler_case_t   cs;
+  compiler_matrix_t mx;
+  cs.tail = tail;
+  arraylist_default(&(cs.branches));
+  arraylist_default(&(cs.bodies));
+  arraylist_default(&(cs.occurrences));
+  arraylist_default(&(cs.bindings));
+  arraylist_default(&(cs.ends));
+  compiler_matrix_new(&mx);
+  CHKERR(compiler_case_occurrence(&cs, -1, 0, &root));
+  CHKERR(arraylist_append(&(mx.columns), sizeof(int), &root));
+  for(parser_branch_list_t * bl = v->value.caseof.branches; bl != nullptr;
+      bl                        = bl->next, branch++) {
+    CHKERR(compiler_case_scan(c, &cs, bl->deconstruct, root, branch));
+    CHKERR(arraylist_append(&(cs.branches), sizeof(parser_branch_list_t *), &bl));
+    CHKERR(arraylist_append(&(cs.bodies), sizeof(int32_t), &none));
+    CHKERR(arraylist_append(&(mx.rows), sizeof(int), &branch));
+    CHKERR(compiler_matrix_append(&mx, bl->deconstruct));
+    // Following branches are never reached.
+    if(deconstructor_is_irrefutable(bl->deconstruct)) break;
+  }
+  CHKERR(compiler_case_allocate(c, &cs));
+  CHKERR(compile_mono(c, v->value.caseof.of, false));
+  CHKERR(compiler_emit(
+    c, OPCODE_STORE_LOCAL, ((compiler_occurrence_t *)cs.occurrences.buffer)[root].slot));
+  CHKERR(compile_decision(c, &cs, &mx));
+  for(size_t i = 0; i < cs.ends.length; ++i)
+    compiler_patch_jump(c, ((size_t *)cs.ends.buffer)[i]);
+err:
+  compiler_matrix_free(&mx);
+  arraylist_free(&(cs.branches));
+  arraylist_free(&(cs.bodies));
+  arraylist_free(&(cs.occurrences));
+  arraylist_free(&(cs.bindings));
+  arraylist_free(&(cs.ends));
+  return errres;
+}
+
+em_result
+compile_begin(compiler_t * c, parser_expression_t * v, bool tail)
+{
+  em_result              errres  = EM_RESULT_OK;
+  size_t                 visible = c->locals.length;
+  parser_branch_list_t * bl      = v->value.begin.branches;
+  if(bl == nullptr) return compiler_emit(c, OPCODE_PUSH_NIL, 0);
+  for(; bl->next != nullptr; bl = bl->next) {
+    CHKERR(compile_mono(c, bl->body, false));
+    if(bl->deconstruct == nullptr) {
+      CHKERR(compiler_emit(c, OPCODE_POP, 0));
+    } else {
+      CHKERR(compile_match(c, bl->deconstruct));
+    }
+  }
+  CHKERR(compile_mono(c, bl->body, tail));
+  c->locals.length = visible;
+err:
+  return errres;
+}
+
+em_result
+compile_mono(compiler_t * c, parser_expression_t * v, bool tail)
+{
+  object_t * k;
+  if(compiler_fold(c, v, &k))  // Including literals.
+    return compile_immediate(c, k);
+  else if(EXPR_KIND_IS_BIN_OP(v))
+    return compile_binary(c, v);
+  switch(v->kind) {
+    case EXPR_KIND_IDENTIFIER:
+      return compile_identifier(c, v);
+    case EXPR_KIND_LAST_IDENTIFIER:
+      return compile_last_identifier(c, v);
+    case EXPR_KIND_IF:
+      return compile_if(c, v, tail);
+    case EXPR_KIND_TUPLE: {
+      em_result errres = EM_RESULT_OK;
+      int       len    = 0;
+      CHKERR(compile_tuple_list_t(c, &(v->value.tuple), &len));
+      return compiler_emit(c, OPCODE_TUPLE, len);
+err:
+      return errres;
+    }
+    case EXPR_KIND_FUNCCALL:
+      return compile_funccall(c, v, tail);
+    case EXPR_KIND_FUNCTION:
+      return compile_func(c, v);
+    case EXPR_KIND_BEGIN:
+      return compile_begin(c, v, tail);
+    case EXPR_KIND_CASE:
+      return compile_case(c, v, tail);
+    default:  // Floating is not supported, yet.
+      return EM_RESULT_INVALID_ARGUMENT;
+  }
+}
+
+// ! Construct bytecode_t from the compiler state. The buffers are shrinked and moved.
+em_result
+compiler_finish(compiler_t * c, parser_expression_t * source, int arity, bytecode_t ** out)
+{
+  em_result    errres = EM_RESULT_OK;
+  bytecode_t * ret    = nullptr;
+  CHKERR(em_reallocarray(&(c->code.buffer), c->code.buffer, c->code.length, sizeof(instruction_t)));
+  c->code.capacity = c->code.length;
+  if(c->constants.length > 0) {
+    CHKERR(em_reallocarray(
+      &(c->constants.buffer), c->constants.buffer, c->constants.length,
+      sizeof(bytecode_constant_t)));
+    c->constants.capacity = c->constants.length;
+  }
+  CHKERR(em_malloc((void **)&ret, sizeof(bytecode_t)));
+  ret->reference_count  = 1;
+  ret->code             = (instruction_t *)c->code.buffer;
+  ret->length           = c->code.length;
+  ret->constants        = (bytecode_constant_t *)c->constants.buffer;
+  ret->constants_length = c->constants.length;
+  ret->source           = source;
+  ret->arity            = arity;
+  ret->frame_size       = c->frame_size;
+  ret->env_size         = c->env_size;
+  // compiler_resolve counts this table even if the captured variables are in folded branches.
+  if(ret->env_size == 0 && c->captured.length > 0) ret->env_size = 1;
+  arraylist_default(&(c->code));
+  arraylist_default(&(c->constants));
+  *out = ret;
+err:
+  return errres;
+}
+
+// ! Freeing the compiler state, releasing nested functions.
+void
+compiler_free(compiler_t * c)
+{
+  instruction_t *       code      = (instruction_t *)c->code.buffer;
+  bytecode_constant_t * constants = (bytecode_constant_t *)c->constants.buffer;
+  if(code != nullptr && constants != nullptr)
+    for(size_t i = 0; i < c->code.length; ++i)
+      if(INSTRUCTION_OPCODE(code[i]) == OPCODE_CLOSURE)
+        bytecode_release(constants[INSTRUCTION_OPERAND(code[i])].bytecode);
+  arraylist_free(&(c->code));
+  arraylist_free(&(c->constants));
+  arraylist_free(&(c->locals));
+  arraylist_free(&(c->captured));
+}
+
+// ! Construct the compiler state.
+static inline void
+compiler_new(compiler_t * out, machine_t * m, compiler_t * parent, bool in_function)
+{
+  out->machine     = m;
+  out->parent      = parent;
+  out->frame_size  = 0;
+  out->env_size    = 0;
+  out->in_function = in_function;
+  out->owner       = parent == nullptr ? nullptr : parent->owner;
+  out->typing      = nullptr;
+  arraylist_default(&(out->code));
+  arraylist_default(&(out->constants));
+  arraylist_default(&(out->locals));
+  arraylist_default(&(out->captured));
+}
+
+// ! Infer types of the definition to be compiled.
+/* !
+ * Ill-typed definitions are rejected. But definitions compiled again(machine_t::recompiling) were
+ * accepted before, so that they are compiled with runtime type checks.
+ * \param m The machine
+ * \param t The state of the type inference, which must be freed by the caller.
+ * \param v The expression, or the function of func.
+ * \param owner The definition to be compiled.(Nullable, if the code is executed only once.)
+ * \param out The result, nullptr if types are not used.
+ * \return The status code
+ */
+static em_result
+compiler_infer(
+  machine_t * m, typing_t * t, parser_expression_t * v, const variable_dependent_t * owner,
+  typing_t ** out)
+{
+  em_result errres = EM_RESULT_OK;
+  typing_new(t, m, owner);
+  *out   = t;
+  errres = typing_infer(t, v);
+  if(errres != EM_RESULT_TYPE_MISMATCH) return errres;
+  *out = nullptr;
+  if(!m->recompiling) {
+    EM_DIAG(EM_DIAG_LEVEL_ERROR, typing_print_error(t));
+    return errres;
+  }
+  EM_DIAG(EM_DIAG_LEVEL_WARNING, typing_print_error(t));
+  return EM_RESULT_OK;
+}
+
+em_result
+compile_expression(
+  machine_t * m, parser_expression_t * v, const variable_dependent_t * owner, bytecode_t ** out)
+{
+  em_result  errres = EM_RESULT_OK;
+  compiler_t c;
+  typing_t   t;
+  arraylist_t /*<compiler_binding_t>*/ scope;
+  compiler_new(&c, m, nullptr, false);
+  c.owner = owner;
+  arraylist_default(&scope);
+  CHKERR(compiler_infer(m, &t, v, owner, &(c.typing)));
+  CHKERR(compiler_analyze(&c, &scope, v, 0));
+  CHKERR(compile_mono(&c, v, false));
+  CHKERR(compiler_emit(&c, OPCODE_RETURN, 0));
+  CHKERR(compiler_finish(&c, nullptr, 0, out));
+err:
+  arraylist_free(&scope);
+  compiler_free(&c);
+  typing_free(&t);
+  return errres;
+}
+
+em_result
+compile_function2(
+  machine_t * m, compiler_t * parent, typing_t * typing, const variable_dependent_t * owner,
+  parser_expression_t * f, bytecode_t ** out)
+{
+  em_result  errres = EM_RESULT_OK;
+  compiler_t c;
+  arraylist_t /*<compiler_binding_t>*/ scope;
+  int                                  arity = 0;
+  compiler_new(&c, m, parent, true);
+  c.typing = typing;
+  c.owner  = owner;
+  arraylist_default(&scope);
+  TEST_AND_ERROR(f->kind != EXPR_KIND_FUNCTION, EM_RESULT_INVALID_ARGUMENT);
+  for(list_t * li = f->value.function.arguments; li != nullptr; li = LIST_NEXT(li), arity++)
+    CHKERR(compiler_analyze_bind(&scope, (deconstructor_t *)(&(li->value)), 0));
+  CHKERR(compiler_analyze(&c, &scope, f->value.function.body, 0));
+  // The frame starts with [arguments..., callee, the caller's variable table].
+  c.frame_size = arity + 2;
+  arity        = 0;
+  for(list_t * li = f->value.function.arguments; li != nullptr; li = LIST_NEXT(li), arity++) {
+    deconstructor_t * d = (deconstructor_t *)(&(li->value));
+    if(typing_guards_int(c.typing, d)) CHKERR(compiler_emit(&c, OPCODE_GUARD_INT, arity));
+    if(d->kind == DECONSTRUCTOR_IDENTIFIER && !compiler_is_captured(&c, d)) {
+      // The argument itself is the local variable.
+      compiler_local_t l = {.name = d->value.identifier, .slot = arity, .captured = false};
+      CHKERR(arraylist_append(&(c.locals), sizeof(compiler_local_t), &l));
+    } else if(d->kind != DECONSTRUCTOR_ANY) {
+      CHKERR(compiler_emit(&c, OPCODE_LOAD_LOCAL, arity));
+      CHKERR(compile_match(&c, d));
+    }
+  }
+  CHKERR(compile_mono(&c, f->value.function.body, true));
+  CHKERR(compiler_emit(&c, OPCODE_RETURN, 0));
+  CHKERR(compiler_finish(&c, f, arity, out));
+  if(f->value.function.owner != nullptr) parser_toplevel_retain(f->value.function.owner);
+err:
+  arraylist_free(&scope);
+  compiler_free(&c);
+  return errres;
+}
+
+em_result
+compile_function(machine_t * m, parser_expression_t * f, bytecode_t ** out)
+{
+  em_result                    errres = EM_RESULT_OK;
+  typing_t                     t;
+  typing_t *                   typing = nullptr;
+  parser_toplevel_t *          prog   = f->value.function.owner;
+  variable_dependent_t         owner  = {.name = nullptr, .node = false};
+  const variable_dependent_t * o      = nullptr;
+  // The function is recorded as the dependent by its name.
+  if(prog != nullptr && prog->kind == PARSER_TOPLEVEL_KIND_FUNC) {
+    errres = machine_intern(m, prog->value.func->name, &(owner.name));
+    if(errres != EM_RESULT_OK) return errres;
+    o = &owner;
+  }
+  CHKERR(compiler_infer(m, &t, f, o, &typing));
+  CHKERR(compile_function2(m, nullptr, typing, o, f, out));
+err:
+  typing_free(&t);
+  return errres;
+}
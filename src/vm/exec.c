@@ -2,49 +2,59 @@
  * @file   exec.c
  * @brief  Emfrp REPL Interpreter Implementation
  * @author Go Suzuki <puyogo.suzuki@gmail.com>
- * @date   2023/3/22
+ * @date   2026/10/17
  ------------------------------------------- */
 
 #include "vm/exec.h"
+#include "vm/compiler.h"
 
-typedef struct exec_result_t
+// ! A call frame.
+/* !
+ * The stack layout of a frame is [arguments..., callee, the caller's variable table, locals...].
+ * The callee and the variable table are kept on the stack only to be reached from GC.
+ */
+typedef struct exec_frame_t
 {
-  object_t * value;
-  enum
-  {
-    EXEC_RESULT_OBJECT,
-    EXEC_RESULT_EXECUTE_FUNCTION
-  } kind;
-  stack_state_t stack_state;
-  stack_state_t arglen;
-} exec_result_t;
+  // ! The caller's code.
+  bytecode_t * code;
+  // ! The return address.
+  instruction_t * pc;
+  // ! The caller's frame base.
+  stack_state_t base;
+  // ! The caller's variable table.
+  variable_table_t * variable_table;
+} exec_frame_t;
 
-typedef em_result (*executor)(machine_t * m, parser_expression_t * v, exec_result_t * out);
+// ! Count of frames which are held without malloc.
+#define EXEC_FRAME_INLINE_SIZE 8
 
-em_result exec_ast_mono(machine_t * m, parser_expression_t * v, exec_result_t * out);
+#define STACK_DATA(m)   ((m)->stack->value.stack.data)
+#define STACK_LENGTH(m) ((m)->stack->value.stack.length)
+#define STACK_TOP(m, i) (STACK_DATA(m)[STACK_LENGTH(m) - 1 - (i)])
 
 bool
 exec_equal(object_t * l, object_t * r)
 {
   bool b = true;
   if(l == r) return true;
+  if(l == nullptr || r == nullptr) return false;  // nil
   if(!object_is_pointer(l) || !object_is_pointer(r)) return false;
   if(object_kind(l) != object_kind(r)) return false;
   switch(object_kind(l)) {
     case EMFRP_OBJECT_TUPLE1:
-      return exec_equal(l->value.tuple1.tag, r->value.tuple1.tag)
+      return object_tuple_tag(l) == object_tuple_tag(r)
           && exec_equal(l->value.tuple1.i0, r->value.tuple1.i0);
     case EMFRP_OBJECT_TUPLE2:
-      return exec_equal(l->value.tuple2.tag, r->value.tuple2.tag)
+      return object_tuple_tag(l) == object_tuple_tag(r)
           && exec_equal(l->value.tuple2.i0, r->value.tuple2.i0)
           && exec_equal(l->value.tuple2.i1, r->value.tuple2.i1);
     case EMFRP_OBJECT_TUPLEN:
       if(
-        !exec_equal(l->value.tupleN.tag, r->value.tupleN.tag)
+        object_tuple_tag(l) != object_tuple_tag(r)
         || l->value.tupleN.length != r->value.tupleN.length)
         return false;
-      for(int i = 0; i < l->value.tupleN.length; ++i)
-        b &= exec_equal(l->value.tupleN.data[i], r->value.tupleN.data[i]);
+      for(int i = 0; i < l->value.tupleN.length && b; ++i)
+        b = exec_equal(l->value.tupleN.data[i], r->value.tupleN.data[i]);
       return b;
     case EMFRP_OBJECT_SYMBOL:
     case EMFRP_OBJECT_STRING:
@@ -57,136 +67,12 @@ exec_equal(object_t * l, object_t * r)
   }
 }
 
-#define BIN_OP_NUM_NUM_NUM_FUNC(func_name, expression)                                             \
-  em_result func_name(machine_t * m, parser_expression_t * v, exec_result_t * out)                 \
-  {                                                                                                \
-    object_t *lro = nullptr, *rro = nullptr;                                                       \
-    em_result errres = EM_RESULT_OK;                                                               \
-    int       ll, rr;                                                                              \
-    CHKERR(exec_ast(m, v->value.binary.lhs, &lro));                                                \
-    TEST_AND_ERROR(!object_is_integer(lro), EM_RESULT_TYPE_MISMATCH);                              \
-    CHKERR(exec_ast(m, v->value.binary.rhs, &rro));                                                \
-    TEST_AND_ERROR(!object_is_integer(rro), EM_RESULT_TYPE_MISMATCH);                              \
-    ll = object_get_integer(lro);                                                                  \
-    rr = object_get_integer(rro);                                                                  \
-    object_new_int(&(out->value), expression);                                                     \
-err:                                                                                               \
-    return errres;                                                                                 \
-  }
-
-#define BIN_OP_NUM_NUM_BOOL_FUNC(func_name, expression)                                            \
-  em_result func_name(machine_t * m, parser_expression_t * v, exec_result_t * out)                 \
-  {                                                                                                \
-    object_t *lro = nullptr, *rro = nullptr;                                                       \
-    em_result errres = EM_RESULT_OK;                                                               \
-    int       ll, rr;                                                                              \
-    CHKERR(exec_ast(m, v->value.binary.lhs, &lro));                                                \
-    TEST_AND_ERROR(!object_is_integer(lro), EM_RESULT_TYPE_MISMATCH);                              \
-    CHKERR(exec_ast(m, v->value.binary.rhs, &rro));                                                \
-    TEST_AND_ERROR(!object_is_integer(rro), EM_RESULT_TYPE_MISMATCH);                              \
-    ll         = object_get_integer(lro);                                                          \
-    rr         = object_get_integer(rro);                                                          \
-    out->value = (expression) ? &object_true : &object_false;                                      \
-err:                                                                                               \
-    return errres;                                                                                 \
-  }
-
-BIN_OP_NUM_NUM_NUM_FUNC(exec_ast_addition, ll + rr);
-BIN_OP_NUM_NUM_NUM_FUNC(exec_ast_subtract, ll - rr);
-BIN_OP_NUM_NUM_NUM_FUNC(exec_ast_division, ll / rr);
-BIN_OP_NUM_NUM_NUM_FUNC(exec_ast_multiplication, ll * rr);
-BIN_OP_NUM_NUM_NUM_FUNC(exec_ast_modulo, ll % rr);
-BIN_OP_NUM_NUM_NUM_FUNC(exec_ast_right_shift, ll >> rr);
-BIN_OP_NUM_NUM_NUM_FUNC(exec_ast_left_shift, ll << rr);
-BIN_OP_NUM_NUM_BOOL_FUNC(exec_ast_less_or_equal, ll <= rr);
-BIN_OP_NUM_NUM_BOOL_FUNC(exec_ast_less_than, ll < rr);
-BIN_OP_NUM_NUM_BOOL_FUNC(exec_ast_greater_or_equal, ll >= rr);
-BIN_OP_NUM_NUM_BOOL_FUNC(exec_ast_greater_than, ll > rr);
-
-em_result
-exec_ast_equal(machine_t * m, parser_expression_t * v, exec_result_t * out)
-{
-  object_t *lro = nullptr, *rro = nullptr;
-  em_result errres = EM_RESULT_OK;
-  CHKERR(exec_ast(m, v->value.binary.lhs, &lro));
-  CHKERR(machine_push(m, lro));
-  CHKERR(exec_ast(m, v->value.binary.rhs, &rro));
-  out->value = exec_equal(lro, rro) ? &object_true : &object_false;
-err:
-  return errres;
-}
-
 em_result
-exec_ast_not_equal(machine_t * m, parser_expression_t * v, exec_result_t * out)
-{
-  object_t *lro = nullptr, *rro = nullptr;
-  em_result errres = EM_RESULT_OK;
-  CHKERR(exec_ast(m, v->value.binary.lhs, &lro));
-  CHKERR(machine_push(m, lro));
-  CHKERR(exec_ast(m, v->value.binary.rhs, &rro));
-  out->value = exec_equal(lro, rro) ? &object_false : &object_true;
-err:
-  return errres;
-}
-
-#define BIN_OP_BOOL_BOOL_BOOL_FUNC(func_name, expression)                                          \
-  em_result func_name(machine_t * m, parser_expression_t * v, exec_result_t * out)                 \
-  {                                                                                                \
-    object_t *lro = nullptr, *rro = nullptr;                                                       \
-    em_result errres = EM_RESULT_OK;                                                               \
-    CHKERR(exec_ast(m, v->value.binary.lhs, &lro));                                                \
-    CHKERR(machine_push(m, lro));                                                                  \
-    CHKERR(exec_ast(m, v->value.binary.rhs, &rro));                                                \
-    out->value = (expression) ? &object_true : &object_false;                                      \
-err:                                                                                               \
-    return errres;                                                                                 \
-  }
-
-#define BIN_OP_BOOL_BOOL_BOOL_FUNC2(func_name, expression_short, expression)                       \
-  em_result func_name(machine_t * m, parser_expression_t * v, exec_result_t * out)                 \
-  {                                                                                                \
-    object_t *lro = nullptr, *rro = nullptr;                                                       \
-    em_result errres = EM_RESULT_OK;                                                               \
-    CHKERR(exec_ast(m, v->value.binary.lhs, &lro));                                                \
-    if(expression_short) {                                                                         \
-      out->value = lro;                                                                            \
-      return EM_RESULT_OK;                                                                         \
-    }                                                                                              \
-    CHKERR(machine_push(m, lro));                                                                  \
-    CHKERR(exec_ast(m, v->value.binary.rhs, &rro));                                                \
-    out->value = (expression) ? &object_true : &object_false;                                      \
-err:                                                                                               \
-    return errres;                                                                                 \
-  }
-
-BIN_OP_BOOL_BOOL_BOOL_FUNC(exec_ast_and, (lro != &object_false) && (rro != &object_false));
-BIN_OP_BOOL_BOOL_BOOL_FUNC(exec_ast_or, (lro != &object_false) || (rro != &object_false));
-BIN_OP_BOOL_BOOL_BOOL_FUNC(exec_ast_xor, (lro != &object_false) ^ (rro != &object_false));
-BIN_OP_BOOL_BOOL_BOOL_FUNC2(exec_ast_dand, lro == &object_false, rro != &object_false);
-BIN_OP_BOOL_BOOL_BOOL_FUNC2(exec_ast_dor, lro != &object_false, rro != &object_false);
-
-em_result
-exec_ast_tuple_list_t(machine_t * m, parser_expression_tuple_list_t * li, int * length)
-{
-  em_result errres = EM_RESULT_OK;
-  int       len    = 0;
-  *length          = 0;
-  for(; li != nullptr; li = LIST_NEXT(li)) {
-    object_t * cur = nullptr;
-    len++;
-    CHKERR(exec_ast(m, li->value, &cur));
-    CHKERR(machine_push(m, cur));
-  }
-  *length = len;
-err:
-  return errres;
-}
-
-em_result
-exec_ast_construct_tuple(machine_t * m, object_t * tag, int len, object_t ** buf, object_t ** out)
+exec_construct_tuple(machine_t * m, record_tag_t tag, int len, object_t ** buf, object_t ** out)
 {
   if(len == 0) {
-    *out = tag;
+    *out = nullptr;
+    if(tag != RECORD_TAG_NONE) return object_new_tag(out, tag);
     return EM_RESULT_OK;
   } else {
     em_result  errres = EM_RESULT_OK;
@@ -194,15 +80,13 @@ exec_ast_construct_tuple(machine_t * m, object_t * tag, int len, object_t ** buf
     CHKERR(machine_alloc(m, &ret));
     if(len == 1) {
       CHKERR(object_new_tuple1(ret, buf[0]));
-      ret->value.tuple1.tag = tag;
     } else if(len == 2) {
       CHKERR(object_new_tuple2(ret, buf[0], buf[1]));
-      ret->value.tuple2.tag = tag;
     } else if(len >= 3) {
       CHKERR(object_new_tupleN(ret, len));
       memcpy(ret->value.tupleN.data, buf, len * sizeof(object_t *));
-      ret->value.tupleN.tag = tag;
     }
+    object_set_tuple_tag(ret, tag);
     *out = ret;
     return EM_RESULT_OK;
 err:
@@ -211,86 +95,168 @@ err:
   }
 }
 
-em_result
-exec_ast_tuple(machine_t * m, parser_expression_t * v, exec_result_t * out)
+// ! Drop n values from the stack.
+static inline em_result
+exec_drop(machine_t * m, size_t n)
+{
+  return machine_restore_stack_state(m, STACK_LENGTH(m) - n);
+}
+
+// ! Replace the top of the stack.
+static inline em_result
+exec_replace_top(machine_t * m, object_t * v)
+{
+  em_result errres = machine_mark_gray(m, STACK_TOP(m, 0));
+  STACK_TOP(m, 0)  = v;
+  return errres;
+}
+
+// ! Get the element of the tuple, which is proven to have it.(See OPCODE_TUPLE_ITH.)
+static inline object_t *
+exec_tuple_ith(object_t * t, int i)
+{
+  switch(object_kind(t)) {
+    case EMFRP_OBJECT_TUPLE1:
+      return t->value.tuple1.i0;
+    case EMFRP_OBJECT_TUPLE2:
+      return i == 0 ? t->value.tuple2.i0 : t->value.tuple2.i1;
+    default:
+      return object_tuple_ith(t, i);
+  }
+}
+
+// ! Lookup the jump table of OPCODE_SWITCH_INT.
+/* !
+ * \param table The jump table
+ * \param frame The frame
+ * \return The target
+ */
+static int32_t
+exec_switch_int(bytecode_constant_t * table, object_t ** frame)
+{
+  object_t *            v     = frame[table[BYTECODE_SWITCH_SLOT].integer];
+  bytecode_constant_t * cases = table + BYTECODE_SWITCH_CASES;
+  int32_t               low = 0, high = table[BYTECODE_SWITCH_LENGTH].integer, key;
+  if(!object_is_integer(v)) return table[BYTECODE_SWITCH_OTHERWISE].integer;
+  key = object_get_integer(v);
+  if(cases[(high - 1) * BYTECODE_SWITCH_INT_CASE_SIZE].integer - cases[0].integer == high - 1) {
+    // Cases are dense.
+    low = key - cases[0].integer;
+    if(low >= 0 && low < high) return cases[low * BYTECODE_SWITCH_INT_CASE_SIZE + 1].integer;
+    return table[BYTECODE_SWITCH_OTHERWISE].integer;
+  }
+  while(low < high) {
+    int32_t mid = (low + high) / 2, k = cases[mid * BYTECODE_SWITCH_INT_CASE_SIZE].integer;
+    if(k == key) return cases[mid * BYTECODE_SWITCH_INT_CASE_SIZE + 1].integer;
+    if(k < key)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return table[BYTECODE_SWITCH_OTHERWISE].integer;
+}
+
+// ! Lookup the jump table of OPCODE_SWITCH_TUPLE, and copy elements of the matched tuple.
+/* !
+ * \param m The machine
+ * \param table The jump table
+ * \param frame The frame
+ * \param out The target
+ * \return The status code
+ */
+static em_result
+exec_switch_tuple(machine_t * m, bytecode_constant_t * table, object_t ** frame, int32_t * out)
 {
-  em_result     errres = EM_RESULT_OK;
-  stack_state_t state  = MACHINE_STACK_STATE_DEFAULT;
-  int           len    = 0;
-  CHKERR(machine_get_stack_state(m, &state));
-  CHKERR(exec_ast_tuple_list_t(m, &(v->value.tuple), &len));
-  CHKERR(exec_ast_construct_tuple(
-    m, nullptr, len, &(m->stack->value.tupleN.data[state]), &(out->value)));
+  em_result             errres = EM_RESULT_OK;
+  object_t *            v      = frame[table[BYTECODE_SWITCH_SLOT].integer];
+  bytecode_constant_t * cases  = table + BYTECODE_SWITCH_CASES;
+  record_tag_t          tag    = RECORD_TAG_NONE;
+  object_t **           data   = nullptr;
+  int32_t               arity  = 0;
+  *out                         = table[BYTECODE_SWITCH_OTHERWISE].integer;
+  if(v == nullptr) return EM_RESULT_OK;
+  if(object_is_tag(v))
+    tag = object_get_tag(v);
+  else if(!object_is_pointer(v))
+    return EM_RESULT_OK;
+  else {
+    switch(object_kind(v)) {
+      case EMFRP_OBJECT_TUPLE1:
+        data  = &(v->value.tuple1.i0);
+        arity = 1;
+        break;
+      case EMFRP_OBJECT_TUPLE2:
+        data  = &(v->value.tuple2.i0);
+        arity = 2;
+        break;
+      case EMFRP_OBJECT_TUPLEN:
+        data  = v->value.tupleN.data;
+        arity = v->value.tupleN.length;
+        break;
+      default:
+        return EM_RESULT_OK;
+    }
+    tag = object_tuple_tag(v);
+  }
+  for(int i = 0; i < table[BYTECODE_SWITCH_LENGTH].integer;
+      ++i, cases += BYTECODE_SWITCH_TUPLE_CASE_SIZE) {
+    if(cases[0].integer != arity) continue;
+    if(cases[1].integer != tag) continue;
+    for(int j = 0, first = cases[3].integer; first >= 0 && j < arity; ++j) {
+      CHKERR(machine_mark_gray(m, frame[first + j]));
+      frame[first + j] = data[j];
+    }
+    *out = cases[2].integer;
+    break;
+  }
 err:
   return errres;
 }
 
+// ! Call the function which is not compiled from Emfrp.(callback, record constructor/accessor)
+/* !
+ * \param m The machine
+ * \param callee The function
+ * \param args The arguments
+ * \param arglen The length of the arguments
+ * \param o The result
+ * \return The status code
+ */
 em_result
-exec_ast_funccall(machine_t * m, parser_expression_t * v, exec_result_t * out)
+exec_call_foreign(machine_t * m, object_t * callee, object_t ** args, int arglen, object_t ** o)
 {
-  object_t *         callee  = nullptr;
-  int                arglen  = 0;
-  stack_state_t      state   = MACHINE_STACK_STATE_DEFAULT;
-  em_result          errres  = EM_RESULT_OK;
-  variable_table_t * prev_vt = nullptr;
-  object_t **        o       = &(out->value);
-  CHKERR(machine_get_stack_state(m, &state));
-  // Evaluate Arguments.
-  if(v->value.funccall.arguments.value != nullptr)
-    CHKERR(exec_ast_tuple_list_t(m, &(v->value.funccall.arguments), &arglen));
-  // Evaluate Callee.
-  CHKERR(exec_ast(m, v->value.funccall.callee, &callee));
-  TEST_AND_ERROR(
-    !object_is_pointer(callee) || callee == nullptr
-      || (object_kind(callee) != EMFRP_OBJECT_FUNCTION),
-    EM_RESULT_TYPE_MISMATCH);
-  CHKERR(machine_push(m, callee));
-  // Execute.
+  em_result errres = EM_RESULT_OK;
+  *o               = nullptr;
   switch(callee->value.function.kind) {
-    case EMFRP_PROGRAM_KIND_AST:
-      out->kind  = EXEC_RESULT_EXECUTE_FUNCTION;
-      out->value = callee;
-      for(int i = 0; i < arglen; ++i)
-        CHKERR(machine_mark_gray(m, m->stack->value.stack.data[out->stack_state + i]));
-      // May rewrite to memmove.
-      memcpy(
-        &(m->stack->value.stack.data[out->stack_state]), &(m->stack->value.stack.data[state]),
-        arglen * sizeof(object_t *));
-      out->arglen = arglen;
-      break;
     case EMFRP_PROGRAM_KIND_NOTHING:
       break;
     case EMFRP_PROGRAM_KIND_CALLBACK:
-      CHKERR(
-        callee->value.function.function.callback(o, &(m->stack->value.tupleN.data[state]), arglen));
+      CHKERR(callee->value.function.function.callback(o, args, arglen));
       break;
     case EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT:
       TEST_AND_ERROR(
         callee->value.function.function.construct.arity != arglen, EM_RESULT_INVALID_ARGUMENT);
-      CHKERR(exec_ast_construct_tuple(
-        m, callee->value.function.function.construct.tag, arglen,
-        &(m->stack->value.tupleN.data[state]), o));
+      CHKERR(exec_construct_tuple(
+        m, callee->value.function.function.construct.tag, arglen, args, o));
       break;
     case EMFRP_PROGRAM_KIND_RECORD_ACCESS: {
-      object_t * t            = m->stack->value.tupleN.data[state];
-      size_t     access_index = callee->value.function.function.access.index;
-      object_t * tag          = callee->value.function.function.access.tag;
+      object_t *   t            = args[0];
+      size_t       access_index = callee->value.function.function.access.index;
+      record_tag_t tag          = callee->value.function.function.access.tag;
       TEST_AND_ERROR(arglen != 1, EM_RESULT_INVALID_ARGUMENT);
       TEST_AND_ERROR(!object_is_pointer(t) || t == nullptr, EM_RESULT_TYPE_MISMATCH);
       switch(object_kind(t)) {
         case EMFRP_OBJECT_TUPLE1:
-          TEST_AND_ERROR(
-            !exec_equal(t->value.tuple1.tag, tag) || access_index >= 1, EM_RESULT_TYPE_MISMATCH);
+          TEST_AND_ERROR(object_tuple_tag(t) != tag || access_index >= 1, EM_RESULT_TYPE_MISMATCH);
           *o = t->value.tuple1.i0;
           break;
         case EMFRP_OBJECT_TUPLE2:
-          TEST_AND_ERROR(
-            !exec_equal(t->value.tuple2.tag, tag) || access_index >= 2, EM_RESULT_TYPE_MISMATCH);
+          TEST_AND_ERROR(object_tuple_tag(t) != tag || access_index >= 2, EM_RESULT_TYPE_MISMATCH);
           *o = access_index == 0 ? t->value.tuple2.i0 : t->value.tuple2.i1;
           break;
         case EMFRP_OBJECT_TUPLEN:
           TEST_AND_ERROR(
-            !exec_equal(t->value.tupleN.tag, tag) || access_index >= t->value.tupleN.length,
+            object_tuple_tag(t) != tag || access_index >= t->value.tupleN.length,
             EM_RESULT_TYPE_MISMATCH);
           *o = object_tuple_ith(t, access_index);
           break;
@@ -308,192 +274,408 @@ err:
   return errres;
 }
 
+// ! Enter the compiled function.
+/* !
+ * The frame is placed at the top of the stack, and local variables are reserved.
+ * \param m The machine
+ * \param callee The function(kind == EMFRP_PROGRAM_KIND_BYTECODE)
+ * \param arglen The length of the arguments
+ * \param checked Whether the arity is checked.(It is not if proven.)
+ * \param out The code of callee
+ * \return The status code
+ */
 em_result
-exec_ast_func(machine_t * m, parser_expression_t * v, exec_result_t * out)
+exec_enter_function(machine_t * m, object_t * callee, int arglen, bool checked, bytecode_t ** out)
 {
-  em_result errres = EM_RESULT_OK;
-  CHKERR(machine_alloc(m, &(out->value)));
-  return object_new_function_ast(out->value, machine_get_variable_table(m)->this_object_ref, v);
+  em_result    errres  = EM_RESULT_OK;
+  bytecode_t * program = callee->value.function.function.bytecode.program;
+  object_t *   closure = callee->value.function.function.bytecode.closure;
+  TEST_AND_ERROR(checked && program->arity != arglen, EM_RESULT_INVALID_ARGUMENT);
+  TEST_AND_ERROR(
+    closure == nullptr || !object_is_pointer(closure)
+      || object_kind(closure) != EMFRP_OBJECT_VARIABLE_TABLE,
+    EM_RESULT_INVALID_ARGUMENT);
+  CHKERR(machine_set_variable_table(m, closure->value.variable_table.ptr));
+  if(program->env_size > 0) CHKERR(machine_new_variable_table(m, program->env_size));
+  for(int i = arglen + 2; i < program->frame_size; ++i)
+    CHKERR(machine_push(m, nullptr));
+  *out = program;
 err:
   return errres;
 }
 
 em_result
-exec_ast_case(machine_t * m, parser_expression_t * v, exec_result_t * o)
+exec_bytecode(machine_t * m, bytecode_t * code, object_t ** out)
 {
-  em_result  errres   = EM_RESULT_OK;
-  object_t * v_result = nullptr;
-  CHKERR2(err2, exec_ast(m, v->value.caseof.of, &v_result));
-  CHKERR2(err2, machine_push(m, v_result));
-  parser_branch_list_t * bl = v->value.caseof.branches;
-  for(; bl != nullptr; bl = bl->next) {
-    if(machine_test_matches(m, bl->deconstruct, v_result)) {
-      CHKERR2(err2, machine_new_variable_table(m));
-      CHKERR(machine_matches(m, bl->deconstruct, v_result));
-      CHKERR(exec_ast_mono(m, bl->body, o));
-err:
-      machine_pop_variable_table(m);
-      return errres;  // Leave this function.
-    }
+  em_result          errres          = EM_RESULT_OK;
+  instruction_t *    pc              = code->code;
+  variable_table_t * entry_vt        = machine_get_variable_table(m);
+  stack_state_t      entry           = MACHINE_STACK_STATE_DEFAULT;
+  stack_state_t      base            = MACHINE_STACK_STATE_DEFAULT;
+  exec_frame_t       inline_frames[EXEC_FRAME_INLINE_SIZE];
+  exec_frame_t *     frames          = inline_frames;
+  size_t             frames_length   = 0;
+  size_t             frames_capacity = EXEC_FRAME_INLINE_SIZE;
+  object_t *         result          = nullptr;
+  CHKERR2(err_state, machine_get_stack_state(m, &entry));
+  base = entry;
+  if(code->env_size > 0) CHKERR(machine_new_variable_table(m, code->env_size));
+  for(int i = 0; i < code->frame_size; ++i)
+    CHKERR(machine_push(m, nullptr));
+  for(;;) {
+    instruction_t inst    = *(pc++);
+    int32_t       operand = INSTRUCTION_OPERAND(inst);
+    switch(INSTRUCTION_OPCODE(inst)) {
+      case OPCODE_PUSH_INT:
+        object_new_int(&result, operand);
+        CHKERR(machine_push(m, result));
+        break;
+      case OPCODE_PUSH_CONSTANT:
+        CHKERR(machine_push(m, code->constants[operand].object));
+        break;
+      case OPCODE_PUSH_TRUE:
+        CHKERR(machine_push(m, &object_true));
+        break;
+      case OPCODE_PUSH_FALSE:
+        CHKERR(machine_push(m, &object_false));
+        break;
+      case OPCODE_PUSH_NIL:
+        CHKERR(machine_push(m, nullptr));
+        break;
+      case OPCODE_POP:
+        CHKERR(exec_drop(m, 1));
+        break;
+      case OPCODE_DUP:
+        CHKERR(machine_push(m, STACK_TOP(m, 0)));
+        break;
+      case OPCODE_SLIDE:
+        result = STACK_TOP(m, 0);
+        CHKERR(exec_drop(m, operand + 1));
+        CHKERR(machine_push(m, result));
+        break;
+      case OPCODE_LOAD_NAME: {
+        // Link the name, and rewrite this instruction.
+        atom_t name = code->constants[operand].name;
+        if(machine_lookup_global_atom(m, &(code->constants[operand].global), name))
+          pc[-1] = INSTRUCTION_NEW(OPCODE_LOAD_GLOBAL, operand);
+        else if(machine_lookup_node_atom(m, &(code->constants[operand].node), name))
+          pc[-1] = INSTRUCTION_NEW(OPCODE_LOAD_NODE, operand);
+        else {
+          errres = EM_RESULT_MISSING_IDENTIFIER;
+          goto err;
+        }
+        pc--;
+        break;
+      }
+      case OPCODE_LOAD_LAST:
+        // Link the name, and rewrite this instruction.
+        TEST_AND_ERROR(
+          !machine_lookup_node_atom(
+            m, &(code->constants[operand].node), code->constants[operand].name),
+          EM_RESULT_MISSING_IDENTIFIER);
+        pc[-1] = INSTRUCTION_NEW(OPCODE_LOAD_NODE_LAST, operand);
+        pc--;
+        break;
+      case OPCODE_LOAD_LOCAL:
+        CHKERR(machine_push(m, STACK_DATA(m)[base + operand]));
+        break;
+      case OPCODE_LOAD_ENV: {
+        variable_table_t * vt = machine_get_variable_table(m);
+        for(int depth = INSTRUCTION_OPERAND_HIGH(inst); depth > 0; --depth)
+          vt = vt->parent;
+        CHKERR(machine_push(m, vt->slots[INSTRUCTION_OPERAND_LOW(inst)]));
+        break;
+      }
+      case OPCODE_LOAD_GLOBAL:
+        CHKERR(machine_push(m, code->constants[operand].global->value));
+        break;
+      case OPCODE_LOAD_NODE:
+        CHKERR(machine_push(m, code->constants[operand].node->value));
+        break;
+      case OPCODE_LOAD_NODE_LAST:
+        CHKERR(machine_push(m, code->constants[operand].node->last));
+        break;
+#define BIN_OP_NUM_NUM(opcode, expression)                                                         \
+  case opcode: {                                                                                   \
+    object_t * lro = STACK_TOP(m, 1);                                                              \
+    object_t * rro = STACK_TOP(m, 0);                                                              \
+    int        ll, rr;                                                                             \
+    TEST_AND_ERROR(!object_is_integer(lro) || !object_is_integer(rro), EM_RESULT_TYPE_MISMATCH);   \
+    ll = object_get_integer(lro);                                                                  \
+    rr = object_get_integer(rro);                                                                  \
+    STACK_LENGTH(m)--;                                                                             \
+    expression;                                                                                    \
+    break;                                                                                         \
   }
-  o->value = nullptr;  // Nothing matches.
-err2:
-  return errres;
-}
-
-em_result
-exec_ast_begin(machine_t * m, parser_expression_t * v, exec_result_t * out)
-{
-  em_result              errres          = EM_RESULT_OK;
-  object_t *             o               = nullptr;
-  bool                   isVarTblCreated = false;
-  parser_branch_list_t * bl              = v->value.begin.branches;
-  if(bl == nullptr) return EM_RESULT_OK;
-  for(; bl->next != nullptr; bl = bl->next) {
-    CHKERR(exec_ast(m, bl->body, &o));
-    if(bl->deconstruct != nullptr) {
-      CHKERR(machine_new_variable_table(m));
-      isVarTblCreated = true;
-      goto assign;
-    }
+#define BIN_OP_NUM_NUM_NUM(opcode, expression)                                                     \
+  BIN_OP_NUM_NUM(opcode, object_new_int(&STACK_TOP(m, 0), expression))
+#define BIN_OP_NUM_NUM_BOOL(opcode, expression)                                                    \
+  BIN_OP_NUM_NUM(opcode, STACK_TOP(m, 0) = (expression) ? &object_true : &object_false)
+#define BIN_OP_ANY_ANY_BOOL(opcode, expression)                                                    \
+  case opcode: {                                                                                   \
+    object_t * lro = STACK_TOP(m, 1);                                                              \
+    object_t * rro = STACK_TOP(m, 0);                                                              \
+    CHKERR(exec_drop(m, 1));                                                                       \
+    CHKERR(exec_replace_top(m, (expression) ? &object_true : &object_false));                      \
+    break;                                                                                         \
   }
-  goto last_turn;
-  for(; bl->next != nullptr; bl = bl->next) {
-    CHKERR(exec_ast(m, bl->body, &o));
-    if(bl->deconstruct != nullptr) {
-assign:
-      CHKERR(machine_matches(m, bl->deconstruct, o));
-    }
+        BIN_OP_NUM_NUM_NUM(OPCODE_ADD, ll + rr);
+        BIN_OP_NUM_NUM_NUM(OPCODE_SUB, ll - rr);
+        BIN_OP_NUM_NUM_NUM(OPCODE_DIV, ll / rr);
+        BIN_OP_NUM_NUM_NUM(OPCODE_MUL, ll * rr);
+        BIN_OP_NUM_NUM_NUM(OPCODE_MOD, ll % rr);
+        BIN_OP_NUM_NUM_NUM(OPCODE_LEFT_SHIFT, ll << rr);
+        BIN_OP_NUM_NUM_NUM(OPCODE_RIGHT_SHIFT, ll >> rr);
+        BIN_OP_NUM_NUM_BOOL(OPCODE_LESS_OR_EQUAL, ll <= rr);
+        BIN_OP_NUM_NUM_BOOL(OPCODE_LESS_THAN, ll < rr);
+        BIN_OP_NUM_NUM_BOOL(OPCODE_GREATER_OR_EQUAL, ll >= rr);
+        BIN_OP_NUM_NUM_BOOL(OPCODE_GREATER_THAN, ll > rr);
+        BIN_OP_ANY_ANY_BOOL(OPCODE_EQUAL, exec_equal(lro, rro));
+        BIN_OP_ANY_ANY_BOOL(OPCODE_NOT_EQUAL, !exec_equal(lro, rro));
+        BIN_OP_ANY_ANY_BOOL(OPCODE_AND, (lro != &object_false) && (rro != &object_false));
+        BIN_OP_ANY_ANY_BOOL(OPCODE_OR, (lro != &object_false) || (rro != &object_false));
+        BIN_OP_ANY_ANY_BOOL(OPCODE_XOR, (lro != &object_false) ^ (rro != &object_false));
+#undef BIN_OP_NUM_NUM
+#undef BIN_OP_NUM_NUM_NUM
+#undef BIN_OP_NUM_NUM_BOOL
+#undef BIN_OP_ANY_ANY_BOOL
+// Superinstructions. The right operand(rro) is given by `fetch`, and the result replaces the left.
+#define FUSED_NUM_NUM(opcode, fetch, expression)                                                   \
+  case opcode: {                                                                                   \
+    object_t * lro = STACK_TOP(m, 0);                                                              \
+    object_t * rro;                                                                                \
+    int        ll, rr;                                                                             \
+    fetch;                                                                                         \
+    TEST_AND_ERROR(!object_is_integer(lro) || !object_is_integer(rro), EM_RESULT_TYPE_MISMATCH);   \
+    ll = object_get_integer(lro);                                                                  \
+    rr = object_get_integer(rro);                                                                  \
+    expression;                                                                                    \
+    break;                                                                                         \
   }
-last_turn:
-  CHKERR(exec_ast_mono(m, bl->body, out));
-err:
-  if(isVarTblCreated) machine_pop_variable_table(m);
-  return errres;
-}
-
-em_result
-exec_ast_identifier(machine_t * m, parser_expression_t * v, exec_result_t * out)
-{
-  return machine_lookup_variable(m, &(out->value), &(v->value.identifier))
-         ? EM_RESULT_OK
-         : EM_RESULT_MISSING_IDENTIFIER;
-}
-
-em_result
-exec_ast_lastidentifier(machine_t * m, parser_expression_t * v, exec_result_t * out)
-{
-  node_t * id;
-  if(!machine_lookup_node(m, &id, &(v->value.identifier))) return EM_RESULT_MISSING_IDENTIFIER;
-  out->value = id->last;
-  return EM_RESULT_OK;
-}
-
-em_result
-exec_ast_if(machine_t * m, parser_expression_t * v, exec_result_t * out)
-{
-  em_result  errres      = EM_RESULT_OK;
-  object_t * cond_result = nullptr;
-  CHKERR(exec_ast(m, v->value.ifthenelse.cond, &cond_result));
-  if(cond_result == nullptr) {
-    out->value = nullptr;
-    return EM_RESULT_TYPE_MISMATCH;
+#define FUSED_NUM_NUM_NUM(opcode, fetch, expression)                                               \
+  FUSED_NUM_NUM(opcode, fetch, object_new_int(&STACK_TOP(m, 0), expression))
+#define FUSED_NUM_NUM_BOOL(opcode, fetch, expression)                                              \
+  FUSED_NUM_NUM(opcode, fetch, STACK_TOP(m, 0) = (expression) ? &object_true : &object_false)
+#define FUSED_ANY_ANY_BOOL(opcode, fetch, expression)                                              \
+  case opcode: {                                                                                   \
+    object_t * lro = STACK_TOP(m, 0);                                                              \
+    object_t * rro;                                                                                \
+    fetch;                                                                                         \
+    CHKERR(exec_replace_top(m, (expression) ? &object_true : &object_false));                      \
+    break;                                                                                         \
   }
-  return exec_ast_mono(
-    m, cond_result != &object_false ? v->value.ifthenelse.then : v->value.ifthenelse.otherwise,
-    out);
-err:
-  return errres;
-}
-
-em_result
-exec_ast_execute_function(machine_t * m, object_t * v, int arglen, exec_result_t * out)
-{
-  em_result          errres  = EM_RESULT_OK;
-  variable_table_t * prev_vt = nullptr;
-  switch(v->value.function.kind) {
-    case EMFRP_PROGRAM_KIND_AST:
-      TEST_AND_ERROR(
-        (arglen != 0)
-          ^ (v->value.function.function.ast.program->value.function.arguments != nullptr),
-        EM_RESULT_INVALID_ARGUMENT);
-      prev_vt = machine_get_variable_table(m);
-      CHKERR(machine_push(m, prev_vt->this_object_ref));
-      if(v->value.function.function.ast.closure == nullptr) {
-        CHKERR(machine_set_variable_table(m, nullptr));  // TODO: set the global scope.
-      } else if(
-        !object_is_pointer(v->value.function.function.ast.closure)
-        || object_kind(v->value.function.function.ast.closure) != EMFRP_OBJECT_VARIABLE_TABLE) {
+#define FUSED_BINARY_OPS(suffix, fetch)                                                            \
+  FUSED_NUM_NUM_NUM(OPCODE_ADD##suffix, fetch, ll + rr);                                           \
+  FUSED_NUM_NUM_NUM(OPCODE_SUB##suffix, fetch, ll - rr);                                           \
+  FUSED_NUM_NUM_NUM(OPCODE_DIV##suffix, fetch, ll / rr);                                           \
+  FUSED_NUM_NUM_NUM(OPCODE_MUL##suffix, fetch, ll * rr);                                           \
+  FUSED_NUM_NUM_NUM(OPCODE_MOD##suffix, fetch, ll % rr);                                           \
+  FUSED_NUM_NUM_NUM(OPCODE_LEFT_SHIFT##suffix, fetch, ll << rr);                                   \
+  FUSED_NUM_NUM_NUM(OPCODE_RIGHT_SHIFT##suffix, fetch, ll >> rr);                                  \
+  FUSED_NUM_NUM_BOOL(OPCODE_LESS_OR_EQUAL##suffix, fetch, ll <= rr);                               \
+  FUSED_NUM_NUM_BOOL(OPCODE_LESS_THAN##suffix, fetch, ll < rr);                                    \
+  FUSED_NUM_NUM_BOOL(OPCODE_GREATER_OR_EQUAL##suffix, fetch, ll >= rr);                            \
+  FUSED_NUM_NUM_BOOL(OPCODE_GREATER_THAN##suffix, fetch, ll > rr);                                 \
+  FUSED_ANY_ANY_BOOL(OPCODE_EQUAL##suffix, fetch, exec_equal(lro, rro));                           \
+  FUSED_ANY_ANY_BOOL(OPCODE_NOT_EQUAL##suffix, fetch, !exec_equal(lro, rro))
+        FUSED_BINARY_OPS(_INT, object_new_int(&rro, operand));
+        FUSED_BINARY_OPS(_LOCAL, rro = STACK_DATA(m)[base + operand]);
+        FUSED_BINARY_OPS(_NODE, rro = code->constants[operand].node->value);
+#undef FUSED_NUM_NUM
+#undef FUSED_NUM_NUM_NUM
+#undef FUSED_NUM_NUM_BOOL
+#undef FUSED_ANY_ANY_BOOL
+#undef FUSED_BINARY_OPS
+// Operands are proven to be integers. `drop` operands are popped, and the right operand is `right`.
+#define UNCHECKED_NUM_NUM(opcode, drop, right, expression)                                         \
+  case opcode: {                                                                                   \
+    int rr = (right);                                                                              \
+    int ll;                                                                                        \
+    STACK_LENGTH(m) -= (drop);                                                                     \
+    ll = object_get_integer(STACK_TOP(m, 0));                                                      \
+    expression;                                                                                    \
+    break;                                                                                         \
+  }
+#define UNCHECKED_NUM_NUM_NUM(opcode, drop, right, expression)                                     \
+  UNCHECKED_NUM_NUM(opcode, drop, right, object_new_int(&STACK_TOP(m, 0), expression))
+#define UNCHECKED_NUM_NUM_BOOL(opcode, drop, right, expression)                                    \
+  UNCHECKED_NUM_NUM(                                                                               \
+    opcode, drop, right, STACK_TOP(m, 0) = (expression) ? &object_true : &object_false)
+#define UNCHECKED_BINARY_OPS(suffix, drop, right)                                                  \
+  UNCHECKED_NUM_NUM_NUM(OPCODE_ADD##suffix, drop, right, ll + rr);                                 \
+  UNCHECKED_NUM_NUM_NUM(OPCODE_SUB##suffix, drop, right, ll - rr);                                 \
+  UNCHECKED_NUM_NUM_NUM(OPCODE_DIV##suffix, drop, right, ll / rr);                                 \
+  UNCHECKED_NUM_NUM_NUM(OPCODE_MUL##suffix, drop, right, ll * rr);                                 \
+  UNCHECKED_NUM_NUM_NUM(OPCODE_MOD##suffix, drop, right, ll % rr);                                 \
+  UNCHECKED_NUM_NUM_NUM(OPCODE_LEFT_SHIFT##suffix, drop, right, ll << rr);                         \
+  UNCHECKED_NUM_NUM_NUM(OPCODE_RIGHT_SHIFT##suffix, drop, right, ll >> rr);                        \
+  UNCHECKED_NUM_NUM_BOOL(OPCODE_LESS_OR_EQUAL##suffix, drop, right, ll <= rr);                     \
+  UNCHECKED_NUM_NUM_BOOL(OPCODE_LESS_THAN##suffix, drop, right, ll < rr);                          \
+  UNCHECKED_NUM_NUM_BOOL(OPCODE_GREATER_OR_EQUAL##suffix, drop, right, ll >= rr);                  \
+  UNCHECKED_NUM_NUM_BOOL(OPCODE_GREATER_THAN##suffix, drop, right, ll > rr)
+        UNCHECKED_BINARY_OPS(_UNCHECKED, 1, object_get_integer(STACK_TOP(m, 0)));
+        UNCHECKED_BINARY_OPS(_INT_UNCHECKED, 0, operand);
+        UNCHECKED_BINARY_OPS(
+          _LOCAL_UNCHECKED, 0, object_get_integer(STACK_DATA(m)[base + operand]));
+#undef UNCHECKED_NUM_NUM
+#undef UNCHECKED_NUM_NUM_NUM
+#undef UNCHECKED_NUM_NUM_BOOL
+#undef UNCHECKED_BINARY_OPS
+      case OPCODE_GUARD_INT:
+        TEST_AND_ERROR(!object_is_integer(STACK_DATA(m)[base + operand]), EM_RESULT_TYPE_MISMATCH);
+        break;
+      case OPCODE_TUPLE_ITH:
+        CHKERR(exec_replace_top(m, exec_tuple_ith(STACK_TOP(m, 0), operand)));
+        break;
+      case OPCODE_TO_BOOLEAN:
+        CHKERR(
+          exec_replace_top(m, STACK_TOP(m, 0) != &object_false ? &object_true : &object_false));
+        break;
+      case OPCODE_JUMP:
+        pc = code->code + operand;
+        break;
+      case OPCODE_JUMP_IF_FALSE:
+        result = STACK_TOP(m, 0);
+        TEST_AND_ERROR(result == nullptr, EM_RESULT_TYPE_MISMATCH);
+        CHKERR(exec_drop(m, 1));
+        if(result == &object_false) pc = code->code + operand;
+        break;
+      case OPCODE_JUMP_IF_FALSE_OR_POP:
+        if(STACK_TOP(m, 0) == &object_false)
+          pc = code->code + operand;
+        else
+          CHKERR(exec_drop(m, 1));
+        break;
+      case OPCODE_JUMP_IF_TRUE_OR_POP:
+        if(STACK_TOP(m, 0) != &object_false)
+          pc = code->code + operand;
+        else
+          CHKERR(exec_drop(m, 1));
+        break;
+      case OPCODE_TUPLE:
+        CHKERR(exec_construct_tuple(
+          m, RECORD_TAG_NONE, operand, &STACK_DATA(m)[STACK_LENGTH(m) - operand], &result));
+        CHKERR(exec_drop(m, operand));
+        CHKERR(machine_push(m, result));
+        break;
+      case OPCODE_CALL:
+      case OPCODE_TAIL_CALL:
+      case OPCODE_CALL_UNCHECKED:
+      case OPCODE_TAIL_CALL_UNCHECKED: {
+        object_t *  callee = STACK_TOP(m, 0);
+        object_t ** args   = &STACK_DATA(m)[STACK_LENGTH(m) - 1 - operand];
+        opcode_t    op     = INSTRUCTION_OPCODE(inst);
+        bool        tail   = op == OPCODE_TAIL_CALL || op == OPCODE_TAIL_CALL_UNCHECKED;
+        bool        check  = op == OPCODE_CALL || op == OPCODE_TAIL_CALL;
+        TEST_AND_ERROR(
+          check
+            && (!object_is_pointer(callee) || callee == nullptr
+                || object_kind(callee) != EMFRP_OBJECT_FUNCTION),
+          EM_RESULT_TYPE_MISMATCH);
+        if(callee->value.function.kind != EMFRP_PROGRAM_KIND_BYTECODE) {
+          CHKERR(exec_call_foreign(m, callee, args, operand, &result));
+          CHKERR(exec_drop(m, operand + 1));
+          CHKERR(machine_push(m, result));
+          if(tail) goto exec_return;
+          break;
+        }
+        if(tail && frames_length > 0) {
+          // Reuse the current frame. [args..., callee] is moved to the base.
+          for(size_t i = base; i < STACK_LENGTH(m) - operand - 1; ++i)
+            CHKERR(machine_mark_gray(m, STACK_DATA(m)[i]));
+          memmove(&STACK_DATA(m)[base], args, (operand + 1) * sizeof(object_t *));
+          STACK_LENGTH(m) = base + operand + 1;
+          CHKERR(machine_push(m, frames[frames_length - 1].variable_table->this_object_ref));
+        } else {
+          if(frames_length == frames_capacity) {
+            exec_frame_t * new_frames = nullptr;
+            CHKERR(em_allocarray((void **)&new_frames, frames_capacity * 2, sizeof(exec_frame_t)));
+            memcpy(new_frames, frames, frames_length * sizeof(exec_frame_t));
+            if(frames != inline_frames) em_free(frames);
+            frames = new_frames;
+            frames_capacity *= 2;
+          }
+          frames[frames_length].code           = code;
+          frames[frames_length].pc             = pc;
+          frames[frames_length].base           = base;
+          frames[frames_length].variable_table = machine_get_variable_table(m);
+          frames_length++;
+          base = STACK_LENGTH(m) - operand - 1;
+          // Keep the caller's variable table alive.
+          CHKERR(machine_push(m, machine_get_variable_table(m)->this_object_ref));
+        }
+        CHKERR(exec_enter_function(m, callee, operand, check, &code));
+        pc = code->code;
+        break;
+      }
+      case OPCODE_RETURN:
+exec_return:
+        result = STACK_TOP(m, 0);
+        if(frames_length == 0) goto err;  // errres == EM_RESULT_OK
+        CHKERR(machine_restore_stack_state(m, base));
+        CHKERR(machine_push(m, result));
+        frames_length--;
+        CHKERR(machine_set_variable_table(m, frames[frames_length].variable_table));
+        code = frames[frames_length].code;
+        pc   = frames[frames_length].pc;
+        base = frames[frames_length].base;
+        break;
+      case OPCODE_CLOSURE:
+        CHKERR(machine_alloc(m, &result));
+        CHKERR(object_new_function_bytecode(
+          result, machine_get_variable_table(m)->this_object_ref,
+          code->constants[operand].bytecode));
+        CHKERR(machine_push(m, result));
+        break;
+      case OPCODE_STORE_LOCAL:
+        CHKERR(machine_mark_gray(m, STACK_DATA(m)[base + operand]));
+        STACK_DATA(m)[base + operand] = STACK_TOP(m, 0);
+        CHKERR(exec_drop(m, 1));
+        break;
+      case OPCODE_SWITCH_INT:
+        pc = code->code + exec_switch_int(&(code->constants[operand]), &STACK_DATA(m)[base]);
+        break;
+      case OPCODE_SWITCH_TUPLE: {
+        int32_t target = 0;
+        CHKERR(exec_switch_tuple(m, &(code->constants[operand]), &STACK_DATA(m)[base], &target));
+        pc = code->code + target;
+        break;
+      }
+      case OPCODE_MATCH_LOCAL:
+        CHKERR(machine_matches(
+          m, code->constants[INSTRUCTION_OPERAND_LOW(inst)].deconstructor, STACK_TOP(m, 0),
+          &STACK_DATA(m)[base + INSTRUCTION_OPERAND_HIGH(inst)]));
+        CHKERR(exec_drop(m, 1));
+        break;
+      case OPCODE_MATCH_ENV:
+        CHKERR(machine_matches(
+          m, code->constants[INSTRUCTION_OPERAND_LOW(inst)].deconstructor, STACK_TOP(m, 0),
+          machine_get_variable_table(m)->slots + INSTRUCTION_OPERAND_HIGH(inst)));
+        CHKERR(exec_drop(m, 1));
+        break;
+      default:
+        DEBUGBREAK;
         errres = EM_RESULT_INVALID_ARGUMENT;
         goto err;
-      } else
-        CHKERR(machine_set_variable_table(
-          m, v->value.function.function.ast.closure->value.variable_table.ptr));
-      CHKERR2(err2, machine_new_variable_table(m));
-      CHKERR2(
-        err2, machine_match(
-                m, v->value.function.function.ast.program->value.function.arguments,
-                &(m->stack->value.stack.data[out->stack_state]), arglen));
-      CHKERR2(
-        err2, exec_ast_mono(m, v->value.function.function.ast.program->value.function.body, out));
-      break;
-    default:
-      DEBUGBREAK;
+    }
   }
-err2:
-  machine_set_variable_table(m, prev_vt);
 err:
+  if(errres == EM_RESULT_OK) *out = result;
+  if(machine_get_variable_table(m) != entry_vt) machine_set_variable_table(m, entry_vt);
+  machine_restore_stack_state(m, entry);
+  if(frames != inline_frames) em_free(frames);
+err_state:
   return errres;
 }
 
-const executor bin_op_table[] = {exec_ast_addition,     exec_ast_subtract,
-                                 exec_ast_division,     exec_ast_multiplication,
-                                 exec_ast_modulo,       exec_ast_left_shift,
-                                 exec_ast_right_shift,  exec_ast_less_or_equal,
-                                 exec_ast_less_than,    exec_ast_greater_or_equal,
-                                 exec_ast_greater_than, exec_ast_equal,
-                                 exec_ast_not_equal,    exec_ast_and,
-                                 exec_ast_or,           exec_ast_xor,
-                                 exec_ast_dand,         exec_ast_dor};
-
-const executor op_table[] = {
-  nullptr,      nullptr,        nullptr,           exec_ast_identifier, exec_ast_lastidentifier,
-  exec_ast_if,  exec_ast_tuple, exec_ast_funccall, exec_ast_func,       exec_ast_begin,
-  exec_ast_case};
-
-em_result
-exec_ast_mono(machine_t * m, parser_expression_t * v, exec_result_t * out)
-{
-  if(EXPR_KIND_IS_INTEGER(v)) {
-    return object_new_int(&(out->value), (int)((size_t)v >> 2));
-  } else if(EXPR_KIND_IS_BOOLEAN(v)) {
-    out->value = EXPR_IS_TRUE(v) ? &object_true : &object_false;
-    return EM_RESULT_OK;
-  } else if(EXPR_KIND_IS_BIN_OP(v))
-    return bin_op_table[v->kind >> PARSER_EXPRESSION_KIND_SHIFT](m, v, out);
-  else
-    return op_table[v->kind](m, v, out);
-}
-
 em_result
 exec_ast(machine_t * m, parser_expression_t * v, object_t ** out)
 {
-  em_result     errres = EM_RESULT_OK;
-  exec_result_t o      = {
-         .kind        = EXEC_RESULT_OBJECT,
-         .value       = nullptr,
-         .stack_state = MACHINE_STACK_STATE_DEFAULT,
-         .arglen      = 0};
-  CHKERR2(err_state, machine_get_stack_state(m, &o.stack_state));
-  CHKERR(exec_ast_mono(m, v, &o));
-  while(o.kind == EXEC_RESULT_EXECUTE_FUNCTION) {
-    m->stack->value.stack.length = o.stack_state + o.arglen;
-    o.kind                       = EXEC_RESULT_OBJECT;
-    CHKERR(exec_ast_execute_function(m, o.value, o.arglen, &o));
-  }
-  *out = o.value;
+  em_result    errres = EM_RESULT_OK;
+  bytecode_t * code   = nullptr;
+  CHKERR(compile_expression(m, v, nullptr, &code));  // Executed only once.
+  errres = exec_bytecode(m, code, out);
+  bytecode_release(code);
 err:
-  machine_restore_stack_state(m, o.stack_state);
-err_state:
   return errres;
 }
@@ -0,0 +1,439 @@
+/** -------------------------------------------
+ * @file   exec_order.c
+ * @brief  Incremental Topological Order of Execution Sequences
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include "vm/exec_order.h"
+#include "vm/machine.h"
+
+#define SUCCESSORS(es) ((exec_sequence_t **)((es)->successors.buffer))
+#define ORDER(m)       ((exec_sequence_t **)((m)->order.buffer))
+
+// ! Whether es reads the node.
+static bool
+exec_order_reads(exec_sequence_t * es, node_t * node)
+{
+  for(int i = 0; i < es->reads_length; ++i)
+    if(es->reads[i] == node) return true;
+  return false;
+}
+
+// ! Whether es reads any nodes updated by def.
+static bool
+exec_order_reads_from(exec_sequence_t * es, exec_sequence_t * def)
+{
+  for(int i = 0; i < es->reads_length; ++i)
+    if(es->reads[i]->definition == def) return true;
+  return false;
+}
+
+// ! Whether node_or_tuple_t has any nodes.
+static bool
+exec_order_has_nodes(node_or_tuple_t * nt)
+{
+  switch(nt->kind) {
+    case NODE_OR_TUPLE_NODE:
+      return nt->value.node != nullptr;
+    case NODE_OR_TUPLE_TUPLE:
+      for(int i = 0; i < nt->value.tuple.length; ++i)
+        if(exec_order_has_nodes(&(((node_or_tuple_t *)(nt->value.tuple.buffer))[i]))) return true;
+      return false;
+    default:
+      return false;
+  }
+}
+
+// ! Whether es updates any nodes.(Otherwise, it is removed by machine_cleanup.)
+static bool
+exec_order_updates_nodes(exec_sequence_t * es)
+{
+  return es->node_definition != nullptr
+         || (es->node_definitions != nullptr && exec_order_has_nodes(es->node_definitions));
+}
+
+// ! Assign node_t::definition of nodes in node_or_tuple_t.
+static void
+exec_order_set_definition(node_or_tuple_t * nt, exec_sequence_t * es)
+{
+  switch(nt->kind) {
+    case NODE_OR_TUPLE_NODE:
+      if(nt->value.node != nullptr) nt->value.node->definition = es;
+      break;
+    case NODE_OR_TUPLE_TUPLE:
+      for(int i = 0; i < nt->value.tuple.length; ++i)
+        exec_order_set_definition(&(((node_or_tuple_t *)(nt->value.tuple.buffer))[i]), es);
+      break;
+    default:
+      break;
+  }
+}
+
+// ! Add the edge self -> s.
+static em_result
+exec_order_add_successor(exec_sequence_t * self, exec_sequence_t * s)
+{
+  for(size_t i = 0; i < self->successors.length; ++i)
+    if(SUCCESSORS(self)[i] == s) return EM_RESULT_OK;
+  return arraylist_append(&(self->successors), sizeof(exec_sequence_t *), &s);
+}
+
+// ! Remove the edge self -> s.
+static void
+exec_order_remove_successor(exec_sequence_t * self, exec_sequence_t * s)
+{
+  for(size_t i = 0; i < self->successors.length; ++i)
+    if(SUCCESSORS(self)[i] == s) {
+      SUCCESSORS(self)[i] = SUCCESSORS(self)[self->successors.length - 1];
+      self->successors.length--;
+      return;
+    }
+}
+
+// ! exec_sequence_t::reads being collected.
+typedef struct exec_order_reads_t
+{
+  exec_sequence_t * es;
+  int               capacity;
+} exec_order_reads_t;
+
+static em_result
+exec_order_collect_read(void * user, node_t * n, bool last)
+{
+  em_result            errres = EM_RESULT_OK;
+  exec_order_reads_t * r      = (exec_order_reads_t *)user;
+  exec_sequence_t *    es     = r->es;
+  // node@last does not depend on the node in this iteration.
+  if(last || exec_order_reads(es, n)) return EM_RESULT_OK;
+  if(es->reads_length == r->capacity) {
+    r->capacity = r->capacity == 0 ? 4 : r->capacity * 2;
+    CHKERR(em_reallocarray((void **)&(es->reads), es->reads, r->capacity, sizeof(node_t *)));
+  }
+  es->reads[es->reads_length++] = n;
+err:
+  return errres;
+}
+
+em_result
+exec_order_collect_reads(machine_t * self, exec_sequence_t * es)
+{
+  exec_order_reads_t r = {es, 0};
+  return exec_sequence_walk_reads(
+    self, es->program.ast.code, exec_order_collect_read, &r, nullptr, &(es->reads_globals));
+}
+
+// ! Collect exec_sequence_t reachable from start.
+/* !
+ * Only exec_sequence_t whose exec_sequence_t::order is in (lb, ub) are visited, except start.
+ * Unordered ones(which wait for machine_cleanup) are skipped with lb >= -1.
+ * The visited ones are marked with exec_sequence_t::visited.
+ * \param start Where to start.(It must not be visited yet.)
+ * \param forward Whether it follows the edges(true) or the reverse edges(false).
+ * \param lb The lower bound(exclusive)
+ * \param ub The upper bound(exclusive)
+ * \param visited The visited ones are appended.
+ * \return The status code
+ */
+static em_result
+exec_order_search(exec_sequence_t * start, bool forward, int lb, int ub, arraylist_t * visited)
+{
+  em_result errres = EM_RESULT_OK;
+  size_t    i      = visited->length;
+  start->visited   = true;
+  CHKERR(arraylist_append(visited, sizeof(exec_sequence_t *), &start));
+  // visited works as the queue.
+  for(; i < visited->length; ++i) {
+    exec_sequence_t * cur    = ((exec_sequence_t **)(visited->buffer))[i];
+    int               length = forward ? (int)cur->successors.length : cur->reads_length;
+    for(int j = 0; j < length; ++j) {
+      exec_sequence_t * next = forward ? SUCCESSORS(cur)[j] : cur->reads[j]->definition;
+      if(next->visited || next->order <= lb || next->order >= ub) continue;
+      next->visited = true;
+      CHKERR(arraylist_append(visited, sizeof(exec_sequence_t *), &next));
+    }
+  }
+err:
+  return errres;
+}
+
+// ! Clear exec_sequence_t::visited, and free the list.
+static void
+exec_order_clear_visited(arraylist_t * visited)
+{
+  for(size_t i = 0; i < visited->length; ++i)
+    ((exec_sequence_t **)(visited->buffer))[i]->visited = false;
+  arraylist_free(visited);
+}
+
+em_result
+exec_order_check(machine_t * self, exec_sequence_t * es, journal_t * journal)
+{
+  em_result   errres = EM_RESULT_OK;
+  int         ub     = -1;
+  arraylist_t visited;
+  arraylist_default(&visited);
+  for(int i = 0; i < es->reads_length; ++i) {
+    node_t * r = es->reads[i];
+    for(journal_t * j = journal; j != nullptr; j = j->next)
+      TEST_AND_ERROR(j->what == r, EM_RESULT_CYCLIC_REFERENCE);  // It reads itself.
+    TEST_AND_ERROR(r->definition == nullptr, EM_RESULT_MISSING_IDENTIFIER);
+    if(ub < r->definition->order) ub = r->definition->order;
+  }
+  // A cycle is made if the readers of the redefined nodes reach what es reads.
+  // In the topological order, they are found before ub.
+  for(journal_t * j = journal; j != nullptr; j = j->next) {
+    exec_sequence_t * old = j->what->definition;
+    if(old == nullptr) continue;
+    for(size_t i = 0; i < old->successors.length; ++i) {
+      exec_sequence_t * s = SUCCESSORS(old)[i];
+      if(!s->visited && s->order <= ub && exec_order_reads(s, j->what))
+        CHKERR(exec_order_search(s, true, -1, ub + 1, &visited));
+    }
+  }
+  for(size_t i = 0; i < visited.length; ++i)
+    TEST_AND_ERROR(
+      exec_order_reads_from(es, ((exec_sequence_t **)(visited.buffer))[i]),
+      EM_RESULT_CYCLIC_REFERENCE);
+err:
+  exec_order_clear_visited(&visited);
+  return errres;
+}
+
+static int
+exec_order_compare(const void * l, const void * r)
+{
+  return (*(exec_sequence_t **)l)->order - (*(exec_sequence_t **)r)->order;
+}
+
+// ! Repair the order which violates the edge x -> y.(x->order > y->order)
+/* !
+ * The affected region is [y->order, x->order]. The exec_sequence_t reachable from y and reaching
+ * x in the region are reordered, and the others are not touched. The edges which satisfy the order
+ * still satisfy it, even if other edges violate it.
+ * \param self The machine
+ * \param x The source of the edge.
+ * \param y The destination of the edge.
+ * \return The status code
+ */
+static em_result
+exec_order_repair(machine_t * self, exec_sequence_t * x, exec_sequence_t * y)
+{
+  em_result   errres = EM_RESULT_OK;
+  int *       pool   = nullptr;
+  arraylist_t forward, backward;
+  arraylist_default(&forward);
+  arraylist_default(&backward);
+  CHKERR(exec_order_search(y, true, y->order, x->order, &forward));
+  CHKERR(exec_order_search(x, false, y->order, x->order, &backward));
+  exec_sequence_t ** f = (exec_sequence_t **)forward.buffer;
+  exec_sequence_t ** b = (exec_sequence_t **)backward.buffer;
+  qsort(f, forward.length, sizeof(exec_sequence_t *), exec_order_compare);
+  qsort(b, backward.length, sizeof(exec_sequence_t *), exec_order_compare);
+  // Merge places of them.
+  size_t fi = 0, bi = 0, length = forward.length + backward.length;
+  CHKERR(em_allocarray((void **)&pool, length, sizeof(int)));
+  for(size_t i = 0; i < length; ++i)
+    pool[i] = bi == backward.length || (fi < forward.length && f[fi]->order < b[bi]->order)
+              ? f[fi++]->order
+              : b[bi++]->order;
+  // What reach x come first, and then what are reachable from y.
+  for(size_t i = 0; i < length; ++i) {
+    exec_sequence_t * es = i < backward.length ? b[i] : f[i - backward.length];
+    es->order            = pool[i];
+    ORDER(self)[pool[i]] = es;
+  }
+err:
+  em_free(pool);
+  exec_order_clear_visited(&forward);
+  exec_order_clear_visited(&backward);
+  return errres;
+}
+
+em_result
+exec_order_add(machine_t * self, exec_sequence_t * es, journal_t * journal)
+{
+  em_result errres    = EM_RESULT_OK;
+  self->plan_outdated = true;
+  // Readers of the redefined nodes read es.
+  for(journal_t * j = journal; j != nullptr; j = j->next) {
+    exec_sequence_t * old = j->what->definition;
+    if(old == nullptr || old == es) continue;
+    for(size_t i = 0; i < old->successors.length; ++i)
+      if(exec_order_reads(SUCCESSORS(old)[i], j->what))
+        CHKERR(exec_order_add_successor(es, SUCCESSORS(old)[i]));
+  }
+  for(journal_t * j = journal; j != nullptr; j = j->next) {
+    exec_sequence_t * old = j->what->definition;
+    if(old == nullptr || old == es) continue;
+    j->what->definition = es;
+    for(size_t i = 0; i < old->successors.length;) {
+      exec_sequence_t * s = SUCCESSORS(old)[i];
+      if(exec_order_reads_from(s, old))
+        i++;
+      else
+        exec_order_remove_successor(old, s);
+    }
+    // es takes the place of the previous definition, which updates no nodes now.
+    if(es->order < 0 && old->order >= 0 && !exec_order_updates_nodes(old)) {
+      es->order              = old->order;
+      ORDER(self)[es->order] = es;
+      old->order             = -1;
+    }
+  }
+  if(es->node_definition != nullptr) es->node_definition->definition = es;
+  if(es->node_definitions != nullptr) exec_order_set_definition(es->node_definitions, es);
+  for(int i = 0; i < es->reads_length; ++i)
+    CHKERR(exec_order_add_successor(es->reads[i]->definition, es));
+  if(es->order < 0) {
+    CHKERR(arraylist_append(&(self->order), sizeof(exec_sequence_t *), &es));
+    es->order = (int)self->order.length - 1;
+  }
+  // Repair the edges which violate the order.
+  for(int i = 0; i < es->reads_length; ++i)
+    if(es->reads[i]->definition->order > es->order)
+      CHKERR(exec_order_repair(self, es->reads[i]->definition, es));
+  // Successors which are unordered now are removed by machine_cleanup.
+  for(size_t i = 0; i < es->successors.length; ++i)
+    if(SUCCESSORS(es)[i]->order >= 0 && es->order > SUCCESSORS(es)[i]->order)
+      CHKERR(exec_order_repair(self, es, SUCCESSORS(es)[i]));
+err:
+  return errres;
+}
+
+em_result
+exec_order_update_reads(machine_t * self, exec_sequence_t * es, node_t ** reads, int length)
+{
+  em_result   errres = EM_RESULT_OK;
+  arraylist_t visited;
+  arraylist_default(&visited);
+  if(length == es->reads_length) {
+    int i = 0;
+    while(i < length && exec_order_reads(es, reads[i]))
+      i++;
+    if(i == length) {  // Not changed.
+      em_free(reads);
+      return EM_RESULT_OK;
+    }
+  }
+  for(int i = 0; i < length; ++i)
+    TEST_AND_ERROR(reads[i]->definition == nullptr, EM_RESULT_MISSING_IDENTIFIER);
+  // A cycle is made if es reaches what it reads now.
+  CHKERR(exec_order_search(es, true, -1, (int)self->order.length, &visited));
+  for(int i = 0; i < length; ++i)
+    TEST_AND_ERROR(reads[i]->definition->visited, EM_RESULT_CYCLIC_REFERENCE);
+  exec_order_clear_visited(&visited);
+  for(int i = 0; i < es->reads_length; ++i)
+    if(es->reads[i]->definition != nullptr)
+      exec_order_remove_successor(es->reads[i]->definition, es);
+  em_free(es->reads);
+  es->reads           = reads;
+  es->reads_length    = length;
+  self->plan_outdated = true;
+  for(int i = 0; i < length; ++i)
+    CHKERR(exec_order_add_successor(reads[i]->definition, es));
+  // Repair the edges which violate the order.
+  for(int i = 0; i < length; ++i)
+    if(reads[i]->definition->order > es->order)
+      CHKERR(exec_order_repair(self, reads[i]->definition, es));
+  return EM_RESULT_OK;
+err:
+  exec_order_clear_visited(&visited);
+  return errres;
+}
+
+em_result
+exec_order_add_all(machine_t * self, exec_sequence_t ** added, size_t length)
+{
+  em_result          errres   = EM_RESULT_OK;
+  size_t             n        = self->order.length, total = n + length, count_edges = 0, tail = 0;
+  exec_sequence_t ** all      = nullptr;
+  exec_sequence_t ** next     = nullptr;
+  int *              indegree = nullptr, *first = nullptr, *edges = nullptr, *queue = nullptr;
+  if(length == 0) return EM_RESULT_OK;
+  CHKERR(em_allocarray((void **)&next, total, sizeof(exec_sequence_t *)));
+  CHKERR(em_allocarray((void **)&all, total, sizeof(exec_sequence_t *)));
+  CHKERR(em_allocarray((void **)&indegree, total, sizeof(int)));
+  CHKERR(em_allocarray((void **)&first, total + 1, sizeof(int)));
+  CHKERR(em_allocarray((void **)&queue, total, sizeof(int)));
+  // exec_sequence_t::order is the index in all while sorting.
+  for(size_t i = 0; i < n; ++i)
+    all[i] = ORDER(self)[i];
+  for(size_t i = 0; i < length; ++i) {
+    all[n + i]      = added[i];
+    added[i]->order = (int)(n + i);
+  }
+  // The edges are stored as the compressed rows: edges[first[i]] ... edges[first[i + 1] - 1].
+  for(size_t i = 0; i <= total; ++i)
+    first[i] = 0;
+  for(size_t i = 0; i < total; ++i) {
+    indegree[i] = all[i]->reads_length;
+    count_edges += all[i]->reads_length;
+    for(int j = 0; j < all[i]->reads_length; ++j)
+      first[all[i]->reads[j]->definition->order + 1]++;
+  }
+  for(size_t i = 0; i < total; ++i)
+    first[i + 1] += first[i];
+  if(count_edges > 0) CHKERR(em_allocarray((void **)&edges, count_edges, sizeof(int)));
+  for(size_t i = 0; i < total; ++i)
+    queue[i] = first[i];  // Used as the cursors.
+  for(size_t i = 0; i < total; ++i)
+    for(int j = 0; j < all[i]->reads_length; ++j)
+      edges[queue[all[i]->reads[j]->definition->order]++] = (int)i;
+  // Kahn's algorithm. The queue starts in the previous order, but it is not kept in general.
+  for(size_t i = 0; i < total; ++i)
+    if(indegree[i] == 0) queue[tail++] = (int)i;
+  for(size_t head = 0; head < tail; ++head)
+    for(int e = first[queue[head]]; e < first[queue[head] + 1]; ++e)
+      if(--indegree[edges[e]] == 0) queue[tail++] = edges[e];
+  TEST_AND_ERROR(tail != total, EM_RESULT_CYCLIC_REFERENCE);
+  // Commit. Nothing fails below except for the successors.
+  size_t live = 0;
+  for(size_t i = 0; i < total; ++i) {
+    exec_sequence_t * es  = all[queue[i]];
+    es->successors.length = 0;
+    if(exec_order_updates_nodes(es)) {
+      es->order    = (int)live;
+      next[live++] = es;
+    } else
+      es->order = -1;  // Removed by machine_cleanup.
+  }
+  em_free(self->order.buffer);
+  self->order.buffer   = next;
+  self->order.length   = live;
+  self->order.capacity = total;
+  self->plan_outdated  = true;
+  next                 = nullptr;
+  for(size_t i = 0; i < live; ++i) {
+    exec_sequence_t * es = ORDER(self)[i];
+    for(int j = 0; j < es->reads_length; ++j)
+      CHKERR(exec_order_add_successor(es->reads[j]->definition, es));
+  }
+err:
+  if(next != nullptr)  // Failed before the commit.
+    for(size_t i = 0; i < length; ++i)
+      added[i]->order = -1;
+  em_free(next);
+  em_free(all);
+  em_free(indegree);
+  em_free(first);
+  em_free(edges);
+  em_free(queue);
+  return errres;
+}
+
+void
+exec_order_remove(machine_t * self, exec_sequence_t * es)
+{
+  for(int i = 0; i < es->reads_length; ++i)
+    if(es->reads[i]->definition != nullptr)
+      exec_order_remove_successor(es->reads[i]->definition, es);
+  if(es->order < 0) return;
+  exec_sequence_t ** order = ORDER(self);
+  self->plan_outdated      = true;
+  for(size_t i = es->order + 1; i < self->order.length; ++i) {
+    order[i - 1]        = order[i];
+    order[i - 1]->order = (int)i - 1;
+  }
+  self->order.length--;
+  es->order = -1;
+}
@@ -0,0 +1,78 @@
+/** -------------------------------------------
+ * @file   exec_plan.c
+ * @brief  Execution Plan, the Flat Execution Order
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include "vm/exec_plan.h"
+#include "vm/machine.h"
+
+#define ENTRIES(m) ((exec_plan_entry_t *)((m)->plan.buffer))
+
+em_result
+exec_plan_build(machine_t * self)
+{
+  em_result          errres = EM_RESULT_OK;
+  exec_sequence_t ** order  = (exec_sequence_t **)self->order.buffer;
+  self->plan.length         = 0;
+  for(size_t i = 0; i < self->order.length; ++i) {
+    exec_sequence_t * es = order[i];
+    exec_plan_entry_t e  = {es, es->node_definition, nullptr, 0, 0};
+    switch(exec_sequence_program_kind(es)) {
+      case EMFRP_PROGRAM_KIND_AST:
+        if(exec_sequence_resolve_dependencies(self, es)) {
+          e.dependencies        = es->dependencies;
+          e.dependencies_length = es->dependencies_length;
+        } else
+          e.flags |= EXEC_PLAN_ENTRY_UNRESOLVED;
+        break;
+      case EMFRP_PROGRAM_KIND_CALLBACK:
+        e.flags |= EXEC_PLAN_ENTRY_ALWAYS;
+        break;
+      default:
+        if(e.last == nullptr) continue;  // Nothing to do.
+        e.flags |= EXEC_PLAN_ENTRY_NEVER;
+        break;
+    }
+    CHKERR(arraylist_append(&(self->plan), sizeof(exec_plan_entry_t), &e));
+  }
+  self->plan_outdated = false;
+err:
+  return errres;
+}
+
+em_result
+exec_plan_update_last(machine_t * self)
+{
+  em_result           errres  = EM_RESULT_OK;
+  exec_plan_entry_t * entries = ENTRIES(self);
+  for(size_t i = 0; i < self->plan.length; ++i)
+    if(entries[i].last != nullptr) CHKERR(update_node_last(self, entries[i].last));
+err:
+  return errres;
+}
+
+void
+exec_plan_update_values(machine_t * self, bool all)
+{
+  exec_plan_entry_t * entries = ENTRIES(self);
+  // In the topological order, the nodes which the sequence depends on are already updated.
+  for(size_t i = 0; i < self->plan.length; ++i) {
+    exec_plan_entry_t * e = &(entries[i]);
+    if(e->flags & EXEC_PLAN_ENTRY_NEVER) continue;
+    if(!all && !(e->flags & EXEC_PLAN_ENTRY_ALWAYS)) {
+      if(e->flags & EXEC_PLAN_ENTRY_UNRESOLVED) {
+        bool needs_update = exec_sequence_needs_update(self, e->sequence);
+        if(e->sequence->dependencies_length >= 0) {  // Resolved now.
+          e->dependencies        = e->sequence->dependencies;
+          e->dependencies_length = e->sequence->dependencies_length;
+          e->flags &= ~EXEC_PLAN_ENTRY_UNRESOLVED;
+        }
+        if(!needs_update) continue;
+      } else if(!node_dependencies_updated(
+                  e->dependencies, e->dependencies_length, self->iteration))
+        continue;
+    }
+    exec_sequence_update_value(self, e->sequence);  // Failures are reported by itself.
+  }
+}
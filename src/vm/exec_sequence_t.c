@@ -9,184 +9,24 @@
 #include "vm/gc.h"
 #include "vm/variable_t.h"
 #include "vm/machine.h"
-#include <stdio.h>
+#if EMFRP_ENABLE_PROFILING
+#include "emtime.h"
+#endif
+#include "emdiag.h"
 
 em_result
-get_dependencies_ast(machine_t * machine, parser_expression_t * v, list_t /*<string_t *>*/ ** out)
+exec_sequence_set_node(machine_t * machine, node_t * n, object_t * v)
 {
   em_result errres = EM_RESULT_OK;
-  if(EXPR_KIND_IS_INTEGER(v) || EXPR_KIND_IS_BOOLEAN(v)) return EM_RESULT_OK;
-  if(v->kind == EXPR_KIND_IDENTIFIER) {
-    string_t * s = &(v->value.identifier);
-    object_t * ignore;
-    if(!variable_table_lookup(machine->variable_table, &ignore, s)) {
-      CHKERR(list_add2(out, string_t *, &s));
-    } else
-      return EM_RESULT_OK;
-  } else if(EXPR_KIND_IS_BIN_OP(v)) {
-    CHKERR(get_dependencies_ast(machine, v->value.binary.lhs, out));
-    CHKERR(get_dependencies_ast(machine, v->value.binary.rhs, out));
-  } else
-    switch(v->kind) {
-      case EXPR_KIND_TUPLE:
-        for(parser_expression_tuple_list_t * li = &(v->value.tuple); li != nullptr; li = li->next)
-          CHKERR(get_dependencies_ast(machine, li->value, out));
-        break;
-      case EXPR_KIND_IF:
-        CHKERR(get_dependencies_ast(machine, v->value.ifthenelse.cond, out));
-        CHKERR(get_dependencies_ast(machine, v->value.ifthenelse.then, out));
-        CHKERR(get_dependencies_ast(machine, v->value.ifthenelse.otherwise, out));
-        break;
-      case EXPR_KIND_FUNCCALL:
-        CHKERR(get_dependencies_ast(machine, v->value.funccall.callee, out));
-        if(v->value.funccall.arguments.value != nullptr) {
-          for(parser_expression_tuple_list_t * li = &(v->value.funccall.arguments); li != nullptr;
-              li                                  = li->next)
-            CHKERR(get_dependencies_ast(machine, li->value, out));
-        }
-        break;
-      default:
-        break;
-    }
-  // return EM_RESULT_OK;
+  if(n->cut_off && exec_equal(n->value, v)) return EM_RESULT_OK;  // Not changed.
+  CHKERR(machine_mark_gray(machine, n->value));
+  n->value      = v;
+  n->updated_at = machine->iteration;
+  if(n->action != nullptr) n->action(v);
 err:
   return errres;
 }
 
-bool
-check_depends_on_ast(parser_expression_t * v, string_t * str)
-{
-  if(EXPR_KIND_IS_INTEGER(v) || EXPR_KIND_IS_BOOLEAN(v)) return false;
-  if(v->kind == EXPR_KIND_IDENTIFIER)
-    return string_compare(&(v->value.identifier), str);
-  else if(EXPR_KIND_IS_BIN_OP(v))
-    return check_depends_on_ast(v->value.binary.lhs, str)
-        || check_depends_on_ast(v->value.binary.rhs, str);
-  else
-    switch(v->kind) {
-      case EXPR_KIND_TUPLE:
-        for(parser_expression_tuple_list_t * li = &(v->value.tuple); li != nullptr; li = li->next)
-          if(check_depends_on_ast(li->value, str)) return true;
-        return false;
-      case EXPR_KIND_IF:
-        return check_depends_on_ast(v->value.ifthenelse.cond, str)
-            || check_depends_on_ast(v->value.ifthenelse.then, str)
-            || check_depends_on_ast(v->value.ifthenelse.otherwise, str);
-      case EXPR_KIND_FUNCCALL:
-        if(check_depends_on_ast(v->value.funccall.callee, str)) return true;
-        if(v->value.funccall.arguments.value != nullptr) {
-          for(parser_expression_tuple_list_t * li = &(v->value.funccall.arguments); li != nullptr;
-              li                                  = li->next)
-            if(check_depends_on_ast(li->value, str)) return true;
-        }
-        return false;
-      default:
-        break;
-    }
-  return false;
-}
-
-typedef struct topo_t
-{
-  list_t * /*<exec_sequence_t>*/ val;
-  list_t * /*<string_t*>*/       references;
-} topo_t;
-
-bool
-go_topological_sort(string_t * dependency, node_or_tuple_t * nt)
-{
-  if(nt == nullptr) return false;
-  switch(nt->kind) {
-    case NODE_OR_TUPLE_NONE:
-      return false;
-    case NODE_OR_TUPLE_NODE: {
-      if(nt->value.node == nullptr) return false;
-      return string_compare(dependency, &(nt->value.node->name));
-    }
-    case NODE_OR_TUPLE_TUPLE:
-      for(int i = 0; i < nt->value.tuple.length; ++i)
-        if(go_topological_sort(dependency, &(((node_or_tuple_t *)(nt->value.tuple.buffer))[i])))
-          return true;
-      return false;
-    default:
-      return false;
-  }
-}
-
-em_result
-topological_sort(
-  machine_t * machine, list_t /*<exec_sequence_t>*/ ** es, list_t /*<exec_sequence_t>*/ *** last_es)
-{
-  em_result errres = EM_RESULT_OK;
-  if(*es == nullptr) return EM_RESULT_OK;
-  queue_t /*<topo_t>*/ ts;
-  CHKERR(queue_default(&ts));
-  queue_t /*<topo_t>*/ empty;
-  CHKERR(queue_default(&empty));
-  for(list_t /*<exec_sequence_t>*/ * i = *es; i != nullptr; i = LIST_NEXT(i)) {
-    topo_t            v = {i, nullptr};
-    exec_sequence_t * e = (exec_sequence_t *)&(i->value);
-    if(e->program_kind == EMFRP_PROGRAM_KIND_AST)
-      CHKERR(get_dependencies_ast(machine, e->program.ast, &(v.references)));
-    CHKERR(queue_enqueue(v.references == nullptr ? &empty : &ts, sizeof(topo_t), &v));
-  }
-  for(list_t * li = empty.head; li != nullptr; li = LIST_NEXT(li)) {
-    topo_t *          li_v   = (topo_t *)&(li->value);
-    exec_sequence_t * li_v_v = (exec_sequence_t *)&(li_v->val->value);
-    for(list_t ** lli_ = &(ts.head); *lli_ != nullptr;) {
-      list_t * lli   = *lli_;
-      topo_t * lli_v = (topo_t *)&(lli->value);
-      for(list_t ** /*<string_t *>*/ refs = &(lli_v->references); *refs != nullptr;) {
-        if(
-          (li_v_v->node_definition != nullptr
-           && string_compare(&(li_v_v->node_definition->name), (string_t *)((*refs)->value)))
-          || go_topological_sort((string_t *)((*refs)->value), li_v_v->node_definitions)) {
-          list_t * ne = (*refs)->next;
-          em_free(*refs);
-          *refs = ne;
-        } else
-          refs = &((*refs)->next);
-      }
-      if(lli_v->references == nullptr) {
-        list_t * ne   = lli->next;
-        *(empty.last) = lli;
-        empty.last    = &(lli->next);
-        lli->next     = nullptr;
-        *lli_         = ne;
-      } else
-        lli_ = &(lli->next);
-    }
-  }
-
-  if(ts.head == nullptr) {  // SUCCESS
-    list_t ** las = es;
-    for(list_t * cur = empty.head; cur != nullptr; cur = cur->next) {
-      *las = ((topo_t *)(&(cur->value)))->val;
-      las  = &((*las)->next);
-    }
-    *(last_es) = las;
-  }
-
-  list_t * cur = ts.head;
-  while(cur != nullptr) {
-    list_t * f = cur;
-    cur        = cur->next;
-    list_free(&(((topo_t *)(&(f->value)))->references));
-    em_free(f);
-  }
-  cur = empty.head;
-  while(cur != nullptr) {
-    list_t * f = cur;
-    cur        = cur->next;
-    list_free(&(((topo_t *)(&(f->value)))->references));
-    em_free(f);
-  }
-
-  return ts.head == nullptr ? EM_RESULT_OK : EM_RESULT_CYCLIC_REFERENCE;
-err:  // TODO: Freeing.
-  return errres;
-}
-
 em_result
 exec_sequence_set_nil(machine_t * machine, node_or_tuple_t * nt)
 {
@@ -194,13 +34,10 @@ exec_sequence_set_nil(machine_t * machine, node_or_tuple_t * nt)
   switch(nt->kind) {
     case NODE_OR_TUPLE_NONE:
       return EM_RESULT_OK;
-    case NODE_OR_TUPLE_NODE: {
-      node_t * n = nt->value.node;
-      CHKERR(machine_mark_gray(machine, n->value));
-      n->value = nullptr;
-      if(n->action != nullptr) n->action(nullptr);
+    case NODE_OR_TUPLE_NODE:
+      if(nt->value.node != nullptr)
+        CHKERR(exec_sequence_set_node(machine, nt->value.node, nullptr));
       break;
-    }
     case NODE_OR_TUPLE_TUPLE: {
       arraylist_t /* <node_or_tuple_t> */ * al = &(nt->value.tuple);
       for(int i = 0; i < al->length; ++i)
@@ -217,18 +54,13 @@ err:
 em_result
 exec_sequence_set_nodes(machine_t * machine, node_or_tuple_t * nt, object_t * v)
 {
-  em_result errres = EM_RESULT_OK;
   if(v == nullptr) return exec_sequence_set_nil(machine, nt);
   switch(nt->kind) {
     case NODE_OR_TUPLE_NONE:
       return EM_RESULT_OK;
     case NODE_OR_TUPLE_NODE: {
-      node_t * n = nt->value.node;
-      if(n == nullptr) return EM_RESULT_OK;
-      CHKERR(machine_mark_gray(machine, n->value));
-      n->value = v;
-      if(n->action != nullptr) n->action(v);
-      return EM_RESULT_OK;
+      if(nt->value.node == nullptr) return EM_RESULT_OK;
+      return exec_sequence_set_node(machine, nt->value.node, v);
     }
     case NODE_OR_TUPLE_TUPLE: {
       arraylist_t /* <node_or_tuple_t> */ * al = &(nt->value.tuple);
@@ -265,43 +97,53 @@ exec_sequence_set_nodes(machine_t * machine, node_or_tuple_t * nt, object_t * v)
       }
     }
   }
-err:
-  return errres;
+  return EM_RESULT_OK;
 }
 
 em_result
 exec_sequence_update_value_given_object(machine_t * machine, exec_sequence_t * self, object_t * obj)
 {
   em_result errres = EM_RESULT_OK;
-  if(self->node_definition != nullptr) {
-    CHKERR(machine_mark_gray(machine, self->node_definition->value));
-    self->node_definition->value = obj;
-    if(self->node_definition->action != nullptr) self->node_definition->action(obj);
-  }
+  if(self->node_definition != nullptr)
+    CHKERR(exec_sequence_set_node(machine, self->node_definition, obj));
   if(
     self->node_definitions != nullptr
     && exec_sequence_set_nodes(machine, self->node_definitions, obj) != EM_RESULT_OK)
     goto err2;
   return EM_RESULT_OK;
 err:
-  if(self->node_definition != nullptr) {
-    CHKERR(machine_mark_gray(machine, self->node_definition->value));
-    self->node_definition->value = nullptr;
-    if(self->node_definition->action != nullptr) self->node_definition->action(nullptr);
-  }
+  if(self->node_definition != nullptr)
+    exec_sequence_set_node(machine, self->node_definition, nullptr);
 err2:
   if(self->node_definitions != nullptr) exec_sequence_set_nil(machine, self->node_definitions);
   return errres;
 }
 
-em_result
-exec_sequence_update_value(machine_t * machine, exec_sequence_t * self)
+void
+exec_sequence_report_failure(exec_sequence_t * self, const char * action, em_result res)
+{
+  if(exec_sequence_marked_lastfailed(self)) return;
+  exec_sequence_mark_lastfailed(self);
+  if(em_diag_is_enabled(EM_DIAG_LEVEL_ERROR)) {
+    em_diag_begin(EM_DIAG_LEVEL_ERROR);
+    em_diag_printf("The %s of ", action);
+    if(self->node_definitions != nullptr)
+      node_or_tuple_debug_print(self->node_definitions);
+    else
+      em_diag_puts(self->node_definition->name->buffer);
+    em_diag_printf(" is failed: %s\n", EM_RESULT_STR_TABLE[res]);
+    em_diag_end();
+  }
+}
+
+static em_result
+exec_sequence_update_value2(machine_t * machine, exec_sequence_t * self)
 {
   em_result  errres;
   object_t * new_obj = nullptr;
   switch(exec_sequence_program_kind(self)) {
     case EMFRP_PROGRAM_KIND_AST:
-      CHKERR(exec_ast(machine, self->program.ast, &new_obj));
+      CHKERR(exec_bytecode(machine, self->program.ast.code, &new_obj));
       break;
     case EMFRP_PROGRAM_KIND_CALLBACK:
       new_obj = self->program.callback();
@@ -314,19 +156,29 @@ exec_sequence_update_value(machine_t * machine, exec_sequence_t * self)
   exec_sequence_unmark_lastfailed(self);
   return errres;
 err:
-#if __ESP_IDF
+  if(errres != EM_RESULT_OK) exec_sequence_report_failure(self, "execution", errres);
   return errres;
-#endif
-  if(errres != EM_RESULT_OK && !exec_sequence_marked_lastfailed(self)) {
-    exec_sequence_mark_lastfailed(self);
-    printf("The execution of ");
-    if(self->node_definitions != nullptr)
-      node_or_tuple_debug_print(self->node_definitions);
-    else
-      printf("%s", self->node_definition->name.buffer);
-    printf(" is failed: %s\n", EM_RESULT_STR_TABLE[errres]);
-  }
+}
+
+em_result
+exec_sequence_update_value(machine_t * machine, exec_sequence_t * self)
+{
+#if EMFRP_ENABLE_PROFILING
+  if(exec_sequence_program_kind(self) == EMFRP_PROGRAM_KIND_NOTHING) return EM_RESULT_OK;
+  exec_sequence_profile_t * p           = &(self->profile);
+  size_t                    allocations = machine->memory_manager->allocations;
+  uint64_t                  started     = em_time_ns();
+  em_result                 errres      = exec_sequence_update_value2(machine, self);
+  uint64_t                  elapsed     = em_time_ns() - started;
+  p->evaluations++;
+  p->total_ns += elapsed;
+  if(p->max_ns < elapsed) p->max_ns = elapsed;
+  p->allocations += machine->memory_manager->allocations - allocations;
+  if(errres != EM_RESULT_OK) p->failures++;
   return errres;
+#else
+  return exec_sequence_update_value2(machine, self);
+#endif
 }
 
 em_result
@@ -335,6 +187,8 @@ update_node_last(struct machine_t * machine, node_t * n)
   em_result errres;
   if(n == nullptr) return EM_RESULT_OK;
   CHKERR(machine_mark_gray(machine, n->last));
+  // node_t::value is updated in the previous iteration or before this iteration.
+  if(n->updated_at + 1 >= machine->iteration) n->last_updated_at = machine->iteration;
   n->last = n->value;
   return EM_RESULT_OK;
 err:
@@ -372,6 +226,200 @@ err:
   return errres;
 }
 
+// ! The state of exec_sequence_walk_reads.
+typedef struct exec_sequence_walk_t
+{
+  // ! The machine.
+  machine_t * machine;
+  // ! Called with each node.
+  exec_sequence_read_callback_t callback;
+  // ! The user data of exec_sequence_walk_t::callback.
+  void * user;
+  // ! Visited code and variable tables.(void *)
+  arraylist_t visited;
+  // ! Whether names which are not linked yet are found.
+  bool unresolved;
+  // ! Whether global variables are followed.
+  bool globals;
+} exec_sequence_walk_t;
+
+// ! Mark ptr as visited.
+/* !
+ * \return Whether it is visited for the first time(true) or not(false).
+ */
+static bool
+exec_sequence_walk_visit(exec_sequence_walk_t * w, void * ptr, em_result * errres)
+{
+  for(size_t i = 0; i < w->visited.length; ++i)
+    if(((void **)(w->visited.buffer))[i] == ptr) return false;
+  *errres = arraylist_append(&(w->visited), sizeof(void *), &ptr);
+  return *errres == EM_RESULT_OK;
+}
+
+static em_result exec_sequence_walk_code(exec_sequence_walk_t * w, bytecode_t * code, bool nested);
+
+// ! Follow the functions in the value.(e.g. data whose value is a tuple of the functions.)
+static em_result
+exec_sequence_walk_object(exec_sequence_walk_t * w, object_t * v)
+{
+  em_result errres = EM_RESULT_OK;
+  if(v == nullptr || !object_is_pointer(v)) return EM_RESULT_OK;
+  switch(object_kind(v)) {
+    case EMFRP_OBJECT_TUPLE1:
+      return exec_sequence_walk_object(w, v->value.tuple1.i0);
+    case EMFRP_OBJECT_TUPLE2:
+      CHKERR(exec_sequence_walk_object(w, v->value.tuple2.i0));
+      return exec_sequence_walk_object(w, v->value.tuple2.i1);
+    case EMFRP_OBJECT_TUPLEN:
+      for(size_t i = 0; i < v->value.tupleN.length; ++i)
+        CHKERR(exec_sequence_walk_object(w, object_tuple_ith(v, i)));
+      break;
+    case EMFRP_OBJECT_FUNCTION: {
+      if(v->value.function.kind != EMFRP_PROGRAM_KIND_BYTECODE) break;
+      object_t * closure = v->value.function.function.bytecode.closure;
+      CHKERR(exec_sequence_walk_code(w, v->value.function.function.bytecode.program, true));
+      // Captured variables may be functions too.
+      if(closure == nullptr) break;
+      for(variable_table_t * vt = closure->value.variable_table.ptr; vt != nullptr;
+          vt                    = vt->parent) {
+        if(!exec_sequence_walk_visit(w, vt, &errres)) break;
+        for(size_t i = 0; i < vt->length; ++i)
+          CHKERR(exec_sequence_walk_object(w, vt->slots[i]));
+      }
+      break;
+    }
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+static em_result
+exec_sequence_walk_code(exec_sequence_walk_t * w, bytecode_t * code, bool nested)
+{
+  em_result errres = EM_RESULT_OK;
+  if(!exec_sequence_walk_visit(w, code, &errres)) return errres;
+  for(size_t i = 0; i < code->length; ++i) {
+    int          v  = INSTRUCTION_OPERAND(code->code[i]);
+    opcode_t     op = INSTRUCTION_OPCODE(code->code[i]);
+    variable_t * var;
+    node_t *     n;
+    switch(OPCODE_LOADS_NODE(op) ? OPCODE_LOAD_NODE : op) {
+      case OPCODE_LOAD_NAME:  // It is linked at runtime like this.
+        if(machine_lookup_global_atom(w->machine, &var, code->constants[v].name)) {
+          w->globals = true;
+          CHKERR(exec_sequence_walk_object(w, var->value));
+        } else if(machine_lookup_node_atom(w->machine, &n, code->constants[v].name)) {
+          w->unresolved = true;
+          CHKERR(w->callback(w->user, n, false));
+        } else {
+          // Functions may refer to the ones defined later.
+          TEST_AND_ERROR(!nested, EM_RESULT_MISSING_IDENTIFIER);
+          w->unresolved = true;
+        }
+        break;
+      case OPCODE_LOAD_LAST:
+        w->unresolved = true;
+        break;
+      case OPCODE_LOAD_NODE:
+        CHKERR(w->callback(w->user, code->constants[v].node, false));
+        break;
+      case OPCODE_LOAD_NODE_LAST:
+        CHKERR(w->callback(w->user, code->constants[v].node, true));
+        break;
+      case OPCODE_LOAD_GLOBAL:
+        w->globals = true;
+        CHKERR(exec_sequence_walk_object(w, code->constants[v].global->value));
+        break;
+      case OPCODE_CLOSURE:
+        CHKERR(exec_sequence_walk_code(w, code->constants[v].bytecode, nested));
+        break;
+      default:
+        break;
+    }
+  }
+err:
+  return errres;
+}
+
+em_result
+exec_sequence_walk_reads(
+  machine_t * machine, bytecode_t * code, exec_sequence_read_callback_t callback, void * user,
+  bool * unresolved, bool * globals)
+{
+  exec_sequence_walk_t w = {.machine = machine, .callback = callback, .user = user};
+  arraylist_default(&(w.visited));
+  em_result errres = exec_sequence_walk_code(&w, code, false);
+  arraylist_free(&(w.visited));
+  if(unresolved != nullptr) *unresolved = w.unresolved;
+  if(globals != nullptr) *globals = w.globals;
+  return errres;
+}
+
+// ! exec_sequence_t::dependencies being collected.
+typedef struct exec_sequence_deps_t
+{
+  node_dependency_t * deps;
+  int                 length;
+  int                 capacity;
+} exec_sequence_deps_t;
+
+static em_result
+collect_dependency(void * user, node_t * node, bool last)
+{
+  em_result              errres = EM_RESULT_OK;
+  exec_sequence_deps_t * d      = (exec_sequence_deps_t *)user;
+  for(int j = 0; j < d->length; ++j)
+    if(d->deps[j].node == node && d->deps[j].last == last) return EM_RESULT_OK;  // Collected.
+  if(d->length == d->capacity) {
+    d->capacity = d->capacity == 0 ? 4 : d->capacity * 2;
+    CHKERR(em_reallocarray((void **)&(d->deps), d->deps, d->capacity, sizeof(node_dependency_t)));
+  }
+  d->deps[d->length++] = (node_dependency_t){node, last};
+err:
+  return errres;
+}
+
+bool
+exec_sequence_resolve_dependencies(machine_t * machine, exec_sequence_t * self)
+{
+  exec_sequence_deps_t d          = {nullptr, 0, 0};
+  bool                 unresolved = false;
+  if(self->dependencies_length >= 0) return true;
+  em_free(self->dependencies);
+  self->dependencies = nullptr;
+  if(
+    exec_sequence_walk_reads(
+      machine, self->program.ast.code, collect_dependency, &d, &unresolved, nullptr)
+      != EM_RESULT_OK
+    || unresolved) {
+    // The names may refer nodes at runtime, so collect them again at the next time.
+    em_free(d.deps);
+    self->dependencies_length = -1;
+    return false;
+  }
+  self->dependencies        = d.deps;
+  self->dependencies_length = d.length;
+  return true;
+}
+
+bool
+exec_sequence_needs_update(machine_t * machine, exec_sequence_t * self)
+{
+  switch(exec_sequence_program_kind(self)) {
+    case EMFRP_PROGRAM_KIND_AST:
+      break;
+    case EMFRP_PROGRAM_KIND_CALLBACK:
+      return true;
+    default:
+      return false;
+  }
+  if(!exec_sequence_resolve_dependencies(machine, self)) return true;
+  return node_dependencies_updated(
+    self->dependencies, self->dependencies_length, machine->iteration);
+}
+
 bool
 node_or_tuple_t_compact(node_or_tuple_t * nt)
 {
@@ -420,32 +468,35 @@ exec_sequence_free(exec_sequence_t * es)
 #if DEBUG
   if(es->node_definitions != nullptr) DEBUGBREAK;
 #endif
-  if(exec_sequence_program_kind(es) == EMFRP_PROGRAM_KIND_AST)
-    parser_expression_free(es->program.ast);
+  if(exec_sequence_program_kind(es) == EMFRP_PROGRAM_KIND_AST) {
+    bytecode_release(es->program.ast.code);
+    parser_toplevel_release(es->program.ast.source);
+  }
+  em_free(es->dependencies);
+  em_free(es->reads);
+  arraylist_free(&(es->successors));
 }
 
-#include <stdio.h>
-
 void
 node_or_tuple_debug_print(node_or_tuple_t * nt)
 {
   switch(nt->kind) {
     case NODE_OR_TUPLE_NONE:
-      printf("*");
+      em_diag_puts("*");
       break;
     case NODE_OR_TUPLE_NODE:
-      printf("%s", nt->value.node->name.buffer);
+      em_diag_puts(nt->value.node->name->buffer);
       break;
     case NODE_OR_TUPLE_TUPLE:
-      printf("(");
+      em_diag_puts("(");
       {  //if(nt->value.tuple.length > 0) {
         node_or_tuple_debug_print(&(((node_or_tuple_t *)(nt->value.tuple.buffer))[0]));
         for(int i = 1; i < nt->value.tuple.length; ++i) {
-          printf(", ");
+          em_diag_puts(", ");
           node_or_tuple_debug_print(&(((node_or_tuple_t *)(nt->value.tuple.buffer))[i]));
         }
       }
-      printf(")");
+      em_diag_puts(")");
       break;
   }
 }
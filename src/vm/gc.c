@@ -13,25 +13,111 @@
 #define MARK_LIMIT  20
 #define SWEEP_LIMIT 8
 
+// ! Whether the object is in the nursery.
+#define IN_NURSERY(self, o)                                                                        \
+  ((self)->nursery <= (o) && (o) < (self)->nursery + MEMORY_MANAGER_NURSERY_SIZE)
+
+// ! Allocate a new page, and append it to the heap.
+/* !
+ * \param self The memory manager
+ * \return The result(may return out of memory, if it reaches memory_manager_t::max_pages.)
+ */
+static em_result
+memory_manager_add_page(memory_manager_t * self)
+{
+  em_result       errres = EM_RESULT_OK;
+  memory_page_t * page   = nullptr;
+  TEST_AND_ERROR(self->pages_length >= self->max_pages, EM_RESULT_OUT_OF_MEMORY);
+  if(self->pages_length == self->pages_capacity) {
+    int new_capacity = self->pages_capacity == 0 ? 4 : self->pages_capacity * 2;
+    CHKERR(
+      em_reallocarray((void **)&(self->pages), self->pages, new_capacity, sizeof(memory_page_t *)));
+    self->pages_capacity = new_capacity;
+  }
+  CHKERR(em_malloc((void **)&page, sizeof(memory_page_t)));
+  object_t * next = nullptr;
+  for(int i = MEMORY_MANAGER_PAGE_SIZE - 1; i >= 0; --i) {
+    object_new_freelist(&(page->space[i]), next);
+    next = &(page->space[i]);
+  }
+  page->freelist                  = page->space;
+  page->remaining                 = MEMORY_MANAGER_PAGE_SIZE;
+  self->allocator                 = self->pages_length;
+  self->pages[self->pages_length] = page;
+  self->pages_length++;
+  self->remaining += MEMORY_MANAGER_PAGE_SIZE;
+err:
+  return errres;
+}
+
+// ! Return empty pages to the system.
+/* !
+ * It is called after sweeping. The half of the heap is kept free, so that the gc does not start
+ * again immediately.
+ * \param self The memory manager
+ */
+static void
+memory_manager_release_pages(memory_manager_t * self)
+{
+  // memory_manager_t::remembered may refer dead objects in empty pages.
+  if(self->remembered.length > 0) return;
+  int j = 0;
+  for(int i = 0; i < self->pages_length; ++i) {
+    memory_page_t * page = self->pages[i];
+    if(
+      page->remaining == MEMORY_MANAGER_PAGE_SIZE
+      && self->pages_length - (i - j) > MEMORY_MANAGER_MIN_PAGES
+      && !MEMORY_MANAGER_SHOULD_START_GC(
+        self->remaining - MEMORY_MANAGER_PAGE_SIZE, self->pages_length - (i - j) - 1)) {
+      self->remaining -= MEMORY_MANAGER_PAGE_SIZE;
+      em_free(page);
+      continue;
+    }
+    self->pages[j] = page;
+    j++;
+  }
+  self->pages_length = j;
+  self->allocator    = 0;
+}
+
 em_result
 memory_manager_new(memory_manager_t ** out)
 {
   em_result          errres = EM_RESULT_OK;
   memory_manager_t * m;
   CHKERR(em_malloc((void **)&m, sizeof(memory_manager_t)));
-  *out            = m;
-  object_t * next = nullptr;
-  for(int i = MEMORY_MANAGER_HEAP_SIZE - 1; i >= 0; --i) {
-    object_new_freelist(&(m->space[i]), next);
-    next = &(m->space[i]);
-  }
-  m->freelist     = m->space;
-  m->remaining    = MEMORY_MANAGER_HEAP_SIZE;
-  m->worklist[0]  = nullptr;
-  m->worklist_top = 0;
-  m->state        = MEMORY_MANAGER_STATE_IDLE;
-  m->sweeper      = MEMORY_MANAGER_HEAP_SIZE;
-  //return EM_RESULT_OK;
+  m->pages               = nullptr;
+  m->pages_length        = 0;
+  m->pages_capacity      = 0;
+  m->max_pages           = MEMORY_MANAGER_MAX_PAGES;
+  m->allocator           = 0;
+  m->remaining           = 0;
+  m->worklist[0]         = nullptr;
+  m->worklist_top        = 0;
+  m->worklist_overflowed = false;
+  m->state               = MEMORY_MANAGER_STATE_IDLE;
+  m->sweeper_page        = 0;
+  m->sweeper             = 0;
+  m->nursery_top         = 0;
+  m->nursery_enabled     = false;
+  m->allocations         = 0;
+  m->gc_cycles           = 0;
+  arraylist_default(&(m->remembered));
+  arraylist_default(&(m->promoted));
+  CHKERR2(
+    err_nursery,
+    em_allocarray((void **)&(m->nursery), MEMORY_MANAGER_NURSERY_SIZE, sizeof(object_t)));
+  for(int i = 0; i < MEMORY_MANAGER_MIN_PAGES; ++i)
+    CHKERR2(err2, memory_manager_add_page(m));
+  *out = m;
+  return EM_RESULT_OK;
+err2:
+  for(int i = 0; i < m->pages_length; ++i)
+    em_free(m->pages[i]);
+  em_free(m->pages);
+  em_free(m->nursery);
+err_nursery:
+  em_free(m);
 err:
   return errres;
 }
@@ -46,13 +132,83 @@ memory_manager_push_worklist_uncheck_state(memory_manager_t * self, object_t * o
     return EM_RESULT_OK;
   object_mark(obj);
   //printf("marked: %d\n", ((int)obj - (int)self->space) / sizeof(object_t));
-  if(MEMORY_MANAGER_WORK_LIST_SIZE == self->worklist_top) return EM_RESULT_GC_WORKLIST_OVERFLOW;
+  if(MEMORY_MANAGER_WORK_LIST_SIZE == self->worklist_top) {
+    // obj is already marked, its children are pushed when marked objects are rescanned.
+    self->worklist_overflowed = true;
+    return EM_RESULT_OK;
+  }
   self->worklist[self->worklist_top] = obj;
   self->worklist_top++;
   return EM_RESULT_OK;
 }
 #define push_worklist(s, o) memory_manager_push_worklist_uncheck_state(s, o)
 
+// ! Push children of the object.
+/* !
+ * \param self The memory manager
+ * \param cur The object
+ * \param cost The cost of marking, which is added.
+ * \return The result
+ */
+em_result
+memory_manager_mark_children(memory_manager_t * self, object_t * cur, int * cost)
+{
+  em_result errres = EM_RESULT_OK;
+  int       i      = *cost;
+  switch(object_kind(cur)) {
+    case EMFRP_OBJECT_TUPLE1:
+      CHKERR(push_worklist(self, cur->value.tuple1.i0));
+      i += 1;
+      break;
+    case EMFRP_OBJECT_TUPLE2:
+      CHKERR(push_worklist(self, cur->value.tuple2.i0));
+      CHKERR(push_worklist(self, cur->value.tuple2.i1));
+      i += 2;
+      break;
+    //case EMFRP_OBJECT_STACK:
+    case EMFRP_OBJECT_TUPLEN:
+      for(size_t i = 0; i < cur->value.tupleN.length; ++i)
+        CHKERR(push_worklist(self, object_tuple_ith(cur, i)));
+      i += cur->value.tupleN.length;
+      break;
+    case EMFRP_OBJECT_VARIABLE_TABLE:
+      if(cur->value.variable_table.ptr != nullptr) {
+        variable_table_t * vt = cur->value.variable_table.ptr;
+        for(size_t j = 0; j < vt->length; ++j)
+          CHKERR(push_worklist(self, vt->slots[j]));
+        i += vt->length;
+        if(vt->parent != nullptr) {
+          CHKERR(push_worklist(self, vt->parent->this_object_ref));
+          i++;
+        }
+      }
+      break;
+    case EMFRP_OBJECT_FUNCTION: {
+      switch(cur->value.function.kind) {
+        case EMFRP_PROGRAM_KIND_BYTECODE:
+          CHKERR(push_worklist(self, cur->value.function.function.bytecode.closure));
+          break;
+        case EMFRP_PROGRAM_KIND_NOTHING:
+        case EMFRP_PROGRAM_KIND_CALLBACK:
+        case EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT:  // Tags are not objects.
+        case EMFRP_PROGRAM_KIND_RECORD_ACCESS:
+          break;
+        default:
+          DEBUGBREAK;
+          break;
+      }
+      break;
+    }
+    case EMFRP_OBJECT_FREE:
+    case EMFRP_OBJECT_STRING:
+    case EMFRP_OBJECT_SYMBOL:
+      break;
+  }
+err:
+  *cost = i;
+  return errres;
+}
+
 em_result
 memory_manager_mark(memory_manager_t * self, int mark_limit)
 {
@@ -60,130 +216,105 @@ memory_manager_mark(memory_manager_t * self, int mark_limit)
   for(int i = 0; i < mark_limit; ++i) {
     if(self->worklist_top == 0) break;
     self->worklist_top--;
-    object_t * cur = self->worklist[self->worklist_top];
-    switch(object_kind(cur)) {
-      case EMFRP_OBJECT_TUPLE1:
-        CHKERR(push_worklist(self, cur->value.tuple1.i0));
-        CHKERR(push_worklist(self, cur->value.tuple1.tag));
-        i += 1;
-        break;
-      case EMFRP_OBJECT_TUPLE2:
-        CHKERR(push_worklist(self, cur->value.tuple2.i0));
-        CHKERR(push_worklist(self, cur->value.tuple2.i1));
-        CHKERR(push_worklist(self, cur->value.tuple2.tag));
-        i += 2;
-        break;
-      //case EMFRP_OBJECT_STACK:
-      case EMFRP_OBJECT_TUPLEN:
-        for(size_t i = 0; i < cur->value.tupleN.length; ++i)
-          CHKERR(push_worklist(self, object_tuple_ith(cur, i)));
-        CHKERR(push_worklist(self, cur->value.tupleN.tag));
-        i += cur->value.tupleN.length;
-        break;
-      case EMFRP_OBJECT_VARIABLE_TABLE:
-        if(cur->value.variable_table.ptr != nullptr) {
-          list_t * li;
-          FOREACH_DICTIONARY(li, &(cur->value.variable_table.ptr->table))
-          {
-            void * v;
-            FOREACH_LIST(v, li)
-            {
-              variable_t * n = (variable_t *)v;
-              //printf("root: %s %d\n", n->name.buffer , ((int)n->value - (int)self->memory_manager->space) / sizeof(object_t));
-              CHKERR(push_worklist(self, n->value));
-              i++;
-            }
-          }
-          if(cur->value.variable_table.ptr->parent != nullptr) {
-            CHKERR(push_worklist(self, cur->value.variable_table.ptr->parent->this_object_ref));
-            i++;
-          }
-        }
-        break;
-      case EMFRP_OBJECT_FUNCTION: {
-        switch(cur->value.function.kind) {
-          case EMFRP_PROGRAM_KIND_AST:
-            CHKERR(push_worklist(self, cur->value.function.function.ast.closure));
-            break;
-          case EMFRP_PROGRAM_KIND_NOTHING:
-          case EMFRP_PROGRAM_KIND_CALLBACK:
-            break;
-          case EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT:
-            CHKERR(push_worklist(self, cur->value.function.function.construct.tag));
-            break;
-          case EMFRP_PROGRAM_KIND_RECORD_ACCESS:
-            CHKERR(push_worklist(self, cur->value.function.function.access.tag));
-            break;
-          default:
-            DEBUGBREAK;
-            break;
-        }
-        break;
+    CHKERR(memory_manager_mark_children(self, self->worklist[self->worklist_top], &i));
+  }
+  if(self->worklist_top == 0 && self->worklist_overflowed) {
+    // Rescan marked objects, because some of them are dropped from the work list.
+    int ignore                = 0;
+    self->worklist_overflowed = false;
+    for(int p = 0; p < self->pages_length; ++p) {
+      for(int j = 0; j < MEMORY_MANAGER_PAGE_SIZE; ++j) {
+        object_t * cur = &(self->pages[p]->space[j]);
+        if(object_is_marked(cur) && object_kind(cur) != EMFRP_OBJECT_FREE)
+          CHKERR(memory_manager_mark_children(self, cur, &ignore));
       }
-      case EMFRP_OBJECT_FREE:
-      case EMFRP_OBJECT_STRING:
-      case EMFRP_OBJECT_SYMBOL:
-        break;
+    }
+    for(int j = 0; j < self->nursery_top; ++j) {
+      object_t * cur = &(self->nursery[j]);
+      if(object_is_marked(cur) && object_kind(cur) != EMFRP_OBJECT_FREE)
+        CHKERR(memory_manager_mark_children(self, cur, &ignore));
     }
   }
 err:
   return errres;
 }
 
-void
+// ! Free resources which the dead object holds.
+/* !
+ * \param cur The object
+ * \return The additional cost of sweeping.
+ */
+static int
+memory_manager_finalize(object_t * cur)
+{
+  int cost = 0;
+  switch(object_kind(cur)) {
+    case EMFRP_OBJECT_SYMBOL:
+      string_free(&(cur->value.symbol.value));
+      break;
+    //case EMFRP_OBJECT_STACK:
+    case EMFRP_OBJECT_TUPLEN:
+      em_free(cur->value.tupleN.data);
+      break;
+    case EMFRP_OBJECT_VARIABLE_TABLE:
+      variable_table_free(cur->value.variable_table.ptr);
+      break;
+    case EMFRP_OBJECT_FUNCTION:
+      switch(cur->value.function.kind) {
+        case EMFRP_PROGRAM_KIND_BYTECODE:
+          if(cur->value.function.function.bytecode.program->reference_count <= 1) cost = 10;
+          bytecode_release(cur->value.function.function.bytecode.program);
+          break;
+        case EMFRP_PROGRAM_KIND_NOTHING:
+          break;
+        case EMFRP_PROGRAM_KIND_CALLBACK:
+          break;
+        case EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT:
+          break;
+        case EMFRP_PROGRAM_KIND_RECORD_ACCESS:
+          break;
+        default:
+          DEBUGBREAK;
+          break;
+      }
+      break;
+    default:
+      break;
+  }
+  return cost;
+}
+
+// ! Sweep the heap incrementally.
+/* !
+ * \param self The memory manager
+ * \param sweep_limit The count of cells to be swept.
+ * \return Whether all pages are swept.
+ */
+static bool
 memory_manager_sweep(memory_manager_t * self, int sweep_limit)
 {
   for(int i = 0; i < sweep_limit; ++i) {
-    if(self->sweeper >= MEMORY_MANAGER_HEAP_SIZE) break;
-    object_t * cur = &self->space[self->sweeper];
+    if(self->sweeper >= MEMORY_MANAGER_PAGE_SIZE) {
+      self->sweeper_page++;
+      self->sweeper = 0;
+    }
+    if(self->sweeper_page >= self->pages_length) return true;
+    memory_page_t * page = self->pages[self->sweeper_page];
+    object_t *      cur  = &(page->space[self->sweeper]);
     if(object_kind(cur) != EMFRP_OBJECT_FREE) {
       if(object_is_marked(cur))
         object_unmark(cur);
       else {
-        switch(object_kind(cur)) {
-          case EMFRP_OBJECT_SYMBOL:
-            string_free(&(cur->value.symbol.value));
-            break;
-          //case EMFRP_OBJECT_STACK:
-          case EMFRP_OBJECT_TUPLEN:
-            em_free(cur->value.tupleN.data);
-            break;
-          case EMFRP_OBJECT_VARIABLE_TABLE:
-            variable_table_free(cur->value.variable_table.ptr);
-            break;
-          case EMFRP_OBJECT_FUNCTION:
-            switch(cur->value.function.kind) {
-              case EMFRP_PROGRAM_KIND_AST:
-                cur->value.function.function.ast.program->value.function.reference_count--;
-                if(cur->value.function.function.ast.program->value.function.reference_count <= 0) {
-                  parser_expression_free(cur->value.function.function.ast.program);
-                  i += 10;
-                }
-                break;
-              case EMFRP_PROGRAM_KIND_NOTHING:
-                break;
-              case EMFRP_PROGRAM_KIND_CALLBACK:
-                break;
-              case EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT:
-                break;
-              case EMFRP_PROGRAM_KIND_RECORD_ACCESS:
-                break;
-              default:
-                DEBUGBREAK;
-                break;
-            }
-            break;
-          default:
-            break;
-        }
-        object_new_freelist(cur, self->freelist);
-        self->freelist = cur;
-        //printf("recycled: %d\n", ((int)cur - (int)self->space) / sizeof(object_t));
+        i += memory_manager_finalize(cur);
+        object_new_freelist(cur, page->freelist);
+        page->freelist = cur;
+        page->remaining++;
         self->remaining++;
       }
     }
     self->sweeper++;
   }
+  return false;
 }
 em_result
 memory_manager_gc(struct machine_t * self, int mark_limit, int sweep_limit)
@@ -192,30 +323,42 @@ memory_manager_gc(struct machine_t * self, int mark_limit, int sweep_limit)
   memory_manager_t * mm = self->memory_manager;
   switch(mm->state) {
     case MEMORY_MANAGER_STATE_IDLE:
-      if(mm->remaining <= MEMORY_MANAGER_GC_START_SIZE) {
+      if(MEMORY_MANAGER_SHOULD_START_GC(mm->remaining, mm->pages_length)) {
+        mm->sweeper_page = 0;
         mm->sweeper      = 0;
         mm->worklist_top = 0;
+        // The nursery is not swept, so its marks are left from the previous cycle.
+        for(int i = 0; i < mm->nursery_top; ++i)
+          object_unmark(&(mm->nursery[i]));
         CHKERR(push_worklist(mm, self->stack));
         CHKERR(push_worklist(mm, machine_get_variable_table(self)->this_object_ref));
-        for(int i = 0; i < DICTIONARY_TABLE_SIZE; ++i)
-          for(list_t * li = self->nodes.values[i]; li != nullptr; li = LIST_NEXT(li)) {
-            node_t * n = (node_t *)(&(li->value));
-            //printf("root: %s %d\n", n->name.buffer , ((int)n->value - (int)self->memory_manager->space) / sizeof(object_t));
-            CHKERR(push_worklist(mm, n->value));
-          }
+        node_t * n;
+        FOREACH_DICTIONARY(n, &(self->nodes)) {
+          //printf("root: %s %d\n", n->name.buffer , ((int)n->value - (int)self->memory_manager->space) / sizeof(object_t));
+          CHKERR(push_worklist(mm, n->value));
+          CHKERR(push_worklist(mm, n->last));
+        }
+        variable_t * v;
+        FOREACH_DICTIONARY(v, &(self->globals)) {
+          CHKERR(push_worklist(mm, v->value));
+        }
         mm->state = MEMORY_MANAGER_STATE_MARK;
       }
       break;
     case MEMORY_MANAGER_STATE_MARK:
       CHKERR(memory_manager_mark(mm, mark_limit));
       if(mm->worklist_top == 0) {
-        mm->state   = MEMORY_MANAGER_STATE_SWEEP;
-        mm->sweeper = 0;
+        mm->state        = MEMORY_MANAGER_STATE_SWEEP;
+        mm->sweeper_page = 0;
+        mm->sweeper      = 0;
       }
       break;
     case MEMORY_MANAGER_STATE_SWEEP:
-      memory_manager_sweep(mm, sweep_limit);
-      if(mm->sweeper >= MEMORY_MANAGER_HEAP_SIZE) mm->state = MEMORY_MANAGER_STATE_IDLE;
+      if(memory_manager_sweep(mm, sweep_limit)) {
+        mm->state = MEMORY_MANAGER_STATE_IDLE;
+        mm->gc_cycles++;
+        memory_manager_release_pages(mm);
+      }
       break;
   }
   return EM_RESULT_OK;
@@ -223,23 +366,240 @@ err:
   return errres;
 }
 
+// ! Take a free cell from pages.
+/* !
+ * It does not run the gc, so memory_manager_t::remaining must be positive.
+ * \param self The memory manager
+ * \return The cell
+ */
+static object_t *
+memory_manager_take(memory_manager_t * self)
+{
+  object_t * o;
+  // Find a page which has free cells.
+  while(self->pages[self->allocator]->remaining == 0)
+    self->allocator = (self->allocator + 1) % self->pages_length;
+  memory_page_t * page = self->pages[self->allocator];
+  page->remaining--;
+  self->remaining--;
+  o              = page->freelist;
+  page->freelist = o->value.free.next;
+  o->kind        = 0;
+  // Allocated objects are black, unless the sweeper has passed.
+  if(
+    self->state != MEMORY_MANAGER_STATE_IDLE
+    && (self->allocator > self->sweeper_page
+        || (self->allocator == self->sweeper_page && page->space + self->sweeper <= o)))
+    object_mark(o);
+  return o;
+}
+
+// ! Finish the current cycle of the gc.
+/* !
+ * If the gc is idle, a new cycle starts only if memory_manager_t::remaining is small.
+ * \param self The machine
+ * \return The result
+ */
+static em_result
+memory_manager_finish_gc(machine_t * self)
+{
+  em_result          errres = EM_RESULT_OK;
+  memory_manager_t * mm     = self->memory_manager;
+  do {
+    CHKERR(memory_manager_gc(self, MEMORY_MANAGER_WORK_LIST_SIZE, MEMORY_MANAGER_PAGE_SIZE));
+  } while(mm->state != MEMORY_MANAGER_STATE_IDLE);
+err:
+  return errres;
+}
+
 em_result
 memory_manager_alloc(machine_t * self, object_t ** o)
 {
-  em_result errres = EM_RESULT_OK;
+  em_result          errres = EM_RESULT_OK;
+  memory_manager_t * mm     = self->memory_manager;
+  mm->allocations++;
+  if(mm->nursery_enabled && mm->nursery_top < MEMORY_MANAGER_NURSERY_SIZE) {
+    // Bump allocation. The gc does not run.
+    *o = &(mm->nursery[mm->nursery_top]);
+    mm->nursery_top++;
+    (*o)->kind            = 0;
+    (*o)->value.free.next = nullptr;
+    return EM_RESULT_OK;
+  }
   CHKERR(memory_manager_gc(self, MARK_LIMIT, SWEEP_LIMIT));
-  if(self->memory_manager->remaining == 0) return EM_RESULT_OUT_OF_MEMORY;
-  self->memory_manager->remaining--;
-  *o                             = self->memory_manager->freelist;
-  self->memory_manager->freelist = (*o)->value.free.next;
-  (*o)->kind                     = 0;
-  if(&(self->memory_manager->space[self->memory_manager->sweeper]) <= *o) object_mark(*o);
-  // printf("allocated: %d\n", ((int)*o - (int)self->memory_manager->space) / sizeof(object_t));
+  if(mm->remaining == 0 && memory_manager_add_page(mm) != EM_RESULT_OK) {
+    // The heap cannot grow, finish the current cycle.
+    CHKERR(memory_manager_finish_gc(self));
+    if(mm->remaining == 0) return EM_RESULT_OUT_OF_MEMORY;
+  }
+  *o = memory_manager_take(mm);
+  // It may refer objects in the nursery.
+  if(mm->nursery_top > 0) {
+    errres = arraylist_append(&(mm->remembered), sizeof(object_t *), o);
+    if(errres != EM_RESULT_OK) memory_manager_return(mm, *o);
+  }
   // return EM_RESULT_OK;
 err:
   return errres;
 }
 
+// ! Reserve the capacity of the array list of object_t *.
+/* !
+ * \param self The array list
+ * \param capacity The capacity
+ * \return The result
+ */
+static em_result
+memory_manager_reserve(arraylist_t * self, size_t capacity)
+{
+  em_result errres = EM_RESULT_OK;
+  if(self->capacity >= capacity) return EM_RESULT_OK;
+  CHKERR(em_reallocarray(&(self->buffer), self->buffer, capacity, sizeof(object_t *)));
+  self->capacity = capacity;
+err:
+  return errres;
+}
+
+// ! Promote the object in the nursery to pages.
+/* !
+ * Pages and memory_manager_t::promoted must have enough space.
+ * \param self The memory manager
+ * \param ref The reference to the object, which is rewritten to the promoted one.
+ */
+static void
+memory_manager_promote(memory_manager_t * self, object_t ** ref)
+{
+  object_t * v = *ref;
+  if(!object_is_pointer(v) || !IN_NURSERY(self, v)) return;
+  if(object_kind(v) == EMFRP_OBJECT_FREE) {  // Already promoted.
+    *ref = v->value.free.next;
+    return;
+  }
+  object_t * p      = memory_manager_take(self);
+  bool       marked = object_is_marked(p);
+  *p                = *v;
+  object_unmark(p);
+  // While marking, the copy must be gray, because its children may not be marked.
+  if(self->state == MEMORY_MANAGER_STATE_MARK)
+    memory_manager_push_worklist_uncheck_state(self, p);
+  else if(marked)
+    object_mark(p);
+  if(object_kind(p) == EMFRP_OBJECT_VARIABLE_TABLE && p->value.variable_table.ptr != nullptr)
+    p->value.variable_table.ptr->this_object_ref = p;
+  ((object_t **)self->promoted.buffer)[self->promoted.length] = p;
+  self->promoted.length++;
+  // Leave the forwarding pointer.
+  v->kind            = EMFRP_OBJECT_FREE;
+  v->value.free.next = p;
+  *ref               = p;
+}
+
+// ! Promote children of the object.
+/* !
+ * \param self The memory manager
+ * \param cur The object
+ */
+static void
+memory_manager_promote_children(memory_manager_t * self, object_t * cur)
+{
+  switch(object_kind(cur)) {
+    case EMFRP_OBJECT_TUPLE1:
+      memory_manager_promote(self, &(cur->value.tuple1.i0));
+      break;
+    case EMFRP_OBJECT_TUPLE2:
+      memory_manager_promote(self, &(cur->value.tuple2.i0));
+      memory_manager_promote(self, &(cur->value.tuple2.i1));
+      break;
+    case EMFRP_OBJECT_TUPLEN:
+      for(size_t i = 0; i < cur->value.tupleN.length; ++i)
+        memory_manager_promote(self, &object_tuple_ith(cur, i));
+      break;
+    case EMFRP_OBJECT_VARIABLE_TABLE:
+      if(cur->value.variable_table.ptr != nullptr) {
+        variable_table_t * vt = cur->value.variable_table.ptr;
+        for(size_t j = 0; j < vt->length; ++j)
+          memory_manager_promote(self, &(vt->slots[j]));
+        if(vt->parent != nullptr) memory_manager_promote(self, &(vt->parent->this_object_ref));
+      }
+      break;
+    case EMFRP_OBJECT_FUNCTION:
+      switch(cur->value.function.kind) {
+        case EMFRP_PROGRAM_KIND_BYTECODE:
+          memory_manager_promote(self, &(cur->value.function.function.bytecode.closure));
+          break;
+        default:
+          break;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+em_result
+memory_manager_end_iteration(machine_t * self)
+{
+  em_result          errres = EM_RESULT_OK;
+  memory_manager_t * mm     = self->memory_manager;
+  mm->nursery_enabled       = false;
+  if(mm->nursery_top == 0) return EM_RESULT_OK;
+  // Promoting cannot fail halfway, so pages must be able to hold all objects in the nursery.
+  while(mm->remaining < mm->nursery_top && memory_manager_add_page(mm) == EM_RESULT_OK)
+    ;
+  if(mm->remaining < mm->nursery_top) {
+    CHKERR(memory_manager_finish_gc(self));
+    if(mm->remaining < mm->nursery_top) return EM_RESULT_OK;  // Keep the nursery.
+  }
+  CHKERR(memory_manager_reserve(&(mm->promoted), mm->nursery_top));
+  // Promote objects reachable from roots.
+  node_t * n;
+  FOREACH_DICTIONARY(n, &(self->nodes)) {
+    memory_manager_promote(mm, &(n->value));
+    memory_manager_promote(mm, &(n->last));
+  }
+  variable_t * v;
+  FOREACH_DICTIONARY(v, &(self->globals)) {
+    memory_manager_promote(mm, &(v->value));
+  }
+  for(size_t i = 0; i < self->stack->value.stack.length; ++i)
+    memory_manager_promote(mm, &(self->stack->value.stack.data[i]));
+  for(variable_table_t * vt = machine_get_variable_table(self); vt != nullptr; vt = vt->parent) {
+    memory_manager_promote(mm, &(vt->this_object_ref));
+    memory_manager_promote_children(mm, vt->this_object_ref);
+  }
+  for(size_t i = 0; i < mm->remembered.length; ++i)
+    memory_manager_promote_children(mm, ((object_t **)mm->remembered.buffer)[i]);
+  int promoted_count = 0;
+  while(mm->promoted.length > 0) {
+    mm->promoted.length--;
+    promoted_count++;
+    memory_manager_promote_children(mm, ((object_t **)mm->promoted.buffer)[mm->promoted.length]);
+  }
+  // The work list must not refer the nursery.
+  int j = 0;
+  for(int i = 0; i < mm->worklist_top; ++i) {
+    object_t * o = mm->worklist[i];
+    if(object_is_pointer(o) && IN_NURSERY(mm, o)) {
+      if(object_kind(o) != EMFRP_OBJECT_FREE || o->value.free.next == nullptr) continue;
+      o = o->value.free.next;
+    }
+    mm->worklist[j] = o;
+    j++;
+  }
+  mm->worklist_top = j;
+  // Reset the nursery.
+  for(int i = 0; i < mm->nursery_top; ++i)
+    if(object_kind(&(mm->nursery[i])) != EMFRP_OBJECT_FREE)
+      memory_manager_finalize(&(mm->nursery[i]));
+  mm->nursery_top       = 0;
+  mm->remembered.length = 0;
+  // The gc works as if promoted objects are allocated.
+  for(int i = 0; i < promoted_count; ++i)
+    CHKERR(memory_manager_gc(self, MARK_LIMIT, SWEEP_LIMIT));
+err:
+  return errres;
+}
+
 em_result
 memory_manager_force_gc(memory_manager_t * self)
 {
@@ -251,7 +611,18 @@ void
 memory_manager_return(memory_manager_t * self, object_t * v)
 {
   if(!object_is_pointer(v)) return;
-  v->kind            = EMFRP_OBJECT_FREE;
-  v->value.free.next = self->freelist;
-  self->freelist     = v;
+  if(IN_NURSERY(self, v)) {
+    v->kind            = EMFRP_OBJECT_FREE;
+    v->value.free.next = nullptr;
+    return;
+  }
+  for(int i = 0; i < self->pages_length; ++i) {
+    memory_page_t * page = self->pages[i];
+    if(v < page->space || page->space + MEMORY_MANAGER_PAGE_SIZE <= v) continue;
+    object_new_freelist(v, page->freelist);
+    page->freelist = v;
+    page->remaining++;
+    self->remaining++;
+    return;
+  }
 }
@@ -0,0 +1,64 @@
+/** -------------------------------------------
+ * @file   input_queue_t.c
+ * @brief  Lock-free Queue of Posted Inputs
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include <stdint.h>
+#include "vm/input_queue_t.h"
+
+#define INPUT_QUEUE_MASK (EMFRP_INPUT_QUEUE_SIZE - 1)
+
+#if EMFRP_INPUT_QUEUE_SIZE & INPUT_QUEUE_MASK
+#error EMFRP_INPUT_QUEUE_SIZE must be a power of 2.
+#endif
+
+void
+input_queue_new(input_queue_t * out)
+{
+  for(size_t i = 0; i < EMFRP_INPUT_QUEUE_SIZE; ++i) {
+    input_queue_atomic_init(&(out->items[i].sequence), i);
+    out->items[i].node  = nullptr;
+    out->items[i].value = nullptr;
+  }
+  input_queue_atomic_init(&(out->enqueue_position), 0);
+  out->dequeue_position = 0;
+}
+
+bool
+input_queue_post(input_queue_t * self, node_t * node, struct object_t * value)
+{
+  input_queue_item_t * item;
+  size_t               pos = input_queue_load_relaxed(&(self->enqueue_position));
+  while(true) {
+    item          = &(self->items[pos & INPUT_QUEUE_MASK]);
+    size_t   seq  = input_queue_load_acquire(&(item->sequence));
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+    if(diff == 0) {
+      // Claim the slot. If another producer(or an interrupt) claimed it, pos is reloaded.
+      if(input_queue_compare_exchange(&(self->enqueue_position), &pos, pos + 1)) break;
+    } else if(diff < 0)
+      return false;  // The consumer has not taken the slot yet.
+    else
+      pos = input_queue_load_relaxed(&(self->enqueue_position));
+  }
+  item->node  = node;
+  item->value = value;
+  input_queue_store_release(&(item->sequence), pos + 1);
+  return true;
+}
+
+bool
+input_queue_take(input_queue_t * self, node_t ** node, struct object_t ** value)
+{
+  size_t               pos  = self->dequeue_position;
+  input_queue_item_t * item = &(self->items[pos & INPUT_QUEUE_MASK]);
+  size_t               seq  = input_queue_load_acquire(&(item->sequence));
+  // Empty, or the producer which claimed the slot has not written it yet.
+  if((intptr_t)seq - (intptr_t)(pos + 1) < 0) return false;
+  *node  = item->node;
+  *value = item->value;
+  input_queue_store_release(&(item->sequence), pos + EMFRP_INPUT_QUEUE_SIZE);
+  self->dequeue_position = pos + 1;
+  return true;
+}
@@ -66,6 +66,16 @@ err:
   return errres;
 }
 
+em_result
+remove_defined_node2(journal_t ** out, node_t * node)
+{
+  exec_sequence_t * es = node->definition;
+  if(es == nullptr) return EM_RESULT_OK;
+  if(es->node_definition == node) return remove_the_node(out, es, &(es->node_definition));
+  if(es->node_definitions == nullptr) return EM_RESULT_OK;
+  return go_remove_defined_node(out, es, node, es->node_definitions);
+}
+
 void
 revert_from_journal(journal_t * j)
 {
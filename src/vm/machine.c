@@ -5,30 +5,32 @@
  * @date   2023/3/22
  ------------------------------------------- */
 
-#include <stdio.h>
+#include <string.h>
 #include "ast.h"
+#include "emdiag.h"
 #include "vm/machine.h"
 #include "vm/object_t.h"
 #include "vm/exec.h"
+#include "vm/compiler.h"
 #include "vm/journal_t.h"
+#include "vm/exec_order.h"
+#include "vm/exec_plan.h"
 size_t
 node_hasher(void * val)
 {
-  return string_hash(&(((node_t *)val)->name));
+  return atom_hash(((node_t *)val)->name);
 }
-// node_t and string_t
+// node_t and atom_t
 bool
 node_compare(void * l, void * r)
 {
-  return string_compare(&(((node_t *)l)->name), (string_t *)r);
+  return ((node_t *)l)->name == (atom_t)r;
 }
 
 bool
 node_compare2(void * l, void * r)
 {
-  node_t * lhs = (node_t *)l;
-  node_t * rhs = (node_t *)r;
-  return string_compare(&(lhs->name), &(rhs->name));
+  return ((node_t *)l)->name == ((node_t *)r)->name;
 }
 
 em_result
@@ -36,30 +38,61 @@ machine_new(machine_t * out)
 {
   em_result errres = EM_RESULT_OK;
   CHKERR(queue_default(&(out->execution_list)));
+  arraylist_default(&(out->order));
+  arraylist_default(&(out->plan));
+  out->plan_outdated = false;
   CHKERR(dictionary_new(&(out->nodes)));
+  CHKERR(dictionary_new(&(out->globals)));
+  CHKERR(dictionary_new(&(out->atoms)));
   CHKERR(memory_manager_new(&(out->memory_manager)));
   CHKERR(machine_alloc(out, &(out->stack)));
   CHKERR(object_new_stack(out->stack, MACHINE_STACK_SIZE));
-  out->variable_table = nullptr;
-  CHKERR(machine_new_variable_table(out));
+  out->variable_table      = nullptr;
+  out->iteration           = 0;
+  out->definitions_changed = false;
+  arraylist_default(&(out->outdated));
+  out->globals_changed     = false;
+  out->recompiling         = false;
+  input_queue_new(&(out->inputs));
+  CHKERR(machine_new_variable_table(out, 0));
   //return EM_RESULT_OK;
 err:
   return errres;
 }
 
-em_result
-machine_exec(machine_t * self, parser_toplevel_t * prog, object_t ** out)
+static em_result machine_recompile(machine_t * self, bool with_nodes);
+static em_result machine_refresh_reads(machine_t * self);
+
+// ! Mark the variables bound by data as constants.(See variable_t::constant.)
+static void
+machine_mark_constants(machine_t * self, deconstructor_t * d)
+{
+  variable_t * var;
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      if(machine_lookup_global(self, &var, d->value.identifier)) var->constant = true;
+      break;
+    case DECONSTRUCTOR_TUPLE:
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+        machine_mark_constants(self, (deconstructor_t *)(&(li->value)));
+      break;
+    default:
+      break;
+  }
+}
+
+// ! Define the data, the function or the record, without compiling the dependents again.
+static em_result
+machine_define(machine_t * self, parser_toplevel_t * prog, object_t ** out)
 {
   em_result errres = EM_RESULT_OK;
-  *out             = nullptr;
   switch(prog->kind) {
-    case PARSER_TOPLEVEL_KIND_EXPR:
-      return exec_ast(self, prog->value.expression, out);
     case PARSER_TOPLEVEL_KIND_DATA: {
       parser_data_t * d = prog->value.data;
       CHKERR(exec_ast(self, d->expression, out));
       if(machine_test_matches(self, &(d->name), *out)) {
-        CHKERR(machine_matches(self, &(d->name), *out));
+        CHKERR(machine_matches(self, &(d->name), *out, nullptr));
+        machine_mark_constants(self, &(d->name));
       } else {
         errres = EM_RESULT_INVALID_ARGUMENT;
         goto err;
@@ -67,26 +100,22 @@ machine_exec(machine_t * self, parser_toplevel_t * prog, object_t ** out)
       break;
     }
     case PARSER_TOPLEVEL_KIND_FUNC: {
-      parser_func_t *       f = prog->value.func;
-      parser_expression_t * e = parser_expression_new_function(f->arguments, f->expression);
-      TEST_AND_ERROR(e == nullptr, EM_RESULT_OUT_OF_MEMORY);
-      CHKERR(machine_alloc(self, out));
-      CHKERR(object_new_function_ast(*out, machine_get_variable_table(self)->this_object_ref, e));
+      parser_func_t * f    = prog->value.func;
+      bytecode_t *    code = nullptr;
+      CHKERR(compile_function(self, f->function, &code));  // code retains prog.
+      CHKERR2(err_func, machine_alloc(self, out));
+      CHKERR2(err_func, object_new_function_bytecode(
+                          *out, machine_get_variable_table(self)->this_object_ref, code));
+      bytecode_release(code);
       CHKERR(machine_assign_variable(self, f->name, *out));
       break;
-    }
-    case PARSER_TOPLEVEL_KIND_NODE: {
-      exec_sequence_t * _ = nullptr;
-      return machine_add_node_ast(self, &_, prog->value.node);
+err_func:
+      bytecode_release(code);
+      goto err;
     }
     case PARSER_TOPLEVEL_KIND_RECORD: {
-      object_t * tag = nullptr;
-      {  // Construct the tag.
-        string_t tagname;
-        CHKERR(machine_alloc(self, &tag));
-        CHKERR(string_copy(&tagname, &(prog->value.record->name)));
-        CHKERR(object_new_symbol(tag, tagname));
-      }
+      record_tag_t tag = RECORD_TAG_NONE;
+      CHKERR(record_table_intern(&(prog->value.record->name), &tag));
       // Construct the accessors.
       size_t len = 0;
       for(list_t /*<string_t*>*/ * li = prog->value.record->accessors; li != nullptr;
@@ -102,6 +131,8 @@ machine_exec(machine_t * self, parser_toplevel_t * prog, object_t ** out)
       CHKERR(machine_assign_variable(self, &(prog->value.record->name), *out));
       break;
     }
+    default:
+      break;
   }
   return EM_RESULT_OK;
 err:
@@ -109,13 +140,37 @@ err:
   return errres;
 }
 
+em_result
+machine_exec(machine_t * self, parser_toplevel_t * prog, object_t ** out)
+{
+  em_result errres = EM_RESULT_OK;
+  *out             = nullptr;
+  switch(prog->kind) {
+    case PARSER_TOPLEVEL_KIND_EXPR:
+      return exec_ast(self, prog->value.expression, out);
+    case PARSER_TOPLEVEL_KIND_NODE: {
+      exec_sequence_t * _ = nullptr;
+      return machine_add_node_ast(self, &_, prog);
+    }
+    default:
+      CHKERR(machine_define(self, prog, out));
+      break;
+  }
+  if(self->outdated.length > 0) CHKERR(machine_recompile(self, true));
+  if(self->globals_changed) CHKERR(machine_refresh_reads(self));
+  return EM_RESULT_OK;
+err:
+  *out = nullptr;
+  return errres;
+}
+
 em_result
 machine_push(machine_t * self, object_t * obj)
 {
   em_result errres = EM_RESULT_OK;
 #if DEBUG
   if(object_kind(self->stack.kind) != EMFRP_OBJECT_STACK) {
-    fputs("Illegal stack kind.\n", stdout);
+    EM_DIAG_ERROR("Illegal stack kind.\n");
     DEBUGBREAK;
   }
 #endif
@@ -142,7 +197,7 @@ machine_pop(machine_t * self, object_t ** obj)
   object_t * st     = self->stack;
 #if DEBUG
   if(object_kind(st->kind) != EMFRP_OBJECT_STACK) {
-    fputs("Illegal stack kind.\n", stdout);
+    EM_DIAG_ERROR("Illegal stack kind.\n");
     DEBUGBREAK;
   }
 #endif
@@ -157,69 +212,84 @@ err:
   return errres;
 }
 
-bool
-machine_match_symbol(object_t * tag, string_t * match_symbol)
-{
-  if(tag == nullptr && match_symbol == nullptr) return true;  // BOTH are null.
-  return !(
-    tag == nullptr || !object_is_pointer(tag) || object_kind(tag) != EMFRP_OBJECT_SYMBOL
-    || !string_compare(match_symbol, &(tag->value.symbol.value)));
-}
+em_result machine_matches2(
+  machine_t * self, deconstructor_t * deconst, object_t * v, object_t *** slots);
 
+// slots is the cursor of the slots to be bound, or nullptr for the global variables.
 em_result
-machine_match(machine_t * self, list_t /*<deconstructor_t>*/ * nt, object_t ** vs, int length)
+machine_match2(
+  machine_t * self, list_t /*<deconstructor_t>*/ * nt, object_t ** vs, int length,
+  object_t *** slots)
 {
   em_result errres = EM_RESULT_OK;
   for(int len = 0; nt != nullptr || len != length; ++len, nt = LIST_NEXT(nt)) {
     TEST_AND_ERROR(nt == nullptr || len == length, EM_RESULT_INVALID_ARGUMENT);
-    CHKERR(machine_matches(self, (deconstructor_t *)(&(nt->value)), vs[len]));
+    CHKERR(machine_matches2(self, (deconstructor_t *)(&(nt->value)), vs[len], slots));
   }
 err:
   return errres;
 }
 
 em_result
-machine_matches(machine_t * self, deconstructor_t * deconst, object_t * v)
+machine_match(
+  machine_t * self, list_t /*<deconstructor_t>*/ * nt, object_t ** vs, int length,
+  object_t ** slots)
+{
+  return machine_match2(self, nt, vs, length, slots == nullptr ? nullptr : &slots);
+}
+
+em_result
+machine_matches(machine_t * self, deconstructor_t * deconst, object_t * v, object_t ** slots)
+{
+  return machine_matches2(self, deconst, v, slots == nullptr ? nullptr : &slots);
+}
+
+em_result
+machine_matches2(machine_t * self, deconstructor_t * deconst, object_t * v, object_t *** slots)
 {
   em_result errres = EM_RESULT_OK;
   switch(deconst->kind) {
     case DECONSTRUCTOR_IDENTIFIER:
-      CHKERR(machine_assign_variable(self, deconst->value.identifier, v));
+      if(slots == nullptr) {
+        CHKERR(machine_assign_variable(self, deconst->value.identifier, v));
+      } else {
+        CHKERR(machine_mark_gray(self, **slots));
+        **slots = v;
+        (*slots)++;
+      }
       break;
     case DECONSTRUCTOR_ANY:
       break;
-    case DECONSTRUCTOR_TUPLE:
+    case DECONSTRUCTOR_TUPLE: {
+      record_tag_t tag = RECORD_TAG_NONE;
+      CHKERR(record_table_resolve(deconst, &tag));
+      if(object_is_tag(v)) {
+        TEST_AND_ERROR(
+          deconst->value.tuple.data != nullptr || object_get_tag(v) != tag,
+          EM_RESULT_INVALID_ARGUMENT);
+        break;
+      }
       TEST_AND_ERROR(!object_is_pointer(v) || v == nullptr, EM_RESULT_INVALID_ARGUMENT);
+      // Objects other than tuples have no tag, so they fail at the following switch.
+      TEST_AND_ERROR(object_tuple_tag(v) != tag, EM_RESULT_INVALID_ARGUMENT);
       switch(object_kind(v)) {
-        case EMFRP_OBJECT_SYMBOL:
-          if(
-            deconst->value.tuple.tag == nullptr || deconst->value.tuple.data != nullptr
-            || !string_compare(deconst->value.tuple.tag, &(v->value.symbol.value)))
-            return EM_RESULT_INVALID_ARGUMENT;
-          break;
         case EMFRP_OBJECT_TUPLE1:
-          TEST_AND_ERROR(
-            !machine_match_symbol(v->value.tuple1.tag, deconst->value.tuple.tag),
-            EM_RESULT_INVALID_ARGUMENT);
-          CHKERR(machine_match(self, deconst->value.tuple.data, &(v->value.tuple1.i0), 1));
+          CHKERR(
+            machine_match2(self, deconst->value.tuple.data, &(v->value.tuple1.i0), 1, slots));
           break;
         case EMFRP_OBJECT_TUPLE2:
-          TEST_AND_ERROR(
-            !machine_match_symbol(v->value.tuple2.tag, deconst->value.tuple.tag),
-            EM_RESULT_INVALID_ARGUMENT);
-          CHKERR(machine_match(self, deconst->value.tuple.data, &(v->value.tuple2.i0), 2));
+          CHKERR(
+            machine_match2(self, deconst->value.tuple.data, &(v->value.tuple2.i0), 2, slots));
           break;
         case EMFRP_OBJECT_TUPLEN:
-          TEST_AND_ERROR(
-            !machine_match_symbol(v->value.tupleN.tag, deconst->value.tuple.tag),
-            EM_RESULT_INVALID_ARGUMENT);
-          CHKERR(machine_match(
-            self, deconst->value.tuple.data, v->value.tupleN.data, v->value.tupleN.length));
+          CHKERR(machine_match2(
+            self, deconst->value.tuple.data, v->value.tupleN.data, v->value.tupleN.length, slots));
           break;
         default:
           return EM_RESULT_INVALID_ARGUMENT;
       }
       break;
+    }
     case DECONSTRUCTOR_INTEGER:
       if(!object_is_integer(v) || deconst->value.integer != object_get_integer(v))
         errres = EM_RESULT_INVALID_ARGUMENT;
@@ -253,28 +323,24 @@ machine_test_matches(machine_t * self, deconstructor_t * deconst, object_t * v)
     case DECONSTRUCTOR_IDENTIFIER:
     case DECONSTRUCTOR_ANY:
       return true;
-    case DECONSTRUCTOR_TUPLE:
-      if(!object_is_pointer(v) || v == nullptr) return false;
+    case DECONSTRUCTOR_TUPLE: {
+      record_tag_t tag = RECORD_TAG_NONE;
+      if(record_table_resolve(deconst, &tag) != EM_RESULT_OK) return false;
+      if(object_is_tag(v)) return deconst->value.tuple.data == nullptr && object_get_tag(v) == tag;
+      if(!object_is_pointer(v) || v == nullptr || object_tuple_tag(v) != tag) return false;
       switch(object_kind(v)) {
-        case EMFRP_OBJECT_SYMBOL:
-          return !(
-            deconst->value.tuple.tag == nullptr || deconst->value.tuple.data != nullptr
-            || !string_compare(deconst->value.tuple.tag, &(v->value.symbol.value)));
-          break;
         case EMFRP_OBJECT_TUPLE1:
-          if(!machine_match_symbol(v->value.tuple1.tag, deconst->value.tuple.tag)) return false;
           return machine_test_match(self, deconst->value.tuple.data, &(v->value.tuple1.i0), 1);
         case EMFRP_OBJECT_TUPLE2:
-          if(!machine_match_symbol(v->value.tuple2.tag, deconst->value.tuple.tag)) return false;
           return machine_test_match(self, deconst->value.tuple.data, &(v->value.tuple2.i0), 2);
         case EMFRP_OBJECT_TUPLEN:
-          if(!machine_match_symbol(v->value.tupleN.tag, deconst->value.tuple.tag)) return false;
           return machine_test_match(
             self, deconst->value.tuple.data, v->value.tupleN.data, v->value.tupleN.length);
         default:
           return false;
       }
       break;
+    }
     case DECONSTRUCTOR_INTEGER:
       return !(!object_is_integer(v) || deconst->value.integer != object_get_integer(v));
 #if EMFRP_ENABLE_FLOATING
@@ -287,108 +353,17 @@ machine_test_matches(machine_t * self, deconstructor_t * deconst, object_t * v)
   return false;
 }
 
-bool
-string_compare2(void * l, void * r)
-{
-  return string_compare(*((string_t **)l), (string_t *)r);
-}
-void
-go_check_dependencies(list_t ** dependencies, node_or_tuple_t * nt)
-{
-  switch(nt->kind) {
-    case NODE_OR_TUPLE_NONE:
-      return;
-    case NODE_OR_TUPLE_NODE: {
-      if(nt->value.node == nullptr) return;  // itself
-      list_t * removed;
-      do {
-        removed = list_remove(dependencies, string_compare2, &(nt->value.node->name));
-        em_free(removed);
-      } while(removed != nullptr);
-      return;
-    }
-    case NODE_OR_TUPLE_TUPLE:
-      for(int i = 0; i < nt->value.tuple.length; ++i)
-        go_check_dependencies(dependencies, &(((node_or_tuple_t *)(nt->value.tuple.buffer))[i]));
-      return;
-  }
-}
-
-em_result
-check_dependencies(
-  machine_t * self, parser_expression_t * prog, list_t ** executionlist_head,
-  list_t *** whereto_insert)
-{
-  em_result                        errres = EM_RESULT_OK;
-  list_t * /*<exec_sequence_t *>*/ cur    = *executionlist_head;
-  list_t * /*<string_t *>*/        dependencies;
-  CHKERR(list_default(&dependencies));
-  CHKERR(get_dependencies_ast(self, prog, &dependencies));
-  // Search where to insert.
-  // Inserted after all dependencies are satisfied.
-  list_t ** p = executionlist_head;
-  for(; !LIST_IS_EMPTY(&dependencies); p = &((*p)->next), cur = LIST_NEXT(cur)) {
-    if(LIST_IS_EMPTY(&cur)) {  // dependencies are not satisfied.
-      list_free(&dependencies);
-      return EM_RESULT_MISSING_IDENTIFIER;
-    }
-    exec_sequence_t * n = (exec_sequence_t *)(&(cur->value));
-    if(n->node_definition != nullptr) {
-      list_t * removed = (void *)1;
-      do {
-        removed = list_remove(&dependencies, string_compare2, &(n->node_definition->name));
-        em_free(removed);
-      } while(removed != nullptr);
-    }
-    if(n->node_definitions != nullptr) go_check_dependencies(&dependencies, n->node_definitions);
-  }
-  *whereto_insert = p;
-  // return EM_RESULT_OK;
-err:
-  return errres;
-}
-
-bool
-has_cyclicreference(string_t * newnode_str, list_t * executionlist_head, list_t * cur)
-{
-  // CHECK CYCLIC DEPENDENCIES!
-  for(list_t * pcur = executionlist_head; pcur != cur; pcur = LIST_NEXT(pcur)) {
-    exec_sequence_t * es = (exec_sequence_t *)(&(pcur->value));
-    if(exec_sequence_marked_modified(es)) continue;  // Skip!
-    if(
-      exec_sequence_program_kind(es) == EMFRP_PROGRAM_KIND_AST
-      && check_depends_on_ast(es->program.ast, newnode_str))
-      return true;
-  }
-  return false;
-}
-
-bool
-has_cyclicreference2(deconstructor_t * newnode_str, list_t * executionlist_head, list_t * cur)
-{
-  switch(newnode_str->kind) {
-    case DECONSTRUCTOR_IDENTIFIER:
-      return has_cyclicreference(newnode_str->value.identifier, executionlist_head, cur);
-    case DECONSTRUCTOR_TUPLE:
-      for(list_t * li = newnode_str->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
-        if(has_cyclicreference2((deconstructor_t *)(&(li->value)), executionlist_head, cur))
-          return true;
-      return false;
-    default:
-      DEBUGBREAK;
-      return false;
-  }
-}
-
 em_result
-machine_add_node(machine_t * self, string_t str, node_t ** node_ptr)
+machine_add_node(machine_t * self, string_t * str, node_t ** node_ptr)
 {
   em_result errres = EM_RESULT_OK;
+  atom_t    name;
+  CHKERR(machine_intern(self, str, &name));
   if(dictionary_get(
-       &(self->nodes), (void **)node_ptr, (size_t(*)(void *))string_hash, node_compare, &str))
+       &(self->nodes), (void **)node_ptr, (size_t(*)(void *))atom_hash, node_compare, name))
     return EM_RESULT_OK;  // Do nothing.
   node_t new_node = {0};
-  CHKERR(node_new(&new_node, str));
+  CHKERR(node_new(&new_node, name));
   CHKERR(dictionary_add2(
     &(self->nodes), &new_node, sizeof(node_t), node_hasher, node_compare2, nullptr, nullptr,
     (void **)node_ptr));
@@ -398,8 +373,9 @@ err:
 }
 
 void
-machine_cleanup(queue_t /*<exec_sequence_t>*/ * execSeq)
+machine_cleanup(machine_t * self)
 {
+  queue_t /*<exec_sequence_t>*/ * execSeq = &(self->execution_list);
   for(list_t ** cur = &(execSeq->head); *cur != nullptr;) {
     exec_sequence_t * es = (exec_sequence_t *)&((*cur)->value);
     if(!exec_sequence_marked_modified(es)) goto next;  // Not modified, skip.
@@ -407,9 +383,10 @@ machine_cleanup(queue_t /*<exec_sequence_t>*/ * execSeq)
     if(!exec_sequence_compact(es)) goto next;  // Do not remove this list item.
     list_t * ne = LIST_NEXT(*cur);
     if(ne == nullptr) execSeq->last = cur;
+    exec_order_remove(self, es);
+    exec_sequence_free(es);
     em_free(*cur);
     *cur = ne;
-    exec_sequence_free(es);
     continue;
 next:
     cur = &(LIST_NEXT(*cur));
@@ -421,11 +398,8 @@ machine_remove_previous_definition2(machine_t * self, journal_t ** out, string_t
 {
   node_t * node_ptr;
   if(str == nullptr) return EM_RESULT_INVALID_ARGUMENT;
-  if(!dictionary_get(
-       &(self->nodes), (void **)&node_ptr, (size_t(*)(void *))string_hash, node_compare,
-       str))  // Not Found.
-    return EM_RESULT_OK;
-  return remove_defined_node(self->execution_list.head, out, node_ptr);
+  if(!machine_lookup_node(self, &node_ptr, str)) return EM_RESULT_OK;  // Not Found.
+  return remove_defined_node2(out, node_ptr);
 }
 
 em_result
@@ -454,15 +428,17 @@ machine_add_nodes(machine_t * self, deconstructor_t * dt, node_or_tuple_t * node
   em_result errres = EM_RESULT_OK;
   switch(dt->kind) {
     case DECONSTRUCTOR_IDENTIFIER:  // string -> node
-      CHKERR(machine_add_node(self, *(dt->value.identifier), &(node_ptr->value.node)));
+      CHKERR(machine_add_node(self, dt->value.identifier, &(node_ptr->value.node)));
       node_ptr->kind = NODE_OR_TUPLE_NODE;
       break;
     case DECONSTRUCTOR_TUPLE: {  // list -> array
       int cnt = 0;
       for(list_t * li = dt->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
         cnt++;
-      node_ptr->kind = NODE_OR_TUPLE_TUPLE;
       CHKERR(arraylist_new(&(node_ptr->value.tuple), sizeof(node_or_tuple_t), cnt));
+      node_ptr->kind = NODE_OR_TUPLE_TUPLE;
+      // The rest are NODE_OR_TUPLE_NONE, if it fails.
+      memset(node_ptr->value.tuple.buffer, 0, sizeof(node_or_tuple_t) * cnt);
       list_t * li = dt->value.tuple.data;
       for(int i = 0; i < cnt; ++i, li = LIST_NEXT(li))
         CHKERR(machine_add_nodes(
@@ -478,170 +454,811 @@ err:
   return errres;
 }
 
+// ! The first name of the nodes which the deconstructor defines.(Nullable)
+static string_t *
+machine_first_node_name(deconstructor_t * d)
+{
+  string_t * name = nullptr;
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      return d->value.identifier;
+    case DECONSTRUCTOR_TUPLE:
+      for(list_t * li = d->value.tuple.data; li != nullptr && name == nullptr; li = LIST_NEXT(li))
+        name = machine_first_node_name((deconstructor_t *)(&(li->value)));
+      break;
+    default:
+      break;
+  }
+  return name;
+}
+
+// ! Compile the program of the node.
+/* !
+ * The node is recorded as the dependent by the first name, so that it is compiled again if the
+ * data which it depends on are changed.(See variable_t::dependents.)
+ * \param self The machine
+ * \param n The node
+ * \param out The result
+ * \return The status code
+ */
+static em_result
+machine_compile_node(machine_t * self, parser_node_t * n, bytecode_t ** out)
+{
+  em_result            errres = EM_RESULT_OK;
+  string_t *           name   = machine_first_node_name(&(n->name));
+  variable_dependent_t owner  = {.name = nullptr, .node = true};
+  if(name == nullptr) name = n->as;
+  if(name != nullptr) CHKERR(machine_intern(self, name, &(owner.name)));
+  CHKERR(compile_expression(self, n->expression, name == nullptr ? nullptr : &owner, out));
+err:
+  return errres;
+}
+
 em_result
-machine_add_node_ast(machine_t * self, exec_sequence_t ** out, parser_node_t * n)
+machine_add_node_ast(machine_t * self, exec_sequence_t ** out, parser_toplevel_t * prog)
 {
-  em_result                       errres = EM_RESULT_OK;
-  list_t ** /*<exec_sequence_t>*/ whereto_insert;
-  exec_sequence_t                 new_exec_seq = {0};
-  exec_sequence_t *               new_entry;
-  journal_t *                     journal = nullptr;
+  em_result         errres       = EM_RESULT_OK;
+  parser_node_t *   n            = prog->value.node;
+  exec_sequence_t   new_exec_seq = {0};
+  exec_sequence_t * new_entry;
+  journal_t *       journal = nullptr;
+  bytecode_t *      code    = nullptr;
   // Remove the previous definition.
   if(n->as != nullptr) CHKERR(machine_remove_previous_definition2(self, &journal, n->as));
   CHKERR(machine_remove_previous_definition(self, &journal, &(n->name)));
-  // Allocate the new exec_sequence.
-  CHKERR(exec_sequence_new_mono_ast(&new_exec_seq, n->expression, nullptr));
+  // Compile, and allocate the new exec_sequence.
+  CHKERR(machine_compile_node(self, n, &code));
+  CHKERR(exec_sequence_new_mono_ast(&new_exec_seq, prog, code, nullptr));
   // Dependency Check
-  CHKERR(check_dependencies(self, n->expression, &(self->execution_list.head), &whereto_insert));
-  // If it contains already-defined nodes, Test the dependency and Try topological sort.
-  if(
-    journal != nullptr
-    && has_cyclicreference2(&(n->name), self->execution_list.head, *whereto_insert)
-    && (n->as == nullptr || has_cyclicreference(n->as, self->execution_list.head, *whereto_insert))) {
-    if(
-      topological_sort(self, &(self->execution_list.head), &(self->execution_list.last))
-      != EM_RESULT_OK) {
-      errres = EM_RESULT_CYCLIC_REFERENCE;
-      goto err;
-    }
-  }
-  // Adding the new exec_sequence.
-  CHKERR(list_add4(whereto_insert, exec_sequence_t, &new_exec_seq, (void **)&new_entry));
-  // Update the last node.
-  if(LIST_IS_EMPTY(&((*whereto_insert)->next)))
-    self->execution_list.last = &((*whereto_insert)->next);
+  CHKERR(exec_order_collect_reads(self, &new_exec_seq));
+  CHKERR(exec_order_check(self, &new_exec_seq, journal));
+  // Adding the new exec_sequence. The order is kept in machine_t::order.
+  CHKERR(queue_enqueue3(
+    &(self->execution_list), sizeof(exec_sequence_t), &new_exec_seq, (void **)&new_entry));
+  code               = nullptr;  // Now, they are owned by new_entry.
+  new_exec_seq.reads = nullptr;
+  parser_toplevel_retain(prog);
   switch(n->name.kind) {
     case DECONSTRUCTOR_IDENTIFIER:  // Single name.
       CHKERR2(
-        err2, machine_add_node(self, *(n->name.value.identifier), &(new_entry->node_definition)));
+        err2, machine_add_node(self, n->name.value.identifier, &(new_entry->node_definition)));
       break;
     case DECONSTRUCTOR_TUPLE:
       CHKERR2(err2, em_malloc((void **)(&(new_entry->node_definitions)), sizeof(node_or_tuple_t)));
       CHKERR2(err2, machine_add_nodes(self, &(n->name), new_entry->node_definitions));
       if(n->as != nullptr)
-        CHKERR2(err2, machine_add_node(self, *(n->as), &(new_entry->node_definition)));
+        CHKERR2(err2, machine_add_node(self, n->as, &(new_entry->node_definition)));
       break;
     default:
       DEBUGBREAK;
       break;
   }
+  CHKERR2(err2, exec_order_add(self, new_entry, journal));
   // Clean up the journal.
   if(journal != nullptr) {
-    machine_cleanup(&(self->execution_list));
+    machine_cleanup(self);
     journal_free(&journal);
     journal = nullptr;
   }
   if(n->init_expression != nullptr) {
     object_t * obj = nullptr;
     em_result  res = exec_ast(self, n->init_expression, &obj);
-    if(res) {
-      // TODO: last failure.
-    }
+    // The definition is kept, and the node has no value until it is executed.
+    if(res != EM_RESULT_OK) exec_sequence_report_failure(new_entry, "initialization", res);
     CHKERR(exec_sequence_update_value_given_object(self, new_entry, obj));
   }
   if(out != nullptr) *out = new_entry;
+  self->definitions_changed = true;
   return EM_RESULT_OK;
 err2:
   // TODO: Out of Memory failure.
 err:
+  bytecode_release(code);
+  em_free(new_exec_seq.reads);
   revert_from_journal(journal);
   journal_free(&journal);
   return errres;
 }
 
+// ! A node linked to the new definition by machine_add_node_ast_all.
+typedef struct machine_relink_t
+{
+  // ! The node.
+  node_t * node;
+  // ! The previous node_t::definition.(Nullable)
+  exec_sequence_t * definition;
+} machine_relink_t;
+
+// ! Add the nodes in the deconstructor, without definitions.
+static em_result
+machine_intern_nodes(machine_t * self, deconstructor_t * dt)
+{
+  em_result errres = EM_RESULT_OK;
+  node_t *  _;
+  switch(dt->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      return machine_add_node(self, dt->value.identifier, &_);
+    case DECONSTRUCTOR_TUPLE:
+      for(list_t * li = dt->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+        CHKERR(machine_intern_nodes(self, (deconstructor_t *)(&(li->value))));
+      break;
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+// ! Link the node to es, and record the previous definition.
+static em_result
+machine_relink_node(arraylist_t * relinked, node_t * node, exec_sequence_t * es)
+{
+  em_result        errres = EM_RESULT_OK;
+  machine_relink_t r      = {node, node->definition};
+  // Existing definitions are ordered, so that the node is defined twice in the program.
+  TEST_AND_ERROR(
+    node->definition != nullptr && node->definition->order < 0, EM_RESULT_INVALID_ARGUMENT);
+  CHKERR(arraylist_append(relinked, sizeof(machine_relink_t), &r));
+  node->definition = es;
+err:
+  return errres;
+}
+
+static em_result
+machine_relink_nodes(arraylist_t * relinked, node_or_tuple_t * nt, exec_sequence_t * es)
+{
+  em_result errres = EM_RESULT_OK;
+  switch(nt->kind) {
+    case NODE_OR_TUPLE_NODE:
+      return machine_relink_node(relinked, nt->value.node, es);
+    case NODE_OR_TUPLE_TUPLE:
+      for(int i = 0; i < nt->value.tuple.length; ++i)
+        CHKERR(machine_relink_nodes(
+          relinked, &(((node_or_tuple_t *)(nt->value.tuple.buffer))[i]), es));
+      break;
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+static void
+machine_free_node_or_tuple(node_or_tuple_t * nt)
+{
+  if(nt->kind != NODE_OR_TUPLE_TUPLE) return;
+  for(int i = 0; i < nt->value.tuple.length; ++i)
+    machine_free_node_or_tuple(&(((node_or_tuple_t *)(nt->value.tuple.buffer))[i]));
+  arraylist_free(&(nt->value.tuple));
+}
+
 em_result
-machine_add_node_callback(machine_t * self, string_t str, exec_callback_t callback)
+machine_add_node_ast_all(
+  machine_t * self, parser_toplevel_t ** nodes, size_t length, size_t * failed)
+{
+  em_result   errres  = EM_RESULT_OK;
+  journal_t * journal = nullptr;
+  queue_t     added_list;  // exec_sequence_t
+  arraylist_t added;       // exec_sequence_t *
+  arraylist_t relinked;    // machine_relink_t
+  size_t      i = 0;
+  arraylist_default(&added);
+  arraylist_default(&relinked);
+  CHKERR(queue_default(&added_list));
+  // All of the nodes are made first, so that the programs can refer to the ones below.
+  for(i = 0; i < length; ++i) {
+    parser_node_t * n = nodes[i]->value.node;
+    node_t *        _;
+    CHKERR(machine_intern_nodes(self, &(n->name)));
+    if(n->as != nullptr) CHKERR(machine_add_node(self, n->as, &_));
+  }
+  for(i = 0; i < length; ++i) {
+    parser_node_t *   n = nodes[i]->value.node;
+    exec_sequence_t   new_exec_seq;
+    exec_sequence_t * new_entry;
+    bytecode_t *      code = nullptr;
+    if(n->as != nullptr) CHKERR(machine_remove_previous_definition2(self, &journal, n->as));
+    CHKERR(machine_remove_previous_definition(self, &journal, &(n->name)));
+    CHKERR(machine_compile_node(self, n, &code));
+    exec_sequence_new_mono_ast(&new_exec_seq, nodes[i], code, nullptr);
+    errres = exec_order_collect_reads(self, &new_exec_seq);
+    if(errres == EM_RESULT_OK)
+      errres = queue_enqueue3(
+        &added_list, sizeof(exec_sequence_t), &new_exec_seq, (void **)&new_entry);
+    if(errres != EM_RESULT_OK) {
+      bytecode_release(code);
+      em_free(new_exec_seq.reads);
+      goto err;
+    }
+    parser_toplevel_retain(nodes[i]);
+    CHKERR(arraylist_append(&added, sizeof(exec_sequence_t *), &new_entry));
+    switch(n->name.kind) {
+      case DECONSTRUCTOR_IDENTIFIER:  // Single name.
+        CHKERR(machine_add_node(self, n->name.value.identifier, &(new_entry->node_definition)));
+        CHKERR(machine_relink_node(&relinked, new_entry->node_definition, new_entry));
+        break;
+      case DECONSTRUCTOR_TUPLE:
+        CHKERR(em_malloc((void **)(&(new_entry->node_definitions)), sizeof(node_or_tuple_t)));
+        new_entry->node_definitions->kind = NODE_OR_TUPLE_NONE;
+        CHKERR(machine_add_nodes(self, &(n->name), new_entry->node_definitions));
+        CHKERR(machine_relink_nodes(&relinked, new_entry->node_definitions, new_entry));
+        if(n->as != nullptr) {
+          CHKERR(machine_add_node(self, n->as, &(new_entry->node_definition)));
+          CHKERR(machine_relink_node(&relinked, new_entry->node_definition, new_entry));
+        }
+        break;
+      default:
+        DEBUGBREAK;
+        break;
+    }
+  }
+  // The nodes which the programs read must be defined here or before.
+  for(i = 0; i < length; ++i) {
+    exec_sequence_t * es = ((exec_sequence_t **)added.buffer)[i];
+    for(int j = 0; j < es->reads_length; ++j)
+      TEST_AND_ERROR(es->reads[j]->definition == nullptr, EM_RESULT_MISSING_IDENTIFIER);
+  }
+  // i == length: the programs make a cycle.
+  CHKERR(exec_order_add_all(self, (exec_sequence_t **)added.buffer, added.length));
+  if(added_list.head != nullptr) {
+    *(self->execution_list.last) = added_list.head;
+    self->execution_list.last    = added_list.last;
+  }
+  machine_cleanup(self);
+  journal_free(&journal);
+  for(i = 0; i < length; ++i) {
+    object_t *            obj  = nullptr;
+    parser_expression_t * init = nodes[i]->value.node->init_expression;
+    if(init == nullptr) continue;
+    exec_sequence_t * es  = ((exec_sequence_t **)added.buffer)[i];
+    em_result         res = exec_ast(self, init, &obj);
+    // The definitions are kept, and the node has no value until it is executed.
+    if(res != EM_RESULT_OK) exec_sequence_report_failure(es, "initialization", res);
+    CHKERR(exec_sequence_update_value_given_object(self, es, obj));
+  }
+  self->definitions_changed = true;
+  arraylist_free(&added);
+  arraylist_free(&relinked);
+  return EM_RESULT_OK;
+err:
+  if(failed != nullptr) *failed = i;
+  for(size_t j = relinked.length; j > 0; --j) {
+    machine_relink_t * r = &(((machine_relink_t *)relinked.buffer)[j - 1]);
+    r->node->definition  = r->definition;
+  }
+  revert_from_journal(journal);
+  journal_free(&journal);
+  for(list_t * li = added_list.head; li != nullptr;) {
+    list_t *          ne = LIST_NEXT(li);
+    exec_sequence_t * es = (exec_sequence_t *)&(li->value);
+    if(es->node_definitions != nullptr) {
+      machine_free_node_or_tuple(es->node_definitions);
+      em_free(es->node_definitions);
+      es->node_definitions = nullptr;
+    }
+    exec_sequence_free(es);
+    em_free(li);
+    li = ne;
+  }
+  arraylist_free(&added);
+  arraylist_free(&relinked);
+  return errres;
+}
+
+// ! Compile the function defined by func again, so that it inlines the current data.
+/* !
+ * \param self The machine
+ * \param var The global variable, which is skipped unless it is the function defined by func.
+ * \return The status code
+ */
+static em_result
+machine_recompile_function(machine_t * self, variable_t * var)
+{
+  em_result             errres = EM_RESULT_OK;
+  object_t *            f      = var->value;
+  bytecode_t *          code;
+  parser_expression_t * source;
+  if(
+    f == nullptr || !object_is_pointer(f) || object_kind(f) != EMFRP_OBJECT_FUNCTION
+    || f->value.function.kind != EMFRP_PROGRAM_KIND_BYTECODE)
+    return EM_RESULT_OK;
+  source = f->value.function.function.bytecode.program->source;
+  // Closures may capture local variables, so that only toplevel functions are compiled.
+  if(
+    source == nullptr || source->value.function.owner == nullptr
+    || source->value.function.owner->kind != PARSER_TOPLEVEL_KIND_FUNC
+    || source->value.function.owner->value.func->function != source)
+    return EM_RESULT_OK;
+  CHKERR(compile_function(self, source, &code));
+  bytecode_release(f->value.function.function.bytecode.program);
+  f->value.function.function.bytecode.program = code;
+err:
+  return errres;
+}
+
+// ! Compile the functions defined by func again, so that they inline the current data.
+static em_result
+machine_recompile_functions(machine_t * self)
+{
+  em_result    errres      = EM_RESULT_OK;
+  bool         recompiling = self->recompiling;
+  variable_t * var;
+  self->recompiling = true;
+  FOREACH_DICTIONARY(var, &(self->globals)) {
+    CHKERR(machine_recompile_function(self, var));
+  }
+err:
+  self->recompiling = recompiling;
+  return errres;
+}
+
+// ! Compile the node again, and replace the code if it reads no other nodes than before.
+/* !
+ * Otherwise, the dependency graph may be changed, so that the node must be added again.
+ * \param self The machine
+ * \param es The exec_sequence_t with the AST program.
+ * \param replaced The result, whether the code is replaced.
+ * \return The status code
+ */
+static em_result
+machine_recompile_node(machine_t * self, exec_sequence_t * es, bool * replaced)
 {
   em_result       errres = EM_RESULT_OK;
-  exec_sequence_t new_exec_seq;
-  node_t *        node_ptr;
-  if(!dictionary_get(
-       &(self->nodes), (void **)&node_ptr, (size_t(*)(void *))string_hash, node_compare,
-       &str)) {  // If not already defined.
-    CHKERR(machine_add_node(self, str, &node_ptr));
-  } else {
-    journal_t * journal = nullptr;
-    CHKERR(remove_defined_node(self->execution_list.head, &journal, node_ptr));
-    machine_cleanup(&(self->execution_list));
-    journal_free(&journal);
+  bytecode_t *    code   = nullptr;
+  exec_sequence_t probe  = {.reads = nullptr};
+  *replaced              = false;
+  CHKERR(machine_compile_node(self, es->program.ast.source->value.node, &code));
+  CHKERR(exec_sequence_new_mono_ast(&probe, es->program.ast.source, code, nullptr));
+  CHKERR(exec_order_collect_reads(self, &probe));
+  for(int i = 0; i < probe.reads_length; ++i) {
+    int j = 0;
+    while(j < es->reads_length && es->reads[j] != probe.reads[i])
+      j++;
+    if(j == es->reads_length) goto err;
+  }
+  bytecode_release(es->program.ast.code);
+  es->program.ast.code = code;
+  es->reads_globals    = probe.reads_globals;
+  code                 = nullptr;
+  // The dependencies are collected again, and machine_t::plan refers to them.
+  em_free(es->dependencies);
+  es->dependencies        = nullptr;
+  es->dependencies_length = -1;
+  self->plan_outdated     = true;
+  *replaced               = true;
+err:
+  bytecode_release(code);
+  em_free(probe.reads);
+  return errres;
+}
+
+// ! Compile the functions and the nodes again, because the values which they depend on are changed.
+/* !
+ * Only the definitions in machine_t::outdated are compiled. They are found by the names, and the
+ * names which are redefined as other kinds or removed are skipped.
+ * The nodes keep their values, unless they read other nodes than before.(They are added again.)
+ * If it fails, all of them are left in machine_t::outdated, because compiling again is harmless.
+ * \param self The machine
+ * \param with_nodes Are the nodes compiled?(Otherwise, they are left in machine_t::outdated.)
+ * \return The status code
+ */
+static em_result
+machine_recompile(machine_t * self, bool with_nodes)
+{
+  em_result              errres   = EM_RESULT_OK;
+  arraylist_t            outdated = self->outdated;
+  variable_dependent_t * items    = (variable_dependent_t *)outdated.buffer;
+  parser_toplevel_t **   nodes    = nullptr;
+  size_t                 length   = 0;
+  arraylist_default(&(self->outdated));
+  self->recompiling = true;
+  // The functions first, because the nodes may call them.
+  for(size_t i = 0; i < outdated.length; ++i) {
+    variable_t * var;
+    if(!items[i].node && machine_lookup_global_atom(self, &var, items[i].name))
+      CHKERR(machine_recompile_function(self, var));
   }
-  CHKERR(exec_sequence_new_mono_callback(&new_exec_seq, callback, node_ptr));
-  // CHKERR(callback == nullptr
-  //        ? exec_sequence_new_mono_nothing(&new_exec_seq, node_ptr)
-  //        : exec_sequence_new_mono_callback(&new_exec_seq, callback, node_ptr));
+  CHKERR(em_allocarray((void **)&nodes, outdated.length, sizeof(parser_toplevel_t *)));
+  for(size_t i = 0; i < outdated.length; ++i) {
+    node_t *          node;
+    exec_sequence_t * es;
+    bool              replaced;
+    size_t            j = 0;
+    if(items[i].node && !with_nodes) {
+      CHKERR(variable_dependents_add(&(self->outdated), &(items[i])));
+      continue;
+    }
+    if(
+      !items[i].node || !machine_lookup_node_atom(self, &node, items[i].name)
+      || (es = node->definition) == nullptr
+      || exec_sequence_program_kind(es) != EMFRP_PROGRAM_KIND_AST)
+      continue;
+    // Names of the same definition may be recorded, if it is redefined.
+    while(j < length && nodes[j] != es->program.ast.source)
+      j++;
+    if(j < length) continue;
+    CHKERR(machine_recompile_node(self, es, &replaced));
+    if(replaced) continue;
+    parser_toplevel_retain(es->program.ast.source);  // The previous definition releases it.
+    nodes[length++] = es->program.ast.source;
+  }
+  if(length > 0) CHKERR(machine_add_node_ast_all(self, nodes, length, nullptr));
+err:
+  self->recompiling = false;
+  for(size_t i = 0; i < length; ++i)
+    parser_toplevel_release(nodes[i]);
+  em_free(nodes);
+  for(size_t i = 0; errres != EM_RESULT_OK && i < outdated.length; ++i)
+    if(variable_dependents_add(&(self->outdated), &(items[i])) != EM_RESULT_OK) break;
+  arraylist_free(&outdated);
+  return errres;
+}
+
+// ! Collect exec_sequence_t::reads again, because the functions which the nodes call are changed.
+/* !
+ * Only the nodes which read nodes through global variables are visited.(See
+ * exec_sequence_t::reads_globals.) If the new reads make a cycle, the previous ones are kept.
+ * \param self The machine
+ * \return The status code
+ */
+static em_result
+machine_refresh_reads(machine_t * self)
+{
+  em_result errres      = EM_RESULT_OK;
+  self->globals_changed = false;
+  for(list_t * /*<exec_sequence_t>*/ cur = self->execution_list.head; cur != nullptr;
+      cur                                = LIST_NEXT(cur)) {
+    exec_sequence_t * es    = (exec_sequence_t *)(&(cur->value));
+    exec_sequence_t   probe = {.reads = nullptr};
+    em_result         res;
+    if(exec_sequence_program_kind(es) != EMFRP_PROGRAM_KIND_AST || !es->reads_globals) continue;
+    // The dependencies are collected again, and machine_t::plan refers to them.
+    em_free(es->dependencies);
+    es->dependencies        = nullptr;
+    es->dependencies_length = -1;
+    self->plan_outdated     = true;
+    CHKERR(
+      exec_sequence_new_mono_ast(&probe, es->program.ast.source, es->program.ast.code, nullptr));
+    res = exec_order_collect_reads(self, &probe);
+    if(res == EM_RESULT_OK) {
+      es->reads_globals = probe.reads_globals;
+      res               = exec_order_update_reads(self, es, probe.reads, probe.reads_length);
+    }
+    if(res == EM_RESULT_OK) continue;
+    em_free(probe.reads);
+    if(errres == EM_RESULT_OK) errres = res;
+    if(em_diag_is_enabled(EM_DIAG_LEVEL_ERROR)) {
+      em_diag_begin(EM_DIAG_LEVEL_ERROR);
+      em_diag_puts("The dependencies of ");
+      if(es->node_definitions != nullptr)
+        node_or_tuple_debug_print(es->node_definitions);
+      else if(es->node_definition != nullptr)
+        em_diag_puts(es->node_definition->name->buffer);
+      em_diag_printf(" are not updated: %s\n", EM_RESULT_STR_TABLE[res]);
+      em_diag_end();
+    }
+  }
+err:
+  return errres;
+}
+
+// ! Back up the global variable, and keep its value in the stack.(See machine_load.)
+static em_result
+machine_backup_global(machine_t * self, arraylist_t * backups, string_t * name)
+{
+  em_result  errres = EM_RESULT_OK;
+  atom_t     atom;
+  variable_t backup;
+  CHKERR(machine_intern(self, name, &atom));
+  CHKERR(variable_dictionary_backup(&(self->globals), &backup, atom));
+  if((errres = arraylist_append(backups, sizeof(variable_t), &backup)) != EM_RESULT_OK) {
+    variable_deep_free(&backup);
+    goto err;
+  }
+  // The previous value is not collected while it is replaced.
+  CHKERR(machine_push(self, backup.value));
+err:
+  return errres;
+}
+
+// ! Back up the global variables bound by the deconstructor.
+static em_result
+machine_backup_deconstructor(machine_t * self, arraylist_t * backups, deconstructor_t * d)
+{
+  em_result errres = EM_RESULT_OK;
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      CHKERR(machine_backup_global(self, backups, d->value.identifier));
+      break;
+    case DECONSTRUCTOR_TUPLE:
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+        CHKERR(machine_backup_deconstructor(self, backups, (deconstructor_t *)(&(li->value))));
+      break;
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+// ! Back up the global variables defined by the toplevel.
+static em_result
+machine_backup_toplevel(machine_t * self, arraylist_t * backups, parser_toplevel_t * prog)
+{
+  em_result errres = EM_RESULT_OK;
+  switch(prog->kind) {
+    case PARSER_TOPLEVEL_KIND_DATA:
+      return machine_backup_deconstructor(self, backups, &(prog->value.data->name));
+    case PARSER_TOPLEVEL_KIND_FUNC:
+      return machine_backup_global(self, backups, prog->value.func->name);
+    case PARSER_TOPLEVEL_KIND_RECORD:
+      for(list_t /*<string_t*>*/ * li = prog->value.record->accessors; li != nullptr;
+          li                          = LIST_NEXT(li))
+        CHKERR(machine_backup_global(self, backups, (string_t *)(&(li->value))));
+      return machine_backup_global(self, backups, &(prog->value.record->name));
+    default:
+      return EM_RESULT_OK;
+  }
+err:
+  return errres;
+}
+
+em_result
+machine_load(machine_t * self, parser_toplevel_t ** programs, size_t length, size_t * failed)
+{
+  static const parser_toplevel_kind globals[] = {
+    PARSER_TOPLEVEL_KIND_RECORD, PARSER_TOPLEVEL_KIND_FUNC, PARSER_TOPLEVEL_KIND_DATA};
+  em_result            errres      = EM_RESULT_OK;
+  parser_toplevel_t ** nodes       = nullptr;
+  size_t *             indices     = nullptr;
+  size_t               count_nodes = 0, i = 0, f = 0;
+  size_t               count[3]    = {0, 0, 0};
+  bool                 committed   = false;
+  bool                 changed     = self->globals_changed;
+  arraylist_t          backups;   // <variable_t>
+  arraylist_t          outdated;  // <variable_dependent_t>
+  stack_state_t        stack;
+  object_t *           o;
+  if(length == 0) return EM_RESULT_OK;
+  arraylist_default(&backups);
+  arraylist_default(&outdated);
+  machine_get_stack_state(self, &stack);
+  // The global variables are restored if it fails.
+  for(i = 0; i < length; ++i)
+    if(programs[i] != nullptr) CHKERR(machine_backup_toplevel(self, &backups, programs[i]));
+  for(size_t j = 0; j < self->outdated.length; ++j)
+    CHKERR(
+      variable_dependents_add(&outdated, &(((variable_dependent_t *)self->outdated.buffer)[j])));
+  // Records, functions and data are defined first, in this order.
+  for(int k = 0; k < 3; ++k)
+    for(i = 0; i < length; ++i)
+      if(programs[i] != nullptr && programs[i]->kind == globals[k]) {
+        CHKERR(machine_define(self, programs[i], &o));
+        count[k]++;
+        // The next data may call the functions. The nodes are compiled after they are added.
+        if(self->outdated.length > 0) CHKERR(machine_recompile(self, false));
+      }
+  i = length;
+  // The functions are compiled before the data are defined.
+  if(count[1] > 0 && count[2] > 0) CHKERR(machine_recompile_functions(self));
+  CHKERR(em_allocarray((void **)&nodes, length, sizeof(parser_toplevel_t *)));
+  CHKERR(em_allocarray((void **)&indices, length, sizeof(size_t)));
+  for(size_t j = 0; j < length; ++j)
+    if(programs[j] != nullptr && programs[j]->kind == PARSER_TOPLEVEL_KIND_NODE) {
+      nodes[count_nodes]     = programs[j];
+      indices[count_nodes++] = j;
+    }
+  errres = machine_add_node_ast_all(self, nodes, count_nodes, &f);
+  if(errres != EM_RESULT_OK) {
+    i = f == count_nodes ? length : indices[f];
+    goto err;
+  }
+  committed = true;
+  if(self->outdated.length > 0) CHKERR(machine_recompile(self, true));
+  if(self->globals_changed) CHKERR(machine_refresh_reads(self));
+  // Expressions are evaluated after all of definitions.
+  for(i = 0; i < length; ++i)
+    if(programs[i] != nullptr && programs[i]->kind == PARSER_TOPLEVEL_KIND_EXPR)
+      CHKERR(machine_exec(self, programs[i], &o));
+err:
+  if(errres != EM_RESULT_OK && failed != nullptr) *failed = i;
+  if(errres != EM_RESULT_OK && !committed) {
+    // In the reverse order, so that the first backup of the name is restored at last.
+    for(size_t j = backups.length; j > 0; --j)
+      variable_dictionary_restore(self, &(self->globals), &(((variable_t *)backups.buffer)[j - 1]));
+    arraylist_free(&(self->outdated));
+    self->outdated = outdated;
+    arraylist_default(&outdated);
+    self->globals_changed = changed;
+    // The functions may be compiled with the definitions which are reverted.
+    if(backups.length > 0) machine_recompile_functions(self);
+  }
+  for(size_t j = 0; j < backups.length; ++j)
+    variable_deep_free(&(((variable_t *)backups.buffer)[j]));
+  arraylist_free(&backups);
+  arraylist_free(&outdated);
+  machine_restore_stack_state(self, stack);
+  for(size_t j = 0; j < length; ++j)
+    parser_toplevel_release(programs[j]);
+  em_free(nodes);
+  em_free(indices);
+  return errres;
+}
+
+em_result
+machine_add_node_callback(machine_t * self, string_t * name, exec_callback_t callback)
+{
+  em_result errres = EM_RESULT_OK;
+  node_t *  node_ptr;
+  CHKERR(machine_add_node(self, name, &node_ptr));
+  return machine_add_node_callback2(self, node_ptr, callback);
+err:
+  return errres;
+}
+
+em_result
+machine_add_node_callback2(machine_t * self, node_t * node_ptr, exec_callback_t callback)
+{
+  em_result       errres = EM_RESULT_OK;
+  exec_sequence_t new_exec_seq;
+  journal_t *     journal = nullptr;
+  if(node_ptr->definition != nullptr)
+    CHKERR(remove_defined_node2(&journal, node_ptr));
+  // Without the callback, the value is set by machine_set_value_of_node or machine_drain_inputs.
+  CHKERR(
+    callback == nullptr ? exec_sequence_new_mono_nothing(&new_exec_seq, node_ptr)
+                        : exec_sequence_new_mono_callback(&new_exec_seq, callback, node_ptr));
   CHKERR(list_add2(&(self->execution_list.head), exec_sequence_t, &new_exec_seq));
   if(LIST_IS_EMPTY(&(self->execution_list.head->next)))
     self->execution_list.last = &(self->execution_list.head->next);
+  CHKERR(exec_order_add(self, (exec_sequence_t *)&(self->execution_list.head->value), journal));
+  machine_cleanup(self);
+  self->definitions_changed = true;
   // return EM_RESULT_OK;
 err:
+  journal_free(&journal);
   return errres;
 }
 
 bool
 machine_lookup_node(machine_t * self, node_t ** out, string_t * name)
 {
-  return dictionary_get(&(self->nodes), (void **)out, node_hasher, node_compare, name);
+  atom_t atom;
+  return atom_lookup(&(self->atoms), name, &atom) && machine_lookup_node_atom(self, out, atom);
+}
+
+bool
+machine_lookup_node_atom(machine_t * self, node_t ** out, atom_t name)
+{
+  return dictionary_get(
+    &(self->nodes), (void **)out, (size_t(*)(void *))atom_hash, node_compare, name);
 }
 
 bool
 macihne_is_defined(machine_t * self, string_t * name)
 {
-  return dictionary_contains(&(self->nodes), node_hasher, node_compare, name);
+  node_t * _;
+  return machine_lookup_node(self, &_, name);
 }
 
 em_result
 machine_indicate(machine_t * self, string_t * names, int count_names)
 {
-  // names is currently ignored. i.e. All of nodes are executed.
   em_result errres = EM_RESULT_OK;
-
-  for(list_t * /*<exec_sequence_t>*/ cur = self->execution_list.head; !LIST_IS_EMPTY(&cur);
-      cur                                = LIST_NEXT(cur))
-    CHKERR(exec_sequence_update_last(self, (exec_sequence_t *)(&(cur->value))));
-
-  for(list_t * /*<exec_sequence_t>*/ cur = self->execution_list.head; !LIST_IS_EMPTY(&cur);
-      cur                                = LIST_NEXT(cur)) {
-    em_result result = exec_sequence_update_value(self, (exec_sequence_t *)(&(cur->value)));
-    // TODO: result
+  bool      all    = self->definitions_changed;
+  self->iteration++;
+  self->definitions_changed = false;
+  // Temporaries in this iteration are allocated from the nursery.
+  memory_manager_begin_iteration(self->memory_manager);
+  for(int i = 0; i < count_names; ++i) {
+    node_t * n;
+    if(machine_lookup_node(self, &n, &(names[i]))) n->updated_at = self->iteration;
   }
-  // return EM_RESULT_OK;
+
+  if(self->plan_outdated) CHKERR(exec_plan_build(self));
+  CHKERR(exec_plan_update_last(self));
+  exec_plan_update_values(self, all);
+  return memory_manager_end_iteration(self);
 err:
+  memory_manager_end_iteration(self);
   return errres;
 }
 
 em_result
 machine_set_value_of_node(machine_t * self, string_t * name, object_t * val)
 {
-  node_t *  o      = nullptr;
+  node_t * o = nullptr;
+  if(!machine_lookup_node(self, &o, name)) return EM_RESULT_MISSING_IDENTIFIER;
+  return machine_set_value_of_node2(self, o, val);
+}
+
+em_result
+machine_set_value_of_node2(machine_t * self, node_t * node, object_t * val)
+{
   em_result errres = EM_RESULT_OK;
-  if(!dictionary_get(
-       &(self->nodes), (void **)&o, (size_t(*)(void *))string_hash, node_compare, name))
-    return EM_RESULT_MISSING_IDENTIFIER;
-  CHKERR(machine_mark_gray(self, o->last));
-  o->last  = o->value;
-  o->value = val;
+  CHKERR(machine_mark_gray(self, node->last));
+  node->last       = node->value;
+  node->value      = val;
+  node->updated_at = self->iteration + 1;  // It is treated as updated in the next iteration.
   // return EM_RESULT_OK;
 err:
   return errres;
 }
 
 em_result
-machine_add_output_node(machine_t * self, string_t name, node_event_delegate_t callback)
+machine_drain_inputs(machine_t * self)
+{
+  em_result  errres = EM_RESULT_OK;
+  node_t *   node;
+  object_t * val;
+  while(input_queue_take(&(self->inputs), &node, &val)) {
+    if(node->updated_at == self->iteration + 1) {
+      // Posted again before the iteration.
+      CHKERR(machine_mark_gray(self, node->value));
+      node->value = val;
+    } else
+      CHKERR(machine_set_value_of_node2(self, node, val));
+  }
+err:
+  return errres;
+}
+
+em_result
+machine_set_node_cut_off(machine_t * self, string_t * name, bool cut_off)
+{
+  node_t * o = nullptr;
+  if(!machine_lookup_node(self, &o, name)) return EM_RESULT_MISSING_IDENTIFIER;
+  o->cut_off = cut_off;
+  return EM_RESULT_OK;
+}
+
+// ! Whether the node is in node_or_tuple_t.
+/* !
+ * \param nt The node_or_tuple_t
+ * \param node The node
+ * \return Whether found or not
+ */
+static bool
+node_or_tuple_contains(node_or_tuple_t * nt, node_t * node)
+{
+  switch(nt->kind) {
+    case NODE_OR_TUPLE_NODE:
+      return nt->value.node == node;
+    case NODE_OR_TUPLE_TUPLE:
+      for(int i = 0; i < nt->value.tuple.length; ++i)
+        if(node_or_tuple_contains(&(((node_or_tuple_t *)(nt->value.tuple.buffer))[i]), node))
+          return true;
+      return false;
+    default:
+      return false;
+  }
+}
+
+bool
+machine_lookup_exec_sequence(machine_t * self, exec_sequence_t ** out, string_t * name)
+{
+  node_t * node;
+  if(!machine_lookup_node(self, &node, name)) return false;
+  for(list_t * /*<exec_sequence_t>*/ cur = self->execution_list.head; cur != nullptr;
+      cur                                = LIST_NEXT(cur)) {
+    exec_sequence_t * es = (exec_sequence_t *)(&(cur->value));
+    if(
+      es->node_definition == node
+      || (es->node_definitions != nullptr && node_or_tuple_contains(es->node_definitions, node))) {
+      *out = es;
+      return true;
+    }
+  }
+  return false;
+}
+
+em_result
+machine_add_output_node(machine_t * self, string_t * name, node_event_delegate_t callback)
 {
   em_result errres    = EM_RESULT_OK;
   node_t *  ptrToNode = nullptr;
-  if(dictionary_get(
-       &(self->nodes), (void **)(&ptrToNode), (size_t(*)(void *))string_hash, node_compare,
-       &name)) {
-    ptrToNode->action = callback;
-    string_free(&name);
-  } else {
-    node_t new_node = {0};
-    node_new(&new_node, name);
-    new_node.action = callback;
-    CHKERR(dictionary_add(
-      &(self->nodes), &new_node, sizeof(node_t), node_hasher, node_compare2, nullptr, nullptr));
-  }
+  CHKERR(machine_add_node(self, name, &ptrToNode));
+  ptrToNode->action = callback;
   //return EM_RESULT_OK;
 err:
   return errres;
@@ -650,29 +1267,49 @@ err:
 void
 machine_debug_print_definitions(machine_t * self)
 {
-  fputs("=== EXECUTION LIST ===\n", stdout);
-  for(list_t * /*<exec_sequence_t>*/ cur = self->execution_list.head; cur != nullptr;
-      cur                                = LIST_NEXT(cur)) {
-    exec_sequence_t * n = (exec_sequence_t *)(&(cur->value));
+  em_diag_puts("=== EXECUTION LIST ===\n");
+  for(size_t i = 0; i < self->order.length; ++i) {
+    exec_sequence_t * n = ((exec_sequence_t **)self->order.buffer)[i];
     if(n->node_definitions == nullptr) {
       if(n->node_definition == nullptr)
-        fputs("Node<INVALID!>\n", stdout);
+        em_diag_puts("Node<INVALID!>\n");
       else {
-        fputs("Node<", stdout);
-        fputs(n->node_definition->name.buffer, stdout);
-        fputs(">\n", stdout);
+        em_diag_puts("Node<");
+        em_diag_puts(n->node_definition->name->buffer);
+        em_diag_puts(">\n");
       }
     } else {
-      fputs("Node<", stdout);
+      em_diag_puts("Node<");
       node_or_tuple_debug_print(n->node_definitions);
       if(n->node_definition == nullptr)
-        fputs(">\n", stdout);
+        em_diag_puts(">\n");
       else {
-        fputs("as ", stdout);
-        fputs(n->node_definition->name.buffer, stdout);
-        fputs(">\n", stdout);
+        em_diag_puts("as ");
+        em_diag_puts(n->node_definition->name->buffer);
+        em_diag_puts(">\n");
       }
     }
   }
-  fputs("======================\n", stdout);
+  em_diag_puts("======================\n");
+}
+
+#if EMFRP_ENABLE_PROFILING
+void
+machine_debug_print_profile(machine_t * self)
+{
+  em_diag_printf(
+    "%-24s %10s %12s %12s %10s %8s\n", "node", "evals", "avg(ns)", "max(ns)", "allocs", "fails");
+  for(size_t i = 0; i < self->order.length; ++i) {
+    exec_sequence_t *         n = ((exec_sequence_t **)self->order.buffer)[i];
+    exec_sequence_profile_t * p = &(n->profile);
+    if(n->node_definition != nullptr)
+      em_diag_printf("%-24s", n->node_definition->name->buffer);
+    else if(n->node_definitions != nullptr)
+      node_or_tuple_debug_print(n->node_definitions);
+    em_diag_printf(
+      " %10zu %12llu %12llu %10zu %8zu\n", p->evaluations,
+      p->evaluations == 0 ? 0ULL : (unsigned long long)(p->total_ns / p->evaluations),
+      (unsigned long long)p->max_ns, p->allocations, p->failures);
+  }
 }
+#endif
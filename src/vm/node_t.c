@@ -10,5 +10,5 @@
 void
 node_deep_free(node_t * v)
 {
-  string_free(&(v->name));
+  // The name is owned by machine_t::atoms.
 }
@@ -5,7 +5,7 @@
  * @date   2023/1/9
  ------------------------------------------- */
 #include "vm/object_t.h"
-#include <stdio.h>
+#include "emdiag.h"
 
 // ! True Object
 object_t object_true;
@@ -16,52 +16,55 @@ void
 object_print(object_t * v)
 {
   if(v == nullptr)
-    printf("NIL");
+    em_diag_puts("NIL");
   else if(object_is_integer(v))
-    printf("%d", object_get_integer(v));
+    em_diag_print_int(object_get_integer(v));
   else if(v == &object_true)
-    printf("true");
+    em_diag_puts("true");
   else if(v == &object_false)
-    printf("false");
+    em_diag_puts("false");
+  else if(object_is_tag(v))
+    em_diag_puts(record_table_name(object_get_tag(v))->buffer);
   else if(object_is_pointer(v)) {
+    if(object_tuple_tag(v) != RECORD_TAG_NONE)  // Only tuples have tags.
+      em_diag_puts(record_table_name(object_tuple_tag(v))->buffer);
     switch(object_kind(v)) {
       case EMFRP_OBJECT_SYMBOL:
-        printf("%s", v->value.symbol.value.buffer);
+        em_diag_puts(v->value.symbol.value.buffer);
         break;
       case EMFRP_OBJECT_STRING:
-        printf("\"%s\"", v->value.string.value.buffer);
+        em_diag_puts("\"");
+        em_diag_puts(v->value.string.value.buffer);
+        em_diag_puts("\"");
         break;
       case EMFRP_OBJECT_TUPLE1:
-        if(v->value.tuple1.tag != nullptr) object_print(v->value.tuple1.tag);
-        printf("(");
+        em_diag_puts("(");
         object_print(v->value.tuple1.i0);
-        printf(")");
+        em_diag_puts(")");
         break;
       case EMFRP_OBJECT_TUPLE2:
-        if(v->value.tuple2.tag != nullptr) object_print(v->value.tuple2.tag);
-        printf("(");
+        em_diag_puts("(");
         object_print(v->value.tuple2.i0);
-        printf(", ");
+        em_diag_puts(", ");
         object_print(v->value.tuple2.i1);
-        printf(")");
+        em_diag_puts(")");
         break;
       case EMFRP_OBJECT_TUPLEN: {
-        if(v->value.tupleN.tag != nullptr) object_print(v->value.tupleN.tag);
-        printf("(");
+        em_diag_puts("(");
         object_print(object_tuple_ith(v, 0));
         for(int i = 1; i < v->value.tupleN.length; ++i) {
-          printf(", ");
+          em_diag_puts(", ");
           object_print(object_tuple_ith(v, i));
         }
-        printf(")");
+        em_diag_puts(")");
         break;
       }
       case EMFRP_OBJECT_FUNCTION: {
-        printf("<function object>");
+        em_diag_puts("<function object>");
         break;
       }
       case EMFRP_OBJECT_VARIABLE_TABLE: {
-        printf("<variable table>");
+        em_diag_puts("<variable table>");
         break;
       }
       default:
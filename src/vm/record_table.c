@@ -0,0 +1,40 @@
+/** -------------------------------------------
+ * @file   record_table.c
+ * @brief  Table of Record Types
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include "vm/record_table.h"
+#include "collections/arraylist_t.h"
+
+// ! Names of record types. The ID is the index + 1.
+static arraylist_t /*<string_t>*/ record_table;
+
+em_result
+record_table_intern(string_t * name, record_tag_t * out)
+{
+  em_result  errres = EM_RESULT_OK;
+  string_t * names  = (string_t *)record_table.buffer;
+  string_t   copied;
+  // Record types are few, and they are looked up only when definitions are accepted.
+  for(size_t i = 0; i < record_table.length; ++i)
+    if(string_compare(&(names[i]), name)) {
+      *out = (record_tag_t)(i + 1);
+      return EM_RESULT_OK;
+    }
+  TEST_AND_ERROR(record_table.length >= RECORD_TAG_MAX, EM_RESULT_OUT_OF_INDEX);
+  CHKERR(string_copy(&copied, name));
+  CHKERR2(err2, arraylist_append(&record_table, sizeof(string_t), &copied));
+  *out = (record_tag_t)record_table.length;
+  return EM_RESULT_OK;
+err2:
+  string_free(&copied);
+err:
+  return errres;
+}
+
+string_t *
+record_table_name(record_tag_t tag)
+{
+  return &(((string_t *)record_table.buffer)[tag - 1]);
+}
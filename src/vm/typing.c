@@ -0,0 +1,945 @@
+/** -------------------------------------------
+ * @file   typing.c
+ * @brief  Type Inference Implementation
+ * @author Go Suzuki <puyogo.suzuki@gmail.com>
+ * @date   2026/10/17
+ ------------------------------------------- */
+#include <stdlib.h>
+#include "vm/typing.h"
+#include "vm/machine.h"
+#include "emdiag.h"
+
+// ! The depth of tuples in values of global variables whose types are inferred.
+#define TYPING_VALUE_DEPTH 4
+
+// ! Kind of types.
+typedef enum type_kind_t
+{
+  // ! A type variable. It is the type of type_t::link if linked.
+  TYPE_KIND_VARIABLE,
+  // ! Any(not known statically)
+  TYPE_KIND_ANY,
+  // ! Int
+  TYPE_KIND_INT,
+  // ! Bool
+  TYPE_KIND_BOOL,
+  // ! Tuples and records.(type_t::items are elements.)
+  TYPE_KIND_TUPLE,
+  // ! Functions.(type_t::items are arguments and the result.)
+  TYPE_KIND_FUNCTION,
+} type_kind_t;
+
+// ! The type.
+typedef struct type_t
+{
+  // ! Kind of the type.
+  type_kind_t kind;
+  // ! The linked type.(Nullable, only for TYPE_KIND_VARIABLE.)
+  struct type_t * link;
+  // ! The tag.(only for TYPE_KIND_TUPLE.)
+  record_tag_t tag;
+  // ! Count of elements, or arguments.
+  size_t arity;
+  // ! Elements, or arguments followed by the result.
+  struct type_t * items[];
+} type_t;
+
+// ! Kind of local variables.
+typedef enum typing_binding_kind
+{
+  // ! Bound by case/of or `{ .. }`.
+  TYPING_BINDING_LOCAL,
+  // ! The argument of the function.
+  TYPING_BINDING_ARGUMENT,
+  // ! The name of the toplevel function itself.
+  TYPING_BINDING_SELF,
+} typing_binding_kind;
+
+// ! A local variable.
+typedef struct typing_binding_t
+{
+  // ! Name of the variable.(It is owned by the AST.)
+  string_t * name;
+  // ! The type.
+  type_t * type;
+  // ! Kind of the variable.
+  typing_binding_kind kind;
+  // ! The expression whose value is bound.(Nullable, e.g. elements of tuples.)
+  parser_expression_t * value;
+} typing_binding_t;
+
+// ! The type of the expression or the argument.
+typedef struct typing_entry_t
+{
+  // ! The expression, or the deconstructor of the argument.
+  const void * key;
+  // ! The type.
+  type_t * type;
+  // ! The local variable which the identifier refers to.(Nullable)
+  typing_binding_t * binding;
+  // ! Is the value proven to be the type?(Only for global variables and calls.)
+  bool proven;
+} typing_entry_t;
+
+// ! The type of other definition.
+typedef struct typing_memo_t
+{
+  // ! The function expression, or the node.
+  const void * key;
+  // ! The type.(nullptr while it is inferred.)
+  type_t * type;
+} typing_memo_t;
+
+static em_result typing_expression(typing_t * t, parser_expression_t * v, type_t ** out);
+static em_result typing_value(typing_t * t, object_t * v, int depth, type_t ** out);
+
+void
+typing_new(typing_t * out, struct machine_t * m, const variable_dependent_t * owner)
+{
+  out->machine = m;
+  arena_new(&(out->arena));
+  arraylist_default(&(out->entries));
+  arraylist_default(&(out->scope));
+  arraylist_default(&(out->memos));
+  out->scope_base     = 0;
+  out->root           = nullptr;
+  out->recording      = false;
+  out->owner          = owner;
+  out->error_at       = nullptr;
+  out->error_expected = nullptr;
+  out->error_actual   = nullptr;
+}
+
+// ! Allocate the new type, whose items are not set.
+static em_result
+typing_new_type(typing_t * t, type_kind_t kind, size_t arity, type_t ** out)
+{
+  em_result errres = EM_RESULT_OK;
+  size_t    items  = kind == TYPE_KIND_FUNCTION ? arity + 1 : (kind == TYPE_KIND_TUPLE ? arity : 0);
+  type_t *  ret    = nullptr;
+  CHKERR(arena_alloc(&(t->arena), (void **)&ret, sizeof(type_t) + items * sizeof(type_t *)));
+  ret->kind  = kind;
+  ret->link  = nullptr;
+  ret->tag   = RECORD_TAG_NONE;
+  ret->arity = arity;
+  *out       = ret;
+err:
+  return errres;
+}
+
+// ! Allocate the new type variable.
+static inline em_result
+typing_variable(typing_t * t, type_t ** out)
+{
+  return typing_new_type(t, TYPE_KIND_VARIABLE, 0, out);
+}
+
+// ! Allocate the new type, whose items are new type variables.
+static em_result
+typing_new_type_fresh(typing_t * t, type_kind_t kind, size_t arity, type_t ** out)
+{
+  em_result errres = EM_RESULT_OK;
+  type_t *  ret    = nullptr;
+  CHKERR(typing_new_type(t, kind, arity, &ret));
+  for(size_t i = 0; i < arity + (kind == TYPE_KIND_FUNCTION ? 1 : 0); ++i)
+    CHKERR(typing_variable(t, &(ret->items[i])));
+  *out = ret;
+err:
+  return errres;
+}
+
+// ! Follow links of type variables.
+static type_t *
+typing_resolve(type_t * v)
+{
+  while(v->kind == TYPE_KIND_VARIABLE && v->link != nullptr)
+    v = v->link;
+  return v;
+}
+
+// ! Does the type contain the type variable?
+static bool
+typing_occurs(type_t * var, type_t * v)
+{
+  v = typing_resolve(v);
+  if(v == var) return true;
+  if(v->kind == TYPE_KIND_TUPLE || v->kind == TYPE_KIND_FUNCTION)
+    for(size_t i = 0; i < v->arity + (v->kind == TYPE_KIND_FUNCTION ? 1 : 0); ++i)
+      if(typing_occurs(var, v->items[i])) return true;
+  return false;
+}
+
+// ! Unify two types.
+/* !
+ * \return EM_RESULT_TYPE_MISMATCH if they cannot be unified.
+ */
+static em_result
+typing_unify(type_t * a, type_t * b)
+{
+  em_result errres = EM_RESULT_OK;
+  a                = typing_resolve(a);
+  b                = typing_resolve(b);
+  if(a == b) return EM_RESULT_OK;
+  if(a->kind == TYPE_KIND_VARIABLE || b->kind == TYPE_KIND_VARIABLE) {
+    type_t * var = a->kind == TYPE_KIND_VARIABLE ? a : b;
+    type_t * v   = a->kind == TYPE_KIND_VARIABLE ? b : a;
+    TEST_AND_ERROR(typing_occurs(var, v), EM_RESULT_TYPE_MISMATCH);
+    var->link = v;
+    return EM_RESULT_OK;
+  }
+  if(a->kind == TYPE_KIND_ANY || b->kind == TYPE_KIND_ANY) return EM_RESULT_OK;
+  TEST_AND_ERROR(a->kind != b->kind, EM_RESULT_TYPE_MISMATCH);
+  switch(a->kind) {
+    case TYPE_KIND_TUPLE:
+      if(a->tag != b->tag || a->arity != b->arity) {
+        // Widened, because records of different kinds are often mixed.
+        a->kind = TYPE_KIND_ANY;
+        b->kind = TYPE_KIND_ANY;
+        return EM_RESULT_OK;
+      }
+      for(size_t i = 0; i < a->arity; ++i)
+        CHKERR(typing_unify(a->items[i], b->items[i]));
+      break;
+    case TYPE_KIND_FUNCTION:
+      TEST_AND_ERROR(a->arity != b->arity, EM_RESULT_TYPE_MISMATCH);
+      for(size_t i = 0; i <= a->arity; ++i)
+        CHKERR(typing_unify(a->items[i], b->items[i]));
+      break;
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+// ! Unify two types, and record the error at the expression.
+static em_result
+typing_unify_at(typing_t * t, parser_expression_t * at, type_t * expected, type_t * actual)
+{
+  em_result errres = typing_unify(expected, actual);
+  if(errres == EM_RESULT_TYPE_MISMATCH && t->error_at == nullptr) {
+    t->error_at       = at;
+    t->error_expected = expected;
+    t->error_actual   = actual;
+  }
+  return errres;
+}
+
+// ! Copy the type with new type variables.(Generalized type variables are instantiated.)
+/* !
+ * \param map Pairs of the type variable and the new one.
+ */
+static em_result
+typing_instantiate2(typing_t * t, type_t * v, arraylist_t /*<type_t *>*/ * map, type_t ** out)
+{
+  em_result errres = EM_RESULT_OK;
+  type_t ** pairs  = nullptr;
+  type_t *  ret    = nullptr;
+  v                = typing_resolve(v);
+  switch(v->kind) {
+    case TYPE_KIND_VARIABLE:
+      pairs = (type_t **)map->buffer;
+      for(size_t i = 0; i < map->length; i += 2)
+        if(pairs[i] == v) {
+          *out = pairs[i + 1];
+          return EM_RESULT_OK;
+        }
+      CHKERR(typing_variable(t, &ret));
+      CHKERR(arraylist_append(map, sizeof(type_t *), &v));
+      CHKERR(arraylist_append(map, sizeof(type_t *), &ret));
+      break;
+    case TYPE_KIND_TUPLE:
+    case TYPE_KIND_FUNCTION:
+      // Copied, because tuples may be widened.
+      CHKERR(typing_new_type(t, v->kind, v->arity, &ret));
+      ret->tag = v->tag;
+      for(size_t i = 0; i < v->arity + (v->kind == TYPE_KIND_FUNCTION ? 1 : 0); ++i)
+        CHKERR(typing_instantiate2(t, v->items[i], map, &(ret->items[i])));
+      break;
+    default:
+      ret = v;
+      break;
+  }
+  *out = ret;
+err:
+  return errres;
+}
+
+static em_result
+typing_instantiate(typing_t * t, type_t * v, type_t ** out)
+{
+  em_result errres = EM_RESULT_OK;
+  arraylist_t /*<type_t *>*/ map;
+  arraylist_default(&map);
+  errres = typing_instantiate2(t, v, &map, out);
+  arraylist_free(&map);
+  return errres;
+}
+
+// ! Record the type of the expression or the argument.
+static em_result
+typing_record(typing_t * t, const void * key, type_t * type, typing_binding_t * b, bool proven)
+{
+  typing_entry_t e = {.key = key, .type = type, .binding = b, .proven = proven};
+  if(!t->recording) return EM_RESULT_OK;
+  return arraylist_append(&(t->entries), sizeof(typing_entry_t), &e);
+}
+
+// ! Look up the visible local variable.
+static typing_binding_t *
+typing_lookup(typing_t * t, string_t * name)
+{
+  typing_binding_t ** bs = (typing_binding_t **)t->scope.buffer;
+  for(size_t i = t->scope.length; i > t->scope_base; --i)
+    if(string_compare(bs[i - 1]->name, name)) return bs[i - 1];
+  return nullptr;
+}
+
+// ! Bind local variables of the deconstructor.
+/* !
+ * \param type The type of the value.
+ * \param value The expression whose value is bound.(Nullable)
+ * \param at The expression which holds the deconstructor.(for errors.)
+ */
+static em_result
+typing_bind(
+  typing_t *            t,
+  deconstructor_t *     d,
+  type_t *              type,
+  typing_binding_kind   kind,
+  parser_expression_t * value,
+  parser_expression_t * at)
+{
+  em_result          errres = EM_RESULT_OK;
+  typing_binding_t * b      = nullptr;
+  type_t *           tuple  = nullptr;
+  type_t *           i      = nullptr;
+  record_tag_t       tag    = RECORD_TAG_NONE;
+  size_t             arity  = 0;
+  switch(d->kind) {
+    case DECONSTRUCTOR_IDENTIFIER:
+      CHKERR(arena_alloc(&(t->arena), (void **)&b, sizeof(typing_binding_t)));
+      b->name  = d->value.identifier;
+      b->type  = type;
+      b->kind  = kind;
+      b->value = value;
+      CHKERR(arraylist_append(&(t->scope), sizeof(typing_binding_t *), &b));
+      if(kind == TYPING_BINDING_ARGUMENT) CHKERR(typing_record(t, d, type, b, false));
+      break;
+    case DECONSTRUCTOR_INTEGER:
+      CHKERR(typing_new_type(t, TYPE_KIND_INT, 0, &i));
+      CHKERR(typing_unify_at(t, at, type, i));
+      break;
+    case DECONSTRUCTOR_TUPLE:
+      CHKERR(record_table_resolve(d, &tag));
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li))
+        arity++;
+      CHKERR(typing_new_type_fresh(t, TYPE_KIND_TUPLE, arity, &tuple));
+      tuple->tag = tag;
+      CHKERR(typing_unify_at(t, at, type, tuple));
+      arity = 0;
+      for(list_t * li = d->value.tuple.data; li != nullptr; li = LIST_NEXT(li), arity++)
+        CHKERR(typing_bind(
+          t, (deconstructor_t *)(&(li->value)), tuple->items[arity], TYPING_BINDING_LOCAL, nullptr,
+          at));
+      break;
+    default:
+      break;
+  }
+err:
+  return errres;
+}
+
+// ! Is the expression the toplevel function?
+static inline bool
+typing_is_toplevel_function(parser_expression_t * v)
+{
+  parser_toplevel_t * owner = nullptr;
+  if(!EXPR_IS_POINTER(v) || v->kind != EXPR_KIND_FUNCTION) return false;
+  owner = v->value.function.owner;
+  return owner != nullptr && owner->kind == PARSER_TOPLEVEL_KIND_FUNC
+         && owner->value.func->function == v;
+}
+
+// ! Infer the type of the definition.
+/* !
+ * The name of the toplevel function is bound to itself for the recursion.
+ */
+static em_result
+typing_definition(typing_t * t, parser_expression_t * v, type_t ** out)
+{
+  em_result          errres = EM_RESULT_OK;
+  typing_binding_t * self   = nullptr;
+  type_t *           ret    = nullptr;
+  if(typing_is_toplevel_function(v)) {
+    CHKERR(arena_alloc(&(t->arena), (void **)&self, sizeof(typing_binding_t)));
+    self->name  = v->value.function.owner->value.func->name;
+    self->kind  = TYPING_BINDING_SELF;
+    self->value = nullptr;
+    CHKERR(typing_variable(t, &(self->type)));
+    CHKERR(arraylist_append(&(t->scope), sizeof(typing_binding_t *), &self));
+  }
+  CHKERR(typing_expression(t, v, &ret));
+  if(self != nullptr) CHKERR(typing_unify_at(t, v, self->type, ret));
+  *out = ret;
+err:
+  return errres;
+}
+
+// ! Infer the type of other definition.
+/* !
+ * The result is memoized, and instantiated. Other definitions are typed as Any, if they are
+ * ill-typed(e.g. definitions which they depend on are changed), or they are being inferred.
+ * \param key The key of the memo.
+ * \param v The expression.
+ * \param node The node whose type is extracted from the type of v.(Nullable)
+ */
+static em_result
+typing_other(typing_t * t, const void * key, parser_expression_t * v, node_t * node, type_t ** out)
+{
+  em_result          errres    = EM_RESULT_OK;
+  typing_memo_t *    memos     = (typing_memo_t *)t->memos.buffer;
+  typing_memo_t      memo      = {.key = key, .type = nullptr};
+  typing_binding_t * b         = nullptr;
+  parser_node_t *    pn        = nullptr;
+  size_t             index     = t->memos.length;
+  size_t             base      = t->scope_base;
+  bool               recording = t->recording;
+  type_t *           ret       = nullptr;
+  if(v == t->root) return typing_new_type(t, TYPE_KIND_ANY, 0, out);  // Being compiled.
+  for(size_t i = 0; i < t->memos.length; ++i)
+    if(memos[i].key == key) {
+      if(memos[i].type == nullptr) return typing_new_type(t, TYPE_KIND_ANY, 0, out);
+      return typing_instantiate(t, memos[i].type, out);
+    }
+  CHKERR(arraylist_append(&(t->memos), sizeof(typing_memo_t), &memo));
+  t->scope_base = t->scope.length;
+  t->recording  = false;
+  errres        = typing_definition(t, v, &ret);
+  if(errres == EM_RESULT_OK && node != nullptr) {
+    pn = node->definition->program.ast.source->value.node;
+    if(pn->as == nullptr || !string_compare(pn->as, node->name)) {
+      errres = typing_bind(t, &(pn->name), ret, TYPING_BINDING_LOCAL, nullptr, v);
+      b      = typing_lookup(t, node->name);
+      if(errres == EM_RESULT_OK && b != nullptr)
+        ret = b->type;
+      else if(errres == EM_RESULT_OK)
+        errres = typing_new_type(t, TYPE_KIND_ANY, 0, &ret);
+    }
+  }
+  t->scope.length = t->scope_base;
+  t->scope_base   = base;
+  t->recording    = recording;
+  if(errres == EM_RESULT_TYPE_MISMATCH) {
+    t->error_at = nullptr;
+    errres      = typing_new_type(t, TYPE_KIND_ANY, 0, &ret);
+  }
+  CHKERR(errres);
+  ((typing_memo_t *)t->memos.buffer)[index].type = ret;
+  CHKERR(typing_instantiate(t, ret, out));
+err:
+  return errres;
+}
+
+// ! Infer the type of the node.
+static em_result
+typing_node(typing_t * t, node_t * node, type_t ** out)
+{
+  exec_sequence_t * es = node->definition;
+  if(es == nullptr || exec_sequence_program_kind(es) != EMFRP_PROGRAM_KIND_AST)
+    return typing_new_type(t, TYPE_KIND_ANY, 0, out);
+  return typing_other(t, node, es->program.ast.source->value.node->expression, node, out);
+}
+
+// ! Infer the type of the function object.
+static em_result
+typing_value_function(typing_t * t, object_t * v, type_t ** out)
+{
+  em_result    errres = EM_RESULT_OK;
+  bytecode_t * code   = nullptr;
+  variable_t * var    = nullptr;
+  object_t *   ctor   = nullptr;
+  type_t *     ret    = nullptr;
+  type_t *     tuple  = nullptr;
+  size_t       arity  = 0;
+  switch(v->value.function.kind) {
+    case EMFRP_PROGRAM_KIND_BYTECODE:
+      code = v->value.function.function.bytecode.program;
+      if(typing_is_toplevel_function(code->source))
+        return typing_other(t, code->source, code->source, nullptr, out);
+      CHKERR(typing_new_type(t, TYPE_KIND_FUNCTION, code->arity, &ret));
+      for(size_t i = 0; i <= (size_t)code->arity; ++i)
+        CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &(ret->items[i])));
+      break;
+    case EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT:
+      arity = v->value.function.function.construct.arity;
+      CHKERR(typing_new_type_fresh(t, TYPE_KIND_TUPLE, arity, &tuple));
+      tuple->tag = v->value.function.function.construct.tag;
+      CHKERR(typing_new_type(t, TYPE_KIND_FUNCTION, arity, &ret));
+      for(size_t i = 0; i < arity; ++i)
+        ret->items[i] = tuple->items[i];
+      ret->items[arity] = tuple;
+      break;
+    case EMFRP_PROGRAM_KIND_RECORD_ACCESS:
+      // The arity is known from the constructor, which is named after the record.
+      if(machine_lookup_global(
+           t->machine, &var, record_table_name(v->value.function.function.access.tag))) {
+        ctor = var->value;
+        if(
+          object_is_pointer(ctor) && ctor != nullptr
+          && object_kind(ctor) == EMFRP_OBJECT_FUNCTION
+          && ctor->value.function.kind == EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT
+          && ctor->value.function.function.construct.tag
+               == v->value.function.function.access.tag
+          && v->value.function.function.access.index
+               < ctor->value.function.function.construct.arity)
+          arity = ctor->value.function.function.construct.arity;
+      }
+      CHKERR(typing_new_type(t, TYPE_KIND_FUNCTION, 1, &ret));
+      if(arity > 0) {
+        CHKERR(typing_new_type_fresh(t, TYPE_KIND_TUPLE, arity, &tuple));
+        tuple->tag    = v->value.function.function.access.tag;
+        ret->items[0] = tuple;
+        ret->items[1] = tuple->items[v->value.function.function.access.index];
+      } else {
+        CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &(ret->items[0])));
+        CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &(ret->items[1])));
+      }
+      break;
+    default:
+      CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &ret));
+      break;
+  }
+  *out = ret;
+err:
+  return errres;
+}
+
+// ! Infer the type of the value.(e.g. values of global variables.)
+static em_result
+typing_value(typing_t * t, object_t * v, int depth, type_t ** out)
+{
+  em_result errres = EM_RESULT_OK;
+  type_t *  ret    = nullptr;
+  size_t    arity  = 0;
+  if(object_is_integer(v)) return typing_new_type(t, TYPE_KIND_INT, 0, out);
+  if(object_is_boolean(v)) return typing_new_type(t, TYPE_KIND_BOOL, 0, out);
+  if(object_is_tag(v)) {
+    CHKERR(typing_new_type(t, TYPE_KIND_TUPLE, 0, &ret));
+    ret->tag = object_get_tag(v);
+    *out     = ret;
+    return EM_RESULT_OK;
+  }
+  if(!object_is_pointer(v) || v == nullptr || depth > TYPING_VALUE_DEPTH)
+    return typing_new_type(t, TYPE_KIND_ANY, 0, out);
+  switch(object_kind(v)) {
+    case EMFRP_OBJECT_TUPLE1:
+      arity = 1;
+      break;
+    case EMFRP_OBJECT_TUPLE2:
+      arity = 2;
+      break;
+    case EMFRP_OBJECT_TUPLEN:
+      arity = v->value.tupleN.length;
+      break;
+    case EMFRP_OBJECT_FUNCTION:
+      return typing_value_function(t, v, out);
+    default:
+      return typing_new_type(t, TYPE_KIND_ANY, 0, out);
+  }
+  CHKERR(typing_new_type(t, TYPE_KIND_TUPLE, arity, &ret));
+  ret->tag = object_tuple_tag(v);
+  switch(arity) {
+    case 1:
+      CHKERR(typing_value(t, v->value.tuple1.i0, depth + 1, &(ret->items[0])));
+      break;
+    case 2:
+      CHKERR(typing_value(t, v->value.tuple2.i0, depth + 1, &(ret->items[0])));
+      CHKERR(typing_value(t, v->value.tuple2.i1, depth + 1, &(ret->items[1])));
+      break;
+    default:
+      for(size_t i = 0; i < arity; ++i)
+        CHKERR(typing_value(t, object_tuple_ith(v, i), depth + 1, &(ret->items[i])));
+      break;
+  }
+  *out = ret;
+err:
+  return errres;
+}
+
+// ! Infer the type of the identifier.
+static em_result
+typing_identifier(
+  typing_t *            t,
+  parser_expression_t * v,
+  type_t **             out,
+  typing_binding_t **   binding,
+  bool *                proven)
+{
+  typing_binding_t * b    = typing_lookup(t, &(v->value.identifier));
+  variable_t *       var  = nullptr;
+  node_t *           node = nullptr;
+  if(b != nullptr) {
+    *binding = b;
+    *out     = b->type;
+    return EM_RESULT_OK;
+  }
+  if(machine_lookup_global(t->machine, &var, &(v->value.identifier))) {
+    // The code is compiled again, if the value is changed.
+    if(t->owner != nullptr && t->recording) {
+      em_result errres = variable_dependents_add(&(var->dependents), t->owner);
+      if(errres != EM_RESULT_OK) return errres;
+    }
+    *proven = true;
+    return typing_value(t, var->value, 0, out);
+  }
+  if(machine_lookup_node(t->machine, &node, &(v->value.identifier)))
+    return typing_node(t, node, out);
+  return typing_new_type(t, TYPE_KIND_ANY, 0, out);
+}
+
+// ! Is the callee the record constructor?
+static bool
+typing_is_constructor(typing_t * t, parser_expression_t * callee)
+{
+  variable_t * var = nullptr;
+  if(!EXPR_IS_POINTER(callee) || callee->kind != EXPR_KIND_IDENTIFIER) return false;
+  if(typing_lookup(t, &(callee->value.identifier)) != nullptr) return false;
+  if(!machine_lookup_global(t->machine, &var, &(callee->value.identifier))) return false;
+  return object_is_pointer(var->value) && var->value != nullptr
+         && object_kind(var->value) == EMFRP_OBJECT_FUNCTION
+         && var->value->value.function.kind == EMFRP_PROGRAM_KIND_RECORD_CONSTRUCT;
+}
+
+static em_result
+typing_expression(typing_t * t, parser_expression_t * v, type_t ** out)
+{
+  em_result          errres  = EM_RESULT_OK;
+  size_t             visible = t->scope.length;
+  typing_binding_t * binding = nullptr;
+  node_t *           node    = nullptr;
+  bool               proven  = false;
+  type_t *           ret     = nullptr;
+  type_t *           l       = nullptr;
+  type_t *           r       = nullptr;
+  size_t             n       = 0;
+  if(EXPR_KIND_IS_INTEGER(v)) return typing_new_type(t, TYPE_KIND_INT, 0, out);
+  if(EXPR_KIND_IS_BOOLEAN(v)) return typing_new_type(t, TYPE_KIND_BOOL, 0, out);
+  if(!EXPR_IS_POINTER(v)) return typing_new_type(t, TYPE_KIND_ANY, 0, out);
+  if(EXPR_KIND_IS_BIN_OP(v)) {
+    CHKERR(typing_expression(t, v->value.binary.lhs, &l));
+    CHKERR(typing_expression(t, v->value.binary.rhs, &r));
+    switch(v->kind) {
+      case EXPR_KIND_EQUAL:
+      case EXPR_KIND_NOT_EQUAL:
+        CHKERR(typing_unify_at(t, v, l, r));
+        break;
+      // The operands are tested by whether they are False, so that they may be any type.
+      case EXPR_KIND_AND:
+      case EXPR_KIND_OR:
+      case EXPR_KIND_XOR:
+      case EXPR_KIND_DAND:
+        break;
+      case EXPR_KIND_DOR:  // It may be the left operand.(See typing_proves.)
+        CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &ret));
+        break;
+      default:
+        CHKERR(typing_new_type(t, TYPE_KIND_INT, 0, &ret));
+        CHKERR(typing_unify_at(t, v, ret, l));
+        CHKERR(typing_unify_at(t, v, ret, r));
+        if(v->kind >= EXPR_KIND_LESS_OR_EQUAL && v->kind <= EXPR_KIND_GREATER_THAN) ret = nullptr;
+        break;
+    }
+    if(ret == nullptr) CHKERR(typing_new_type(t, TYPE_KIND_BOOL, 0, &ret));
+  } else
+    switch(v->kind) {
+      case EXPR_KIND_IDENTIFIER:
+        CHKERR(typing_identifier(t, v, &ret, &binding, &proven));
+        break;
+      case EXPR_KIND_LAST_IDENTIFIER:
+        if(machine_lookup_node(t->machine, &node, &(v->value.identifier))) {
+          CHKERR(typing_node(t, node, &ret));
+        } else {
+          CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &ret));
+        }
+        break;
+      case EXPR_KIND_IF:
+        CHKERR(typing_expression(t, v->value.ifthenelse.cond, &l));
+        CHKERR(typing_expression(t, v->value.ifthenelse.then, &ret));
+        CHKERR(typing_expression(t, v->value.ifthenelse.otherwise, &r));
+        CHKERR(typing_unify_at(t, v, ret, r));
+        break;
+      case EXPR_KIND_TUPLE:
+        for(parser_expression_tuple_list_t * li = &(v->value.tuple); li != nullptr; li = li->next)
+          n++;
+        CHKERR(typing_new_type(t, TYPE_KIND_TUPLE, n, &ret));
+        n = 0;
+        for(parser_expression_tuple_list_t * li = &(v->value.tuple); li != nullptr; li = li->next)
+          CHKERR(typing_expression(t, li->value, &(ret->items[n++])));
+        break;
+      case EXPR_KIND_FUNCCALL:
+        if(v->value.funccall.arguments.value != nullptr)
+          for(parser_expression_tuple_list_t * li = &(v->value.funccall.arguments); li != nullptr;
+              li                                  = li->next)
+            n++;
+        CHKERR(typing_new_type(t, TYPE_KIND_FUNCTION, n, &l));
+        n = 0;
+        if(v->value.funccall.arguments.value != nullptr)
+          for(parser_expression_tuple_list_t * li = &(v->value.funccall.arguments); li != nullptr;
+              li                                  = li->next)
+            CHKERR(typing_expression(t, li->value, &(l->items[n++])));
+        CHKERR(typing_variable(t, &(l->items[n])));
+        CHKERR(typing_expression(t, v->value.funccall.callee, &r));
+        CHKERR(typing_unify_at(t, v, r, l));
+        ret    = l->items[n];
+        proven = typing_is_constructor(t, v->value.funccall.callee);
+        break;
+      case EXPR_KIND_FUNCTION:
+        for(list_t * li = v->value.function.arguments; li != nullptr; li = LIST_NEXT(li))
+          n++;
+        CHKERR(typing_new_type_fresh(t, TYPE_KIND_FUNCTION, n, &ret));
+        n = 0;
+        for(list_t * li = v->value.function.arguments; li != nullptr; li = LIST_NEXT(li), n++)
+          CHKERR(typing_bind(
+            t, (deconstructor_t *)(&(li->value)), ret->items[n], TYPING_BINDING_ARGUMENT, nullptr,
+            v));
+        CHKERR(typing_expression(t, v->value.function.body, &r));
+        CHKERR(typing_unify_at(t, v, ret->items[n], r));
+        break;
+      case EXPR_KIND_CASE:
+        CHKERR(typing_expression(t, v->value.caseof.of, &l));
+        CHKERR(typing_variable(t, &ret));
+        for(parser_branch_list_t * bl = v->value.caseof.branches; bl != nullptr; bl = bl->next) {
+          CHKERR(typing_bind(t, bl->deconstruct, l, TYPING_BINDING_LOCAL, v->value.caseof.of, v));
+          CHKERR(typing_expression(t, bl->body, &r));
+          CHKERR(typing_unify_at(t, v, ret, r));
+          t->scope.length = visible;
+        }
+        break;
+      case EXPR_KIND_BEGIN:
+        for(parser_branch_list_t * bl = v->value.begin.branches; bl != nullptr; bl = bl->next) {
+          CHKERR(typing_expression(t, bl->body, &ret));
+          if(bl->next != nullptr && bl->deconstruct != nullptr)
+            CHKERR(typing_bind(t, bl->deconstruct, ret, TYPING_BINDING_LOCAL, bl->body, v));
+        }
+        if(ret == nullptr) CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &ret));
+        break;
+      default:
+        CHKERR(typing_new_type(t, TYPE_KIND_ANY, 0, &ret));
+        break;
+    }
+  CHKERR(typing_record(t, v, ret, binding, proven));
+  *out = ret;
+err:
+  t->scope.length = visible;
+  return errres;
+}
+
+static int
+typing_entry_compare(const void * a, const void * b)
+{
+  uintptr_t ka = (uintptr_t)((const typing_entry_t *)a)->key;
+  uintptr_t kb = (uintptr_t)((const typing_entry_t *)b)->key;
+  return ka < kb ? -1 : (ka > kb ? 1 : 0);
+}
+
+em_result
+typing_infer(typing_t * self, parser_expression_t * v)
+{
+  em_result errres = EM_RESULT_OK;
+  type_t *  ret    = nullptr;
+  self->root         = v;
+  self->recording    = true;
+  self->scope_base   = 0;
+  errres             = typing_definition(self, v, &ret);
+  self->scope.length = 0;
+  CHKERR(errres);
+  if(self->entries.length > 1)
+    qsort(
+      self->entries.buffer, self->entries.length, sizeof(typing_entry_t), typing_entry_compare);
+err:
+  return errres;
+}
+
+// ! Find the entry of the expression or the argument.
+static typing_entry_t *
+typing_find(typing_t * t, const void * key)
+{
+  typing_entry_t e = {.key = key};
+  if(t->entries.length == 0) return nullptr;
+  return (typing_entry_t *)bsearch(
+    &e, t->entries.buffer, t->entries.length, sizeof(typing_entry_t), typing_entry_compare);
+}
+
+static bool typing_proves(typing_t * t, parser_expression_t * v);
+
+// ! Is the value of the local variable proven to be its type?
+static bool
+typing_binding_proves(typing_t * t, typing_binding_t * b)
+{
+  switch(b->kind) {
+    // Checked at the entry.(See typing_guards_int.)
+    case TYPING_BINDING_ARGUMENT:
+      return typing_resolve(b->type)->kind == TYPE_KIND_INT;
+    case TYPING_BINDING_LOCAL:
+      return b->value != nullptr && typing_proves(t, b->value);
+    default:
+      return false;
+  }
+}
+
+// ! Is the value of the expression proven to be its type?
+/* !
+ * Only heads of types are proven.(e.g. elements of tuples are not.)
+ */
+static bool
+typing_proves(typing_t * t, parser_expression_t * v)
+{
+  typing_entry_t * e = nullptr;
+  if(!EXPR_IS_POINTER(v)) return EXPR_KIND_IS_INTEGER(v) || EXPR_KIND_IS_BOOLEAN(v);
+  if(EXPR_KIND_IS_BIN_OP(v))
+    return v->kind != EXPR_KIND_DOR;
+  switch(v->kind) {
+    case EXPR_KIND_TUPLE:
+    case EXPR_KIND_FUNCTION:
+      return true;
+    case EXPR_KIND_IDENTIFIER:
+    case EXPR_KIND_FUNCCALL:
+      e = typing_find(t, v);
+      if(e == nullptr) return false;
+      return e->binding != nullptr ? typing_binding_proves(t, e->binding) : e->proven;
+    case EXPR_KIND_IF:
+      return typing_proves(t, v->value.ifthenelse.then)
+             && typing_proves(t, v->value.ifthenelse.otherwise);
+    case EXPR_KIND_CASE:
+      // The result is nil if no branches match.
+      for(parser_branch_list_t * bl = v->value.caseof.branches; bl != nullptr; bl = bl->next) {
+        if(!typing_proves(t, bl->body)) return false;
+        if(
+          bl->deconstruct->kind == DECONSTRUCTOR_IDENTIFIER
+          || bl->deconstruct->kind == DECONSTRUCTOR_ANY)
+          return true;
+      }
+      return false;
+    case EXPR_KIND_BEGIN:
+      for(parser_branch_list_t * bl = v->value.begin.branches; bl != nullptr; bl = bl->next)
+        if(bl->next == nullptr) return typing_proves(t, bl->body);
+      return false;
+    default:
+      return false;
+  }
+}
+
+// ! Get the type of the proven expression.
+static type_t *
+typing_proven_type(typing_t * t, parser_expression_t * v)
+{
+  typing_entry_t * e = nullptr;
+  if(t == nullptr || !EXPR_IS_POINTER(v)) return nullptr;
+  e = typing_find(t, v);
+  if(e == nullptr || !typing_proves(t, v)) return nullptr;
+  return typing_resolve(e->type);
+}
+
+bool
+typing_proves_int(typing_t * self, parser_expression_t * v)
+{
+  type_t * type = nullptr;
+  if(self == nullptr) return false;
+  if(!EXPR_IS_POINTER(v)) return EXPR_KIND_IS_INTEGER(v);
+  type = typing_proven_type(self, v);
+  return type != nullptr && type->kind == TYPE_KIND_INT;
+}
+
+bool
+typing_proves_function(typing_t * self, parser_expression_t * v, int arity)
+{
+  type_t * type = typing_proven_type(self, v);
+  return type != nullptr && type->kind == TYPE_KIND_FUNCTION && type->arity == (size_t)arity;
+}
+
+bool
+typing_proves_record(typing_t * self, parser_expression_t * v, record_tag_t tag, size_t index)
+{
+  type_t * type = typing_proven_type(self, v);
+  return type != nullptr && type->kind == TYPE_KIND_TUPLE && type->tag == tag
+         && index < type->arity;
+}
+
+bool
+typing_guards_int(typing_t * self, deconstructor_t * d)
+{
+  typing_entry_t * e = nullptr;
+  if(self == nullptr || d->kind != DECONSTRUCTOR_IDENTIFIER) return false;
+  e = typing_find(self, d);
+  return e != nullptr && typing_resolve(e->type)->kind == TYPE_KIND_INT;
+}
+
+// ! Print the type.
+static void
+typing_print_type(type_t * v)
+{
+  string_t * name = nullptr;
+  v               = typing_resolve(v);
+  switch(v->kind) {
+    case TYPE_KIND_VARIABLE:
+      em_diag_puts("_");
+      break;
+    case TYPE_KIND_ANY:
+      em_diag_puts("Any");
+      break;
+    case TYPE_KIND_INT:
+      em_diag_puts("Int");
+      break;
+    case TYPE_KIND_BOOL:
+      em_diag_puts("Bool");
+      break;
+    case TYPE_KIND_TUPLE:
+      if(v->tag != RECORD_TAG_NONE) {
+        name = record_table_name(v->tag);
+        em_diag_write(name->buffer, name->length);
+        if(v->arity == 0) break;
+      }
+      em_diag_puts("(");
+      for(size_t i = 0; i < v->arity; ++i) {
+        if(i > 0) em_diag_puts(", ");
+        typing_print_type(v->items[i]);
+      }
+      em_diag_puts(")");
+      break;
+    case TYPE_KIND_FUNCTION:
+      em_diag_puts("func(");
+      for(size_t i = 0; i < v->arity; ++i) {
+        if(i > 0) em_diag_puts(", ");
+        typing_print_type(v->items[i]);
+      }
+      em_diag_puts(") -> ");
+      typing_print_type(v->items[v->arity]);
+      break;
+  }
+}
+
+void
+typing_print_error(typing_t * self)
+{
+  if(self->error_at == nullptr) {
+    em_diag_puts("Type mismatch.\n");
+    return;
+  }
+  em_diag_puts("Type mismatch: ");
+  typing_print_type(self->error_expected);
+  em_diag_puts(" and ");
+  typing_print_type(self->error_actual);
+  em_diag_puts(" in ");
+  parser_expression_print(self->error_at);
+  em_diag_puts("\n");
+}
+
+void
+typing_free(typing_t * self)
+{
+  arraylist_free(&(self->entries));
+  arraylist_free(&(self->scope));
+  arraylist_free(&(self->memos));
+  arena_free(&(self->arena));
+}
@@ -12,96 +12,147 @@
 size_t
 var_hasher(void * val)
 {
-  return string_hash(&(((variable_t *)val)->name));
+  return atom_hash(((variable_t *)val)->name);
 }
-// node_t and string_t
+// variable_t and atom_t
 bool
 var_compare(void * l, void * r)
 {
-  return string_compare(&(((variable_t *)l)->name), (string_t *)r);
+  return ((variable_t *)l)->name == (atom_t)r;
 }
 bool
 var_compare2(void * l, void * r)
 {
-  variable_t * lhs = (variable_t *)l;
-  variable_t * rhs = (variable_t *)r;
-  return string_compare(&(lhs->name), &(rhs->name));
+  return ((variable_t *)l)->name == ((variable_t *)r)->name;
 }
 
 em_result
-variable_table_new(struct machine_t * m, variable_table_t * out, variable_table_t * parent)
+variable_table_new(
+  struct machine_t * m, variable_table_t ** out, variable_table_t * parent, size_t length)
 {
-  em_result  errres = EM_RESULT_OK;
-  object_t * o_ref  = nullptr;
+  em_result          errres = EM_RESULT_OK;
+  object_t *         o_ref  = nullptr;
+  variable_table_t * ret    = nullptr;
+  CHKERR(em_malloc((void **)&ret, sizeof(variable_table_t) + length * sizeof(object_t *)));
+  ret->slots  = (object_t **)(ret + 1);
+  ret->length = length;
+  ret->parent = parent;
+  for(size_t i = 0; i < length; ++i)
+    ret->slots[i] = nullptr;
   CHKERR(machine_alloc(m, &o_ref));
-  CHKERR(object_new_variable_table(o_ref, out));
-  out->this_object_ref = o_ref;
-  out->parent          = parent;
-  CHKERR(dictionary_new(&(out->table)));
+  CHKERR(object_new_variable_table(o_ref, ret));
+  ret->this_object_ref = o_ref;
+  *out                 = ret;
   return EM_RESULT_OK;
 err:
   if(o_ref != nullptr) machine_return(m, o_ref);
+  if(ret != nullptr) em_free(ret);
   return errres;
 }
 
 em_result
-variable_table_assign(machine_t * m, variable_table_t * self, string_t * name, object_t * value)
+variable_dictionary_assign(machine_t * m, dictionary_t * self, atom_t name, object_t * value)
 {
   em_result    errres;
   variable_t * var_ptr;
   variable_t   new_var = {0};
-  if(dictionary_get(
-       &(self->table), (void **)&var_ptr, (size_t(*)(void *))string_hash, var_compare, name)) {
+  if(dictionary_get(self, (void **)&var_ptr, (size_t(*)(void *))atom_hash, var_compare, name)) {
     CHKERR(machine_mark_gray(m, var_ptr->value));
-    var_ptr->value = value;
+    if(!var_ptr->defined) {
+      var_ptr->defined   = true;
+      m->globals_changed = true;
+    } else if(var_ptr->value != value) {
+      // Only the definitions which depend on the previous value are compiled again.
+      for(size_t i = 0; i < var_ptr->dependents.length; ++i)
+        CHKERR(variable_dependents_add(
+          &(m->outdated), &(((variable_dependent_t *)var_ptr->dependents.buffer)[i])));
+      var_ptr->dependents.length = 0;
+      m->globals_changed         = true;
+    }
+    var_ptr->value    = value;
+    var_ptr->constant = false;
     return EM_RESULT_OK;
   }
-  CHKERR(string_copy(&(new_var.name), name));
+  m->globals_changed = true;  // Functions may refer to it already.
+  CHKERR(variable_new(&new_var, name));
   new_var.value = value;
-  CHKERR2(
-    err2,
-    dictionary_add(
-      &(self->table), &new_var, sizeof(variable_t), var_hasher, var_compare2, nullptr, nullptr));
-  return EM_RESULT_OK;
-err2:
-  string_free(&(new_var.name));
+  CHKERR(
+    dictionary_add(self, &new_var, sizeof(variable_t), var_hasher, var_compare2, nullptr, nullptr));
+  // return EM_RESULT_OK;
 err:
   return errres;
 }
 
-bool
-variable_table_lookup(variable_table_t * self, object_t ** out, string_t * name)
+em_result
+variable_dependents_add(arraylist_t * self, const variable_dependent_t * dependent)
 {
+  for(size_t i = 0; i < self->length; ++i) {
+    variable_dependent_t * d = &(((variable_dependent_t *)self->buffer)[i]);
+    if(d->name == dependent->name && d->node == dependent->node) return EM_RESULT_OK;
+  }
+  return arraylist_append(self, sizeof(variable_dependent_t), (void *)dependent);
+}
+
+em_result
+variable_dictionary_backup(dictionary_t * self, variable_t * out, atom_t name)
+{
+  em_result    errres = EM_RESULT_OK;
   variable_t * var_ptr;
-  while(self != nullptr) {
-    if(dictionary_get(
-         &(self->table), (void **)&var_ptr, (size_t(*)(void *))string_hash, var_compare, name)) {
-      *out = var_ptr->value;
-      return true;
-    }
-    self = self->parent;
+  variable_new(out, name);
+  if(!variable_dictionary_lookup(self, &var_ptr, name)) {
+    out->defined = false;
+    return EM_RESULT_OK;
   }
-  return false;
+  out->value    = var_ptr->value;
+  out->constant = var_ptr->constant;
+  if(var_ptr->dependents.length == 0) return EM_RESULT_OK;
+  CHKERR(em_allocarray(
+    &(out->dependents.buffer), var_ptr->dependents.length, sizeof(variable_dependent_t)));
+  memcpy(
+    out->dependents.buffer, var_ptr->dependents.buffer,
+    var_ptr->dependents.length * sizeof(variable_dependent_t));
+  out->dependents.length   = var_ptr->dependents.length;
+  out->dependents.capacity = var_ptr->dependents.length;
+err:
+  return errres;
+}
+
+em_result
+variable_dictionary_restore(machine_t * m, dictionary_t * self, variable_t * backup)
+{
+  em_result    errres = EM_RESULT_OK;
+  variable_t * var_ptr;
+  if(!dictionary_get(
+       self, (void **)&var_ptr, (size_t(*)(void *))atom_hash, var_compare, backup->name))
+    return EM_RESULT_OK;  // Not defined yet.
+  CHKERR(machine_mark_gray(m, var_ptr->value));
+  arraylist_free(&(var_ptr->dependents));
+  var_ptr->value      = backup->value;
+  var_ptr->constant   = backup->constant;
+  var_ptr->defined    = backup->defined;
+  var_ptr->dependents = backup->dependents;
+  arraylist_default(&(backup->dependents));
+  m->globals_changed = true;
+err:
+  return errres;
+}
+
+bool
+variable_dictionary_lookup(dictionary_t * self, variable_t ** out, atom_t name)
+{
+  return dictionary_get(self, (void **)out, (size_t(*)(void *))atom_hash, var_compare, name)
+         && (*out)->defined;
 }
 
 void
 variable_deep_free(variable_t * v)
 {
-  string_free(&(v->name));
+  // The name is owned by machine_t::atoms.
+  arraylist_free(&(v->dependents));
 }
 
 void
 variable_table_free(variable_table_t * v)
 {
-  list_t * li;
-  FOREACH_DICTIONARY(li, &(v->table))
-  {
-    while(li != nullptr) {
-      list_t * ne = LIST_NEXT(li);
-      variable_deep_free((variable_t *)(&(li->value)));
-      em_free(li);
-      li = ne;
-    }
-  }
   em_free(v);
 }